@@ -1,11 +1,56 @@
 import gzip
+import os
 import zstandard as zstd
+from django.conf import settings
 from django.utils.deprecation import MiddlewareMixin
 
+
+def load_zstd_dictionaries(directory):
+    """
+    Loads every trained dictionary in directory, keyed by its zstd dictionary ID.
+    """
+    dictionaries = {}
+    if not directory or not os.path.isdir(directory):
+        return dictionaries
+    for name in sorted(os.listdir(directory)):
+        if not name.endswith('.dict'):
+            continue
+        try:
+            with open(os.path.join(directory, name), 'rb') as f:
+                dictionary = zstd.ZstdCompressionDict(f.read())
+            dictionaries[dictionary.dict_id()] = dictionary
+            print(f"[Middleware] Loaded zstd dictionary {name} (id {dictionary.dict_id()})")
+        except Exception as e:
+            print(f"[Middleware] Failed to load zstd dictionary {name}: {e}")
+    return dictionaries
+
+
+def zstd_decompress(body, dictionaries):
+    """
+    Decompresses one zstd frame, with the trained dictionary it names (if any).
+    decompressobj() also handles streamed frames, which carry no content size.
+    """
+    dict_id = zstd.get_frame_parameters(body).dict_id
+    if dict_id:
+        dictionary = dictionaries.get(dict_id)
+        if dictionary is None:
+            raise ValueError(f"unknown zstd dictionary id {dict_id}")
+        dctx = zstd.ZstdDecompressor(dict_data=dictionary)
+    else:
+        dctx = zstd.ZstdDecompressor()
+    return dctx.decompressobj().decompress(body)
+
+
 class DecompressMiddleware(MiddlewareMixin):
     """
     Middleware to decompress request body if Content-Encoding is gzip or zstd.
+    Zstd frames compressed with a trained dictionary are decompressed with the
+    matching one from ZSTD_DICTIONARY_DIR.
     """
+    def __init__(self, get_response=None):
+        super().__init__(get_response)
+        self.dictionaries = load_zstd_dictionaries(getattr(settings, 'ZSTD_DICTIONARY_DIR', None))
+
     def process_request(self, request):
         # Only process/log for telemetry endpoint to reduce noise
         if request.path == '/api/v1/telemetry/':
@@ -18,8 +63,7 @@ class DecompressMiddleware(MiddlewareMixin):
                     print(f"[Middleware] Received Auth Header: '{auth_header}'")
                     print(f"[Middleware] Decompressing {compressed_size} bytes (Zstd)...")
                     
-                    dctx = zstd.ZstdDecompressor()
-                    request._body = dctx.decompress(request.body)
+                    request._body = zstd_decompress(request.body, self.dictionaries)
                     decompressed_size = len(request._body)
                     
                     print(f"[Middleware] ✅ Decompressed {compressed_size} → {decompressed_size} bytes (saved {((decompressed_size - compressed_size) / decompressed_size * 100):.1f}%)")
@@ -222,6 +222,13 @@ RATELIMIT_PAGE_VIEW = os.getenv('RATELIMIT_PAGE_VIEW', '200/m')  # HTML page vie
 
 
 
+# ==========================================
+# TELEMETRY COMPRESSION
+# ==========================================
+# Trained zstd dictionaries (*.dict) the agents may compress with. Frames name
+# their dictionary by ID, so several generations can be deployed side by side.
+ZSTD_DICTIONARY_DIR = os.getenv('ZSTD_DICTIONARY_DIR', str(BASE_DIR / 'zstd_dicts'))
+
 LOGGING = {
     'version': 1,
     'disable_existing_loggers': False,
@@ -16,11 +16,12 @@ Including another URLconf
 """
 from django.contrib import admin
 from django.urls import path , include
-from health.views import health_check
+from health.views import health_check, agent_health
 
 urlpatterns = [
     path('admin/', admin.site.urls),
     path('api/v1/health/', health_check, name='health'),
+    path('api/v1/health/agent/', agent_health, name='agent_health'),
     # ========== INGESTION APP URLs ==========
     # This includes ALL ingestion URLs (telemetry, dashboard, etc.)
     path('', include('ingestion.urls')),
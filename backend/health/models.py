@@ -1,3 +1,25 @@
-from django.db import models
+from mongoengine import Document, StringField, DateTimeField, DictField, IntField
+from datetime import datetime, timezone
 
-# Create your models here.
+
+class AgentHealth(Document):
+    """One agent_health report: pipeline counters and per-stage latencies for an interval."""
+    agent_id = StringField(required=True)
+    timestamp = DateTimeField(required=True)  # Agent clock, UTC
+    version = StringField()
+    uptime_s = IntField(default=0)
+    interval_s = IntField(default=0)
+    metrics = DictField(required=True)        # {"counters": {...}, "stages": {...}}
+    log_suppressed = IntField(default=0)
+    spool_pending_bytes = IntField()          # Bytes waiting in the agent's spool, when enabled
+    rate_control = DictField()                # Send rate, batch size and backoff state, when enabled
+    governor = DictField()                    # Resource governor level and usage, when enabled
+    received_at = DateTimeField(default=lambda: datetime.now(timezone.utc))
+
+    meta = {
+        'collection': 'agent_health',
+        'indexes': ['agent_id', 'timestamp', ('agent_id', '-timestamp')]
+    }
+
+    def __str__(self):
+        return f"Health from {self.agent_id} at {self.timestamp}"
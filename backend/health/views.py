@@ -1,8 +1,67 @@
 from rest_framework.decorators import api_view, permission_classes
-from rest_framework.permissions import AllowAny
+from rest_framework.permissions import AllowAny, IsAuthenticated
 from rest_framework.response import Response
+from rest_framework import status
+from datetime import datetime
+import logging
+
+from .models import AgentHealth
+
+logger = logging.getLogger(__name__)
+
+
+def _optional_dict(data, key):
+    """A section the agent only sends when that subsystem is enabled."""
+    value = data.get(key)
+    return value if isinstance(value, dict) else {}
+
 
 @api_view(['GET'])
 @permission_classes([AllowAny])
 def health_check(request):
     return Response({'status': 'ok'})
+
+
+@api_view(['POST'])
+@permission_classes([IsAuthenticated])
+def agent_health(request):
+    """
+    Store a periodic agent_health report (pipeline counters and stage latency percentiles).
+    """
+    data = request.data
+    agent_id = data.get('agent_id') if isinstance(data, dict) else None
+    metrics = data.get('metrics') if isinstance(data, dict) else None
+
+    if not agent_id or not isinstance(metrics, dict):
+        return Response({
+            'status': 'error',
+            'message': 'agent_id and metrics are required'
+        }, status=status.HTTP_400_BAD_REQUEST)
+
+    try:
+        timestamp = datetime.fromisoformat(str(data.get('timestamp', '')).replace('Z', '+00:00'))
+    except ValueError:
+        return Response({
+            'status': 'error',
+            'message': 'timestamp must be ISO-8601'
+        }, status=status.HTTP_400_BAD_REQUEST)
+
+    try:
+        AgentHealth(
+            agent_id=agent_id,
+            timestamp=timestamp,
+            version=str(data.get('version', '')),
+            uptime_s=int(data.get('uptime_s', 0)),
+            interval_s=int(data.get('interval_s', 0)),
+            metrics=metrics,
+            log_suppressed=int(data.get('log_suppressed', 0)),
+            spool_pending_bytes=int(data['spool_pending_bytes']) if 'spool_pending_bytes' in data else None,
+            rate_control=_optional_dict(data, 'rate_control'),
+            governor=_optional_dict(data, 'governor'),
+        ).save()
+    except Exception as e:
+        logger.error(f"Failed to store health report from {agent_id}: {str(e)}")
+        return Response({'status': 'error', 'message': 'Failed to store report'},
+                        status=status.HTTP_500_INTERNAL_SERVER_ERROR)
+
+    return Response({'status': 'accepted'}, status=status.HTTP_201_CREATED)
@@ -5,7 +5,10 @@ from rest_framework.response import Response
 from rest_framework import status
 from django.utils import timezone
 from datetime import timedelta, timezone as dt_timezone
+import asyncio
 import json
+import re
+import time
 
 from .models_mongo import PendingCommand, ResponseAction
 from .rbac_decorators import require_analyst_or_admin
@@ -16,7 +19,20 @@ from django.conf import settings
 # WebSocket Command Push
 # ==========================================
 from channels.layers import get_channel_layer
-from asgiref.sync import async_to_sync
+from asgiref.sync import async_to_sync, sync_to_async
+from django.http import JsonResponse, HttpResponse
+
+# Long-poll limits: the agent asks for wait=N seconds, the server caps it
+LONG_POLL_MAX_S = 55
+MAX_COMMANDS_PER_POLL = 50
+
+
+def agent_group_name(agent_id):
+    """
+    Channel layer group a single agent's long-poll waits on.
+    Group names only allow ASCII alphanumerics, hyphens, underscores and periods.
+    """
+    return 'agent_' + re.sub(r'[^A-Za-z0-9_.-]', '_', agent_id)[:80]
 
 def push_command_via_websocket(command):
     """
@@ -48,6 +64,8 @@ def push_command_via_websocket(command):
     try:
         # Send to all agents in the 'agents' group
         async_to_sync(channel_layer.group_send)("agents", message)
+        # And wake the target agent's long-poll, if it is waiting on one
+        async_to_sync(channel_layer.group_send)(agent_group_name(command.agent_id), message)
         print(f"[WebSocket] Command {command.command_id} pushed to agents group")
     except Exception as e:
         print(f"[WebSocket] Error pushing command: {e}")
@@ -56,6 +74,37 @@ def push_command_via_websocket(command):
 # AGENT APIs (Polling & Reporting)
 # ==========================================
 
+def claim_commands(agent_id, limit):
+    """
+    Takes up to limit 'new' commands for agent_id, oldest first, and marks them
+    in_progress. Each is claimed with a conditional update, so a command is
+    handed out once even when a poll and a WebSocket connect race for it.
+    Expired commands are marked 'timeout' on the way.
+    """
+    now = timezone.now()
+    claimed = []
+    candidates = PendingCommand.objects(agent_id=agent_id, status='new').order_by('created_at').limit(limit * 2)
+    for command in candidates:
+        if len(claimed) >= limit:
+            break
+
+        expires_at = command.expires_at
+        if expires_at is not None:
+            if timezone.is_naive(expires_at):
+                expires_at = timezone.make_aware(expires_at, dt_timezone.utc)
+            if expires_at < now:
+                PendingCommand.objects(id=command.id, status='new').update_one(set__status='timeout')
+                continue
+
+        if PendingCommand.objects(id=command.id, status='new').update_one(set__status='in_progress'):
+            claimed.append({
+                'command_id': command.command_id,
+                'type': command.command_type,
+                'parameters': command.parameters
+            })
+    return claimed
+
+
 @api_view(['GET'])
 @permission_classes([IsAuthenticated])
 @ratelimit_with_logging(key='header:HTTP_X_AGENT_TOKEN', rate='300/m', method='GET')
@@ -72,32 +121,90 @@ def poll_commands(request):
     if not agent_id:
         return Response({'error': 'X-Agent-ID header required'}, status=status.HTTP_400_BAD_REQUEST)
 
-    # Find the oldest 'new' command for this agent
-    command = PendingCommand.objects(agent_id=agent_id, status='new').order_by('created_at').first()
-    
-    if command:
-        # Check if expired
-        expires_at = command.expires_at
-        if timezone.is_naive(expires_at):
-            expires_at = timezone.make_aware(expires_at, dt_timezone.utc)
-
-        if expires_at < timezone.now():
-            command.status = 'timeout'
-            command.save()
+    # ?max=N: everything pending (up to N) as {"commands": [...]}
+    if 'max' in request.query_params:
+        try:
+            limit = max(1, min(int(request.query_params['max']), MAX_COMMANDS_PER_POLL))
+        except ValueError:
+            return Response({'error': 'max must be an integer'}, status=status.HTTP_400_BAD_REQUEST)
+        commands = claim_commands(agent_id, limit)
+        if not commands:
             return Response(status=status.HTTP_204_NO_CONTENT)
-            
-        # Mark as in progress
-        command.status = 'in_progress'
-        command.save()
-        
-        return Response({
-            'command_id': command.command_id,
-            'type': command.command_type,
-            'parameters': command.parameters
-        })
+        return Response({'commands': commands})
+
+    # Otherwise the oldest 'new' command for this agent
+    commands = claim_commands(agent_id, 1)
+    if commands:
+        return Response(commands[0])
     
     return Response(status=status.HTTP_204_NO_CONTENT)
 
+
+async def wait_for_commands(request):
+    """
+    Long-poll variant of poll_commands: GET ?wait=<s>&max=<n>.
+    Holds the request until a command is queued for the agent or wait seconds
+    pass, then returns {"commands": [...]} (up to max), or 204 when none came.
+
+    A plain async Django view rather than a DRF one, so a held request costs
+    a coroutine, not a worker thread. push_command_via_websocket wakes it
+    through the agent's channel layer group.
+    """
+    if request.method != 'GET':
+        return JsonResponse({'error': 'Method not allowed'}, status=405)
+
+    # Same token the agent uses everywhere else
+    try:
+        auth = await sync_to_async(TokenAuthentication().authenticate)(request)
+    except Exception:
+        auth = None
+    if auth is None:
+        return JsonResponse({'detail': 'Authentication credentials were not provided.'}, status=401)
+
+    agent_id = request.headers.get('X-Agent-ID')
+    if not agent_id:
+        return JsonResponse({'error': 'X-Agent-ID header required'}, status=400)
+
+    try:
+        wait = max(0, min(int(request.GET.get('wait', 0)), LONG_POLL_MAX_S))
+        limit = max(1, min(int(request.GET.get('max', 1)), MAX_COMMANDS_PER_POLL))
+    except ValueError:
+        return JsonResponse({'error': 'wait and max must be integers'}, status=400)
+
+    claim = sync_to_async(claim_commands, thread_sensitive=False)
+    commands = await claim(agent_id, limit)
+
+    channel_layer = get_channel_layer()
+    deadline = time.monotonic() + wait
+    if not commands and wait > 0:
+        channel = None
+        group = agent_group_name(agent_id)
+        if channel_layer is not None:
+            channel = await channel_layer.new_channel()
+            await channel_layer.group_add(group, channel)
+        try:
+            # Claimed again after every wake-up (and every few seconds without a
+            # channel layer); a wake-up for a command another path took just loops
+            while not commands:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    break
+                if channel is not None:
+                    try:
+                        await asyncio.wait_for(channel_layer.receive(channel), remaining)
+                    except asyncio.TimeoutError:
+                        pass
+                else:
+                    await asyncio.sleep(min(remaining, 2))
+                commands = await claim(agent_id, limit)
+        finally:
+            if channel is not None:
+                await channel_layer.group_discard(group, channel)
+
+    if not commands:
+        return HttpResponse(status=204)
+    return JsonResponse({'commands': commands})
+
 @api_view(['POST'])
 @permission_classes([IsAuthenticated])
 @ratelimit_with_logging(key='header:HTTP_X_AGENT_TOKEN', rate='50/m', method='POST')
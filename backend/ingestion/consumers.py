@@ -9,6 +9,7 @@ How it works:
 2. Consumer accepts and adds agent to "agents" group
 3. When dashboard sends command, Consumer pushes it to agent
 4. Agent responds, Consumer processes the response
+5. Agent may also stream telemetry batches as binary frames (see receive)
 """
 
 import json
@@ -16,9 +17,23 @@ import logging
 from channels.generic.websocket import AsyncWebsocketConsumer
 from channels.db import database_sync_to_async
 from asgiref.sync import sync_to_async
+from django.conf import settings
+from edr_server.middleware import load_zstd_dictionaries, zstd_decompress
 
 logger = logging.getLogger(__name__)
 
+# Binary telemetry frame: u64 batch_id (little-endian), then one zstd frame
+BATCH_ID_BYTES = 8
+
+_zstd_dictionaries = None
+
+
+def _dictionaries():
+    global _zstd_dictionaries
+    if _zstd_dictionaries is None:
+        _zstd_dictionaries = load_zstd_dictionaries(getattr(settings, 'ZSTD_DICTIONARY_DIR', None))
+    return _zstd_dictionaries
+
 
 class AgentConsumer(AsyncWebsocketConsumer):
     """
@@ -41,6 +56,18 @@ class AgentConsumer(AsyncWebsocketConsumer):
         "status": "success|failed",
         "result": {...}
     }
+
+    Telemetry (Agent → Server, binary frame):
+        u64 batch_id (little-endian) + zstd-compressed JSON array or
+        application/x-edr-batch body, answered with
+    {
+        "type": "telemetry_ack",
+        "batch_id": 42,
+        "status": "accepted|rejected|unauthorized",
+        "batch_size": 500
+    }
+    Batches are only taken from agents that sent a valid
+    "Authorization: Token ..." header in the handshake.
     """
     
     async def connect(self):
@@ -52,6 +79,9 @@ class AgentConsumer(AsyncWebsocketConsumer):
         2. Add agent to "agents" group for broadcast commands
         3. Log the connection
         """
+        # Telemetry needs the same token as the HTTP endpoint; commands do not (yet)
+        self.agent_user = await self.authenticate_token()
+
         # Accept the WebSocket connection
         await self.accept()
         
@@ -71,6 +101,10 @@ class AgentConsumer(AsyncWebsocketConsumer):
             "message": "Connected to EDR Server",
             "channel": self.channel_name
         }))
+
+        # Commands queued while the agent was offline (it polls over HTTP only
+        # while this connection is down, so nothing else would pick them up)
+        await self.deliver_queued_commands()
     
     async def disconnect(self, close_code):
         """
@@ -92,18 +126,24 @@ class AgentConsumer(AsyncWebsocketConsumer):
         logger.info(f"[WebSocket] Agent disconnected: {self.channel_name} (code: {close_code})")
         print(f"[-] Agent disconnected: {self.channel_name} (code: {close_code})")
     
-    async def receive(self, text_data):
+    async def receive(self, text_data=None, bytes_data=None):
         """
         Called when agent sends a message to the server.
         
         This handles:
         - Command responses from agent
         - Heartbeat messages
+        - Telemetry batches (binary frames)
         - Any agent-initiated communication
         
         Args:
             text_data: JSON string from agent
+            bytes_data: Telemetry batch frame from agent
         """
+        if bytes_data is not None:
+            await self.handle_telemetry_batch(bytes_data)
+            return
+
         try:
             data = json.loads(text_data)
             message_type = data.get("type", "unknown")
@@ -157,6 +197,125 @@ class AgentConsumer(AsyncWebsocketConsumer):
         if command_id:
             await self.update_command_status(command_id, status, message)
     
+    async def deliver_queued_commands(self):
+        """
+        Claims everything pending for the agent named in the handshake's
+        X-Agent-ID header and pushes it, oldest first.
+        """
+        from .command_views import MAX_COMMANDS_PER_POLL, claim_commands
+
+        headers = dict(self.scope.get('headers', []))
+        agent_id = headers.get(b'x-agent-id', b'').decode('utf-8', 'replace')
+        if self.agent_user is None or not agent_id:
+            return
+
+        commands = await database_sync_to_async(claim_commands)(agent_id, MAX_COMMANDS_PER_POLL)
+        for command in commands:
+            await self.send(text_data=json.dumps({
+                "type": "command",
+                "command_id": command['command_id'],
+                "action": command['type'],
+                "parameters": command['parameters']
+            }))
+        if commands:
+            logger.info(f"[WebSocket] Delivered {len(commands)} queued command(s) to {agent_id}")
+
+    # =========================================================
+    # Telemetry over the persistent connection
+    # =========================================================
+
+    @database_sync_to_async
+    def authenticate_token(self):
+        """
+        Returns the user of the handshake's "Authorization: Token <key>", or None.
+        """
+        from rest_framework.authtoken.models import Token
+
+        headers = dict(self.scope.get('headers', []))
+        parts = headers.get(b'authorization', b'').decode('latin-1').split()
+        if len(parts) != 2 or parts[0].lower() != 'token':
+            return None
+        token = Token.objects.select_related('user').filter(key=parts[1]).first()
+        if token is None or not token.user.is_active:
+            return None
+        return token.user
+
+    async def handle_telemetry_batch(self, frame):
+        """
+        Decodes one batch frame, queues its events like telemetry_endpoint does
+        and acknowledges it. Anything but "accepted" makes the agent spool the batch.
+        """
+        if len(frame) <= BATCH_ID_BYTES:
+            logger.warning("[WebSocket] Truncated telemetry frame")
+            return
+        batch_id = int.from_bytes(frame[:BATCH_ID_BYTES], 'little')
+
+        if self.agent_user is None:
+            await self.send_telemetry_ack(batch_id, 'unauthorized', message='Token required for telemetry')
+            return
+
+        try:
+            events = await sync_to_async(self.decode_batch_frame)(frame[BATCH_ID_BYTES:])
+            queued, failed = await self.queue_events(events)
+        except ValueError as e:
+            logger.error(f"[WebSocket] Rejected batch {batch_id}: {e}")
+            await self.send_telemetry_ack(batch_id, 'rejected', message=str(e))
+            return
+
+        print(f"\n[Ingestion] Queued {queued} of {len(events)} event(s) (WebSocket batch {batch_id})")
+        await self.send_telemetry_ack(batch_id, 'accepted', batch_size=len(events), failed=failed)
+
+    @staticmethod
+    def decode_batch_frame(compressed):
+        """
+        zstd frame -> list of event dicts (binary batch or JSON array).
+        Raises ValueError for anything the HTTP endpoint would answer 400 to.
+        """
+        from rest_framework.exceptions import ParseError
+        from .parsers import MAGIC, decode_batch
+        from .serializers import TelemetrySerializer
+
+        try:
+            body = zstd_decompress(compressed, _dictionaries())
+            if body[:len(MAGIC)] == MAGIC:
+                events = decode_batch(body)
+            else:
+                events = json.loads(body)
+        except (ParseError, json.JSONDecodeError, UnicodeDecodeError) as e:
+            raise ValueError(f'Invalid batch: {e}')
+        except Exception as e:
+            raise ValueError(f'Decompression failed: {e}')
+
+        if not isinstance(events, list):
+            events = [events]
+        serializer = TelemetrySerializer(data=events, many=True)
+        if not serializer.is_valid():
+            raise ValueError(f'Validation failed: {serializer.errors}')
+        return serializer.validated_data
+
+    @database_sync_to_async
+    def queue_events(self, events):
+        from .tasks import telemetry_ingest
+
+        queued = 0
+        failed = 0
+        for event in events:
+            try:
+                telemetry_ingest.delay(event)
+                queued += 1
+            except Exception as e:
+                failed += 1
+                logger.error(f"Failed to queue event {event.get('event_id')}: {str(e)}")
+        return queued, failed
+
+    async def send_telemetry_ack(self, batch_id, status, **extra):
+        await self.send(text_data=json.dumps({
+            "type": "telemetry_ack",
+            "batch_id": batch_id,
+            "status": status,
+            **extra
+        }, default=str))
+
     @database_sync_to_async
     def update_command_status(self, command_id, status, message):
         """
@@ -0,0 +1,178 @@
+import json
+import uuid
+
+from rest_framework.exceptions import ParseError
+from rest_framework.parsers import BaseParser
+
+
+MAGIC = b'EDRB'
+SUPPORTED_VERSIONS = (1, 2)  # v2: timestamps in microseconds
+
+# Record types and flags, see edr-agent/BinaryBatch.hpp
+RECORD_JSON = 0
+RECORD_TYPES = {
+    1: ('process', [('name', str), ('pid', int), ('command_line', str),
+                    ('user', str), ('parent_image', str), ('action', str)]),
+    2: ('network', [('source_ip', str), ('source_port', int), ('dest_ip', str),
+                    ('dest_port', int), ('protocol', str), ('image', str)]),
+    3: ('file', [('path', str), ('operation', str), ('process_image', str)]),
+}
+
+FLAG_AGENT_ID = 0x01
+FLAG_HOST = 0x02
+FLAG_SEVERITY = 0x04
+FLAG_VERSION = 0x08
+FLAG_TAGS = 0x10
+FLAG_AGGREGATION = 0x20
+FLAG_LINEAGE = 0x40
+
+
+class _Reader:
+    """Cursor over one batch body; every read raises ParseError past the end."""
+
+    def __init__(self, data, table):
+        self.data = data
+        self.pos = 0
+        self.table = table
+
+    def remaining(self):
+        return len(self.data) - self.pos
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise ParseError('Truncated binary batch')
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def raw(self, size):
+        if size > self.remaining():
+            raise ParseError('Truncated binary batch')
+        value = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return value
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return value
+            shift += 7
+            if shift > 63:
+                raise ParseError('Varint too long')
+
+    def svarint(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def string(self):
+        # Even = table reference, odd = literal that becomes the next entry
+        value = self.varint()
+        if not value & 1:
+            index = value >> 1
+            if index >= len(self.table):
+                raise ParseError('Bad string table reference')
+            return self.table[index]
+        try:
+            text = bytes(self.raw(value >> 1)).decode('utf-8')
+        except UnicodeDecodeError:
+            raise ParseError('Invalid UTF-8 in binary batch')
+        self.table.append(text)
+        return text
+
+
+def decode_batch(data):
+    """
+    Decodes an application/x-edr-batch body into the list of event dicts the
+    JSON array body would have carried.
+    """
+    data = memoryview(data)
+    if len(data) < 5 or bytes(data[:4]) != MAGIC:
+        raise ParseError('Not an EDR binary batch')
+    if data[4] not in SUPPORTED_VERSIONS:
+        raise ParseError(f'Unsupported binary batch version {data[4]}')
+    micros = data[4] >= 2
+
+    table = []
+    header = _Reader(data, table)
+    header.pos = 5
+    agent_id = header.string()
+    host = {'hostname': header.string(), 'os': header.string(), 'os_version': header.string()}
+    version = header.string()
+    severity = header.string()
+
+    events = []
+    timestamp = 0
+    while header.remaining() > 0:
+        length = header.varint()
+        record = _Reader(header.raw(length), table)
+        record_type = record.byte()
+
+        if record_type == RECORD_JSON:
+            try:
+                events.append(json.loads(bytes(record.raw(record.remaining()))))
+            except ValueError:
+                raise ParseError('Invalid JSON record in binary batch')
+            continue
+        if record_type not in RECORD_TYPES:
+            raise ParseError(f'Unknown record type {record_type}')
+
+        event_type, fields = RECORD_TYPES[record_type]
+        event_id = str(uuid.UUID(bytes=bytes(record.raw(16))))
+        timestamp += record.svarint()
+        flags = record.byte()
+
+        event = {
+            'event_id': event_id,
+            'event_type': event_type,
+            'timestamp': timestamp // 1_000_000 if micros else timestamp,
+            'agent_id': record.string() if flags & FLAG_AGENT_ID else agent_id,
+        }
+        if flags & FLAG_HOST:
+            event['host'] = {'hostname': record.string(), 'os': record.string(), 'os_version': record.string()}
+        else:
+            event['host'] = dict(host)
+        if micros:
+            event['timestamp_us'] = timestamp
+        event['severity'] = record.string() if flags & FLAG_SEVERITY else severity
+        event['version'] = record.string() if flags & FLAG_VERSION else version
+
+        event[event_type] = {
+            name: (record.varint() if kind is int else record.string()) for name, kind in fields
+        }
+
+        if flags & FLAG_TAGS:
+            event['tags'] = [record.string() for _ in range(record.varint())]
+        if flags & FLAG_AGGREGATION:
+            event['aggregation'] = {
+                'count': record.varint(),
+                'first_seen': record.svarint(),
+                'last_seen': record.svarint(),
+            }
+        if flags & FLAG_LINEAGE:
+            parent_pid = record.varint()
+            ancestors = [record.string() for _ in range(record.varint())]
+            if parent_pid:
+                event[event_type]['parent_pid'] = parent_pid
+            if ancestors:
+                event[event_type]['ancestors'] = ancestors
+
+        if record.remaining() != 0:
+            raise ParseError('Trailing bytes in binary batch record')
+        events.append(event)
+
+    return events
+
+
+class EdrBatchParser(BaseParser):
+    """
+    Parses the agent's binary batch format (batch.format = "binary").
+    Runs after DecompressMiddleware, so the stream is already plain bytes.
+    """
+    media_type = 'application/x-edr-batch'
+
+    def parse(self, stream, media_type=None, parser_context=None):
+        return decode_batch(stream.read())
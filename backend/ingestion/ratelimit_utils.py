@@ -79,12 +79,15 @@ def ratelimit_with_logging(key, rate, method='POST', group=None):
                     f"path={request.path}"
                 )
                 
-                # Return 429 Too Many Requests
+                # Return 429 Too Many Requests. Agents back off on the
+                # Retry-After header, the body field is for humans.
+                retry_after = get_retry_after(rate)
                 return Response({
                     'error': 'Rate limit exceeded',
                     'message': f'You have exceeded the rate limit of {rate}',
-                    'retry_after': get_retry_after(rate)
-                }, status=status.HTTP_429_TOO_MANY_REQUESTS)
+                    'retry_after': retry_after
+                }, status=status.HTTP_429_TOO_MANY_REQUESTS,
+                   headers={'Retry-After': str(retry_after)})
             
             # Request was not limited, proceed to next decorator or view
             return func(request, *args, **kwargs)
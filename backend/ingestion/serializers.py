@@ -1,5 +1,5 @@
 from rest_framework import serializers
-from datetime import datetime, timezone
+from datetime import datetime, timedelta, timezone
 
 
 class TelemetrySerializer(serializers.Serializer):
@@ -7,6 +7,7 @@ class TelemetrySerializer(serializers.Serializer):
     event_id = serializers.CharField(required=True)
     event_type = serializers.ChoiceField(choices=['process', 'file', 'network'], required=True)
     timestamp = serializers.IntegerField(required=False)
+    timestamp_us = serializers.IntegerField(required=False)  # Same instant in microseconds, from newer agents
 
 
     severity = serializers.CharField(required=True)
@@ -15,6 +16,8 @@ class TelemetrySerializer(serializers.Serializer):
     process = serializers.DictField(required=False)
     file = serializers.DictField(required=False)
     network = serializers.DictField(required=False)
+    tags = serializers.ListField(child=serializers.CharField(), required=False)  # Set by the agent-side filter
+    aggregation = serializers.DictField(required=False)  # count/first_seen/last_seen of a collapsed burst
 
 
 
@@ -61,8 +64,15 @@ class TelemetrySerializer(serializers.Serializer):
     def validate(self, data):
         """
         Validate that event_type-specific data is present.
+        Prefers timestamp_us over timestamp so events within a second keep their order.
         """
         event_type = data.get('event_type')
+
+        if 'timestamp_us' in data:
+            try:
+                data['timestamp'] = datetime(1970, 1, 1, tzinfo=timezone.utc) + timedelta(microseconds=data['timestamp_us'])
+            except OverflowError:
+                raise serializers.ValidationError({'timestamp_us': 'Out of range'})
         
         if event_type == 'process' and 'process' not in data:
             raise serializers.ValidationError(
@@ -27,6 +27,7 @@ urlpatterns = [
     # ========== RESPONSE ACTION APIs (New) ==========
     # Agent Communication
     path('api/v1/commands/poll/', command_views.poll_commands, name='poll_commands'),
+    path('api/v1/commands/wait/', command_views.wait_for_commands, name='wait_for_commands'),
     path('api/v1/commands/result/<str:command_id>/', command_views.report_command_result, name='report_command_result'),
     
     # Dashboard Triggers
@@ -1,8 +1,10 @@
-from rest_framework.decorators import api_view, permission_classes
+from rest_framework.decorators import api_view, permission_classes, parser_classes
+from rest_framework.parsers import JSONParser
 from rest_framework.permissions import IsAuthenticated
 from rest_framework.response import Response
 from rest_framework import status
 from .serializers import TelemetrySerializer
+from .parsers import EdrBatchParser
 from .tasks import telemetry_ingest
 from .ratelimit_utils import ratelimit_with_logging
 from django.conf import settings
@@ -12,12 +14,14 @@ logger = logging.getLogger(__name__)
 
 
 @api_view(['POST'])
+@parser_classes([JSONParser, EdrBatchParser])
 @permission_classes([IsAuthenticated])
 @ratelimit_with_logging(key='header:HTTP_X_AGENT_TOKEN', rate=settings.RATELIMIT_TELEMETRY, method='POST', group='telemetry_sustained')  # Sustained limit
 @ratelimit_with_logging(key='header:HTTP_X_AGENT_TOKEN', rate='200/10s', method='POST', group='telemetry_burst')  # Burst protection
 def telemetry_endpoint(request):
     """
-    Ingest telemetry events. Supports both single event (dict) and batch events (list).
+    Ingest telemetry events. Supports both single event (dict) and batch events (list),
+    as JSON or as the agent's binary batch format (application/x-edr-batch).
     """
     # Determine if this is a batch or single event
     is_batch = isinstance(request.data, list)
@@ -0,0 +1,174 @@
+#include "AgentIdentity.hpp"
+
+#include <Windows.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+
+namespace {
+
+const int64_t REFRESH_INTERVAL_MS = 60000;
+const uint32_t CHECK_EVERY_CALLS = 1024;    // Look at the clock this often, not per event
+
+std::mutex g_identityMutex;
+std::string g_agentId;                      // Guarded by g_identityMutex
+std::atomic<uint32_t> g_generation{0};      // 0 = not read yet
+std::atomic<int64_t> g_lastCheckMs{0};
+
+// (Unix ms << 12) | counter of the last ID handed out
+std::atomic<uint64_t> g_lastStamp{0};
+
+struct ThreadIdentity {
+    uint32_t generation = 0;
+    uint32_t calls = 0;
+    std::string agentId;
+    std::string computer;
+    nlohmann::json host;
+    bool hostValid = false;
+};
+
+thread_local ThreadIdentity t_identity;
+
+int64_t steadyMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string readComputerName() {
+    char hostname[256];
+    DWORD size = sizeof(hostname);
+    if (GetComputerNameA(hostname, &size)) {
+        return std::string(hostname, size);
+    }
+    return "Unknown";
+}
+
+void ensureCurrent() {
+    ThreadIdentity& local = t_identity;
+
+    if (g_generation.load(std::memory_order_acquire) == 0) {
+        AgentIdentity::refresh();
+    } else if (++local.calls % CHECK_EVERY_CALLS == 0) {
+        int64_t now = steadyMs();
+        int64_t last = g_lastCheckMs.load(std::memory_order_relaxed);
+        // Only the thread that wins the exchange pays for the syscall
+        if (now - last >= REFRESH_INTERVAL_MS &&
+            g_lastCheckMs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            AgentIdentity::refresh();
+        }
+    }
+
+    uint32_t generation = g_generation.load(std::memory_order_acquire);
+    if (generation != local.generation) {
+        std::lock_guard<std::mutex> lock(g_identityMutex);
+        local.agentId = g_agentId;
+        local.generation = generation;
+        local.hostValid = false;
+    }
+}
+
+// splitmix64: fast, and plenty for the random half of an ID
+uint64_t nextRandom() {
+    thread_local uint64_t state = [] {
+        std::random_device rd;
+        return ((uint64_t)rd() << 32) ^ (uint64_t)rd() ^ (uint64_t)(uintptr_t)&state;
+    }();
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<char, 512> makeHexTable() {
+    std::array<char, 512> table{};
+    const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 256; i++) {
+        table[i * 2] = digits[i >> 4];
+        table[i * 2 + 1] = digits[i & 0x0F];
+    }
+    return table;
+}
+
+constexpr std::array<char, 512> HEX_TABLE = makeHexTable();
+
+} // namespace
+
+// ============================================
+// Identity
+// ============================================
+void AgentIdentity::refresh() {
+    std::string name = readComputerName();
+
+    std::lock_guard<std::mutex> lock(g_identityMutex);
+    g_lastCheckMs.store(steadyMs(), std::memory_order_relaxed);
+    if (name != g_agentId || g_generation.load(std::memory_order_relaxed) == 0) {
+        g_agentId = std::move(name);
+        g_generation.fetch_add(1, std::memory_order_release);
+    }
+}
+
+const std::string& AgentIdentity::agentId() {
+    ensureCurrent();
+    return t_identity.agentId;
+}
+
+const nlohmann::json& AgentIdentity::hostBlock(std::string_view computer) {
+    ensureCurrent();
+
+    ThreadIdentity& local = t_identity;
+    if (!local.hostValid || local.computer != computer) {
+        local.computer.assign(computer.data(), computer.size());
+        local.host = {
+            {"hostname", local.computer},
+            {"os", OS_NAME},
+            {"os_version", OS_VERSION}
+        };
+        local.hostValid = true;
+    }
+    return local.host;
+}
+
+// ============================================
+// Event IDs (UUIDv7)
+// ============================================
+void AgentIdentity::generateEventId(char out[36]) {
+    uint64_t nowMs = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // Same millisecond (or the clock stepped back): bump the counter instead,
+    // so IDs never go backwards
+    uint64_t candidate = nowMs << 12;
+    uint64_t previous = g_lastStamp.load(std::memory_order_relaxed);
+    uint64_t stamp;
+    do {
+        stamp = candidate > previous ? candidate : previous + 1;
+    } while (!g_lastStamp.compare_exchange_weak(previous, stamp, std::memory_order_relaxed));
+
+    uint64_t ms = stamp >> 12;
+    uint32_t counter = (uint32_t)(stamp & 0x0FFF);
+    uint64_t random = nextRandom();
+
+    uint8_t bytes[16];
+    for (int i = 0; i < 6; i++) bytes[i] = (uint8_t)(ms >> (40 - 8 * i));
+    bytes[6] = (uint8_t)(0x70 | (counter >> 8));          // Version 7
+    bytes[7] = (uint8_t)counter;
+    bytes[8] = (uint8_t)(0x80 | ((random >> 56) & 0x3F)); // Variant 10
+    for (int i = 9; i < 16; i++) bytes[i] = (uint8_t)(random >> (8 * (15 - i)));
+
+    // 8-4-4-4-12
+    char* p = out;
+    for (int i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) *p++ = '-';
+        *p++ = HEX_TABLE[bytes[i] * 2];
+        *p++ = HEX_TABLE[bytes[i] * 2 + 1];
+    }
+}
+
+std::string AgentIdentity::generateEventId() {
+    char id[36];
+    generateEventId(id);
+    return std::string(id, sizeof(id));
+}
@@ -0,0 +1,47 @@
+#ifndef AGENTIDENTITY_HPP
+#define AGENTIDENTITY_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// ============================================================
+// Agent Identity
+// ============================================================
+// Per-agent constants every telemetry record carries, computed once
+// instead of per event:
+//   - agent_id (the computer name), re-read at most every 60 s so a
+//     rename is picked up without a syscall per event
+//   - the "host" block, built once per distinct Computer value
+//   - event IDs: UUIDv7 (48-bit Unix ms + 12-bit counter + 62 random
+//     bits), strictly increasing across the process, so the server's
+//     unique index on event_id stays append-only
+//
+// Each thread keeps its own copy of the current identity and revalidates
+// it against a generation counter, so the per-event cost is one relaxed
+// atomic load.
+// ============================================================
+
+class AgentIdentity {
+public:
+    // Constant part of the host block
+    static constexpr const char* OS_NAME = "Windows";
+    static constexpr const char* OS_VERSION = "11";
+
+    // Computer name used as agent_id
+    static const std::string& agentId();
+
+    // {"hostname": computer, "os": "Windows", "os_version": ...}, reused while computer is unchanged
+    static const nlohmann::json& hostBlock(std::string_view computer);
+
+    // Re-reads the computer name; bumps the generation when it changed
+    static void refresh();
+
+    // Writes a 36-character UUIDv7 (no terminator); no allocation
+    static void generateEventId(char out[36]);
+    static std::string generateEventId();
+};
+
+#endif // AGENTIDENTITY_HPP
@@ -0,0 +1,226 @@
+#include "AsyncHttpSender.hpp"
+#include "HttpClient.hpp"
+#include "Logger.hpp"
+#include "RateController.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+static std::wstring toWide(const std::string& str) {
+    if (str.empty()) return std::wstring();
+    int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), NULL, 0);
+    std::wstring wstr(size, 0);
+    MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), &wstr[0], size);
+    return wstr;
+}
+
+AsyncHttpSender::AsyncHttpSender(const std::string& serverHost, int serverPort,
+                                 const std::string& apiPath, const std::string& token,
+                                 const AsyncSenderConfig& config)
+    : m_server(toWide(serverHost))
+    , m_port(serverPort)
+    , m_path(toWide(apiPath))
+    , m_config(config)
+{
+    if (m_config.maxInFlight == 0) m_config.maxInFlight = 1;
+    m_headers = L"\r\nContent-Encoding: zstd\r\nAuthorization: Token "
+              + toWide(token) + L"\r\n";
+}
+
+AsyncHttpSender::~AsyncHttpSender() {
+    close();
+}
+
+// ============================================
+// Lifecycle
+// ============================================
+bool AsyncHttpSender::open() {
+    if (m_hSession && m_hConnect) return true;
+
+    m_hSession = WinHttpOpen(L"EDR-Agent/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+                             WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, WINHTTP_FLAG_ASYNC);
+    if (!m_hSession) {
+        std::cerr << "[AsyncHTTP] WinHttpOpen failed. Error: " << GetLastError() << std::endl;
+        return false;
+    }
+
+    // Request handles inherit the callback from the session
+    WINHTTP_STATUS_CALLBACK previous = WinHttpSetStatusCallback(
+        m_hSession, &AsyncHttpSender::statusCallback,
+        WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_HANDLES, 0);
+    if (previous == WINHTTP_INVALID_STATUS_CALLBACK) {
+        std::cerr << "[AsyncHTTP] WinHttpSetStatusCallback failed. Error: " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+
+    m_hConnect = WinHttpConnect(m_hSession, m_server.c_str(), (INTERNET_PORT)m_port, 0);
+    if (!m_hConnect) {
+        std::cerr << "[AsyncHTTP] WinHttpConnect failed. Error: " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+
+    std::cout << "[AsyncHTTP] Ready (" << m_config.maxInFlight << " batch(es) in flight)" << std::endl;
+    return true;
+}
+
+void AsyncHttpSender::close() {
+    auto waitIdle = [this](std::chrono::milliseconds limit) {
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        return m_idleCV.wait_for(lock, limit, [this] { return m_inFlight.load() == 0; });
+    };
+
+    // Requests end on their own within the timeout; whatever is still open
+    // after that is cancelled by closing the connection below
+    waitIdle(std::chrono::milliseconds(m_config.requestTimeoutMs + 1000));
+
+    if (m_hConnect) {
+        WinHttpCloseHandle(m_hConnect);
+        m_hConnect = NULL;
+    }
+    if (m_hSession) {
+        WinHttpCloseHandle(m_hSession);
+        m_hSession = NULL;
+    }
+
+    if (!waitIdle(std::chrono::milliseconds(5000))) {
+        std::cerr << "[AsyncHTTP] " << m_inFlight.load() << " request(s) did not close" << std::endl;
+    }
+}
+
+// ============================================
+// Sending
+// ============================================
+bool AsyncHttpSender::postCompressed(const std::vector<BYTE>& body, const wchar_t* contentType, Completion done) {
+    if (!m_hConnect) return false;
+
+    HINTERNET hRequest = WinHttpOpenRequest(m_hConnect, L"POST", m_path.c_str(), NULL,
+                                            WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, 0);
+    if (!hRequest) {
+        LOG_ERROR("AsyncHTTP") << "WinHttpOpenRequest failed: " << GetLastError();
+        return false;
+    }
+
+    Request* request = new Request();
+    request->owner = this;
+    request->hRequest = hRequest;
+    request->done = std::move(done);
+    request->headers = std::wstring(L"Content-Type: ") + contentType + m_headers;
+    request->started = std::chrono::steady_clock::now();
+    m_inFlight.fetch_add(1, std::memory_order_acq_rel);
+
+    // Set before anything can fail, so HANDLE_CLOSING always finds the request to free
+    DWORD_PTR context = (DWORD_PTR)request;
+    WinHttpSetOption(hRequest, WINHTTP_OPTION_CONTEXT_VALUE, &context, sizeof(context));
+
+    int timeout = (int)m_config.requestTimeoutMs;
+    WinHttpSetTimeouts(hRequest, timeout, timeout, timeout, timeout);
+
+    if (!WinHttpSendRequest(hRequest, request->headers.c_str(), (DWORD)request->headers.length(),
+                            (LPVOID)body.data(), (DWORD)body.size(), (DWORD)body.size(),
+                            context)) {
+        LOG_ERROR("AsyncHTTP") << "WinHttpSendRequest failed: " << GetLastError();
+        request->finished = true;   // Caller handles the failure; no completion
+        WinHttpCloseHandle(hRequest);
+        return false;
+    }
+    return true;
+}
+
+void CALLBACK AsyncHttpSender::statusCallback(HINTERNET hInternet, DWORD_PTR context, DWORD status,
+                                              LPVOID info, DWORD infoLength) {
+    // Session and connection handles carry no context
+    if (context == 0) return;
+
+    Request* request = (Request*)context;
+    if (status == WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING) {
+        AsyncHttpSender* owner = request->owner;
+        delete request;
+        owner->released();
+        return;
+    }
+    request->owner->onStatus(*request, status, info, infoLength);
+}
+
+void AsyncHttpSender::onStatus(Request& request, DWORD status, LPVOID info, DWORD infoLength) {
+    if (request.finished) return;
+
+    switch (status) {
+        case WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE:
+            if (!WinHttpReceiveResponse(request.hRequest, NULL)) finish(request, false);
+            break;
+
+        case WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE: {
+            DWORD size = sizeof(request.statusCode);
+            WinHttpQueryHeaders(request.hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                                WINHTTP_HEADER_NAME_BY_INDEX, &request.statusCode, &size, WINHTTP_NO_HEADER_INDEX);
+            if (request.statusCode != 200 && request.statusCode != 201) {
+                LOG_WARN("AsyncHTTP") << "Server returned error: " << request.statusCode;
+                if (request.statusCode == 429 || request.statusCode == 503) {
+                    request.retryAfterS = HttpClient::queryRetryAfter(request.hRequest);
+                }
+            }
+            // Drain the body either way so the connection goes back to the pool
+            if (!WinHttpQueryDataAvailable(request.hRequest, NULL)) finish(request, false);
+            break;
+        }
+
+        case WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE: {
+            DWORD available = *(DWORD*)info;
+            if (available == 0) {
+                finish(request, request.statusCode == 200 || request.statusCode == 201);
+            } else if (!WinHttpReadData(request.hRequest, request.drain,
+                                        std::min<DWORD>(available, sizeof(request.drain)), NULL)) {
+                finish(request, false);
+            }
+            break;
+        }
+
+        case WINHTTP_CALLBACK_STATUS_READ_COMPLETE:
+            if (infoLength == 0) {
+                finish(request, request.statusCode == 200 || request.statusCode == 201);
+            } else if (!WinHttpQueryDataAvailable(request.hRequest, NULL)) {
+                finish(request, false);
+            }
+            break;
+
+        case WINHTTP_CALLBACK_STATUS_REQUEST_ERROR: {
+            WINHTTP_ASYNC_RESULT* result = (WINHTTP_ASYNC_RESULT*)info;
+            if (result->dwError != ERROR_WINHTTP_OPERATION_CANCELLED) {
+                LOG_WARN("AsyncHTTP") << "Request failed (" << result->dwError << ")";
+            } else {
+                request.cancelled = true;
+            }
+            finish(request, false);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void AsyncHttpSender::finish(Request& request, bool ok) {
+    request.finished = true;
+    if (m_rateController != nullptr && !request.cancelled) {
+        auto latencyMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - request.started).count();
+        m_rateController->onResponse(request.statusCode, (uint64_t)latencyMs, request.retryAfterS);
+    }
+    try {
+        if (request.done) request.done(ok);
+    } catch (const std::exception& e) {
+        LOG_ERROR("AsyncHTTP") << "Exception in completion: " << e.what();
+    }
+    // Frees the request through HANDLE_CLOSING
+    WinHttpCloseHandle(request.hRequest);
+}
+
+void AsyncHttpSender::released() {
+    if (m_inFlight.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_idleCV.notify_all();
+    }
+}
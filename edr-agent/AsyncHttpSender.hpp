@@ -0,0 +1,107 @@
+#ifndef ASYNCHTTPSENDER_HPP
+#define ASYNCHTTPSENDER_HPP
+
+#include <windows.h>
+#include <winhttp.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#pragma comment(lib, "winhttp.lib")
+
+class RateController;
+
+// ============================================================
+// Async HTTP Sender
+// ============================================================
+// Posts compressed telemetry batches without waiting for each round trip.
+//
+//   post() --WinHttpSendRequest--> [in flight on hConnect] --status callback--> done(ok)
+//
+// One WINHTTP_FLAG_ASYNC session and one persistent hConnect carry up to
+// maxInFlight requests at a time; WinHTTP spreads them over its pooled
+// keep-alive connections and restores a dropped connection itself on the
+// next request, so there is no inline reconnect here. Each request walks
+// send -> receive -> drain in the status callback and reports once through
+// its completion. Completions arrive on WinHTTP's threads and in any order;
+// putting the results back in order is the caller's job.
+// ============================================================
+
+struct AsyncSenderConfig {
+    unsigned maxInFlight = 4;
+    unsigned requestTimeoutMs = 30000;   // Per request, covers connect/send/receive
+};
+
+class AsyncHttpSender {
+public:
+    // ok = the server answered 200/201
+    using Completion = std::function<void(bool ok)>;
+
+    AsyncHttpSender(const std::string& serverHost, int serverPort,
+                    const std::string& apiPath, const std::string& token,
+                    const AsyncSenderConfig& config);
+    ~AsyncHttpSender();
+
+    AsyncHttpSender(const AsyncHttpSender&) = delete;
+    AsyncHttpSender& operator=(const AsyncHttpSender&) = delete;
+
+    bool open();
+
+    // Waits for in-flight requests to finish (bounded by the request timeout)
+    void close();
+
+    // Starts a POST of an already zstd-compressed batch. body must stay
+    // untouched until done runs. Returns false (and never calls done) if the
+    // request could not be started.
+    bool postCompressed(const std::vector<BYTE>& body, const wchar_t* contentType, Completion done);
+
+    unsigned inFlight() const { return m_inFlight.load(std::memory_order_acquire); }
+    unsigned maxInFlight() const { return m_config.maxInFlight; }
+
+    // Every completed request (status, latency, Retry-After) is reported to it.
+    // Set before the first post.
+    void setRateController(RateController* controller) { m_rateController = controller; }
+
+private:
+    struct Request {
+        AsyncHttpSender* owner = nullptr;
+        HINTERNET hRequest = NULL;
+        Completion done;
+        std::wstring headers;    // Kept alive with the request
+        DWORD statusCode = 0;
+        unsigned retryAfterS = 0;
+        bool cancelled = false;  // By close(), not the server's doing
+        bool finished = false;
+        std::chrono::steady_clock::time_point started;
+        char drain[4096];        // Response bodies are discarded, but must be read to reuse the connection
+    };
+
+    static void CALLBACK statusCallback(HINTERNET hInternet, DWORD_PTR context, DWORD status,
+                                        LPVOID info, DWORD infoLength);
+    void onStatus(Request& request, DWORD status, LPVOID info, DWORD infoLength);
+    void finish(Request& request, bool ok);
+    void released();
+
+    std::wstring m_server;
+    int m_port;
+    std::wstring m_path;
+    std::wstring m_headers;      // Everything after Content-Type
+    AsyncSenderConfig m_config;
+    RateController* m_rateController = nullptr;
+
+    HINTERNET m_hSession = NULL;
+    HINTERNET m_hConnect = NULL;
+
+    // Counts requests until their HANDLE_CLOSING, so close() knows when
+    // WinHTTP no longer holds a pointer into us
+    std::atomic<unsigned> m_inFlight{0};
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCV;
+};
+
+#endif // ASYNCHTTPSENDER_HPP
@@ -0,0 +1,37 @@
+#ifndef BATCHTRANSPORT_HPP
+#define BATCHTRANSPORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// ============================================================
+// Batch Transport
+// ============================================================
+// A long-lived connection the pipeline can hand compressed batches to
+// instead of posting each one over HTTP. Implemented by WebSocketClient,
+// which is only built with ENABLE_WEBSOCKET, so the pipeline sees this
+// interface and never Boost.
+//
+// sendBatch() must not block. It refuses a batch (returns false) while
+// disconnected or when maxInFlight() batches are still unanswered, and the
+// pipeline then sends that batch over HTTP instead. A batch it takes
+// reports exactly once through done, from the transport's own thread.
+// ============================================================
+
+class BatchTransport {
+public:
+    // ok = the server acknowledged the batch
+    using Completion = std::function<void(bool ok)>;
+
+    virtual ~BatchTransport() = default;
+
+    // compressed is one zstd frame of a JSON array or binary batch body.
+    // Copied before returning.
+    virtual bool sendBatch(const std::vector<uint8_t>& compressed, Completion done) = 0;
+
+    virtual size_t maxInFlight() const = 0;
+};
+
+#endif // BATCHTRANSPORT_HPP
@@ -0,0 +1,221 @@
+#include "BinaryBatch.hpp"
+#include "AgentIdentity.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const uint32_t MAX_TRACKED_STRINGS = 8192;   // Per batch; later strings are still sent, just not deduplicated
+const size_t MAX_TRACKED_LENGTH = 1024;      // Long command lines are rarely repeated verbatim
+const size_t SLOT_COUNT = 16384;             // Power of two, twice MAX_TRACKED_STRINGS
+
+enum Flags : uint8_t {
+    OwnAgentId = 0x01,
+    OwnHost = 0x02,
+    OwnSeverity = 0x04,
+    OwnVersion = 0x08,      // Decoder only: the agent's version is a constant
+    HasTags = 0x10,
+    HasAggregation = 0x20,
+    HasLineage = 0x40
+};
+
+uint64_t hashBytes(std::string_view value) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+BinaryBatchEncoder::BinaryBatchEncoder()
+    : m_slots(SLOT_COUNT, 0)
+{
+    m_entries.reserve(MAX_TRACKED_STRINGS);
+    m_arena.reserve(64 * 1024);
+    m_record.reserve(1024);
+}
+
+BatchFormat BinaryBatchEncoder::parseFormat(const std::string& name) {
+    if (name == "binary") return BatchFormat::Binary;
+    if (name != "json" && !name.empty()) {
+        std::cerr << "[Batch] Unknown format '" << name << "', using json" << std::endl;
+    }
+    return BatchFormat::Json;
+}
+
+// ============================================
+// Batch
+// ============================================
+void BinaryBatchEncoder::begin(const TelemetryEvent& firstEvent, std::string& out) {
+    m_arena.clear();
+    m_entries.clear();
+    std::fill(m_slots.begin(), m_slots.end(), 0);
+    m_tableSize = 0;
+    m_lastTimestamp = 0;
+
+    m_agentId = firstEvent.get(TelemetryEvent::AgentId);
+    m_hostname = firstEvent.get(TelemetryEvent::Hostname);
+    m_severity = firstEvent.severity;
+
+    out.append("EDRB", 4);
+    out.push_back((char)VERSION);
+    writeString(m_agentId, out);
+    writeString(m_hostname, out);
+    writeString(AgentIdentity::OS_NAME, out);
+    writeString(AgentIdentity::OS_VERSION, out);
+    writeString(TelemetryEvent::VERSION, out);
+    writeString(m_severity, out);
+}
+
+void BinaryBatchEncoder::encode(const TelemetryEvent& event, std::string& out) {
+    std::string& record = m_record;
+    record.clear();
+
+    uint8_t uuid[16];
+    if (event.empty() || !parseUuid(std::string_view(event.eventId, sizeof(event.eventId)), uuid)) {
+        return;
+    }
+
+    std::string_view agentId = event.get(TelemetryEvent::AgentId);
+    std::string_view hostname = event.get(TelemetryEvent::Hostname);
+    uint8_t flags = 0;
+    if (agentId != m_agentId) flags |= OwnAgentId;
+    if (hostname != m_hostname) flags |= OwnHost;
+    if (m_severity != event.severity) flags |= OwnSeverity;
+    if (!event.tags.empty()) flags |= HasTags;
+    if (event.aggregateCount > 1) flags |= HasAggregation;
+    if (event.family == EventFamily::Process && (event.parentProcessId != 0 || !event.ancestors.empty())) {
+        flags |= HasLineage;
+    }
+
+    RecordType type = event.family == EventFamily::Process ? Process
+                    : event.family == EventFamily::Network ? Network : File;
+    record.push_back((char)type);
+    record.append((const char*)uuid, sizeof(uuid));
+    writeSignedVarint(event.timestampUs - m_lastTimestamp, record);
+    m_lastTimestamp = event.timestampUs;
+    record.push_back((char)flags);
+
+    if (flags & OwnAgentId) writeString(agentId, record);
+    if (flags & OwnHost) {
+        writeString(hostname, record);
+        writeString(AgentIdentity::OS_NAME, record);
+        writeString(AgentIdentity::OS_VERSION, record);
+    }
+    if (flags & OwnSeverity) writeString(event.severity, record);
+
+    // Field order is the wire order; changing it means a new VERSION
+    switch (type) {
+        case Process:
+            writeString(event.get(TelemetryEvent::Image), record);
+            writeVarint((uint32_t)event.processId, record);
+            writeString(event.get(TelemetryEvent::CommandLine), record);
+            writeString(event.get(TelemetryEvent::User), record);
+            writeString(event.get(TelemetryEvent::ParentImage), record);
+            writeString(event.action, record);
+            break;
+        case Network:
+            writeString(event.get(TelemetryEvent::SourceIp), record);
+            writeVarint((uint32_t)event.sourcePort, record);
+            writeString(event.get(TelemetryEvent::DestinationIp), record);
+            writeVarint((uint32_t)event.destinationPort, record);
+            writeString(event.get(TelemetryEvent::Protocol), record);
+            writeString(event.get(TelemetryEvent::Image), record);
+            break;
+        default:
+            writeString(event.get(TelemetryEvent::TargetFilename), record);
+            writeString(event.action, record);
+            writeString(event.get(TelemetryEvent::Image), record);
+            break;
+    }
+
+    if (flags & HasTags) {
+        writeVarint(event.tags.size(), record);
+        for (size_t i = 0; i < event.tags.size(); i++) writeString(event.tag(i), record);
+    }
+    if (flags & HasAggregation) {
+        writeVarint(event.aggregateCount, record);
+        writeSignedVarint(event.firstSeen, record);
+        writeSignedVarint(event.lastSeen, record);
+    }
+    if (flags & HasLineage) {
+        writeVarint((uint32_t)event.parentProcessId, record);
+        writeVarint(event.ancestors.size(), record);
+        for (size_t i = 0; i < event.ancestors.size(); i++) writeString(event.ancestor(i), record);
+    }
+
+    writeVarint(record.size(), out);
+    out += record;
+}
+
+// ============================================
+// Primitives
+// ============================================
+void BinaryBatchEncoder::writeString(std::string_view value, std::string& out) {
+    bool trackable = value.size() <= MAX_TRACKED_LENGTH;
+    size_t slot = 0;
+
+    if (trackable) {
+        size_t mask = m_slots.size() - 1;
+        slot = hashBytes(value) & mask;
+        while (m_slots[slot] != 0) {
+            const TableEntry& entry = m_entries[m_slots[slot] - 1];
+            if (entry.length == value.size() &&
+                std::memcmp(m_arena.data() + entry.offset, value.data(), value.size()) == 0) {
+                writeVarint((uint64_t)entry.index << 1, out);
+                return;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    // Literal: becomes table entry m_tableSize on both ends, tracked here or not
+    uint32_t index = m_tableSize++;
+    if (trackable && m_entries.size() < MAX_TRACKED_STRINGS) {
+        m_entries.push_back({(uint32_t)m_arena.size(), (uint32_t)value.size(), index});
+        m_arena.append(value.data(), value.size());
+        m_slots[slot] = (uint32_t)m_entries.size();
+    }
+    writeVarint(((uint64_t)value.size() << 1) | 1, out);
+    out.append(value.data(), value.size());
+}
+
+void BinaryBatchEncoder::writeVarint(uint64_t value, std::string& out) {
+    while (value >= 0x80) {
+        out.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+void BinaryBatchEncoder::writeSignedVarint(int64_t value, std::string& out) {
+    writeVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63), out);
+}
+
+bool BinaryBatchEncoder::parseUuid(std::string_view text, uint8_t bytes[16]) {
+    if (text.size() != 36 || text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-') {
+        return false;
+    }
+    size_t pos = 0;
+    for (int i = 0; i < 16; i++) {
+        if (pos == 8 || pos == 13 || pos == 18 || pos == 23) pos++;
+        int high = hexDigit(text[pos]);
+        int low = hexDigit(text[pos + 1]);
+        if (high < 0 || low < 0) return false;
+        bytes[i] = (uint8_t)((high << 4) | low);
+        pos += 2;
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#ifndef BINARYBATCH_HPP
+#define BINARYBATCH_HPP
+
+#include "TelemetryEvent.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================
+// Binary Batch Format (v2)
+// ============================================================
+// Opt-in alternative to the JSON array body, sent as
+// Content-Type: application/x-edr-batch. Decoded by
+// backend/ingestion/parsers.py back into the same event dicts.
+//
+//   header   "EDRB" u8 version
+//            str agent_id, str hostname, str os, str os_version,
+//            str version, str severity        (batch-level constants)
+//   records  varint length, then length bytes:
+//              u8 type   0 = JSON text (reserved for events outside the schema;
+//                            the decoder accepts it, the agent has no such events)
+//                        1 = process, 2 = network, 3 = file
+//              16 bytes  event_id (UUID)
+//              svarint   timestamp - previous record's timestamp, in Unix
+//                        microseconds (v1: seconds)
+//              u8 flags  0x01 agent_id str, 0x02 host (3 str), 0x04 severity str,
+//                        0x08 version str: overrides of the header, in this order
+//              type fields:
+//                process  name str, pid varint, command_line str, user str,
+//                         parent_image str, action str
+//                network  source_ip str, source_port varint, dest_ip str,
+//                         dest_port varint, protocol str, image str
+//                file     path str, operation str, process_image str
+//              0x10 tags: varint n, n str
+//              0x20 aggregation: varint count, svarint first_seen, svarint last_seen
+//              0x40 lineage (process only): varint parent_pid, varint n, n str ancestors
+//
+// str is varint v: v even = reference to string table entry v/2; v odd =
+// literal of v/2 bytes that follows and becomes the next table entry. The
+// table starts empty for every batch, so repeated images, IPs and users
+// cost one or two bytes after their first use.
+//
+// varint is unsigned LEB128; svarint is zigzag LEB128.
+// ============================================================
+
+#define EDR_BATCH_CONTENT_TYPE L"application/x-edr-batch"
+#define EDR_JSON_CONTENT_TYPE  L"application/json"
+
+enum class BatchFormat {
+    Json,
+    Binary
+};
+
+class BinaryBatchEncoder {
+public:
+    static const uint8_t VERSION = 2;
+
+    BinaryBatchEncoder();
+
+    // Resets the string table and writes the header, taking the batch
+    // constants from the first event
+    void begin(const TelemetryEvent& firstEvent, std::string& out);
+
+    // Appends one length-prefixed record to out. Buffers keep their capacity,
+    // so steady-state encoding does not allocate.
+    void encode(const TelemetryEvent& event, std::string& out);
+
+    // "json" | "binary" (defaults to Json)
+    static BatchFormat parseFormat(const std::string& name);
+
+private:
+    enum RecordType : uint8_t {
+        JsonText = 0,
+        Process = 1,
+        Network = 2,
+        File = 3
+    };
+
+    void writeString(std::string_view value, std::string& out);
+    static void writeVarint(uint64_t value, std::string& out);
+    static void writeSignedVarint(int64_t value, std::string& out);
+    static bool parseUuid(std::string_view text, uint8_t bytes[16]);
+
+    // Batch constants from the header, for override checks
+    std::string m_agentId;
+    std::string m_hostname;
+    std::string m_severity;
+    long long m_lastTimestamp = 0;
+
+    struct TableEntry {
+        uint32_t offset;   // In m_arena
+        uint32_t length;
+        uint32_t index;    // Position in the decoder's table
+    };
+
+    // String table: open addressing over entries whose text lives in one arena
+    std::string m_arena;
+    std::vector<TableEntry> m_entries;
+    std::vector<uint32_t> m_slots;                           // m_entries index + 1, 0 = empty
+    uint32_t m_tableSize = 0;                                // Entries the decoder holds
+
+    std::string m_record;                                    // One record before its length prefix
+};
+
+#endif // BINARYBATCH_HPP
@@ -0,0 +1,184 @@
+#include "BookmarkStore.hpp"
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+BookmarkStore::BookmarkStore(const std::string& filePath, unsigned flushIntervalMs)
+    : m_filePath(filePath)
+    , m_flushIntervalMs(flushIntervalMs == 0 ? 1000 : flushIntervalMs)
+{
+}
+
+BookmarkStore::~BookmarkStore() {
+    stop();
+}
+
+// ============================================
+// Load
+// ============================================
+bool BookmarkStore::load() {
+    std::ifstream file(m_filePath);
+    if (!file.is_open()) {
+        std::cout << "[Bookmarks] No saved bookmarks (" << m_filePath << "), starting from live events" << std::endl;
+        return false;
+    }
+
+    try {
+        nlohmann::json saved;
+        file >> saved;
+
+        if (saved.contains("sources")) {
+            for (auto& item : saved["sources"].items()) {
+                m_loaded[item.key()] = item.value().get<uint64_t>();
+            }
+        }
+        std::cout << "[Bookmarks] Loaded " << m_loaded.size() << " bookmark(s) from " << m_filePath << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        // A corrupt file only costs us the resume point, never the agent
+        std::cerr << "[Bookmarks] ⚠️ Ignoring unreadable " << m_filePath << ": " << e.what() << std::endl;
+        m_loaded.clear();
+        return false;
+    }
+}
+
+size_t BookmarkStore::registerSource(const std::wstring& channel) {
+    std::unique_lock<std::shared_mutex> lock(m_sourcesMutex);
+    for (size_t i = 0; i < m_sources.size(); i++) {
+        if (m_sources[i]->channel == channel) return i;
+    }
+
+    auto source = std::make_unique<Source>();
+    source->channel = channel;
+    source->key = std::string(channel.begin(), channel.end());   // Channel names are ASCII (see ConfigReader)
+
+    auto it = m_loaded.find(source->key);
+    if (it != m_loaded.end()) {
+        source->ackedRecordId = it->second;
+    }
+
+    m_sources.push_back(std::move(source));
+    return m_sources.size() - 1;
+}
+
+uint64_t BookmarkStore::recordId(size_t source) const {
+    std::shared_lock<std::shared_mutex> lock(m_sourcesMutex);
+    if (source >= m_sources.size()) return 0;
+    return m_sources[source]->ackedRecordId.load(std::memory_order_relaxed);
+}
+
+std::wstring BookmarkStore::bookmarkXml(size_t source) const {
+    std::shared_lock<std::shared_mutex> lock(m_sourcesMutex);
+    if (source >= m_sources.size()) return L"";
+    uint64_t id = m_sources[source]->ackedRecordId.load(std::memory_order_relaxed);
+    if (id == 0) return L"";
+
+    // Same shape EvtRender(EvtRenderBookmark) produces
+    std::wostringstream xml;
+    xml << L"<BookmarkList><Bookmark Channel='" << m_sources[source]->channel
+        << L"' RecordId='" << id << L"' IsCurrent='true'/></BookmarkList>";
+    return xml.str();
+}
+
+// ============================================
+// Acknowledge (sender thread)
+// ============================================
+void BookmarkStore::acknowledge(size_t source, uint64_t recordId) {
+    std::shared_lock<std::shared_mutex> lock(m_sourcesMutex);
+    if (source >= m_sources.size() || recordId == 0) return;
+
+    // Record IDs only move forward; a late ack for an older batch is ignored
+    std::atomic<uint64_t>& acked = m_sources[source]->ackedRecordId;
+    uint64_t current = acked.load(std::memory_order_relaxed);
+    while (recordId > current) {
+        if (acked.compare_exchange_weak(current, recordId, std::memory_order_relaxed)) {
+            m_dirty.store(true, std::memory_order_release);
+            break;
+        }
+    }
+}
+
+// ============================================
+// Persistence
+// ============================================
+void BookmarkStore::start() {
+    if (m_running.exchange(true)) return;
+    m_flushThread = std::thread(&BookmarkStore::flushLoop, this);
+}
+
+void BookmarkStore::stop() {
+    if (m_running.exchange(false)) {
+        m_flushCV.notify_all();
+        if (m_flushThread.joinable()) m_flushThread.join();
+    }
+    flush();
+}
+
+void BookmarkStore::flushLoop() {
+    while (m_running) {
+        {
+            std::unique_lock<std::mutex> lock(m_flushMutex);
+            m_flushCV.wait_for(lock, std::chrono::milliseconds(m_flushIntervalMs), [this] {
+                return !m_running;
+            });
+        }
+        if (m_running) flush();
+    }
+}
+
+bool BookmarkStore::flush() {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    if (!m_dirty.exchange(false, std::memory_order_acquire)) return true;
+
+    nlohmann::json saved;
+    saved["version"] = 1;
+    saved["sources"] = nlohmann::json::object();
+    for (const auto& entry : m_loaded) {
+        saved["sources"][entry.first] = entry.second;
+    }
+    std::shared_lock<std::shared_mutex> sourcesLock(m_sourcesMutex);
+    for (const auto& source : m_sources) {
+        saved["sources"][source->key] = source->ackedRecordId.load(std::memory_order_relaxed);
+    }
+
+    if (!writeFile(saved.dump(2))) {
+        m_dirty = true;   // Try again next interval
+        return false;
+    }
+    return true;
+}
+
+bool BookmarkStore::writeFile(const std::string& contents) {
+    // Write the new copy next to the old one, force it to disk, then swap it
+    // in. MoveFileEx replaces atomically, so we never leave a torn file.
+    std::string tmpPath = m_filePath + ".tmp";
+
+    HANDLE hFile = CreateFileA(tmpPath.c_str(), GENERIC_WRITE, 0, NULL,
+                               CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        std::cerr << "[Bookmarks] ❌ Cannot create " << tmpPath << " (Error: " << GetLastError() << ")" << std::endl;
+        return false;
+    }
+
+    DWORD written = 0;
+    BOOL ok = WriteFile(hFile, contents.data(), (DWORD)contents.size(), &written, NULL)
+              && written == contents.size()
+              && FlushFileBuffers(hFile);
+    CloseHandle(hFile);
+
+    if (!ok) {
+        std::cerr << "[Bookmarks] ❌ Failed to write " << tmpPath << " (Error: " << GetLastError() << ")" << std::endl;
+        DeleteFileA(tmpPath.c_str());
+        return false;
+    }
+
+    if (!MoveFileExA(tmpPath.c_str(), m_filePath.c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        std::cerr << "[Bookmarks] ❌ Failed to replace " << m_filePath << " (Error: " << GetLastError() << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef BOOKMARKSTORE_HPP
+#define BOOKMARKSTORE_HPP
+
+#include <Windows.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================
+// Bookmark Store
+// ============================================================
+// Remembers, per configured event source, the last EventRecordID the
+// server acknowledged, so a restart resumes right after it instead of
+// losing everything that happened while the agent was down.
+//
+//   sender --acknowledge()--> in-memory position --flush thread--> bookmarks.json
+//
+// acknowledge() is only called for batches the server accepted. The file
+// is rewritten every flushIntervalMs when something changed (never per
+// event), via a temp file + MoveFileEx so a crash mid-write leaves the
+// previous copy intact.
+// ============================================================
+
+class BookmarkStore {
+public:
+    BookmarkStore(const std::string& filePath, unsigned flushIntervalMs);
+    ~BookmarkStore();
+
+    BookmarkStore(const BookmarkStore&) = delete;
+    BookmarkStore& operator=(const BookmarkStore&) = delete;
+
+    // Reads the saved positions (a missing file just means "no bookmarks yet")
+    bool load();
+
+    // Returns the source index used in RenderedEvent::source
+    size_t registerSource(const std::wstring& channel);
+
+    // 0 when the source has never been acknowledged
+    uint64_t recordId(size_t source) const;
+
+    // Bookmark XML for EvtCreateBookmark, empty when there is nothing to resume from
+    std::wstring bookmarkXml(size_t source) const;
+
+    // Called by the sender once a batch has been accepted by the server
+    void acknowledge(size_t source, uint64_t recordId);
+
+    void start();
+    void stop();       // Stops the flush thread and writes the final positions
+
+    // Writes the file if anything changed since the last write
+    bool flush();
+
+private:
+    struct Source {
+        std::wstring channel;
+        std::string key;                      // Channel name as stored in the file
+        std::atomic<uint64_t> ackedRecordId{0};
+    };
+
+    void flushLoop();
+    bool writeFile(const std::string& contents);
+
+    std::string m_filePath;
+    unsigned m_flushIntervalMs;
+
+    // A config reload can register a source while the sender acknowledges and
+    // the flush thread writes: the vector is guarded, unique_ptr keeps the atomics put
+    mutable std::shared_mutex m_sourcesMutex;
+    std::vector<std::unique_ptr<Source>> m_sources;
+    std::unordered_map<std::string, uint64_t> m_loaded;   // From the file, incl. sources no longer configured
+    std::atomic<bool> m_dirty{false};
+
+    std::mutex m_fileMutex;            // One writer at a time (flush thread vs. stop)
+    std::mutex m_flushMutex;
+    std::condition_variable m_flushCV;
+    std::thread m_flushThread;
+    std::atomic<bool> m_running{false};
+};
+
+#endif // BOOKMARKSTORE_HPP
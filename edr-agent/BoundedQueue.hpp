@@ -0,0 +1,119 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// ============================================================
+// Bounded Lock-Free Ring Buffer
+// ============================================================
+// Dmitry Vyukov's bounded MPMC queue. Every slot carries a sequence
+// number telling producers and consumers whether the slot is free or
+// holds data for the current lap, so pushes and pops are a single CAS
+// on the shared cursor and never take a lock.
+//
+// We use it as an MPSC queue between the EvtSubscribe callback threads
+// and the pipeline workers. It is MPMC-safe, which lets a producer pop
+// the oldest entry itself when the overflow policy is drop-oldest.
+// ============================================================
+template <typename T>
+class BoundedQueue {
+public:
+    // Capacity is rounded up to the next power of two (minimum 2)
+    explicit BoundedQueue(size_t requestedCapacity)
+        : m_capacity(roundUpPow2(requestedCapacity))
+        , m_mask(m_capacity - 1)
+        , m_slots(new Slot[m_capacity])
+    {
+        for (size_t i = 0; i < m_capacity; i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Returns false if the queue is full; item is left untouched in that case
+    bool tryPush(T&& item) {
+        Slot* slot;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(item);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty
+    bool tryPop(T& item) {
+        Slot* slot;
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &m_slots[pos & m_mask];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(slot->value);
+        slot->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // Racy by nature; good enough for stats and wakeup heuristics
+    size_t sizeApprox() const {
+        size_t enq = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t deq = m_dequeuePos.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    bool emptyApprox() const { return sizeApprox() == 0; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUpPow2(size_t v) {
+        size_t cap = 2;
+        while (cap < v) cap <<= 1;
+        return cap;
+    }
+
+    // Keep the two cursors on separate cache lines so producers and
+    // consumers don't false-share
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+};
+
+#endif // BOUNDEDQUEUE_HPP
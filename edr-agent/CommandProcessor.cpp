@@ -1,7 +1,9 @@
 
 #include "CommandProcessor.hpp"
-#include "ConfigReader.hpp"
+#include "ConfigStore.hpp"
 #include "HttpClient.hpp"
+#include "ProcessTable.hpp"
+#include "HostIsolation.hpp"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -14,9 +16,10 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
 #include <atomic>
+#include <functional>
 #include <vector>
-#include <TlHelp32.h>
 
 // MSVC Compatibility: NTSTATUS is not always defined
 #ifndef NTSTATUS
@@ -142,9 +145,9 @@ namespace CommandProcessor
             if (commandType == "reverse_shell") 
             {
                 std::cout << "Starting reverse shell" << std::endl;
-                ConfigReader configReader("config.json");
-                std::string ip = configReader.getServerReverseShellIp();
-                int port = configReader.getServerReverseShellPort();
+                ConfigStore::Snapshot config = ConfigStore::current();
+                std::string ip = config->getServerReverseShellIp();
+                int port = config->getServerReverseShellPort();
                 std::cout << "IP: " << ip << ", Port: " << port << std::endl;
                 if (ip.empty() || port == -1)
                 {
@@ -206,12 +209,9 @@ namespace CommandProcessor
         }
 
         if (type == "isolate_host") {
-            // Default to localhost if not provided (safe failover)
-            ConfigReader config("config.json");
-            std::string serverIp = config.getHttpServer(); 
-            if (serverIp.find("localhost") != std::string::npos) serverIp = "127.0.0.1";
-            
-            if (isolateHost(serverIp, 8000)) { // Hardcoded port for MVP
+            // The server stays reachable; everything else comes from isolation.allow
+            ConfigStore::Snapshot config = ConfigStore::current();
+            if (isolateHost(config->getHttpServer(), config->getHttpPort())) {
                 return {{"status", "success"}, {"message", "Host isolated"}};
             }
             return {{"status", "failed"}, {"message", "Failed to isolate host. Check Admin privileges."}};
@@ -249,133 +249,197 @@ namespace CommandProcessor
         return waitResult == WAIT_OBJECT_0;
     }
 
-    bool killProcessTree(unsigned long pid) {
-        // Find children
-        std::vector<unsigned long> children;
-        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-        
-        if (snapshot != INVALID_HANDLE_VALUE) {
-            PROCESSENTRY32 pe32;
-            pe32.dwSize = sizeof(PROCESSENTRY32);
-            if (Process32First(snapshot, &pe32)) {
-                do {
-                    if (pe32.th32ParentProcessID == pid) {
-                        children.push_back(pe32.th32ProcessID);
-                    }
-                } while (Process32Next(snapshot, &pe32));
+    // Terminates pid only if it is still the process the table knows: a live
+    // process that started later has reused the PID and is left alone
+    static bool killTrackedProcess(const ProcessTable::Process& process) {
+        HANDLE hProcess = OpenProcess(PROCESS_TERMINATE | SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION,
+                                      FALSE, process.pid);
+        if (hProcess == NULL) {
+            return false;
+        }
+
+        FILETIME creation, exitTime, kernel, user;
+        if (process.startTime != 0 && GetProcessTimes(hProcess, &creation, &exitTime, &kernel, &user)) {
+            uint64_t started = ((uint64_t)creation.dwHighDateTime << 32) | creation.dwLowDateTime;
+            if (started > process.startTime) {
+                std::cerr << "[Response] PID " << process.pid << " was reused, not terminating it" << std::endl;
+                CloseHandle(hProcess);
+                SetLastError(ERROR_INVALID_PARAMETER);
+                return false;
             }
-            CloseHandle(snapshot);
         }
 
-        // Kill children first (recursive)
-        for (unsigned long childPid : children) {
-            killProcessTree(childPid);
+        if (!TerminateProcess(hProcess, 1)) {
+            CloseHandle(hProcess);
+            return false;
         }
 
-        // Kill parent
-        return killProcess(pid);
-    }
+        // Verify death (wait up to 2 seconds)
+        DWORD waitResult = WaitForSingleObject(hProcess, 2000);
+        CloseHandle(hProcess);
 
-    bool runNetshCommand(const std::string& args) {
-        std::string fullCmd = "netsh.exe " + args;
-        
-        STARTUPINFOA si = {sizeof(si)};
-        PROCESS_INFORMATION pi;
-        
-        BOOL success = CreateProcessA(
-            NULL, (LPSTR)fullCmd.c_str(), NULL, NULL, FALSE, 
-            CREATE_NO_WINDOW, NULL, NULL, &si, &pi
-        );
-        
-        if (!success) return false;
-        
-        WaitForSingleObject(pi.hProcess, 5000);
-        DWORD exitCode;
-        GetExitCodeProcess(pi.hProcess, &exitCode);
-        
-        CloseHandle(pi.hProcess);
-        CloseHandle(pi.hThread);
-        
-        return exitCode == 0;
+        return waitResult == WAIT_OBJECT_0;
     }
 
-    bool isolateHost(const std::string& serverIp, int serverPort) {
-        // 1. Block all outbound
-        if (!runNetshCommand("advfirewall firewall add rule name=\"EDR_BLOCK_ALL\" dir=out action=block")) return false;
-        
-        // 2. Allow Antigravity IDE (Web ports)
-        if (!runNetshCommand("advfirewall firewall add rule name=\"EDR_ALLOW_ANTIGRAVITY\" dir=out action=allow protocol=TCP remoteport=80,443")) return false;
+    bool killProcessTree(unsigned long pid) {
+        // The tree comes from the process table: O(subtree), no system-wide snapshot
+        std::vector<ProcessTable::Process> tree = ProcessTable::subtree((uint32_t)pid);
+        if (tree.empty()) {
+            // Not seen yet (e.g. Sysmon events are still queued): resync once
+            ProcessTable::rebuild();
+            tree = ProcessTable::subtree((uint32_t)pid);
+        }
+        if (tree.empty()) {
+            return killProcess(pid);
+        }
 
-        // 3. Allow EDR Server
-        std::string allowServer = "advfirewall firewall add rule name=\"EDR_ALLOW_SERVER\" dir=out action=allow remoteip=" + serverIp + " protocol=TCP remoteport=" + std::to_string(serverPort);
-        if (!runNetshCommand(allowServer)) return false;
+        std::cout << "[Response] Terminating " << tree.size() << " process(es) under PID " << pid << std::endl;
 
-        // 4. Allow DNS (UDP 53)
-        if (!runNetshCommand("advfirewall firewall add rule name=\"EDR_ALLOW_DNS\" dir=out action=allow protocol=UDP remoteport=53")) return false;
+        // Descendants first, the root last; its result is what the server gets
+        bool killed = false;
+        for (const auto& process : tree) {
+            killed = killTrackedProcess(process);
+        }
+        return killed;
+    }
 
-        return true;
+    // Allow-list and state file from the "isolation" config section
+    static IsolationConfig readIsolationConfig() {
+        ConfigStore::Snapshot config = ConfigStore::current();
+        IsolationConfig isolation;
+        isolation.allow = HostIsolation::parseRules(config->getIsolationAllowRules());
+        isolation.blockInbound = config->isIsolationBlockInbound();
+        isolation.statePath = config->getIsolationStatePath();
+        return isolation;
+    }
+
+    bool isolateHost(const std::string& serverHost, int serverPort) {
+        return HostIsolation::isolate(readIsolationConfig(), serverHost, serverPort);
     }
 
     bool deisolateHost() {
-        bool success = true;
-        // We attempt all removals, but track if any failed
-        if (!runNetshCommand("advfirewall firewall delete rule name=\"EDR_BLOCK_ALL\"")) success = false;
-        if (!runNetshCommand("advfirewall firewall delete rule name=\"EDR_ALLOW_ANTIGRAVITY\"")) success = false;
-        if (!runNetshCommand("advfirewall firewall delete rule name=\"EDR_ALLOW_SERVER\"")) success = false;
-        if (!runNetshCommand("advfirewall firewall delete rule name=\"EDR_ALLOW_DNS\"")) success = false;
-        
-        return success;
+        return HostIsolation::deisolate(readIsolationConfig());
     }
 
     // ==========================================
     // POLLING THREAD IMPLEMENTATION
     // ==========================================
 
+    // Set when the WebSocket is built in: while it is up, commands are pushed over it
+    static std::function<bool()> pushChannelUp;
+
+    void setPushChannel(std::function<bool()> isConnected) {
+        pushChannelUp = std::move(isConnected);
+    }
+
+    // Executes one command from a poll response and reports its result
+    static void runPolledCommand(HttpClient& client, const std::string& serverUrl, const json& commandJson) {
+        if (!commandJson.contains("command_id")) return;
+
+        std::string commandId = commandJson["command_id"];
+        std::string commandType = commandJson.value("type", "");
+        json params = commandJson.value("parameters", json::object());
+
+        std::cout << "[CommandPoll] Received command: " << commandType << std::endl;
+
+        // Execute command. The server has already handed it to us, so it always gets a result.
+        json result;
+        try {
+            result = executeResponseCommand(commandType, params);
+        } catch (const std::exception& e) {
+            std::cerr << "[CommandPoll] Command " << commandType << " failed: " << e.what() << std::endl;
+            result = {{"status", "failed"}, {"message", std::string("Command failed: ") + e.what()}};
+        }
+
+        // Report result back
+        client.POST(serverUrl + "/api/v1/commands/result/" + commandId + "/", result.dump());
+    }
+
     void pollCommandsLoop() {
-        HttpClient client;
-        ConfigReader config("config.json");
+        // The server and token are bound to the connection; a reload applies on restart
+        ConfigStore::Snapshot snapshot = ConfigStore::current();
+        const ConfigReader& config = *snapshot;
         std::string serverHost = config.getHttpServer();
         int serverPort = config.getHttpPort();
         std::string serverUrl = "http://" + serverHost + ":" + std::to_string(serverPort);
         std::string authToken = config.getAuthToken();
+        unsigned longPollS = config.getCommandPollLongPollS();
+        unsigned minIntervalMs = config.getCommandPollMinIntervalMs();
+        unsigned maxIntervalMs = std::max(config.getCommandPollMaxIntervalMs(), minIntervalMs);
         
         // Ensure URL doesn't end with slash for consistency
         if (serverUrl.back() == '/') serverUrl.pop_back();
 
+        // Bound to the server, so every poll and result reuses one connection
+        HttpClient client(serverHost, serverPort, "", authToken);
         client.addHeader("Authorization", "Token " + authToken);
         client.addHeader("X-Agent-ID", getHostName()); // Use hostname as Agent ID for MVP
 
-        std::cout << "[CommandPoll] Thread started. Polling " << serverUrl << std::endl;
+        // The server holds the request until a command is queued or longPollS
+        // passes, and hands over everything pending (up to max) at once
+        std::string pollUrl = serverUrl + "/api/v1/commands/wait/?wait=" + std::to_string(longPollS) +
+                              "&max=" + std::to_string(config.getCommandPollMaxCommands());
+        unsigned requestTimeoutMs = (longPollS + 15) * 1000;
 
+        std::cout << "[CommandPoll] Thread started. Polling " << serverUrl
+                  << " (long-poll " << longPollS << " s)" << std::endl;
+
+        unsigned intervalMs = minIntervalMs;
+        bool pushWasUp = false;
         while (pollingActive) {
-            try {
-                std::string response = client.GET(serverUrl + "/api/v1/commands/poll/");
-                
-                if (!response.empty() && response != "{}" && response.length() > 2) {
-                    json commandJson = json::parse(response);
-                    
-                    if (commandJson.contains("command_id")) {
-                        std::string commandId = commandJson["command_id"];
-                        std::string commandType = commandJson["type"];
-                        json params = commandJson.value("parameters", json::object());
-                        
-                        std::cout << "[CommandPoll] Received command: " << commandType << std::endl;
-
-                        // Execute command
-                        json result = executeResponseCommand(commandType, params);
-                        
-                        // Report result back
-                        client.POST(serverUrl + "/api/v1/commands/result/" + commandId + "/", 
-                                    result.dump());
+            unsigned waitMs = intervalMs;
+
+            if (pushChannelUp && pushChannelUp()) {
+                // Commands arrive over the WebSocket; only watch for it going down
+                if (!pushWasUp) std::cout << "[CommandPoll] WebSocket connected, polling paused" << std::endl;
+                pushWasUp = true;
+                intervalMs = minIntervalMs;
+                waitMs = minIntervalMs;
+            } else {
+                if (pushWasUp) std::cout << "[CommandPoll] WebSocket down, polling resumed" << std::endl;
+                pushWasUp = false;
+
+                try {
+                    auto started = std::chrono::steady_clock::now();
+                    DWORD status = 0;
+                    std::string response = client.GET(pollUrl, requestTimeoutMs, &status);
+                    auto heldMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - started).count();
+
+                    size_t received = 0;
+                    if (status == 200 && !response.empty()) {
+                        json body = json::parse(response);
+                        for (const auto& commandJson : body.value("commands", json::array())) {
+                            runPolledCommand(client, serverUrl, commandJson);
+                            received++;
+                        }
                     }
+
+                    if (received > 0) {
+                        // More may have been queued meanwhile: ask again right away
+                        intervalMs = minIntervalMs;
+                        waitMs = 0;
+                    } else if (status == 204 && heldMs >= (long long)longPollS * 500) {
+                        // The server held the request: it already waited for us
+                        intervalMs = minIntervalMs;
+                        waitMs = 0;
+                    } else {
+                        // Error, or a server answering at once: back off while idle
+                        intervalMs = std::min(intervalMs * 2, maxIntervalMs);
+                        waitMs = intervalMs;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "[CommandPoll] Error: " << e.what() << std::endl;
+                    intervalMs = std::min(intervalMs * 2, maxIntervalMs);
+                    waitMs = intervalMs;
                 }
-            } catch (const std::exception& e) {
-                std::cerr << "[CommandPoll] Error: " << e.what() << std::endl;
             }
             
-            // Interruptible sleep for 5 seconds
-            std::unique_lock<std::mutex> lock(pollMutex);
-            pollCV.wait_for(lock, std::chrono::seconds(5), []{ return !pollingActive; });
+            // Interruptible sleep
+            if (waitMs > 0) {
+                std::unique_lock<std::mutex> lock(pollMutex);
+                pollCV.wait_for(lock, std::chrono::milliseconds(waitMs), []{ return !pollingActive; });
+            }
         }
     }
 
@@ -3,6 +3,7 @@
 #define COMMANDPROCESSOR_HPP
 
 #include "nlohmann/json.hpp"
+#include <functional>
 #include <string>
 
 namespace CommandProcessor {
@@ -19,12 +20,14 @@ namespace CommandProcessor {
 	// Response Actions (New)
 	bool killProcess(unsigned long pid);
 	bool killProcessTree(unsigned long pid);
-	bool isolateHost(const std::string& serverIp, int serverPort);
+	bool isolateHost(const std::string& serverHost, int serverPort);   // Firewall API, see HostIsolation
 	bool deisolateHost();
 
 	// Command Polling (New)
+	// Long-polls the server; paused while the push channel (WebSocket) reports connected
 	void startCommandPolling();
 	void stopCommandPolling();
+	void setPushChannel(std::function<bool()> isConnected);
 }
 
 #endif // COMMANDPROCESSOR_HPP
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <fstream>
 #include "nlohmann/json.hpp"
 #include "ConfigReader.hpp"
+#include "HostIsolation.hpp"
 
 ConfigReader::ConfigReader(
     const std::filesystem::path& configFilePath
@@ -9,6 +10,11 @@ ConfigReader::ConfigReader(
     jsonObject = parseJsonFile(configFilePath);
 }
 
+ConfigReader::ConfigReader(
+    const std::filesystem::path& configFilePath, nlohmann::json json
+) : configFilePath(configFilePath), jsonObject(std::move(json)) {
+}
+
 nlohmann::json ConfigReader::parseJsonFile(const std::filesystem::path& configFilePath)
 {
     nlohmann::json jsonObject;
@@ -42,16 +48,70 @@ nlohmann::json ConfigReader::parseJsonFile(const std::filesystem::path& configFi
     return jsonObject;
 }
 
-std::vector<std::pair<std::wstring, std::wstring>> ConfigReader::getPathQueryPairs()
+bool ConfigReader::validate(std::string& error) const
+{
+    if (!jsonObject.is_object()) {
+        error = "not a JSON object";
+        return false;
+    }
+    const nlohmann::json& sources = getEventSources();
+    if (!sources.is_array()) {
+        error = "event_processor.source must be an array";
+        return false;
+    }
+    for (const auto& source : sources) {
+        if (!source.is_object() || !source.contains("path") || !source["path"].is_string()) {
+            error = "every event_processor.source needs a path";
+            return false;
+        }
+    }
+
+    try {
+        getPathQueryPairs(); getRenderMode(); getSubscribeMode(); getPullBatchSize();
+        getEtwSessionName(); getEtwBufferKb(); getEtwMinBuffers(); getEtwMaxBuffers(); getEtwFlushTimerS();
+        isBookmarkEnabled(); getBookmarkPath(); getBookmarkFlushIntervalMs();
+        getCompressionLevel(); getCompressionWorkers(); getCompressionMultithreadThresholdKb(); getCompressionDictionary();
+        isSpoolEnabled(); getSpoolDirectory(); getSpoolMaxMb(); getSpoolSegmentMb(); getSpoolMaxAgeHours();
+        getSpoolReplayBatchesPerSec(); getSpoolReplayJitterMs();
+        getServerUri(); getWebSocketMaxPendingBatches(); getWebSocketAckTimeoutMs(); isWebSocketPermessageDeflate();
+        getServerReverseShellIp(); getServerReverseShellPort();
+        getHttpServer(); getHttpPort(); getApiPath(); isHttpPollingDisabled();
+        getPipelineQueueDepth(); getPipelineOverflowPolicy(); getPipelineDropEventIds(); getPipelineWorkerThreads();
+        getBatchMaxEvents(); getBatchMaxBytes(); getBatchMaxDelayMs(); isBatchStreamCompression(); getBatchFormat();
+        isAggregationEnabled(); getAggregationWindowMs(); getAggregationMaxEntries(); getAggregationKeys();
+        HostIsolation::parseRules(getIsolationAllowRules()); isIsolationBlockInbound(); getIsolationStatePath();
+        getCommandPollLongPollS(); getCommandPollMaxCommands(); getCommandPollMinIntervalMs(); getCommandPollMaxIntervalMs();
+        getSenderMaxInFlight(); getSenderTransport(); getSenderRequestTimeoutMs();
+        getLogLevel(); getLogMaxLinesPerSecond();
+        isHealthEnabled(); getHealthIntervalS(); getHealthPath();
+        isRateControlEnabled(); getRateControlTargetLatencyMs(); getRateControlMinBatchEvents();
+        getRateControlMaxBatchesPerSec(); getRateControlMinBatchesPerSec(); getRateControlBackoffBaseMs();
+        getRateControlBackoffMaxMs(); getRateControlStatePath();
+        isGovernorEnabled(); getGovernorSampleIntervalMs(); getGovernorCpuPercent(); getGovernorWorkingSetMb();
+        getGovernorRecoverSamples(); getGovernorShedEventIds(); getGovernorAggregationWindowScale();
+        getGovernorPressureZstdLevel(); isGovernorJobObjectEnabled(); getGovernorJobCpuPercent(); getGovernorJobMemoryMb();
+        isConfigReloadEnabled(); getConfigReloadDebounceMs();
+    }
+    catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::pair<std::wstring, std::wstring>> ConfigReader::getPathQueryPairs() const
 {
     std::vector<std::pair<std::wstring, std::wstring>> pathQueryPairs;
     // Check if "event_processor" and "source" exist
     if (jsonObject.find("event_processor") != jsonObject.end() && 
         jsonObject["event_processor"].find("source") != jsonObject["event_processor"].end()) {
-        auto sourceArray = jsonObject["event_processor"]["source"];
+        const auto& sourceArray = jsonObject["event_processor"]["source"];
 
         // Iterate over the "source" array
         for (const auto& sourceObj : sourceArray) {
+            // ETW sources are read by getEventSources() instead
+            if (sourceObj.is_object() && sourceObj.value("engine", "eventlog") == "etw") continue;
+
             // Check if "path" and "query" exist in sourceObj
             if (sourceObj.find("path") != sourceObj.end() && sourceObj.find("query") != sourceObj.end()) {
                 std::string path = sourceObj["path"];
@@ -71,11 +131,371 @@ std::vector<std::pair<std::wstring, std::wstring>> ConfigReader::getPathQueryPai
     return pathQueryPairs;
 }
 
+const nlohmann::json& ConfigReader::getEventSources() const
+{
+    static const nlohmann::json none = nlohmann::json::array();
+    if (jsonObject.contains("event_processor") && jsonObject["event_processor"].contains("source")) {
+        return jsonObject["event_processor"]["source"];
+    }
+    return none;
+}
+
+std::string ConfigReader::getRenderMode() const
+{
+    // "values" = EvtRenderEventValues for known Sysmon IDs (XML fallback), "xml" = always XML
+    if (jsonObject.contains("event_processor") && jsonObject["event_processor"].contains("render_mode")) {
+        return jsonObject["event_processor"]["render_mode"].get<std::string>();
+    }
+    return "values";
+}
+
+std::string ConfigReader::getSubscribeMode() const
+{
+    // "callback" = one EvtSubscribe callback per event, "pull" = signal event + EvtNext batches
+    if (jsonObject.contains("event_processor") && jsonObject["event_processor"].contains("subscribe_mode")) {
+        return jsonObject["event_processor"]["subscribe_mode"].get<std::string>();
+    }
+    return "callback";
+}
+
+bool ConfigReader::isBookmarkEnabled() const
+{
+    if (jsonObject.contains("bookmarks") && jsonObject["bookmarks"].contains("enabled")) {
+        return jsonObject["bookmarks"]["enabled"].get<bool>();
+    }
+    return true;
+}
+
+std::string ConfigReader::getBookmarkPath() const
+{
+    if (jsonObject.contains("bookmarks") && jsonObject["bookmarks"].contains("path")) {
+        return jsonObject["bookmarks"]["path"].get<std::string>();
+    }
+    return "bookmarks.json";
+}
+
+unsigned ConfigReader::getBookmarkFlushIntervalMs() const
+{
+    if (jsonObject.contains("bookmarks") && jsonObject["bookmarks"].contains("flush_interval_ms")) {
+        return jsonObject["bookmarks"]["flush_interval_ms"].get<unsigned>();
+    }
+    return 5000;
+}
+
+bool ConfigReader::isSpoolEnabled() const
+{
+    if (jsonObject.contains("spool") && jsonObject["spool"].contains("enabled")) {
+        return jsonObject["spool"]["enabled"].get<bool>();
+    }
+    return true;
+}
+
+std::string ConfigReader::getSpoolDirectory() const
+{
+    if (jsonObject.contains("spool") && jsonObject["spool"].contains("directory")) {
+        return jsonObject["spool"]["directory"].get<std::string>();
+    }
+    return "spool";
+}
+
+unsigned ConfigReader::getSpoolMaxMb() const
+{
+    if (jsonObject.contains("spool") && jsonObject["spool"].contains("max_mb")) {
+        return jsonObject["spool"]["max_mb"].get<unsigned>();
+    }
+    return 512;
+}
+
+unsigned ConfigReader::getSpoolSegmentMb() const
+{
+    if (jsonObject.contains("spool") && jsonObject["spool"].contains("segment_mb")) {
+        return jsonObject["spool"]["segment_mb"].get<unsigned>();
+    }
+    return 16;
+}
+
+unsigned ConfigReader::getSpoolMaxAgeHours() const
+{
+    if (jsonObject.contains("spool") && jsonObject["spool"].contains("max_age_hours")) {
+        return jsonObject["spool"]["max_age_hours"].get<unsigned>();
+    }
+    return 72;
+}
+
+unsigned ConfigReader::getSpoolReplayBatchesPerSec() const
+{
+    if (jsonObject.contains("spool") && jsonObject["spool"].contains("replay_batches_per_sec")) {
+        return jsonObject["spool"]["replay_batches_per_sec"].get<unsigned>();
+    }
+    return 5;
+}
+
+unsigned ConfigReader::getSpoolReplayJitterMs() const
+{
+    if (jsonObject.contains("spool") && jsonObject["spool"].contains("replay_jitter_ms")) {
+        return jsonObject["spool"]["replay_jitter_ms"].get<unsigned>();
+    }
+    return 30000;
+}
+
+int ConfigReader::getCompressionLevel() const
+{
+    if (jsonObject.contains("compression") && jsonObject["compression"].contains("level")) {
+        return jsonObject["compression"]["level"].get<int>();
+    }
+    return 3;
+}
+
+int ConfigReader::getCompressionWorkers() const
+{
+    if (jsonObject.contains("compression") && jsonObject["compression"].contains("workers")) {
+        return jsonObject["compression"]["workers"].get<int>();
+    }
+    return 0;
+}
+
+unsigned ConfigReader::getCompressionMultithreadThresholdKb() const
+{
+    if (jsonObject.contains("compression") && jsonObject["compression"].contains("multithread_threshold_kb")) {
+        return jsonObject["compression"]["multithread_threshold_kb"].get<unsigned>();
+    }
+    return 1024;
+}
+
+std::string ConfigReader::getCompressionDictionary() const
+{
+    if (jsonObject.contains("compression") && jsonObject["compression"].contains("dictionary")) {
+        return jsonObject["compression"]["dictionary"].get<std::string>();
+    }
+    return "";
+}
+
+bool ConfigReader::isBatchStreamCompression() const
+{
+    if (jsonObject.contains("batch") && jsonObject["batch"].contains("stream_compression")) {
+        return jsonObject["batch"]["stream_compression"].get<bool>();
+    }
+    return true;
+}
+
+std::string ConfigReader::getBatchFormat() const
+{
+    // "json" = JSON array body, "binary" = BinaryBatch (application/x-edr-batch)
+    if (jsonObject.contains("batch") && jsonObject["batch"].contains("format")) {
+        return jsonObject["batch"]["format"].get<std::string>();
+    }
+    return "json";
+}
+
+// ============================================
+// ETW Methods
+// ============================================
+
+std::string ConfigReader::getEtwSessionName() const
+{
+    if (jsonObject.contains("etw") && jsonObject["etw"].contains("session_name")) {
+        return jsonObject["etw"]["session_name"].get<std::string>();
+    }
+    return "EDR-Agent-ETW";
+}
+
+unsigned ConfigReader::getEtwBufferKb() const
+{
+    if (jsonObject.contains("etw") && jsonObject["etw"].contains("buffer_kb")) {
+        return jsonObject["etw"]["buffer_kb"].get<unsigned>();
+    }
+    return 256;
+}
+
+unsigned ConfigReader::getEtwMinBuffers() const
+{
+    if (jsonObject.contains("etw") && jsonObject["etw"].contains("min_buffers")) {
+        return jsonObject["etw"]["min_buffers"].get<unsigned>();
+    }
+    return 16;
+}
+
+unsigned ConfigReader::getEtwMaxBuffers() const
+{
+    if (jsonObject.contains("etw") && jsonObject["etw"].contains("max_buffers")) {
+        return jsonObject["etw"]["max_buffers"].get<unsigned>();
+    }
+    return 128;
+}
+
+unsigned ConfigReader::getEtwFlushTimerS() const
+{
+    if (jsonObject.contains("etw") && jsonObject["etw"].contains("flush_timer_s")) {
+        return jsonObject["etw"]["flush_timer_s"].get<unsigned>();
+    }
+    return 1;
+}
+
+// ============================================
+// Aggregation Methods
+// ============================================
+
+bool ConfigReader::isAggregationEnabled() const
+{
+    if (jsonObject.contains("aggregation") && jsonObject["aggregation"].contains("enabled")) {
+        return jsonObject["aggregation"]["enabled"].get<bool>();
+    }
+    return false;
+}
+
+unsigned ConfigReader::getAggregationWindowMs() const
+{
+    if (jsonObject.contains("aggregation") && jsonObject["aggregation"].contains("window_ms")) {
+        return jsonObject["aggregation"]["window_ms"].get<unsigned>();
+    }
+    return 10000;
+}
+
+size_t ConfigReader::getAggregationMaxEntries() const
+{
+    if (jsonObject.contains("aggregation") && jsonObject["aggregation"].contains("max_entries")) {
+        return jsonObject["aggregation"]["max_entries"].get<size_t>();
+    }
+    return 4096;
+}
+
+std::vector<std::pair<std::string, std::vector<std::string>>> ConfigReader::getAggregationKeys() const
+{
+    std::vector<std::pair<std::string, std::vector<std::string>>> keys;
+    if (jsonObject.contains("aggregation") && jsonObject["aggregation"].contains("keys")) {
+        for (auto& [eventType, fields] : jsonObject["aggregation"]["keys"].items()) {
+            keys.emplace_back(eventType, fields.get<std::vector<std::string>>());
+        }
+        return keys;
+    }
+
+    // Default: one record per process/destination and per process/directory/extension
+    keys.push_back({"network", {"network.image", "network.dest_ip", "network.dest_port", "network.protocol"}});
+    keys.push_back({"file", {"file.process_image", "file.operation", "file.path:dir", "file.path:ext"}});
+    return keys;
+}
+
+// ============================================
+// Filter Methods
+// ============================================
+
+const nlohmann::json& ConfigReader::getFilterConfig() const
+{
+    static const nlohmann::json none = nlohmann::json::object();
+    if (jsonObject.contains("filter") && jsonObject["filter"].is_object()) {
+        return jsonObject["filter"];
+    }
+    return none;
+}
+
+// ============================================
+// Isolation Methods
+// ============================================
+
+const nlohmann::json& ConfigReader::getIsolationAllowRules() const
+{
+    // DNS only; the server itself is always allowed
+    static const nlohmann::json dnsOnly =
+        nlohmann::json::array({{{"name", "dns"}, {"protocol", "udp"}, {"remote_ports", "53"}}});
+    if (jsonObject.contains("isolation") && jsonObject["isolation"].contains("allow")) {
+        return jsonObject["isolation"]["allow"];
+    }
+    return dnsOnly;
+}
+
+bool ConfigReader::isIsolationBlockInbound() const
+{
+    if (jsonObject.contains("isolation") && jsonObject["isolation"].contains("block_inbound")) {
+        return jsonObject["isolation"]["block_inbound"].get<bool>();
+    }
+    return true;
+}
+
+std::string ConfigReader::getIsolationStatePath() const
+{
+    if (jsonObject.contains("isolation") && jsonObject["isolation"].contains("state_path")) {
+        return jsonObject["isolation"]["state_path"].get<std::string>();
+    }
+    return "isolation_state.json";
+}
+
+// ============================================
+// Command Poll Methods
+// ============================================
+
+unsigned ConfigReader::getCommandPollLongPollS() const
+{
+    if (jsonObject.contains("command_poll") && jsonObject["command_poll"].contains("long_poll_s")) {
+        return jsonObject["command_poll"]["long_poll_s"].get<unsigned>();
+    }
+    return 25;
+}
+
+unsigned ConfigReader::getCommandPollMaxCommands() const
+{
+    if (jsonObject.contains("command_poll") && jsonObject["command_poll"].contains("max_commands")) {
+        return jsonObject["command_poll"]["max_commands"].get<unsigned>();
+    }
+    return 10;
+}
+
+unsigned ConfigReader::getCommandPollMinIntervalMs() const
+{
+    if (jsonObject.contains("command_poll") && jsonObject["command_poll"].contains("min_interval_ms")) {
+        return jsonObject["command_poll"]["min_interval_ms"].get<unsigned>();
+    }
+    return 1000;
+}
+
+unsigned ConfigReader::getCommandPollMaxIntervalMs() const
+{
+    if (jsonObject.contains("command_poll") && jsonObject["command_poll"].contains("max_interval_ms")) {
+        return jsonObject["command_poll"]["max_interval_ms"].get<unsigned>();
+    }
+    return 30000;
+}
+
+// ============================================
+// Sender Methods
+// ============================================
+
+unsigned ConfigReader::getSenderMaxInFlight() const
+{
+    if (jsonObject.contains("sender") && jsonObject["sender"].contains("max_in_flight")) {
+        return jsonObject["sender"]["max_in_flight"].get<unsigned>();
+    }
+    return 4;
+}
+
+unsigned ConfigReader::getSenderRequestTimeoutMs() const
+{
+    if (jsonObject.contains("sender") && jsonObject["sender"].contains("request_timeout_ms")) {
+        return jsonObject["sender"]["request_timeout_ms"].get<unsigned>();
+    }
+    return 30000;
+}
+
+std::string ConfigReader::getSenderTransport() const
+{
+    if (jsonObject.contains("sender") && jsonObject["sender"].contains("transport")) {
+        return jsonObject["sender"]["transport"].get<std::string>();
+    }
+    return "http";
+}
+
+unsigned ConfigReader::getPullBatchSize() const
+{
+    if (jsonObject.contains("event_processor") && jsonObject["event_processor"].contains("pull_batch_size")) {
+        return jsonObject["event_processor"]["pull_batch_size"].get<unsigned>();
+    }
+    return 256;
+}
+
 // ============================================
-// WebSocket Methods (Keep for future)
+// WebSocket Methods
 // ============================================
 
-std::string ConfigReader::getServerUri()
+std::string ConfigReader::getServerUri() const
 {
     if (jsonObject.find("uri") != jsonObject.end()) {
         return jsonObject["uri"];
@@ -84,21 +504,45 @@ std::string ConfigReader::getServerUri()
     }
 }
 
-std::string ConfigReader::getServerReverseShellIp()
+size_t ConfigReader::getWebSocketMaxPendingBatches() const
+{
+    if (jsonObject.contains("websocket") && jsonObject["websocket"].contains("max_pending_batches")) {
+        return jsonObject["websocket"]["max_pending_batches"].get<size_t>();
+    }
+    return 8;
+}
+
+unsigned ConfigReader::getWebSocketAckTimeoutMs() const
+{
+    if (jsonObject.contains("websocket") && jsonObject["websocket"].contains("ack_timeout_ms")) {
+        return jsonObject["websocket"]["ack_timeout_ms"].get<unsigned>();
+    }
+    return 30000;
+}
+
+bool ConfigReader::isWebSocketPermessageDeflate() const
+{
+    if (jsonObject.contains("websocket") && jsonObject["websocket"].contains("permessage_deflate")) {
+        return jsonObject["websocket"]["permessage_deflate"].get<bool>();
+    }
+    return false;
+}
+
+std::string ConfigReader::getServerReverseShellIp() const
 {
     if (jsonObject.find("command_processor") != jsonObject.end() &&
         jsonObject["command_processor"].find("reverse_shell") != jsonObject["command_processor"].end()) {
-        return jsonObject["command_processor"]["reverse_shell"]["ip"];
+        return jsonObject["command_processor"]["reverse_shell"].value("ip", "");
     } else {
         return "";
     }
 }
 
-int ConfigReader::getServerReverseShellPort()
+int ConfigReader::getServerReverseShellPort() const
 {
     if (jsonObject.find("command_processor") != jsonObject.end() &&
         jsonObject["command_processor"].find("reverse_shell") != jsonObject["command_processor"].end()) {
-        return jsonObject["command_processor"]["reverse_shell"]["port"];
+        return jsonObject["command_processor"]["reverse_shell"].value("port", -1);
     } else {
         return -1;
     }
@@ -108,7 +552,7 @@ int ConfigReader::getServerReverseShellPort()
 // HTTP Methods (NEW - for Django)
 // ============================================
 
-std::string ConfigReader::getHttpServer()
+std::string ConfigReader::getHttpServer() const
 {
     if (jsonObject.find("http_server") != jsonObject.end()) {
         return jsonObject["http_server"];
@@ -118,7 +562,7 @@ std::string ConfigReader::getHttpServer()
     }
 }
 
-int ConfigReader::getHttpPort()
+int ConfigReader::getHttpPort() const
 {
     if (jsonObject.find("http_port") != jsonObject.end()) {
         return jsonObject["http_port"];
@@ -128,7 +572,7 @@ int ConfigReader::getHttpPort()
     }
 }
 
-std::string ConfigReader::getApiPath()
+std::string ConfigReader::getApiPath() const
 {
     if (jsonObject.find("api_path") != jsonObject.end()) {
         return jsonObject["api_path"];
@@ -138,7 +582,7 @@ std::string ConfigReader::getApiPath()
     }
 }
 
-std::string ConfigReader::getAuthToken()
+std::string ConfigReader::getAuthToken() const
 {
     // 1. Priority: Check Environment Variable
     const char* envToken = std::getenv("EDR_AUTH_TOKEN");
@@ -190,20 +634,20 @@ std::string ConfigReader::getAuthToken()
 // Utility Methods
 // ============================================
 
-bool ConfigReader::hasHttpConfig()
+bool ConfigReader::hasHttpConfig() const
 {
     // Check if HTTP configuration exists
     return jsonObject.find("http_server") != jsonObject.end() ||
            jsonObject.find("http_port") != jsonObject.end();
 }
 
-bool ConfigReader::hasWebSocketConfig()
+bool ConfigReader::hasWebSocketConfig() const
 {
     // Check if WebSocket configuration exists
     return jsonObject.find("uri") != jsonObject.end();
 }
 
-bool ConfigReader::isHttpPollingDisabled()
+bool ConfigReader::isHttpPollingDisabled() const
 {
     // Check if HTTP polling is disabled (for WebSocket-only testing)
     if (jsonObject.find("disable_http_polling") != jsonObject.end()) {
@@ -211,3 +655,302 @@ bool ConfigReader::isHttpPollingDisabled()
     }
     return false;  // Default: HTTP polling enabled
 }
+
+
+// ============================================
+// Event Pipeline Methods
+// ============================================
+
+size_t ConfigReader::getPipelineQueueDepth() const
+{
+    if (jsonObject.contains("pipeline") && jsonObject["pipeline"].contains("queue_depth")) {
+        return jsonObject["pipeline"]["queue_depth"].get<size_t>();
+    }
+    return 8192;  // Default: ~8k rendered events in flight
+}
+
+std::string ConfigReader::getPipelineOverflowPolicy() const
+{
+    if (jsonObject.contains("pipeline") && jsonObject["pipeline"].contains("overflow_policy")) {
+        return jsonObject["pipeline"]["overflow_policy"].get<std::string>();
+    }
+    return "drop_oldest";
+}
+
+std::vector<int> ConfigReader::getPipelineDropEventIds() const
+{
+    std::vector<int> ids;
+    if (jsonObject.contains("pipeline") && jsonObject["pipeline"].contains("drop_event_ids")) {
+        for (const auto& id : jsonObject["pipeline"]["drop_event_ids"]) {
+            ids.push_back(id.get<int>());
+        }
+    }
+    return ids;
+}
+
+unsigned ConfigReader::getPipelineWorkerThreads() const
+{
+    if (jsonObject.contains("pipeline") && jsonObject["pipeline"].contains("worker_threads")) {
+        return jsonObject["pipeline"]["worker_threads"].get<unsigned>();
+    }
+    return 0;   // One per core
+}
+
+// ============================================
+// Batch Flushing Methods
+// ============================================
+
+size_t ConfigReader::getBatchMaxEvents() const
+{
+    if (jsonObject.contains("batch") && jsonObject["batch"].contains("max_events")) {
+        return jsonObject["batch"]["max_events"].get<size_t>();
+    }
+    return 500;
+}
+
+size_t ConfigReader::getBatchMaxBytes() const
+{
+    if (jsonObject.contains("batch") && jsonObject["batch"].contains("max_bytes")) {
+        return jsonObject["batch"]["max_bytes"].get<size_t>();
+    }
+    return 256 * 1024;  // Compressed bytes per POST
+}
+
+unsigned ConfigReader::getBatchMaxDelayMs() const
+{
+    if (jsonObject.contains("batch") && jsonObject["batch"].contains("max_delay_ms")) {
+        return jsonObject["batch"]["max_delay_ms"].get<unsigned>();
+    }
+    return 2000;  // Bounded detection latency on quiet hosts
+}
+// ============================================
+// Logging Methods
+// ============================================
+
+std::string ConfigReader::getLogLevel() const
+{
+    if (jsonObject.contains("logging") && jsonObject["logging"].contains("level")) {
+        return jsonObject["logging"]["level"].get<std::string>();
+    }
+    return "info";
+}
+
+unsigned ConfigReader::getLogMaxLinesPerSecond() const
+{
+    if (jsonObject.contains("logging") && jsonObject["logging"].contains("max_lines_per_second")) {
+        return jsonObject["logging"]["max_lines_per_second"].get<unsigned>();
+    }
+    return 200;  // 0 = unlimited
+}
+
+// ============================================
+// Health Methods
+// ============================================
+
+bool ConfigReader::isHealthEnabled() const
+{
+    if (jsonObject.contains("health") && jsonObject["health"].contains("enabled")) {
+        return jsonObject["health"]["enabled"].get<bool>();
+    }
+    return true;
+}
+
+unsigned ConfigReader::getHealthIntervalS() const
+{
+    if (jsonObject.contains("health") && jsonObject["health"].contains("interval_s")) {
+        return jsonObject["health"]["interval_s"].get<unsigned>();
+    }
+    return 60;
+}
+
+std::string ConfigReader::getHealthPath() const
+{
+    if (jsonObject.contains("health") && jsonObject["health"].contains("path")) {
+        return jsonObject["health"]["path"].get<std::string>();
+    }
+    return "/api/v1/health/agent/";
+}
+
+// ============================================
+// Rate Control Methods
+// ============================================
+
+bool ConfigReader::isRateControlEnabled() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("enabled")) {
+        return jsonObject["rate_control"]["enabled"].get<bool>();
+    }
+    return true;
+}
+
+unsigned ConfigReader::getRateControlTargetLatencyMs() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("target_latency_ms")) {
+        return jsonObject["rate_control"]["target_latency_ms"].get<unsigned>();
+    }
+    return 1000;
+}
+
+size_t ConfigReader::getRateControlMinBatchEvents() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("min_batch_events")) {
+        return jsonObject["rate_control"]["min_batch_events"].get<size_t>();
+    }
+    return 50;
+}
+
+double ConfigReader::getRateControlMaxBatchesPerSec() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("max_batches_per_sec")) {
+        return jsonObject["rate_control"]["max_batches_per_sec"].get<double>();
+    }
+    return 20.0;
+}
+
+double ConfigReader::getRateControlMinBatchesPerSec() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("min_batches_per_sec")) {
+        return jsonObject["rate_control"]["min_batches_per_sec"].get<double>();
+    }
+    return 0.2;
+}
+
+unsigned ConfigReader::getRateControlBackoffBaseMs() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("backoff_base_ms")) {
+        return jsonObject["rate_control"]["backoff_base_ms"].get<unsigned>();
+    }
+    return 1000;
+}
+
+unsigned ConfigReader::getRateControlBackoffMaxMs() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("backoff_max_ms")) {
+        return jsonObject["rate_control"]["backoff_max_ms"].get<unsigned>();
+    }
+    return 300000;
+}
+
+std::string ConfigReader::getRateControlStatePath() const
+{
+    if (jsonObject.contains("rate_control") && jsonObject["rate_control"].contains("state_path")) {
+        return jsonObject["rate_control"]["state_path"].get<std::string>();
+    }
+    return "backoff_state.json";
+}
+
+// ============================================
+// Governor Methods
+// ============================================
+
+bool ConfigReader::isGovernorEnabled() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("enabled")) {
+        return jsonObject["governor"]["enabled"].get<bool>();
+    }
+    return false;
+}
+
+unsigned ConfigReader::getGovernorSampleIntervalMs() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("sample_interval_ms")) {
+        return jsonObject["governor"]["sample_interval_ms"].get<unsigned>();
+    }
+    return 1000;
+}
+
+double ConfigReader::getGovernorCpuPercent() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("cpu_percent")) {
+        return jsonObject["governor"]["cpu_percent"].get<double>();
+    }
+    return 10.0;
+}
+
+size_t ConfigReader::getGovernorWorkingSetMb() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("working_set_mb")) {
+        return jsonObject["governor"]["working_set_mb"].get<size_t>();
+    }
+    return 256;
+}
+
+unsigned ConfigReader::getGovernorRecoverSamples() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("recover_samples")) {
+        return jsonObject["governor"]["recover_samples"].get<unsigned>();
+    }
+    return 5;
+}
+
+std::vector<int> ConfigReader::getGovernorShedEventIds() const
+{
+    std::vector<int> ids;
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("shed_event_ids")) {
+        for (const auto& id : jsonObject["governor"]["shed_event_ids"]) {
+            ids.push_back(id.get<int>());
+        }
+    }
+    return ids;
+}
+
+unsigned ConfigReader::getGovernorAggregationWindowScale() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("aggregation_window_scale")) {
+        return jsonObject["governor"]["aggregation_window_scale"].get<unsigned>();
+    }
+    return 4;
+}
+
+int ConfigReader::getGovernorPressureZstdLevel() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("pressure_zstd_level")) {
+        return jsonObject["governor"]["pressure_zstd_level"].get<int>();
+    }
+    return 1;
+}
+
+bool ConfigReader::isGovernorJobObjectEnabled() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("use_job_object")) {
+        return jsonObject["governor"]["use_job_object"].get<bool>();
+    }
+    return false;
+}
+
+double ConfigReader::getGovernorJobCpuPercent() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("job_cpu_percent")) {
+        return jsonObject["governor"]["job_cpu_percent"].get<double>();
+    }
+    return 0.0;
+}
+
+size_t ConfigReader::getGovernorJobMemoryMb() const
+{
+    if (jsonObject.contains("governor") && jsonObject["governor"].contains("job_memory_mb")) {
+        return jsonObject["governor"]["job_memory_mb"].get<size_t>();
+    }
+    return 0;
+}
+
+// ============================================
+// Config Reload Methods
+// ============================================
+
+bool ConfigReader::isConfigReloadEnabled() const
+{
+    if (jsonObject.contains("config_reload") && jsonObject["config_reload"].contains("enabled")) {
+        return jsonObject["config_reload"]["enabled"].get<bool>();
+    }
+    return true;
+}
+
+unsigned ConfigReader::getConfigReloadDebounceMs() const
+{
+    // Editors often write a file in several steps; wait for it to settle
+    if (jsonObject.contains("config_reload") && jsonObject["config_reload"].contains("debounce_ms")) {
+        return jsonObject["config_reload"]["debounce_ms"].get<unsigned>();
+    }
+    return 500;
+}
@@ -9,22 +9,141 @@
 class ConfigReader {
 public:
     explicit ConfigReader(const std::filesystem::path& configFilePath);
-    std::vector<std::pair<std::wstring, std::wstring>> getPathQueryPairs();
+    // Already parsed; configFilePath still locates auth.secret
+    ConfigReader(const std::filesystem::path& configFilePath, nlohmann::json json);
+
+    // Parsed document (null if the file could not be read or parsed)
+    const nlohmann::json& json() const { return jsonObject; }
+    const std::filesystem::path& path() const { return configFilePath; }
+
+    // Runs every getter once, so a value of the wrong type is reported here
+    // rather than thrown later from whichever thread reads it first
+    bool validate(std::string& error) const;
+
+    std::vector<std::pair<std::wstring, std::wstring>> getPathQueryPairs() const;   // Event Log sources only
+    const nlohmann::json& getEventSources() const;   // The whole event_processor.source array, every engine
+    std::string getRenderMode() const;
+    std::string getSubscribeMode() const;
+    unsigned getPullBatchSize() const;
+
+    // ETW methods
+    std::string getEtwSessionName() const;
+    unsigned getEtwBufferKb() const;
+    unsigned getEtwMinBuffers() const;
+    unsigned getEtwMaxBuffers() const;
+    unsigned getEtwFlushTimerS() const;
+
+    // Bookmark methods
+    bool isBookmarkEnabled() const;
+    std::string getBookmarkPath() const;
+    unsigned getBookmarkFlushIntervalMs() const;
+
+    // Compression methods
+    int getCompressionLevel() const;
+    int getCompressionWorkers() const;
+    unsigned getCompressionMultithreadThresholdKb() const;
+    std::string getCompressionDictionary() const;
+
+    // Spool methods
+    bool isSpoolEnabled() const;
+    std::string getSpoolDirectory() const;
+    unsigned getSpoolMaxMb() const;
+    unsigned getSpoolSegmentMb() const;
+    unsigned getSpoolMaxAgeHours() const;
+    unsigned getSpoolReplayBatchesPerSec() const;
+    unsigned getSpoolReplayJitterMs() const;
     
     // WebSocket methods
-    std::string getServerUri();
-    std::string getServerReverseShellIp();
-    int getServerReverseShellPort();
+    std::string getServerUri() const;
+    size_t getWebSocketMaxPendingBatches() const;
+    unsigned getWebSocketAckTimeoutMs() const;
+    bool isWebSocketPermessageDeflate() const;
+    std::string getServerReverseShellIp() const;
+    int getServerReverseShellPort() const;
     
     // HTTP methods
-    std::string getHttpServer();
-    int getHttpPort();
-    std::string getApiPath();
-    std::string getAuthToken();
+    std::string getHttpServer() const;
+    int getHttpPort() const;
+    std::string getApiPath() const;
+    std::string getAuthToken() const;
     
-    bool hasHttpConfig();
-    bool hasWebSocketConfig();
-    bool isHttpPollingDisabled();
+    bool hasHttpConfig() const;
+    bool hasWebSocketConfig() const;
+    bool isHttpPollingDisabled() const;
+
+    // Event pipeline methods
+    size_t getPipelineQueueDepth() const;
+    std::string getPipelineOverflowPolicy() const;
+    std::vector<int> getPipelineDropEventIds() const;
+    unsigned getPipelineWorkerThreads() const;
+
+    // Batch flushing methods
+    size_t getBatchMaxEvents() const;
+    size_t getBatchMaxBytes() const;
+    unsigned getBatchMaxDelayMs() const;
+    bool isBatchStreamCompression() const;
+    std::string getBatchFormat() const;
+
+    // Aggregation methods
+    bool isAggregationEnabled() const;
+    unsigned getAggregationWindowMs() const;
+    size_t getAggregationMaxEntries() const;
+    std::vector<std::pair<std::string, std::vector<std::string>>> getAggregationKeys() const;
+
+    // Filter methods (the whole section; EventFilter compiles it)
+    const nlohmann::json& getFilterConfig() const;
+
+    // Isolation methods
+    const nlohmann::json& getIsolationAllowRules() const;
+    bool isIsolationBlockInbound() const;
+    std::string getIsolationStatePath() const;
+
+    // Command poll methods
+    unsigned getCommandPollLongPollS() const;
+    unsigned getCommandPollMaxCommands() const;
+    unsigned getCommandPollMinIntervalMs() const;
+    unsigned getCommandPollMaxIntervalMs() const;
+
+    // Sender methods
+    unsigned getSenderMaxInFlight() const;
+    std::string getSenderTransport() const;
+    unsigned getSenderRequestTimeoutMs() const;
+
+    // Logging methods
+    std::string getLogLevel() const;
+    unsigned getLogMaxLinesPerSecond() const;
+
+    // Health methods
+    bool isHealthEnabled() const;
+    unsigned getHealthIntervalS() const;
+    std::string getHealthPath() const;
+
+    // Rate control methods
+    bool isRateControlEnabled() const;
+    unsigned getRateControlTargetLatencyMs() const;
+    size_t getRateControlMinBatchEvents() const;
+    double getRateControlMaxBatchesPerSec() const;
+    double getRateControlMinBatchesPerSec() const;
+    unsigned getRateControlBackoffBaseMs() const;
+    unsigned getRateControlBackoffMaxMs() const;
+    std::string getRateControlStatePath() const;
+
+    // Governor methods
+    bool isGovernorEnabled() const;
+    unsigned getGovernorSampleIntervalMs() const;
+    double getGovernorCpuPercent() const;
+    size_t getGovernorWorkingSetMb() const;
+    unsigned getGovernorRecoverSamples() const;
+    std::vector<int> getGovernorShedEventIds() const;
+    unsigned getGovernorAggregationWindowScale() const;
+    int getGovernorPressureZstdLevel() const;
+    bool isGovernorJobObjectEnabled() const;
+    double getGovernorJobCpuPercent() const;
+    size_t getGovernorJobMemoryMb() const;
+
+    // Config reload methods
+    bool isConfigReloadEnabled() const;
+    unsigned getConfigReloadDebounceMs() const;
 
 private:
     std::filesystem::path configFilePath;
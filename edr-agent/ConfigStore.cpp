@@ -0,0 +1,206 @@
+#include "ConfigStore.hpp"
+#include "Logger.hpp"
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // Read and written through std::atomic_load / std::atomic_store only
+    std::shared_ptr<const ConfigReader> g_snapshot;
+    std::atomic<uint64_t> g_generation{0};
+    std::filesystem::path g_path;                 // Absolute; set by the first successful load()
+
+    std::mutex g_loadMutex;                       // Startup load vs the watcher thread
+    std::mutex g_listenerMutex;
+    std::vector<ConfigStore::Listener> g_listeners;
+
+    HANDLE g_stopEvent = NULL;
+    std::thread g_watcher;
+
+    // Does this change record name our file? Names are case-insensitive on NTFS.
+    bool namesFile(const FILE_NOTIFY_INFORMATION& info, const std::wstring& fileName) {
+        int length = (int)(info.FileNameLength / sizeof(WCHAR));
+        return CompareStringOrdinal(info.FileName, length, fileName.c_str(), (int)fileName.size(), TRUE) == CSTR_EQUAL;
+    }
+}
+
+// ============================================
+// Snapshots
+// ============================================
+bool ConfigStore::load(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(g_loadMutex);
+
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    if (ec) absolute = path;
+
+    auto next = std::make_shared<const ConfigReader>(absolute);
+    std::string error;
+    if (!next->validate(error)) {
+        std::cerr << "[Config] ❌ " << absolute.string() << " rejected: " << error << std::endl;
+        return false;
+    }
+
+    if (g_path.empty()) g_path = absolute;
+    return publish(std::move(next));
+}
+
+bool ConfigStore::publish(Snapshot next) {
+    Snapshot previous = std::atomic_load(&g_snapshot);
+    if (previous && previous->json() == next->json()) {
+        return true;   // Rewritten with the same content (or touched)
+    }
+
+    std::atomic_store(&g_snapshot, next);
+    uint64_t generation = g_generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (!previous) return true;
+
+    std::cout << "[Config] ✓ Reloaded " << g_path.string() << " (generation " << generation << ")" << std::endl;
+
+    std::lock_guard<std::mutex> lock(g_listenerMutex);
+    for (const Listener& listener : g_listeners) {
+        try {
+            listener(*previous, *next);
+        } catch (const std::exception& e) {
+            std::cerr << "[Config] ⚠️ Applying the reload failed: " << e.what() << std::endl;
+        }
+    }
+    return true;
+}
+
+ConfigStore::Snapshot ConfigStore::current() {
+    Snapshot snapshot = std::atomic_load(&g_snapshot);
+    if (snapshot) return snapshot;
+
+    static const Snapshot empty = std::make_shared<const ConfigReader>(std::filesystem::path(), nlohmann::json::object());
+    return empty;
+}
+
+uint64_t ConfigStore::generation() {
+    return g_generation.load(std::memory_order_acquire);
+}
+
+void ConfigStore::subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(g_listenerMutex);
+    g_listeners.push_back(std::move(listener));
+}
+
+// ============================================
+// File Watcher
+// ============================================
+bool ConfigStore::startWatching(unsigned debounceMs) {
+    if (g_watcher.joinable()) return true;
+    if (g_path.empty()) {
+        std::cerr << "[Config] Nothing loaded, not watching" << std::endl;
+        return false;
+    }
+
+    g_stopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (g_stopEvent == NULL) {
+        std::cerr << "[Config] CreateEvent failed (Error: " << GetLastError() << ")" << std::endl;
+        return false;
+    }
+    g_watcher = std::thread(&ConfigStore::watchLoop, debounceMs);
+    return true;
+}
+
+void ConfigStore::stopWatching() {
+    if (!g_watcher.joinable()) return;
+    SetEvent(g_stopEvent);
+    g_watcher.join();
+    CloseHandle(g_stopEvent);
+    g_stopEvent = NULL;
+}
+
+void ConfigStore::watchLoop(unsigned debounceMs) {
+    std::filesystem::path directory = g_path.parent_path();
+    std::wstring fileName = g_path.filename().wstring();
+
+    HANDLE hDirectory = CreateFileW(directory.wstring().c_str(), FILE_LIST_DIRECTORY,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                    OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (hDirectory == INVALID_HANDLE_VALUE) {
+        std::cerr << "[Config] Cannot watch " << directory.string() << " (Error: " << GetLastError() << ")" << std::endl;
+        return;
+    }
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    alignas(DWORD) BYTE buffer[16 * 1024];
+    // Editors replace the file by rename as often as they write it in place
+    const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+
+    auto arm = [&] {
+        ResetEvent(overlapped.hEvent);
+        return ReadDirectoryChangesW(hDirectory, buffer, sizeof(buffer), FALSE, filter, NULL, &overlapped, NULL) != FALSE;
+    };
+
+    bool armed = overlapped.hEvent != NULL && arm();
+    if (!armed) {
+        std::cerr << "[Config] ReadDirectoryChangesW failed (Error: " << GetLastError() << ")" << std::endl;
+    } else {
+        std::cout << "[Config] ✓ Watching " << g_path.string() << " for changes" << std::endl;
+    }
+
+    bool pending = false;
+    auto due = std::chrono::steady_clock::now();
+
+    while (armed) {
+        DWORD timeout = INFINITE;
+        if (pending) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+            timeout = (DWORD)std::max<long long>(left.count(), 0);
+        }
+
+        HANDLE handles[2] = {g_stopEvent, overlapped.hEvent};
+        DWORD wait = WaitForMultipleObjects(2, handles, FALSE, timeout);
+        if (wait == WAIT_OBJECT_0 || wait == WAIT_FAILED) break;
+
+        if (wait == WAIT_TIMEOUT) {
+            pending = false;
+            if (!load(g_path)) {
+                LOG_WARN("Config") << "Keeping the running configuration";
+            }
+            continue;
+        }
+
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(hDirectory, &overlapped, &bytes, FALSE)) {
+            LOG_WARN("Config") << "Directory watch failed (Error: " << GetLastError() << "), stopped watching";
+            armed = false;
+            break;
+        }
+
+        // 0 bytes = more changes than the buffer held; the file may be among them
+        bool changed = bytes == 0;
+        for (DWORD offset = 0; !changed && offset < bytes;) {
+            const FILE_NOTIFY_INFORMATION& info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            changed = namesFile(info, fileName);
+            if (info.NextEntryOffset == 0) break;
+            offset += info.NextEntryOffset;
+        }
+        if (changed) {
+            pending = true;
+            due = std::chrono::steady_clock::now() + std::chrono::milliseconds(debounceMs);
+        }
+
+        armed = arm();
+    }
+
+    // Stopped with a read outstanding: it must finish before buffer goes away
+    if (armed) {
+        CancelIoEx(hDirectory, &overlapped);
+        DWORD ignored = 0;
+        GetOverlappedResult(hDirectory, &overlapped, &ignored, TRUE);
+    }
+    if (overlapped.hEvent != NULL) CloseHandle(overlapped.hEvent);
+    CloseHandle(hDirectory);
+}
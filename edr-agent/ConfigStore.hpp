@@ -0,0 +1,57 @@
+#ifndef CONFIGSTORE_HPP
+#define CONFIGSTORE_HPP
+
+#include "ConfigReader.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+// ============================================================
+// Config Store
+// ============================================================
+// The one parsed copy of config.json every subsystem reads. A snapshot
+// is parsed and validated once, then published with an atomic
+// shared_ptr swap; readers take current() and keep it for as long as
+// they need consistent values, so nothing parses the file at request
+// time and a reload never changes values under a reader.
+//
+//   config.json --ReadDirectoryChangesW--> debounce --> parse + validate
+//               --> swap snapshot --> listeners(previous, next)
+//
+// A file that does not parse or validate is rejected and the current
+// snapshot stays. Listeners apply what can change while running
+// (filter, batch limits, subscriptions, log level); everything else
+// takes effect on the next start.
+// ============================================================
+
+class ConfigStore {
+public:
+    using Snapshot = std::shared_ptr<const ConfigReader>;
+    using Listener = std::function<void(const ConfigReader& previous, const ConfigReader& next)>;
+
+    // Parses and publishes path. False (and a log line) if it cannot be
+    // read or fails validation; the previous snapshot, if any, stays current.
+    static bool load(const std::filesystem::path& path);
+
+    // Never null: before the first successful load() this is an empty config
+    static Snapshot current();
+
+    // Bumped on every published snapshot
+    static uint64_t generation();
+
+    // Called on the watcher thread after each reload, in registration order
+    static void subscribe(Listener listener);
+
+    // Watches the directory holding the loaded file. A change is picked
+    // up once the file has been quiet for debounceMs.
+    static bool startWatching(unsigned debounceMs);
+    static void stopWatching();
+
+private:
+    static bool publish(Snapshot next);
+    static void watchLoop(unsigned debounceMs);
+};
+
+#endif // CONFIGSTORE_HPP
@@ -3,32 +3,48 @@
 #include <cstdint>
 
 #include "HttpClient.hpp"          // HTTP client for Django
+#include "BinaryBatch.hpp"         // Opt-in binary batch format
+#include "AsyncHttpSender.hpp"     // Pipelined telemetry POSTs
+#include "EventFilter.hpp"         // Agent-side drop/tag rules
 #include "CommandProcessor.hpp"    // Response Actions
 #include "EventConverter.hpp"      // Event format converter
 #ifdef ENABLE_WEBSOCKET
 #include "WebSocketClient.hpp"     // WebSocket for real-time commands
 #endif
 #include "ConfigReader.hpp"
-#include "pugixml.hpp"
+#include "ConfigStore.hpp"         // Shared config snapshot, hot reload
+#include "EventRenderer.hpp"       // EvtRender -> XML
+#include "EventPipeline.hpp"       // Queue, workers and sender thread
+#include "EventSubscriber.hpp"     // EvtSubscribe callback / pull engines
+#include "EtwConsumer.hpp"         // Real-time ETW engine (engine = "etw" sources)
+#include "BookmarkStore.hpp"       // Resume after the last acknowledged record
+#include "TelemetrySpool.hpp"      // Disk spool for batches the server did not take
+#include "EventCorpus.hpp"         // Recorded XML for edr-bench (--record)
+#include "RateController.hpp"      // Batch size / send rate / backoff from server feedback
+#include "ResourceGovernor.hpp"    // The agent's own CPU / memory budget
+#include "SimpleZstd.hpp"          // Shared compression settings / dictionary
+#include "Logger.hpp"              // Async, rate-limited hot-path logging
+#include "HealthReporter.hpp"      // Periodic agent_health metrics
+#include "ProcessTable.hpp"        // Process tree for lineage and tree kill
 
 #include <Windows.h>
 #include <winevt.h>
-#pragma comment(lib, "wevtapi.lib")
 
+#include <algorithm>
 #include <iostream>
 #include <locale>
 #include <conio.h>
+#include <memory>
+#include <string>
 #include <vector>
 
 // ============================================
 // Function Declarations
 // ============================================
-DWORD WINAPI SubscriptionCallback(EVT_SUBSCRIBE_NOTIFY_ACTION action, 
-                                PVOID pContext, EVT_HANDLE hEvent);
-DWORD ProcessEvent(EVT_HANDLE hEvent);
-DWORD EventToEventXml(EVT_HANDLE hEvent, std::string& eventXml);
-std::string EventXmlToEventJson(const std::string& xml);
-std::string sanitizeUtf8(const std::string& input);
+int RunDictionaryTraining(int argc, char* argv[]);
+int RunRecording(int argc, char* argv[]);
+void ApplyConfigReload(const ConfigReader& previous, const ConfigReader& next, EventPipeline& pipeline,
+                       EventSubscriber& subscriber, RateController* rateControl);
 
 // ============================================
 // Global Variables
@@ -41,16 +57,30 @@ HttpClient* g_httpClient = nullptr;                 // Active now
 // ============================================
 // Main Function
 // ============================================
-int main() {
+int main(int argc, char* argv[]) {
+    // Tool mode: build a zstd dictionary from spooled telemetry and exit
+    if (argc >= 2 && std::string(argv[1]) == "--train-dictionary") {
+        return RunDictionaryTraining(argc, argv);
+    }
+    // Tool mode: save rendered events for offline benchmarking and exit
+    if (argc >= 2 && std::string(argv[1]) == "--record") {
+        return RunRecording(argc, argv);
+    }
+
     std::cout << "========================================" << std::endl;
     std::cout << "  EDR Agent v1.0" << std::endl;
     std::cout << "  HTTP Mode (WebSocket added but fot the future )" << std::endl;
     std::cout << "========================================" << std::endl;
     
     try {
-        // Step 1: Read Configuration
+        // Step 1: Read Configuration (parsed and validated once; reloads publish a new snapshot)
         std::cout << "\n[1/4] Reading configuration file..." << std::endl;
-        ConfigReader configReader("config.json");
+        if (!ConfigStore::load("config.json")) {
+            std::cerr << "\n❌ ERROR: config.json could not be loaded" << std::endl;
+            return 1;
+        }
+        ConfigStore::Snapshot startupConfig = ConfigStore::current();
+        const ConfigReader& configReader = *startupConfig;
         
         // Check available modes
         bool hasHttp = configReader.hasHttpConfig();
@@ -66,6 +96,23 @@ int main() {
             return 1;
         }
         
+        // Step 1.2: Logging (hot-path lines go through the async writer from here on)
+        Logger::Config logConfig;
+        logConfig.level = Logger::parseLevel(configReader.getLogLevel());
+        logConfig.maxLinesPerSecond = configReader.getLogMaxLinesPerSecond();
+        Logger::start(logConfig);
+        struct LoggerGuard { ~LoggerGuard() { Logger::stop(); } } loggerGuard;   // Early returns flush too
+
+        // Step 1.5: Compression settings (before any thread compresses)
+        ZstdConfig zstdConfig;
+        zstdConfig.level = configReader.getCompressionLevel();
+        zstdConfig.workers = configReader.getCompressionWorkers();
+        zstdConfig.multithreadThreshold = (size_t)configReader.getCompressionMultithreadThresholdKb() * 1024;
+        zstdConfig.dictionaryPath = configReader.getCompressionDictionary();
+        if (!SimpleZstd::configure(zstdConfig)) {
+            std::cerr << "  ⚠️ Compressing without a dictionary" << std::endl;
+        }
+
         // Step 2: Initialize HTTP Client
         std::cout << "\n[2/4] Initializing HTTP client..." << std::endl;
         std::string httpServer = configReader.getHttpServer();
@@ -82,30 +129,149 @@ int main() {
         
         std::cout << "  ✓ HTTP client initialized" << std::endl;
         std::cout << "  → Target: " << httpServer << ":" << httpPort << apiPath << std::endl;
+
+        // Step 2.05: Rate Control (every telemetry response feeds it; picks up a backoff from the last run)
+        RateControlConfig rateConfig;
+        rateConfig.enabled = configReader.isRateControlEnabled();
+        rateConfig.targetLatencyMs = configReader.getRateControlTargetLatencyMs();
+        rateConfig.minBatchEvents = configReader.getRateControlMinBatchEvents();
+        rateConfig.maxBatchesPerSec = configReader.getRateControlMaxBatchesPerSec();
+        rateConfig.minBatchesPerSec = configReader.getRateControlMinBatchesPerSec();
+        rateConfig.backoffBaseMs = configReader.getRateControlBackoffBaseMs();
+        rateConfig.backoffMaxMs = configReader.getRateControlBackoffMaxMs();
+        rateConfig.statePath = configReader.getRateControlStatePath();
+
+        RateController rateController(rateConfig, configReader.getBatchMaxEvents());
+        RateController* rateControl = rateConfig.enabled ? &rateController : nullptr;
+        if (rateControl != nullptr) {
+            rateController.load();
+            httpClient.setRateController(rateControl);
+        }
         
-        // Step 2.5: Start Command Polling (unless disabled for WebSocket-only mode)
-        bool disablePolling = configReader.isHttpPollingDisabled();
-        if (!disablePolling) {
-            std::cout << "\n[2.5/4] Starting Command Polling Service..." << std::endl;
-            CommandProcessor::startCommandPolling();
-        } else {
-            std::cout << "\n[2.5/4] HTTP Command Polling DISABLED (WebSocket-only mode)" << std::endl;
-            std::cout << "  ⚠️  Commands will only be received via WebSocket" << std::endl;
+        // Step 2.06: Resource Governor (the agent's own CPU/memory budget; degrades the pipeline under load)
+        GovernorConfig governorConfig;
+        governorConfig.enabled = configReader.isGovernorEnabled();
+        governorConfig.sampleIntervalMs = configReader.getGovernorSampleIntervalMs();
+        governorConfig.cpuPercent = configReader.getGovernorCpuPercent();
+        governorConfig.workingSetMb = configReader.getGovernorWorkingSetMb();
+        governorConfig.recoverSamples = configReader.getGovernorRecoverSamples();
+        governorConfig.shedEventIds = configReader.getGovernorShedEventIds();
+        governorConfig.aggregationWindowScale = configReader.getGovernorAggregationWindowScale();
+        governorConfig.pressureZstdLevel = configReader.getGovernorPressureZstdLevel();
+        governorConfig.useJobObject = configReader.isGovernorJobObjectEnabled();
+        governorConfig.jobCpuPercent = configReader.getGovernorJobCpuPercent();
+        governorConfig.jobMemoryMb = configReader.getGovernorJobMemoryMb();
+
+        ResourceGovernor resourceGovernor(governorConfig);
+        ResourceGovernor* governor = governorConfig.enabled ? &resourceGovernor : nullptr;
+        if (governor != nullptr) {
+            resourceGovernor.start();
         }
 
-        // Step 3: WebSocket (Real-time Commands)
+        // Step 2.1: Load Bookmarks (sources are registered before any sender thread exists)
+        bool useBookmarks = configReader.isBookmarkEnabled();
+        BookmarkStore bookmarkStore(configReader.getBookmarkPath(), configReader.getBookmarkFlushIntervalMs());
+        if (useBookmarks) {
+            bookmarkStore.load();
+            for (const auto& pair : configReader.getPathQueryPairs()) {
+                bookmarkStore.registerSource(pair.first);
+            }
+            bookmarkStore.start();
+        }
+
+        // Step 2.15: Open Spool (replay gets its own connection so it never races the sender)
+        bool useSpool = configReader.isSpoolEnabled();
+        SpoolConfig spoolConfig;
+        spoolConfig.directory = configReader.getSpoolDirectory();
+        spoolConfig.maxBytes = (uint64_t)configReader.getSpoolMaxMb() * 1024 * 1024;
+        spoolConfig.segmentBytes = (uint64_t)configReader.getSpoolSegmentMb() * 1024 * 1024;
+        spoolConfig.maxAgeHours = configReader.getSpoolMaxAgeHours();
+        spoolConfig.replayBatchesPerSec = configReader.getSpoolReplayBatchesPerSec();
+        spoolConfig.replayJitterMs = configReader.getSpoolReplayJitterMs();
+
+        TelemetrySpool spool(spoolConfig);
+        HttpClient replayClient(httpServer, httpPort, apiPath, authToken);
+        replayClient.setRateController(rateControl);
+        spool.setRateController(rateControl);
+        spool.setGovernor(governor);
+        if (useSpool) {
+            useSpool = spool.open();
+            if (useSpool) {
+                spool.startReplay(replayClient);
+            } else {
+                std::cerr << "  ⚠️ Spool unavailable, failed batches will be dropped" << std::endl;
+            }
+        }
+
+        // Step 2.16: Process Table (one snapshot; Sysmon events keep it current from here)
+        std::cout << "  ✓ Process table: " << ProcessTable::rebuild() << " process(es)" << std::endl;
+
+        // Step 2.2: Start Event Pipeline (must be running before we subscribe)
+        PipelineConfig pipelineConfig;
+        pipelineConfig.queueDepth = configReader.getPipelineQueueDepth();
+        pipelineConfig.overflowPolicy = EventPipeline::parseOverflowPolicy(configReader.getPipelineOverflowPolicy());
+        pipelineConfig.droppableEventIds = configReader.getPipelineDropEventIds();
+        pipelineConfig.workerThreads = configReader.getPipelineWorkerThreads();
+        pipelineConfig.batch.maxEvents = configReader.getBatchMaxEvents();
+        pipelineConfig.batch.maxBytes = configReader.getBatchMaxBytes();
+        pipelineConfig.batch.maxDelayMs = configReader.getBatchMaxDelayMs();
+        pipelineConfig.batch.streamCompression = configReader.isBatchStreamCompression();
+        pipelineConfig.batch.format = BinaryBatchEncoder::parseFormat(configReader.getBatchFormat());
+        pipelineConfig.aggregation.enabled = configReader.isAggregationEnabled();
+        pipelineConfig.aggregation.windowMs = configReader.getAggregationWindowMs();
+        pipelineConfig.aggregation.maxEntries = configReader.getAggregationMaxEntries();
+        pipelineConfig.aggregation.keys = configReader.getAggregationKeys();
+
+        // Step 2.17: Async Sender (more than one batch on the wire; 1 = synchronous sends)
+        AsyncSenderConfig senderConfig;
+        senderConfig.maxInFlight = configReader.getSenderMaxInFlight();
+        senderConfig.requestTimeoutMs = configReader.getSenderRequestTimeoutMs();
+
+        AsyncHttpSender asyncSender(httpServer, httpPort, apiPath, authToken, senderConfig);
+        asyncSender.setRateController(rateControl);
+        bool useAsyncSender = senderConfig.maxInFlight > 1;
+        if (useAsyncSender) {
+            useAsyncSender = asyncSender.open();
+            if (!useAsyncSender) {
+                std::cerr << "  ⚠️ Async sender unavailable, sending one batch at a time" << std::endl;
+            }
+        }
+
+        // Step 2.18: Compile the agent-side filter (drops noise before any JSON is built)
+        auto eventFilter = std::make_shared<EventFilter>();
+        if (!eventFilter->compile(configReader.getFilterConfig())) {
+            std::cerr << "  ⚠️ Filter config invalid, sending every event" << std::endl;
+        }
+
+        // Step 2.19: WebSocket (Real-time Commands, and telemetry with sender.transport = "websocket").
+        // Connected before the pipeline starts so the first batches can use it.
+        BatchTransport* transport = nullptr;
+        bool useWebSocketTelemetry = configReader.getSenderTransport() == "websocket";
 #ifdef ENABLE_WEBSOCKET
         if (hasWebSocket) {
-            std::cout << "\n[3/4] Initializing WebSocket client..." << std::endl;
+            std::cout << "\n[2.19/4] Initializing WebSocket client..." << std::endl;
             std::string wsUri = configReader.getServerUri();
+
+            WebSocketConfig wsConfig;
+            wsConfig.maxPendingBatches = configReader.getWebSocketMaxPendingBatches();
+            wsConfig.ackTimeoutMs = configReader.getWebSocketAckTimeoutMs();
+            wsConfig.permessageDeflate = configReader.isWebSocketPermessageDeflate();
+            wsConfig.authToken = authToken;
+            wsConfig.agentId = CommandProcessor::getHostName();
             
             // Create WebSocket client on heap so it persists
-            static WebSocketClient webSocketClient;
+            static WebSocketClient webSocketClient(wsConfig);
             g_webSocketClient = &webSocketClient;
             webSocketClient.connect(wsUri);
             
             std::cout << "  ✓ WebSocket connecting to: " << wsUri << std::endl;
             std::cout << "  → Commands will be received in real-time" << std::endl;
+            // HTTP command polling only runs while this is down
+            CommandProcessor::setPushChannel([] { return webSocketClient.is_open(); });
+            if (useWebSocketTelemetry) {
+                transport = &webSocketClient;
+                std::cout << "  → Telemetry batches over WebSocket (HTTP when it cannot take them)" << std::endl;
+            }
             
             // Give time for connection to establish
             Sleep(2000);
@@ -116,65 +282,103 @@ int main() {
             std::cout << "  To enable: Rebuild with -DENABLE_WEBSOCKET=ON" << std::endl;
         }
 #endif
-        
+        if (useWebSocketTelemetry && transport == nullptr) {
+            std::cerr << "  ⚠️ sender.transport is websocket but no WebSocket is available, using HTTP" << std::endl;
+        }
+
+        EventPipeline eventPipeline(httpClient, pipelineConfig,
+                                    useBookmarks ? &bookmarkStore : nullptr,
+                                    useSpool ? &spool : nullptr,
+                                    useAsyncSender ? &asyncSender : nullptr,
+                                    eventFilter->enabled() ? eventFilter : nullptr,
+                                    transport);
+        eventPipeline.setRateController(rateControl);
+        eventPipeline.setGovernor(governor);
+        eventPipeline.start();
+
+        // Step 2.3: Health Reports (per-stage latencies and counters)
+        HealthConfig healthConfig;
+        healthConfig.intervalS = configReader.getHealthIntervalS();
+        healthConfig.serverUrl = "http://" + httpServer + ":" + std::to_string(httpPort);
+        healthConfig.path = configReader.getHealthPath();
+        healthConfig.authToken = authToken;
+
+        HealthReporter healthReporter(healthConfig, useSpool ? &spool : nullptr);
+        healthReporter.setRateController(rateControl);
+        healthReporter.setGovernor(governor);
+        if (configReader.isHealthEnabled()) {
+            healthReporter.start();
+        }
+
+        // Step 2.5: Start Command Polling (unless disabled for WebSocket-only mode)
+        bool disablePolling = configReader.isHttpPollingDisabled();
+        if (!disablePolling) {
+            std::cout << "\n[2.5/4] Starting Command Polling Service..." << std::endl;
+            CommandProcessor::startCommandPolling();
+        } else {
+            std::cout << "\n[2.5/4] HTTP Command Polling DISABLED (WebSocket-only mode)" << std::endl;
+            std::cout << "  ⚠️  Commands will only be received via WebSocket" << std::endl;
+        }
+
         // Step 4: Subscribe to Windows Event Logs
         std::cout << "\n[3/4] Subscribing to Windows Event Logs..." << std::endl;
         std::vector<std::pair<std::wstring, std::wstring>> pathQueryPairs = configReader.getPathQueryPairs();
+        std::vector<EtwSource> etwSources = EtwConsumer::parseSources(configReader.getEventSources());
         
-        if (pathQueryPairs.empty()) {
+        if (pathQueryPairs.empty() && etwSources.empty()) {
             std::cerr << "❌ ERROR: No event sources configured!" << std::endl;
             return 1;
         }
-        
-        DWORD status = ERROR_SUCCESS;
-        std::vector<EVT_HANDLE> subscriptions;
-
-        for (const auto& pair : pathQueryPairs) {
-            std::wstring pwsPath = pair.first;
-            std::wstring pwsQuery = pair.second;
-            std::wcout << L"  → Subscribing to: " << pwsPath << std::endl;
-
-            EVT_HANDLE hSubscription = EvtSubscribe(
-                NULL, 
-                NULL, 
-                pwsPath.c_str(), 
-                pwsQuery.c_str(), 
-                NULL, 
-                NULL,
-                (EVT_SUBSCRIBE_CALLBACK)SubscriptionCallback, 
-                EvtSubscribeToFutureEvents
-            );
-
-            if (NULL == hSubscription) {
-                status = GetLastError();
-                
-                if (ERROR_EVT_CHANNEL_NOT_FOUND == status) {
-                    std::wcout << L"  ⚠️ Channel not found: " << pwsPath << std::endl;
-                } else if (ERROR_EVT_INVALID_QUERY == status) {
-                    std::wcout << L"  ⚠️ Invalid query: " << pwsQuery << std::endl;
-                } else {
-                    std::wcout << L"  ❌ Subscribe failed with error: " << status << std::endl;
-                }
-                
-                continue; // Try next subscription
+
+        SubscriberConfig subscriberConfig;
+        subscriberConfig.mode = EventSubscriber::parseMode(configReader.getSubscribeMode());
+        subscriberConfig.pullBatchSize = configReader.getPullBatchSize();
+
+        if (configReader.getRenderMode() == "values") {
+            subscriberConfig.useValueRender = InitValueRenderContexts();
+            if (!subscriberConfig.useValueRender) {
+                std::cerr << "  ⚠️ Values rendering unavailable, using XML" << std::endl;
             }
-            
-            subscriptions.push_back(hSubscription);
-            std::wcout << L"  ✓ Subscribed successfully" << std::endl;
         }
-        
-        if (subscriptions.empty()) {
+
+        EventSubscriber subscriber(eventPipeline, subscriberConfig, useBookmarks ? &bookmarkStore : nullptr);
+        size_t subscriptionCount = subscriber.subscribe(pathQueryPairs);
+
+        // ETW sources: one real-time session for all of them
+        EtwConfig etwConfig;
+        etwConfig.sessionName = configReader.getEtwSessionName();
+        etwConfig.bufferKb = configReader.getEtwBufferKb();
+        etwConfig.minBuffers = configReader.getEtwMinBuffers();
+        etwConfig.maxBuffers = configReader.getEtwMaxBuffers();
+        etwConfig.flushTimerS = configReader.getEtwFlushTimerS();
+
+        EtwConsumer etwConsumer(eventPipeline, etwConfig);
+        if (!etwSources.empty()) {
+            std::cout << "  → Starting ETW session: " << etwConfig.sessionName << std::endl;
+            subscriptionCount += etwConsumer.start(etwSources);
+        }
+
+        if (subscriptionCount == 0) {
             std::cerr << "\n❌ ERROR: No successful subscriptions!" << std::endl;
             std::cerr << "Make sure Sysmon is installed and running." << std::endl;
             return 1;
         }
 
+        // Step 4.5: Hot Reload (filter, batch limits, Event Log sources and log level apply live)
+        ConfigStore::subscribe([&](const ConfigReader& previous, const ConfigReader& next) {
+            ApplyConfigReload(previous, next, eventPipeline, subscriber, rateControl);
+        });
+        if (configReader.isConfigReloadEnabled()) {
+            ConfigStore::startWatching(configReader.getConfigReloadDebounceMs());
+        }
+
         // Step 5: Monitor Events
         std::cout << "\n[4/4] ========================================" << std::endl;
         std::cout << "✓ Agent is now monitoring events" << std::endl;
         std::cout << "  Active mode: HTTP" << std::endl;
         std::cout << "  Target: " << httpServer << ":" << httpPort << std::endl;
-        std::cout << "  Monitoring " << subscriptions.size() << " event source(s)" << std::endl;
+        std::cout << "  Monitoring " << subscriptionCount << " event source(s)" << std::endl;
+        std::cout << "  UTF-8 path: " << utf8Backend() << std::endl;
         std::cout << "\nPress any key to stop monitoring..." << std::endl;
         std::cout << "========================================\n" << std::endl;
 
@@ -185,23 +389,48 @@ int main() {
 
         // Cleanup
         std::cout << "\n\nShutting down agent..." << std::endl;
-        
+
+        // No reload may reach the subscriber or pipeline while they stop
+        ConfigStore::stopWatching();
         CommandProcessor::stopCommandPolling();
 
-        for (auto hSub : subscriptions) {
-            if (hSub) {
-                EvtClose(hSub);
-            }
+        subscriber.stop();
+        etwConsumer.stop();
+
+        // No more events can arrive now; drain the queues and flush the last batch
+        // (waits for every in-flight batch to be answered or spooled)
+        eventPipeline.stop();
+        if (useAsyncSender) {
+            asyncSender.close();
         }
-        
-        // Close WebSocket if active
-        /*
+
+        // Every batch it carried is acknowledged or spooled by now
+#ifdef ENABLE_WEBSOCKET
         if (g_webSocketClient != nullptr) {
             g_webSocketClient->close();
             std::cout << "✓ WebSocket connection closed" << std::endl;
         }
-        */
+#endif
+
+        // Final report covers the shutdown drain
+        healthReporter.stop();
+        resourceGovernor.stop();
+
+        // The last batch is either sent or spooled; stop replay before the bookmarks
+        if (useSpool) {
+            spool.stop();
+        }
+
+        // Every acknowledged batch is in by now; persist the final positions
+        if (useBookmarks) {
+            bookmarkStore.stop();
+        }
+
+        if (subscriberConfig.useValueRender) {
+            CloseValueRenderContexts();
+        }
         
+        Logger::stop();
         std::cout << "✓ Agent stopped successfully" << std::endl;
         return 0;
         
@@ -212,326 +441,192 @@ int main() {
 }
 
 // ============================================
-// Subscription Callback
+// Config Reload
 // ============================================
-DWORD WINAPI SubscriptionCallback(EVT_SUBSCRIBE_NOTIFY_ACTION action, 
-                                PVOID pContext, 
-                                EVT_HANDLE hEvent) {
-    UNREFERENCED_PARAMETER(pContext);
-    DWORD status = ERROR_SUCCESS;
-
-    switch (action) {
-        case EvtSubscribeActionError:
-            if (ERROR_EVT_QUERY_RESULT_STALE == (uintptr_t)hEvent) {
-                std::wcout << L"⚠️ Event records are missing" << std::endl;
-            } else {
-                std::wcout << L"❌ Subscription error: " << (uintptr_t)hEvent << std::endl;
-            }
-            break;
-
-        case EvtSubscribeActionDeliver:
-            status = ProcessEvent(hEvent);
-            if (ERROR_SUCCESS != status) {
-                std::cerr << "❌ Failed to process event" << std::endl;
-            }
-            break;
-
-        default:
-            std::wcout << L"⚠️ Unknown subscription action" << std::endl;
-            break;
+// Runs on the ConfigStore watcher thread with the snapshot that was
+// replaced and the one now current. Only what can change without
+// dropping events is applied; the rest is reported and waits for a restart.
+void ApplyConfigReload(const ConfigReader& previous, const ConfigReader& next, EventPipeline& pipeline,
+                       EventSubscriber& subscriber, RateController* rateControl) {
+    const nlohmann::json& before = previous.json();
+    const nlohmann::json& after = next.json();
+    auto changed = [&](const std::string& section) {
+        auto was = before.find(section);
+        auto now = after.find(section);
+        if (was == before.end() || now == after.end()) return (was == before.end()) != (now == after.end());
+        return *was != *now;
+    };
+
+    if (changed("filter")) {
+        auto filter = std::make_shared<EventFilter>();
+        if (filter->compile(next.getFilterConfig())) {
+            pipeline.setFilter(filter->enabled() ? filter : nullptr);
+            std::cout << "[Config] ✓ Filter recompiled" << (filter->enabled() ? "" : " (empty, sending every event)") << std::endl;
+        } else {
+            std::cerr << "[Config] ⚠️ Filter config invalid, keeping the running filter" << std::endl;
+        }
     }
 
-    return status;
-}
-
-// ============================================
-// Process Event
-// ============================================
-DWORD ProcessEvent(EVT_HANDLE hEvent) {
-    DWORD status = ERROR_SUCCESS;
-    std::string eventXml;
-    std::string eventJson;
-
-    try {
-        // Step 1: Convert event to XML
-        status = EventToEventXml(hEvent, eventXml);
-        if (status != ERROR_SUCCESS) {
-            std::cerr << "❌ Failed to convert event to XML (Error: " << status << ")" << std::endl;
-            goto cleanup;
+    if (changed("batch")) {
+        BatchConfig limits;
+        limits.maxEvents = next.getBatchMaxEvents();
+        limits.maxBytes = next.getBatchMaxBytes();
+        limits.maxDelayMs = next.getBatchMaxDelayMs();
+        pipeline.setBatchLimits(limits);
+        if (rateControl != nullptr) rateControl->setMaxBatchEvents(limits.maxEvents);
+
+        std::cout << "[Config] ✓ Batch limits: " << limits.maxEvents << " events, " << limits.maxBytes
+                  << " bytes, " << limits.maxDelayMs << " ms" << std::endl;
+        if (next.getBatchFormat() != previous.getBatchFormat() ||
+            next.isBatchStreamCompression() != previous.isBatchStreamCompression()) {
+            std::cerr << "[Config] ⚠️ batch.format / stream_compression apply after a restart" << std::endl;
         }
+    }
 
-        // Step 2: Sanitize XML
-        eventXml = sanitizeUtf8(eventXml);
-        
-        // Step 3: Convert XML to Sysmon JSON
-        eventJson = EventXmlToEventJson(eventXml);
-        if (eventJson.empty()) {
-            std::cerr << "⚠️ Event JSON conversion returned empty" << std::endl;
-            goto cleanup;
+    if (changed("event_processor")) {
+        auto pairs = next.getPathQueryPairs();
+        if (pairs != previous.getPathQueryPairs()) {
+            subscriber.update(pairs);
         }
-        
-        // Step 4: Send via WebSocket (if active)
-        /*
-        if (g_webSocketClient != nullptr) {
-            g_webSocketClient->send(eventJson);
-            std::cout << "📡 Sent to WebSocket server" << std::endl;
-        }
-        */
-        
-        // Step 5: Send via HTTP (active)
-        if (g_httpClient != nullptr) {
-            try {
-                // Parse Sysmon JSON
-                nlohmann::json sysmonEvent = nlohmann::json::parse(eventJson);
-                
-                // Convert to Django format
-                nlohmann::json djangoEvent = EventConverter::sysmonEventToDjangoFormat(sysmonEvent);
-                
-                if (djangoEvent.empty()) {
-                    std::cerr << "⚠️ Django format conversion returned empty" << std::endl;
-                    goto cleanup;
-                }
-                
-                // ==================================================================================
-                // BATCHING LOGIC (Optimization Phase 1)
-                // ==================================================================================
-                // We use 'static' here so these variables persist across function calls.
-                static std::vector<nlohmann::json> eventBuffer; 
-                
-                // TEMPORARY: Set to 1 for debugging
-                static const size_t BATCH_SIZE = 100; 
-                
-                eventBuffer.push_back(djangoEvent);
-                std::cout << "  [Buffer] Added event. Size: " << eventBuffer.size() << "/" << BATCH_SIZE << std::endl;
-                
-                if (eventBuffer.size() >= BATCH_SIZE) {
-                    std::cout << "  [Batch] Sending " << eventBuffer.size() << " events..." << std::endl;
-                    
-                    if (g_httpClient->sendTelemetryBatch(eventBuffer)) {
-                        std::cout << "✅ Batch sent successfully" << std::endl;
-                        eventBuffer.clear();
-                    } else {
-                        std::cerr << "❌ Failed to send batch" << std::endl;
-                        eventBuffer.clear(); 
-                    }
-                }
-                // If buffer isn't full yet, we do nothing and wait for the next event.
-                // ==================================================================================
-                
-                std::cout << "---" << std::endl;
-                
-            } catch (const nlohmann::json::parse_error& e) {
-                std::cerr << "❌ JSON parse error: " << e.what() << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "❌ Exception: " << e.what() << std::endl;
+
+        auto etwOnly = [](const nlohmann::json& sources) {
+            nlohmann::json etw = nlohmann::json::array();
+            for (const auto& source : sources) {
+                if (source.is_object() && source.value("engine", "eventlog") == "etw") etw.push_back(source);
             }
+            return etw;
+        };
+        if (etwOnly(next.getEventSources()) != etwOnly(previous.getEventSources()) ||
+            next.getRenderMode() != previous.getRenderMode() ||
+            next.getSubscribeMode() != previous.getSubscribeMode() ||
+            next.getPullBatchSize() != previous.getPullBatchSize()) {
+            std::cerr << "[Config] ⚠️ ETW sources, render_mode, subscribe_mode and pull_batch_size apply after a restart" << std::endl;
         }
-        
-    } catch (const std::exception& e) {
-        std::cerr << "❌ Exception in ProcessEvent: " << e.what() << std::endl;
-        status = ERROR_UNHANDLED_EXCEPTION;
     }
 
-cleanup:
-    if (hEvent) {
-        EvtClose(hEvent);
+    if (changed("logging")) {
+        Logger::setLevel(Logger::parseLevel(next.getLogLevel()));
+        std::cout << "[Config] ✓ Log level: " << next.getLogLevel() << std::endl;
+    }
+
+    // Everything else was read once at startup
+    static const char* const LIVE[] = {"filter", "batch", "event_processor", "logging"};
+    std::string pending;
+    auto note = [&](const std::string& key) {
+        if (std::find(std::begin(LIVE), std::end(LIVE), key) != std::end(LIVE)) return;
+        if (pending.find("'" + key + "'") != std::string::npos || !changed(key)) return;
+        pending += (pending.empty() ? "'" : ", '") + key + "'";
+    };
+    for (auto it = after.begin(); it != after.end(); ++it) note(it.key());
+    for (auto it = before.begin(); it != before.end(); ++it) note(it.key());
+    if (!pending.empty()) {
+        std::cerr << "[Config] ⚠️ Changed, applies after a restart: " << pending << std::endl;
     }
-    return status;
 }
 
 // ============================================
-// Convert Event to XML
+// Dictionary Training (tool mode)
 // ============================================
-DWORD EventToEventXml(EVT_HANDLE hEvent, std::string& eventXml) {
-    DWORD status = ERROR_SUCCESS;
-    DWORD dwBufferSize = 0;
-    DWORD dwBufferUsed = 0;
-    DWORD dwPropertyCount = 0;
-    std::vector<WCHAR> pContent;
-
-    // First call to get required buffer size
-    if (!EvtRender(NULL, hEvent, EvtRenderEventXml, dwBufferSize, 
-                   pContent.data(), &dwBufferUsed, &dwPropertyCount)) {
-        status = GetLastError();
-        
-        if (ERROR_INSUFFICIENT_BUFFER == status) {
-            dwBufferSize = dwBufferUsed;
-            pContent.resize(dwBufferSize, 0);
-            
-            // Second call with correct buffer size
-            if (!EvtRender(NULL, hEvent, EvtRenderEventXml, dwBufferSize, 
-                          pContent.data(), &dwBufferUsed, &dwPropertyCount)) {
-                status = GetLastError();
-                std::wcout << L"EvtRender failed with error: " << status << std::endl;
-                goto cleanup;
+// edr-agent.exe --train-dictionary [output.dict] [spool_dir] [size_kb]
+//
+// Every spooled batch is split back into single events, which is what the
+// dictionary has to be good at: small, time-bounded batches of events that
+// share keys, the host block and paths.
+int RunDictionaryTraining(int argc, char* argv[]) {
+    try {
+        ConfigReader configReader("config.json");
+        std::string outputPath = argc > 2 ? argv[2] : "telemetry.dict";
+        std::string spoolDir = argc > 3 ? argv[3] : configReader.getSpoolDirectory();
+        size_t dictionaryKb = argc > 4 ? std::stoul(argv[4]) : 112;
+
+        // Batches spooled with the current dictionary need it to decompress
+        ZstdConfig zstdConfig;
+        zstdConfig.dictionaryPath = configReader.getCompressionDictionary();
+        SimpleZstd::configure(zstdConfig);
+
+        const size_t maxSampleBytes = 64 * 1024 * 1024;   // Plenty: zstd suggests ~100x the dictionary size
+        std::vector<std::string> samples;
+        size_t sampleBytes = 0;
+        std::string batch;
+
+        size_t records = TelemetrySpool::forEachRecord(spoolDir, [&](const std::vector<BYTE>& record) {
+            if (!SimpleZstd::decompress(record.data(), record.size(), batch)) return true;
+
+            nlohmann::json events = nlohmann::json::parse(batch, nullptr, false);
+            if (!events.is_array()) return true;
+
+            for (const auto& event : events) {
+                samples.push_back(event.dump());
+                sampleBytes += samples.back().size();
             }
-            
-            status = ERROR_SUCCESS;
-        } else {
-            std::wcout << L"EvtRender failed with error: " << status << std::endl;
-            goto cleanup;
-        }
-    }
+            return sampleBytes < maxSampleBytes;
+        });
 
-    // Convert wide string to regular string
-    if (!pContent.empty()) {
-        int size = WideCharToMultiByte(CP_UTF8, 0, pContent.data(), -1, NULL, 0, NULL, NULL);
-        if (size > 0) {
-            std::vector<char> buffer(size);
-            WideCharToMultiByte(CP_UTF8, 0, pContent.data(), -1, buffer.data(), size, NULL, NULL);
-            eventXml = std::string(buffer.begin(), buffer.end() - 1); // -1 to remove null terminator
-        }
-    }
+        std::cout << "[Train] " << records << " spooled batch(es), " << samples.size()
+                  << " events from " << spoolDir << std::endl;
 
-cleanup:
-    pContent.clear();
-    return status;
+        return SimpleZstd::trainDictionary(samples, dictionaryKb * 1024, outputPath) ? 0 : 1;
+
+    } catch (const std::exception& e) {
+        std::cerr << "\n❌ FATAL ERROR: " << e.what() << std::endl;
+        return 1;
+    }
 }
 
 // ============================================
-// Convert XML to JSON (Sysmon Format)
+// Corpus Recording (tool mode)
 // ============================================
-std::string EventXmlToEventJson(const std::string& xml) {
+// edr-agent.exe --record [output.corpus] [max_events]
+//
+// Renders what the configured channels already hold, oldest first and
+// through the configured queries, exactly as the live path renders it,
+// so edr-bench can replay it on any machine. Run it after Sysmon has
+// been logging for a while: the corpus is only as typical as the log.
+int RunRecording(int argc, char* argv[]) {
     try {
-        pugi::xml_document doc;
-        pugi::xml_parse_result result = doc.load_string(xml.c_str());
-
-        if (!result) {
-            std::cerr << "XML parsing failed: " << result.description() << std::endl;
-            return "";
-        }
-
-        nlohmann::json systemJson;
-        nlohmann::json eventDataJson;
-        nlohmann::json eventJson;
-
-        // Parse System section
-        for (pugi::xml_node node : doc.child("Event").children()) {
-            if (std::string(node.name()) == "System") {
-                for (pugi::xml_node child : node.children()) {
-                    std::string nodeName = child.name();
-                    
-                    if (nodeName == "Channel") {
-                        systemJson["Channel"] = child.text().as_string();
-                    }
-                    else if (nodeName == "Computer") {
-                        systemJson["Computer"] = child.text().as_string();
-                    }
-                    else if (nodeName == "Correlation") {
-                        systemJson["Correlation"] = nlohmann::json::object();
-                        if (child.attribute("ActivityID")) {
-                            systemJson["Correlation"]["ActivityID"] = child.attribute("ActivityID").value();
-                        }
-                    }
-                    else if (nodeName == "EventID") {
-                        systemJson["EventID"] = child.text().as_int();
-                    }
-                    else if (nodeName == "EventRecordID") {
-                        systemJson["EventRecordID"] = child.text().as_int();
-                    }
-                    else if (nodeName == "Execution") {
-                        systemJson["Execution"]["ProcessID"] = child.attribute("ProcessID").as_int();
-                        systemJson["Execution"]["ThreadID"] = child.attribute("ThreadID").as_int();
-                    }
-                    else if (nodeName == "Keywords") {
-                        systemJson["Keywords"] = child.text().as_string();
-                    }
-                    else if (nodeName == "Level") {
-                        systemJson["Level"] = child.text().as_int();
-                    }
-                    else if (nodeName == "Provider") {
-                        systemJson["Provider"]["Name"] = child.attribute("Name").value();
-                        if (child.attribute("Guid")) {
-                            systemJson["Provider"]["Guid"] = child.attribute("Guid").value();
-                        }
-                    }
-                    else if (nodeName == "Security") {
-                        if (child.attribute("UserID")) {
-                            systemJson["Security"]["UserID"] = child.attribute("UserID").value();
-                        }
-                    }
-                    else if (nodeName == "TimeCreated") {
-                        systemJson["TimeCreated"]["SystemTime"] = child.attribute("SystemTime").value();
-                    }
-                    else if (nodeName == "Version") {
-                        systemJson["Version"] = child.text().as_int();
-                    }
-                }
+        ConfigReader configReader("config.json");
+        std::string outputPath = argc > 2 ? argv[2] : "events.corpus";
+        size_t maxEvents = argc > 3 ? std::stoul(argv[3]) : 50000;
+
+        std::vector<std::string> events;
+        std::string xml;
+        EVT_HANDLE handles[64];
+
+        for (const auto& pair : configReader.getPathQueryPairs()) {
+            EVT_HANDLE hQuery = EvtQuery(NULL, pair.first.c_str(), pair.second.c_str(),
+                                         EvtQueryChannelPath | EvtQueryForwardDirection);
+            if (hQuery == NULL) {
+                std::wcerr << L"[Record] ⚠️ Cannot query " << pair.first << L" (Error: " << GetLastError() << L")" << std::endl;
+                continue;
             }
-            // Parse EventData section
-            else if (std::string(node.name()) == "EventData") {
-                for (pugi::xml_node child : node.children()) {
-                    std::string nodeAttr = child.attribute("Name").value();
-                    
-                    // Handle integer fields
-                    if (nodeAttr == "DestinationPort" || nodeAttr == "SourcePort" || 
-                        nodeAttr == "ProcessId" || nodeAttr == "TerminalSessionId") {
-                        eventDataJson[nodeAttr] = child.text().as_int();
-                    } else {
-                        eventDataJson[nodeAttr] = child.text().as_string();
+
+            size_t before = events.size();
+            DWORD returned = 0;
+            while (events.size() < maxEvents &&
+                   EvtNext(hQuery, (DWORD)(sizeof(handles) / sizeof(handles[0])), handles, INFINITE, 0, &returned)) {
+                for (DWORD i = 0; i < returned; i++) {
+                    if (events.size() < maxEvents && EventToEventXml(handles[i], xml) == ERROR_SUCCESS) {
+                        events.push_back(xml);
                     }
+                    EvtClose(handles[i]);
                 }
             }
-        }
+            EvtClose(hQuery);
 
-        // Build final JSON
-        eventJson["type"] = "event";
-        eventJson["info"]["System"] = systemJson;
-        eventJson["info"]["EventData"] = eventDataJson;
+            std::wcout << L"[Record] " << (events.size() - before) << L" event(s) from " << pair.first << std::endl;
+        }
 
-        return eventJson.dump(4);
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error in EventXmlToEventJson: " << e.what() << std::endl;
-        return "";
-    }
-}
+        if (events.empty()) {
+            std::cerr << "[Record] ❌ Nothing recorded (is Sysmon logging, and are we elevated?)" << std::endl;
+            return 1;
+        }
+        if (!EventCorpus::save(outputPath, events)) return 1;
 
-// ============================================
-// Sanitize UTF-8 String
-// ============================================
-std::string sanitizeUtf8(const std::string& input) {
-    std::string output;
-    output.reserve(input.length());
+        std::cout << "[Record] ✓ " << events.size() << " events saved to " << outputPath << std::endl;
+        return 0;
 
-    for (size_t i = 0; i < input.length(); i++) {
-        unsigned char c = input[i];
-        
-        if (c < 0x80) {
-            // ASCII character
-            output.push_back(c);
-        } 
-        else if ((c & 0xE0) == 0xC0) {
-            // 2-byte UTF-8 sequence
-            if (i + 1 < input.length() && (input[i + 1] & 0xC0) == 0x80) {
-                output.push_back(c);
-                output.push_back(input[++i]);
-            }
-        } 
-        else if ((c & 0xF0) == 0xE0) {
-            // 3-byte UTF-8 sequence
-            if (i + 2 < input.length() && 
-                (input[i + 1] & 0xC0) == 0x80 && 
-                (input[i + 2] & 0xC0) == 0x80) {
-                output.push_back(c);
-                output.push_back(input[++i]);
-                output.push_back(input[++i]);
-            }
-        } 
-        else if ((c & 0xF8) == 0xF0) {
-            // 4-byte UTF-8 sequence
-            if (i + 3 < input.length() && 
-                (input[i + 1] & 0xC0) == 0x80 && 
-                (input[i + 2] & 0xC0) == 0x80 && 
-                (input[i + 3] & 0xC0) == 0x80) {
-                output.push_back(c);
-                output.push_back(input[++i]);
-                output.push_back(input[++i]);
-                output.push_back(input[++i]);
-            }
-        }
-        // Invalid UTF-8 character - skip it
+    } catch (const std::exception& e) {
+        std::cerr << "\n❌ FATAL ERROR: " << e.what() << std::endl;
+        return 1;
     }
-
-    return output;
 }
@@ -0,0 +1,579 @@
+// ============================================================
+// EDR Bench
+// ============================================================
+// Offline numbers for the agent's hot path, no live Sysmon needed:
+//
+//   edr-bench [corpus] [--passes N] [--synthetic N] [--format json|binary]
+//             [--plain] [--level N] [--dictionary path] [--micro | --replay]
+//
+// Replay feeds every event of a corpus (recorded with edr-agent --record,
+// or generated when none is given) through the same code the agent runs,
+// on one thread, with a null sender that only counts the bytes:
+//
+//   pipeline  sanitizeUtf8InPlace -> pugixml + extractFields ->
+//             fieldsToTelemetryEvent -> EventBatcher (-> zstd)
+//   legacy    sanitizeUtf8 -> EventXmlToEventJson ->
+//             sysmonEventToDjangoFormat -> JSON array -> SimpleZstd::compress
+//
+// and reports events/sec, ns and allocations per event for each stage,
+// and bytes on the wire. Allocations are operator new calls plus
+// pugixml's own; zstd keeps its contexts and is not counted. Batches
+// flush on max events / max bytes only, so a slow pass does not change
+// the batch sizes.
+//
+// Micro benchmarks (Google Benchmark style: the iteration count grows
+// until a run takes MIN_MICRO_NS) cover the per-event helpers that are
+// too small to see in a stage total.
+// ============================================================
+
+#include "AgentIdentity.hpp"
+#include "EventBatcher.hpp"
+#include "EventConverter.hpp"
+#include "EventCorpus.hpp"
+#include "EventRenderer.hpp"
+#include "SimpleZstd.hpp"
+#include "TelemetryEvent.hpp"
+#include "Utf8.hpp"
+
+#include "nlohmann/json.hpp"
+#include "pugixml.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// ============================================
+// Allocation Counting
+// ============================================
+namespace {
+    std::atomic<uint64_t> g_allocations{0};
+
+    void* countedAlloc(size_t size) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* pugiAlloc(size_t size) { return countedAlloc(size); }
+    void pugiFree(void* ptr) { std::free(ptr); }
+}
+
+void* operator new(size_t size) {
+    if (void* ptr = countedAlloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    if (void* ptr = countedAlloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+namespace {
+
+    constexpr uint64_t MIN_MICRO_NS = 500ull * 1000 * 1000;   // 0.5 s per micro benchmark
+    constexpr uint64_t MAX_MICRO_ITERATIONS = 1ull << 30;
+
+    uint64_t allocations() { return g_allocations.load(std::memory_order_relaxed); }
+
+    uint64_t clockNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Keeps the compiler from dropping a result nobody reads
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+#ifdef _MSC_VER
+        static const volatile void* sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+    struct Options {
+        std::string corpusPath;
+        unsigned passes = 3;
+        size_t syntheticEvents = 20000;
+        BatchFormat format = BatchFormat::Json;
+        bool streamCompression = true;
+        int level = 3;
+        std::string dictionaryPath;
+        bool micro = true;
+        bool replay = true;
+    };
+
+    // ============================================
+    // Synthetic Corpus
+    // ============================================
+    // Shaped like EvtRender output for the three events that dominate a
+    // real Sysmon log, with the fields that vary per event varied.
+    std::string systemBlock(int eventId, uint64_t recordId) {
+        return "<Event xmlns='http://schemas.microsoft.com/win/2004/08/events/event'><System>"
+               "<Provider Name='Microsoft-Windows-Sysmon' Guid='{5770385f-c22a-43e0-bf4c-06f5698ffbd9}'/>"
+               "<EventID>" + std::to_string(eventId) + "</EventID><Version>5</Version><Level>4</Level>"
+               "<Task>" + std::to_string(eventId) + "</Task><Opcode>0</Opcode><Keywords>0x8000000000000000</Keywords>"
+               "<TimeCreated SystemTime='2024-05-01T12:" + std::to_string(10 + recordId % 50) + ":0" +
+               std::to_string(recordId % 10) + "." + std::to_string(1000000 + recordId % 9000000) + "Z'/>"
+               "<EventRecordID>" + std::to_string(recordId) + "</EventRecordID><Correlation/>"
+               "<Execution ProcessID='3032' ThreadID='4012'/><Channel>Microsoft-Windows-Sysmon/Operational</Channel>"
+               "<Computer>BENCH-WS01.corp.example.com</Computer><Security UserID='S-1-5-18'/></System><EventData>";
+    }
+
+    std::string data(const char* name, const std::string& value) {
+        return std::string("<Data Name='") + name + "'>" + value + "</Data>";
+    }
+
+    std::vector<std::string> syntheticCorpus(size_t count) {
+        static const char* const IMAGES[] = {
+            "C:\\Windows\\System32\\svchost.exe", "C:\\Program Files\\Google\\Chrome\\Application\\chrome.exe",
+            "C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe", "C:\\Windows\\explorer.exe",
+            "C:\\Program Files\\Microsoft Office\\root\\Office16\\OUTLOOK.EXE"
+        };
+        const size_t imageCount = sizeof(IMAGES) / sizeof(IMAGES[0]);
+
+        std::vector<std::string> events;
+        events.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            uint64_t recordId = 100000 + i;
+            std::string pid = std::to_string(1000 + (i * 7) % 30000);
+            std::string image = IMAGES[i % imageCount];
+            std::string xml;
+
+            switch (i % 4) {
+                case 0:   // Process create
+                    xml = systemBlock(1, recordId) +
+                          data("RuleName", "-") + data("UtcTime", "2024-05-01 12:00:00.123") +
+                          data("ProcessGuid", "{4a3b2c1d-0000-1000-a000-00000000" + std::to_string(1000 + i % 9000) + "}") +
+                          data("ProcessId", pid) + data("Image", image) +
+                          data("FileVersion", "10.0.22621.1") + data("Description", "Host Process") +
+                          data("Product", "Microsoft® Windows® Operating System") + data("Company", "Microsoft Corporation") +
+                          data("OriginalFileName", "svchost.exe") +
+                          data("CommandLine", image + " -k netsvcs -p -s Schedule --instance " + std::to_string(i)) +
+                          data("CurrentDirectory", "C:\\Windows\\system32\\") + data("User", "CORP\\alice") +
+                          data("LogonGuid", "{4a3b2c1d-0000-1000-e703-000000000000}") + data("LogonId", "0x3e7") +
+                          data("TerminalSessionId", "0") + data("IntegrityLevel", "System") +
+                          data("Hashes", "SHA256=1D8E0F3A6B1C94E07A4C2B5F8E6D3A2910C7B4E5F6A7D8C9B0A1E2F3D4C5B6A7") +
+                          data("ParentProcessGuid", "{4a3b2c1d-0000-1000-a000-000000000010}") +
+                          data("ParentProcessId", "788") + data("ParentImage", "C:\\Windows\\System32\\services.exe") +
+                          data("ParentCommandLine", "C:\\Windows\\system32\\services.exe") + data("ParentUser", "NT AUTHORITY\\SYSTEM");
+                    break;
+                case 1:   // Network connection
+                case 2:
+                    xml = systemBlock(3, recordId) +
+                          data("RuleName", "-") + data("UtcTime", "2024-05-01 12:00:00.456") +
+                          data("ProcessGuid", "{4a3b2c1d-0000-1000-a000-000000000042}") + data("ProcessId", pid) +
+                          data("Image", image) + data("User", "CORP\\alice") + data("Protocol", "tcp") +
+                          data("Initiated", "true") + data("SourceIsIpv6", "false") +
+                          data("SourceIp", "10.0.12." + std::to_string(i % 250)) + data("SourceHostname", "-") +
+                          data("SourcePort", std::to_string(49152 + i % 16000)) + data("SourcePortName", "-") +
+                          data("DestinationIsIpv6", "false") +
+                          data("DestinationIp", "142.250." + std::to_string(i % 200) + "." + std::to_string(i % 97)) +
+                          data("DestinationHostname", "-") + data("DestinationPort", (i % 3) ? "443" : "80") +
+                          data("DestinationPortName", (i % 3) ? "https" : "http");
+                    break;
+                default:  // File create
+                    xml = systemBlock(11, recordId) +
+                          data("RuleName", "-") + data("UtcTime", "2024-05-01 12:00:00.789") +
+                          data("ProcessGuid", "{4a3b2c1d-0000-1000-a000-000000000042}") + data("ProcessId", pid) +
+                          data("Image", image) +
+                          data("TargetFilename", "C:\\Users\\alice\\AppData\\Local\\Temp\\tmp" + std::to_string(i) + ".tmp") +
+                          data("CreationUtcTime", "2024-05-01 12:00:00.789") + data("User", "CORP\\alice");
+                    break;
+            }
+            events.push_back(std::move(xml) + "</EventData></Event>");
+        }
+        return events;
+    }
+
+    // ============================================
+    // Stage Accounting
+    // ============================================
+    struct StageStats {
+        const char* name;
+        uint64_t ns = 0;
+        uint64_t allocations = 0;
+    };
+
+    // Each mark() charges the time and allocations since the previous
+    // mark to one stage; skip() restarts the count without charging it
+    class StageClock {
+    public:
+        explicit StageClock(std::vector<StageStats>& stages) : m_stages(stages) { calibrate(); }
+
+        void skip() {
+            m_lastNs = clockNs();
+            m_lastAllocations = allocations();
+        }
+
+        void mark(size_t stage) {
+            uint64_t now = clockNs();
+            uint64_t allocated = allocations();
+            uint64_t elapsed = now - m_lastNs;
+            m_stages[stage].ns += elapsed > m_overheadNs ? elapsed - m_overheadNs : 0;
+            m_stages[stage].allocations += allocated - m_lastAllocations;
+            m_lastNs = now;
+            m_lastAllocations = allocated;
+        }
+
+        uint64_t overheadNs() const { return m_overheadNs; }
+
+    private:
+        // One clock read is charged to every stage; take it back out
+        void calibrate() {
+            const int reads = 1000000;
+            uint64_t start = clockNs();
+            uint64_t last = start;
+            for (int i = 0; i < reads; i++) last = clockNs();
+            m_overheadNs = (last - start) / reads;
+        }
+
+        std::vector<StageStats>& m_stages;
+        uint64_t m_lastNs = 0;
+        uint64_t m_lastAllocations = 0;
+        uint64_t m_overheadNs = 0;
+    };
+
+    struct WireStats {
+        uint64_t rawBytes = 0;
+        uint64_t wireBytes = 0;
+        uint64_t batches = 0;
+        uint64_t sent = 0;       // Events that made it into a batch
+    };
+
+    void printReplay(const char* name, const std::vector<StageStats>& stages, const WireStats& wire,
+                     uint64_t events, uint64_t wallNs, uint64_t overheadNs) {
+        uint64_t totalNs = 0, totalAllocations = 0;
+        for (const auto& stage : stages) {
+            totalNs += stage.ns;
+            totalAllocations += stage.allocations;
+        }
+
+        std::printf("\n[Bench] %s replay: %llu events (clock overhead %llu ns, subtracted)\n",
+                    name, (unsigned long long)events, (unsigned long long)overheadNs);
+        std::printf("  %-14s %12s %14s\n", "stage", "ns/event", "allocs/event");
+        for (const auto& stage : stages) {
+            std::printf("  %-14s %12.1f %14.2f\n", stage.name,
+                        (double)stage.ns / events, (double)stage.allocations / events);
+        }
+        std::printf("  %-14s %12.1f %14.2f\n", "total", (double)totalNs / events, (double)totalAllocations / events);
+        std::printf("  throughput     %.0f events/sec (one thread, wall clock)\n",
+                    wallNs > 0 ? (double)events * 1e9 / wallNs : 0.0);
+        std::printf("  wire           %llu bytes in %llu batches, %.1f bytes/event (raw %.1f, ratio %.3f)\n",
+                    (unsigned long long)wire.wireBytes, (unsigned long long)wire.batches,
+                    wire.sent > 0 ? (double)wire.wireBytes / wire.sent : 0.0,
+                    wire.sent > 0 ? (double)wire.rawBytes / wire.sent : 0.0,
+                    wire.rawBytes > 0 ? (double)wire.wireBytes / wire.rawBytes : 0.0);
+        std::printf("  sent           %llu of %llu events (the rest are skipped IDs)\n",
+                    (unsigned long long)wire.sent, (unsigned long long)events);
+    }
+
+    // ============================================
+    // Replay: Agent Pipeline
+    // ============================================
+    void replayPipeline(const std::vector<std::string>& corpus, const Options& options, bool report = true) {
+        enum { Sanitize, Parse, Convert, Batch, Compress, StageCount };
+        std::vector<StageStats> stages = {
+            {"sanitize"}, {"parse"}, {"convert"},
+            {options.streamCompression ? "batch+zstd" : "batch"}, {options.streamCompression ? "finish" : "compress"}
+        };
+
+        BatchConfig batchConfig;
+        batchConfig.format = options.format;
+        batchConfig.streamCompression = options.streamCompression;
+        batchConfig.maxDelayMs = 24u * 3600 * 1000;   // Size-based flushes only
+        EventBatcher batcher(batchConfig);
+
+        // Same reuse as a pipeline worker: one document, one working buffer, one event
+        pugi::xml_document doc;
+        std::string work;
+        TelemetryEvent event;
+        std::vector<BYTE> wireBuffer;
+        WireStats wire;
+
+        auto flush = [&]() {
+            wire.rawBytes += batcher.rawBytes();
+            bool ok = batcher.finish();
+            size_t bytes = 0;
+            if (ok && batcher.compressed()) {
+                bytes = batcher.compressedBody().size();
+            } else if (ok && SimpleZstd::compress(batcher.body(), wireBuffer)) {
+                bytes = wireBuffer.size();
+                batcher.recordCompression(batcher.rawBytes(), bytes);
+            }
+            wire.wireBytes += bytes;   // The null sender: counted, never sent
+            wire.batches++;
+            batcher.clear();
+        };
+
+        StageClock clock(stages);
+        uint64_t wallStart = clockNs();
+        for (unsigned pass = 0; pass < options.passes; pass++) {
+            for (const std::string& xml : corpus) {
+                work.assign(xml);   // Stands in for EvtRender: not charged
+                clock.skip();
+
+                sanitizeUtf8InPlace(work);
+                clock.mark(Sanitize);
+
+                EventFields fields;
+                bool extracted = doc.load_buffer_inplace(&work[0], work.size()) &&
+                                 EventConverter::extractFields(doc.child("Event"), fields);
+                clock.mark(Parse);
+                if (!extracted) continue;
+
+                bool converted = EventConverter::fieldsToTelemetryEvent(fields, event);
+                clock.mark(Convert);
+                if (!converted) continue;
+
+                batcher.add(event);
+                wire.sent++;
+                clock.mark(Batch);
+
+                if (batcher.shouldFlush(EventBatcher::Clock::now()) != FlushReason::None) {
+                    clock.skip();
+                    flush();
+                    clock.mark(Compress);
+                }
+            }
+        }
+        if (!batcher.empty()) {
+            clock.skip();
+            flush();
+            clock.mark(Compress);
+        }
+        uint64_t wallNs = clockNs() - wallStart;
+
+        if (report) {
+            printReplay("pipeline", stages, wire, (uint64_t)corpus.size() * options.passes, wallNs, clock.overheadNs());
+        }
+    }
+
+    // ============================================
+    // Replay: Legacy JSON Path
+    // ============================================
+    void replayLegacy(const std::vector<std::string>& corpus, const Options& options) {
+        enum { Sanitize, XmlToJson, ToDjango, Batch, Compress, StageCount };
+        std::vector<StageStats> stages = {
+            {"sanitize"}, {"xml_to_json"}, {"to_django"}, {"batch"}, {"compress"}
+        };
+
+        BatchConfig limits;   // Same event/byte limits as the pipeline batcher
+        std::string body;
+        std::vector<BYTE> wireBuffer;
+        size_t batchEvents = 0;
+        WireStats wire;
+
+        auto flush = [&]() {
+            body += ']';
+            wire.rawBytes += body.size();
+            if (SimpleZstd::compress(body, wireBuffer)) wire.wireBytes += wireBuffer.size();
+            wire.batches++;
+            body.clear();
+            batchEvents = 0;
+        };
+
+        StageClock clock(stages);
+        uint64_t wallStart = clockNs();
+        for (unsigned pass = 0; pass < options.passes; pass++) {
+            for (const std::string& xml : corpus) {
+                clock.skip();
+
+                std::string clean = sanitizeUtf8(xml);
+                clock.mark(Sanitize);
+
+                std::string sysmonJson = EventXmlToEventJson(clean);
+                clock.mark(XmlToJson);
+                if (sysmonJson.empty()) continue;
+
+                nlohmann::json django = EventConverter::sysmonEventToDjangoFormat(
+                    nlohmann::json::parse(sysmonJson, nullptr, false));
+                clock.mark(ToDjango);
+                if (django.is_null() || django.empty()) continue;
+
+                body += batchEvents == 0 ? '[' : ',';
+                body += django.dump();
+                batchEvents++;
+                wire.sent++;
+                clock.mark(Batch);
+
+                // Raw size against the compressed limit, scaled by the usual ratio
+                if (batchEvents >= limits.maxEvents || body.size() * 0.15 >= limits.maxBytes) {
+                    clock.skip();
+                    flush();
+                    clock.mark(Compress);
+                }
+            }
+        }
+        if (batchEvents > 0) {
+            clock.skip();
+            flush();
+            clock.mark(Compress);
+        }
+        uint64_t wallNs = clockNs() - wallStart;
+
+        printReplay("legacy", stages, wire, (uint64_t)corpus.size() * options.passes, wallNs, clock.overheadNs());
+    }
+
+    // ============================================
+    // Micro Benchmarks
+    // ============================================
+    template <typename Fn>
+    void runMicro(const char* name, Fn&& fn) {
+        uint64_t iterations = 1;
+        for (;;) {
+            uint64_t allocationsBefore = allocations();
+            uint64_t start = clockNs();
+            for (uint64_t i = 0; i < iterations; i++) fn();
+            uint64_t elapsed = clockNs() - start;
+            uint64_t allocated = allocations() - allocationsBefore;
+
+            if (elapsed >= MIN_MICRO_NS || iterations >= MAX_MICRO_ITERATIONS) {
+                std::printf("%-36s %12.1f ns %10.2f allocs %12llu\n", name,
+                            (double)elapsed / iterations, (double)allocated / iterations,
+                            (unsigned long long)iterations);
+                return;
+            }
+
+            // Aim past the minimum from what this run took, as Google Benchmark does
+            double scale = elapsed > 0 ? (double)MIN_MICRO_NS * 1.4 / (double)elapsed : 10.0;
+            scale = std::min(std::max(scale, 2.0), 10.0);
+            iterations = std::min<uint64_t>((uint64_t)((double)iterations * scale), MAX_MICRO_ITERATIONS);
+        }
+    }
+
+    void runMicroBenchmarks(const std::vector<std::string>& corpus) {
+        // A typical event, and the same event with a few invalid bytes in it
+        const std::string valid = corpus.empty() ? syntheticCorpus(1).front() : corpus.front();
+        std::string invalid = valid;
+        for (size_t i = invalid.size() / 4; i < invalid.size(); i += invalid.size() / 4) {
+            invalid[i] = (char)0xC0;   // Never valid in UTF-8
+        }
+        const std::string systemTime = "2024-05-01T12:34:56.1234567Z";
+        std::string work;
+        work.reserve(valid.size());
+
+        std::printf("\n%-36s %15s %17s %12s\n", "Benchmark", "Time", "Allocs", "Iterations");
+        std::printf("%s\n", std::string(84, '-').c_str());
+
+        runMicro("BM_sanitizeUtf8/valid", [&] {
+            std::string clean = sanitizeUtf8(valid);
+            doNotOptimize(clean);
+        });
+        runMicro("BM_sanitizeUtf8/invalid", [&] {
+            std::string clean = sanitizeUtf8(invalid);
+            doNotOptimize(clean);
+        });
+        runMicro("BM_sanitizeUtf8InPlace/valid", [&] {
+            work.assign(valid);
+            bool ok = sanitizeUtf8InPlace(work);
+            doNotOptimize(ok);
+        });
+        runMicro("BM_generateEventId", [&] {
+            char id[36];
+            AgentIdentity::generateEventId(id);
+            doNotOptimize(id);
+        });
+        runMicro("BM_generateEventId/string", [&] {
+            std::string id = AgentIdentity::generateEventId();
+            doNotOptimize(id);
+        });
+        runMicro("BM_parseSystemTime", [&] {
+            uint64_t ticks = 0;
+            bool ok = EventConverter::parseSystemTime(systemTime, ticks);
+            doNotOptimize(ok);
+            doNotOptimize(ticks);
+        });
+    }
+
+    bool parseOptions(int argc, char* argv[], Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "--passes" && hasValue)          options.passes = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--synthetic" && hasValue)  options.syntheticEvents = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--format" && hasValue)     options.format = BinaryBatchEncoder::parseFormat(argv[++i]);
+            else if (arg == "--level" && hasValue)      options.level = std::atoi(argv[++i]);
+            else if (arg == "--dictionary" && hasValue) options.dictionaryPath = argv[++i];
+            else if (arg == "--plain")                  options.streamCompression = false;
+            else if (arg == "--micro")                  options.replay = false;
+            else if (arg == "--replay")                 options.micro = false;
+            else if (!arg.empty() && arg[0] != '-' && options.corpusPath.empty()) options.corpusPath = arg;
+            else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// ============================================
+// Main Function
+// ============================================
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: edr-bench [corpus] [--passes N] [--synthetic N] [--format json|binary]\n"
+                     "                 [--plain] [--level N] [--dictionary path] [--micro | --replay]" << std::endl;
+        return 1;
+    }
+
+    pugi::set_memory_management_functions(pugiAlloc, pugiFree);
+
+    ZstdConfig zstdConfig;
+    zstdConfig.level = options.level;
+    zstdConfig.dictionaryPath = options.dictionaryPath;
+    SimpleZstd::configure(zstdConfig);
+
+    std::vector<std::string> corpus;
+    if (!options.corpusPath.empty()) {
+        if (!EventCorpus::load(options.corpusPath, corpus) || corpus.empty()) return 1;
+        std::cout << "[Bench] " << corpus.size() << " events from " << options.corpusPath << std::endl;
+    } else {
+        corpus = syntheticCorpus(options.syntheticEvents);
+        std::cout << "[Bench] No corpus given, using " << corpus.size() << " synthetic events" << std::endl;
+    }
+
+    size_t corpusBytes = 0;
+    for (const auto& xml : corpus) corpusBytes += xml.size();
+    std::cout << "[Bench] " << corpusBytes / std::max<size_t>(corpus.size(), 1) << " bytes/event rendered, "
+              << options.passes << " pass(es), UTF-8 path: " << utf8Backend()
+              << ", zstd level " << options.level << (options.dictionaryPath.empty() ? "" : " + dictionary")
+              << ", " << (options.format == BatchFormat::Binary ? "binary" : "json")
+              << (options.streamCompression ? " streamed" : " plain") << " batches" << std::endl;
+
+    if (options.replay) {
+        // Warm-up pass: first-touch page faults and lazy tables are not the steady state
+        Options warmup = options;
+        warmup.passes = 1;
+        std::vector<std::string> sample(corpus.begin(), corpus.begin() + std::min<size_t>(corpus.size(), 1000));
+        replayPipeline(sample, warmup, false);
+
+        replayPipeline(corpus, options);
+        replayLegacy(corpus, options);
+    }
+    if (options.micro) {
+        runMicroBenchmarks(corpus);
+    }
+    return 0;
+}
@@ -0,0 +1,578 @@
+#include "EtwConsumer.hpp"
+#include "EventConverter.hpp"
+#include "EventRenderer.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+#include <tdh.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+// ============================================
+// Known Providers
+// ============================================
+namespace {
+    struct FieldMap {
+        const char* etwName;
+        const char* field;   // SysmonSchema DATA_FIELDS name
+    };
+
+    struct EventMap {
+        USHORT etwId;
+        int sysmonId;
+        const char* protocol;   // Network.Protocol when the event implies it
+        FieldMap fields[SysmonSchema::MAX_EVENT_FIELDS];
+    };
+}
+
+struct EtwProviderInfo {
+    const char* name;
+    GUID guid;
+    ULONGLONG keywords;     // Enabled when the source sets none
+    const char* channel;    // What EventFields.channel says downstream
+    bool sysmonLayout;      // Event IDs and property names are Sysmon's own
+    EventMap events[2];
+};
+
+namespace {
+    const EtwProviderInfo PROVIDERS[] = {
+        {"Microsoft-Windows-Sysmon",
+         {0x5770385F, 0xC22A, 0x43E0, {0xBF, 0x4C, 0x06, 0xF5, 0x69, 0x8F, 0xFB, 0xD9}},
+         0, "Microsoft-Windows-Sysmon/Operational", true, {}},
+
+        {"Microsoft-Windows-Kernel-Process",
+         {0x22FB2CD6, 0x0E7B, 0x422B, {0xA0, 0xC7, 0x2F, 0xAD, 0x1F, 0xD0, 0xE7, 0x16}},
+         0x10,   // WINEVENT_KEYWORD_PROCESS
+         "Microsoft-Windows-Kernel-Process/Analytic", false,
+         {{1, 1, nullptr, {{"ProcessID", "ProcessId"}, {"ParentProcessID", "ParentProcessId"}, {"ImageName", "Image"}}},
+          {2, 5, nullptr, {{"ProcessID", "ProcessId"}, {"ImageName", "Image"}}}}},
+
+        {"Microsoft-Windows-Kernel-Network",
+         {0x7DD42A49, 0x5329, 0x4832, {0x8D, 0xFD, 0x43, 0xD9, 0x79, 0x15, 0x3A, 0x88}},
+         0x30,   // KERNEL_NETWORK_KEYWORD_IPV4 | IPV6
+         "Microsoft-Windows-Kernel-Network/Analytic", false,
+         {{12, 3, "tcp", {{"PID", "ProcessId"}, {"saddr", "SourceIp"}, {"sport", "SourcePort"},
+                          {"daddr", "DestinationIp"}, {"dport", "DestinationPort"}}},
+          {28, 3, "tcp", {{"PID", "ProcessId"}, {"saddr", "SourceIp"}, {"sport", "SourcePort"},
+                          {"daddr", "DestinationIp"}, {"dport", "DestinationPort"}}}}},
+    };
+
+    constexpr size_t NO_SIZE = (size_t)-1;
+
+    bool sameGuid(const GUID& a, const GUID& b) {
+        return std::memcmp(&a, &b, sizeof(GUID)) == 0;
+    }
+
+    const EtwProviderInfo* findProvider(std::string name) {
+        // A channel name selects its provider
+        size_t slash = name.find('/');
+        if (slash != std::string::npos) name.resize(slash);
+
+        for (const EtwProviderInfo& provider : PROVIDERS) {
+            if (_stricmp(provider.name, name.c_str()) == 0) return &provider;
+        }
+        return nullptr;
+    }
+
+    int slotOf(const SysmonSchema::EventSpec& spec, std::string_view fieldName) {
+        const SysmonSchema::DataField* field = SysmonSchema::findDataField(fieldName);
+        if (field == nullptr) return -1;
+        for (size_t i = 0; i < SysmonSchema::fieldCount(spec); i++) {
+            if (spec.fields[i] == field) return (int)i;
+        }
+        return -1;
+    }
+
+    void appendSlot(RenderedValues& values, size_t slot, std::string_view text) {
+        values.offset[slot] = (uint32_t)values.strings.size();
+        values.strings.append(text.data(), text.size());
+        values.length[slot] = (uint32_t)text.size();
+    }
+
+    bool isInteger(USHORT inType) {
+        switch (inType) {
+            case TDH_INTYPE_INT8:  case TDH_INTYPE_UINT8:
+            case TDH_INTYPE_INT16: case TDH_INTYPE_UINT16:
+            case TDH_INTYPE_INT32: case TDH_INTYPE_UINT32: case TDH_INTYPE_HEXINT32:
+            case TDH_INTYPE_INT64: case TDH_INTYPE_UINT64: case TDH_INTYPE_HEXINT64:
+            case TDH_INTYPE_POINTER: case TDH_INTYPE_SIZET: case TDH_INTYPE_BOOLEAN:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Little-endian, as ETW writes it; ports are the exception (network order)
+    uint64_t readUnsigned(const BYTE* data, size_t size, USHORT outType) {
+        uint64_t value = 0;
+        std::memcpy(&value, data, std::min<size_t>(size, sizeof(value)));
+        if (outType == TDH_OUTTYPE_PORT && size == 2) {
+            value = ((value & 0xFF) << 8) | (value >> 8);
+        }
+        return value;
+    }
+
+    bool isSigned(USHORT inType) {
+        return inType == TDH_INTYPE_INT8 || inType == TDH_INTYPE_INT16 ||
+               inType == TDH_INTYPE_INT32 || inType == TDH_INTYPE_INT64;
+    }
+
+    int64_t readSigned(const BYTE* data, size_t size) {
+        switch (size) {
+            case 1: return (int8_t)data[0];
+            case 2: { int16_t v; std::memcpy(&v, data, 2); return v; }
+            case 4: { int32_t v; std::memcpy(&v, data, 4); return v; }
+            default: { int64_t v = 0; std::memcpy(&v, data, std::min<size_t>(size, 8)); return v; }
+        }
+    }
+
+    // Characters before the terminator (or the end of the property)
+    size_t wideLength(const BYTE* data, size_t size) {
+        const wchar_t* text = reinterpret_cast<const wchar_t*>(data);
+        size_t max = size / sizeof(wchar_t);
+        size_t length = 0;
+        while (length < max && text[length] != L'\0') length++;
+        return length;
+    }
+}
+
+// ============================================
+// Session
+// ============================================
+EtwConsumer::EtwConsumer(EventPipeline& pipeline, const EtwConfig& config)
+    : m_pipeline(pipeline)
+    , m_config(config)
+    , m_sessionName(config.sessionName.begin(), config.sessionName.end())
+    , m_infoBuffer(4096)
+    , m_propertyBuffer(512)
+{
+}
+
+EtwConsumer::~EtwConsumer() {
+    stop();
+}
+
+std::vector<EtwSource> EtwConsumer::parseSources(const nlohmann::json& sources) {
+    std::vector<EtwSource> result;
+    if (!sources.is_array()) return result;
+
+    for (const auto& entry : sources) {
+        if (!entry.is_object() || entry.value("engine", "eventlog") != "etw") continue;
+        try {
+            EtwSource source;
+            source.provider = entry.at("path").get<std::string>();
+            source.level = (UCHAR)entry.value("level", 5);
+            if (entry.contains("keywords")) {
+                const auto& keywords = entry["keywords"];
+                source.keywords = keywords.is_string()
+                    ? std::stoull(keywords.get<std::string>(), nullptr, 0)   // "0x10" or decimal
+                    : keywords.get<ULONGLONG>();
+            }
+            result.push_back(std::move(source));
+        } catch (const std::exception& e) {
+            std::cerr << "[ETW] ⚠️ Ignoring malformed source: " << e.what() << std::endl;
+        }
+    }
+    return result;
+}
+
+size_t EtwConsumer::start(const std::vector<EtwSource>& sources) {
+    std::vector<std::pair<const EtwProviderInfo*, const EtwSource*>> wanted;
+    for (const EtwSource& source : sources) {
+        const EtwProviderInfo* provider = findProvider(source.provider);
+        if (provider == nullptr) {
+            std::cerr << "[ETW] ⚠️ Unknown provider '" << source.provider << "', skipping" << std::endl;
+            continue;
+        }
+        bool duplicate = false;
+        for (const auto& entry : wanted) duplicate = duplicate || entry.first == provider;
+        if (!duplicate) wanted.emplace_back(provider, &source);
+    }
+    if (wanted.empty()) return 0;
+
+    m_computer = EventConverter::getHostname();
+
+    // The properties block is followed by room for the session name
+    std::vector<BYTE> buffer(sizeof(EVENT_TRACE_PROPERTIES) + (m_sessionName.size() + 1) * sizeof(wchar_t));
+    auto prepare = [this, &buffer]() {
+        std::fill(buffer.begin(), buffer.end(), 0);
+        auto* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(buffer.data());
+        props->Wnode.BufferSize = (ULONG)buffer.size();
+        props->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+        props->Wnode.ClientContext = 2;   // Timestamps in system time (FILETIME), like TimeCreated
+        props->BufferSize = m_config.bufferKb;
+        props->MinimumBuffers = m_config.minBuffers;
+        props->MaximumBuffers = std::max(m_config.maxBuffers, m_config.minBuffers);
+        props->FlushTimer = m_config.flushTimerS;
+        props->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+        props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+        return props;
+    };
+
+    ULONG status = StartTraceW(&m_session, m_sessionName.c_str(), prepare());
+    if (status == ERROR_ALREADY_EXISTS) {
+        // Sessions outlive their process: one a crashed run left behind is still there
+        std::wcout << L"  → Stopping stale ETW session " << m_sessionName << std::endl;
+        stopSession();
+        status = StartTraceW(&m_session, m_sessionName.c_str(), prepare());
+    }
+    if (status != ERROR_SUCCESS) {
+        std::cerr << "[ETW] ❌ StartTrace failed (Error: " << status << "), running as administrator?" << std::endl;
+        return 0;
+    }
+
+    for (const auto& entry : wanted) {
+        const EtwProviderInfo& provider = *entry.first;
+        ULONGLONG keywords = entry.second->keywords != 0 ? entry.second->keywords : provider.keywords;
+        status = EnableTraceEx2(m_session, &provider.guid, EVENT_CONTROL_CODE_ENABLE_PROVIDER,
+                                entry.second->level, keywords, 0, 0, NULL);
+        if (status != ERROR_SUCCESS) {
+            std::cerr << "[ETW] ⚠️ Cannot enable " << provider.name << " (Error: " << status << ")" << std::endl;
+            continue;
+        }
+        m_providers.push_back(&provider);
+        std::cout << "  ✓ ETW provider: " << provider.name << std::endl;
+    }
+
+    if (m_providers.empty()) {
+        stopSession();
+        return 0;
+    }
+
+    EVENT_TRACE_LOGFILEW logFile = {};
+    logFile.LoggerName = &m_sessionName[0];
+    logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+    logFile.EventRecordCallback = &EtwConsumer::eventCallback;
+    logFile.Context = this;
+
+    m_trace = OpenTraceW(&logFile);
+    if (m_trace == INVALID_PROCESSTRACE_HANDLE) {
+        std::cerr << "[ETW] ❌ OpenTrace failed (Error: " << GetLastError() << ")" << std::endl;
+        stopSession();
+        m_providers.clear();
+        return 0;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&EtwConsumer::processLoop, this);
+    return m_providers.size();
+}
+
+bool EtwConsumer::stopSession() {
+    std::vector<BYTE> buffer(sizeof(EVENT_TRACE_PROPERTIES) + (m_sessionName.size() + 1) * sizeof(wchar_t), 0);
+    auto* props = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(buffer.data());
+    props->Wnode.BufferSize = (ULONG)buffer.size();
+    props->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+
+    ULONG status = ControlTraceW(0, m_sessionName.c_str(), props, EVENT_TRACE_CONTROL_STOP);
+    if (status != ERROR_SUCCESS) return false;
+
+    m_lost.fetch_add(props->EventsLost, std::memory_order_relaxed);
+    m_session = 0;
+    return true;
+}
+
+void EtwConsumer::stop() {
+    if (!m_running.exchange(false)) return;
+
+    // Stopping the session ends ProcessTrace once the remaining buffers are delivered
+    stopSession();
+    if (m_trace != INVALID_PROCESSTRACE_HANDLE) {
+        CloseTrace(m_trace);
+        m_trace = INVALID_PROCESSTRACE_HANDLE;
+    }
+    if (m_thread.joinable()) m_thread.join();
+
+    std::cout << "[ETW] Stopped. Received: " << receivedCount() << ", Lost: " << lostCount() << std::endl;
+    if (lostCount() > 0) {
+        std::cerr << "[ETW] ⚠️ ETW dropped events: raise etw.max_buffers / buffer_kb" << std::endl;
+    }
+}
+
+void EtwConsumer::processLoop() {
+    std::cout << "[ETW] Consumer thread started (" << m_providers.size() << " provider(s))" << std::endl;
+
+    // Blocks, calling eventCallback, until the session stops
+    ULONG status = ProcessTrace(&m_trace, 1, NULL, NULL);
+    if (status != ERROR_SUCCESS && status != ERROR_CANCELLED && m_running) {
+        LOG_ERROR("ETW") << "ProcessTrace ended (Error: " << status << ")";
+    }
+}
+
+// ============================================
+// Events (ProcessTrace thread)
+// ============================================
+void WINAPI EtwConsumer::eventCallback(PEVENT_RECORD record) {
+    EtwConsumer* self = static_cast<EtwConsumer*>(record->UserContext);
+    try {
+        self->onEvent(record);
+    } catch (const std::exception& e) {
+        LOG_ERROR("ETW") << "❌ Exception in event callback: " << e.what();
+    }
+}
+
+void EtwConsumer::onEvent(PEVENT_RECORD record) {
+    // Anything else (e.g. the session's own header event) is not ours
+    size_t index = 0;
+    while (index < m_providers.size() && !sameGuid(m_providers[index]->guid, record->EventHeader.ProviderId)) index++;
+    if (index == m_providers.size()) return;
+
+    m_received.fetch_add(1, std::memory_order_relaxed);
+    Metrics::Timer timer(Stage::Render);
+
+    const Schema* schema = schemaFor(record, index);
+    if (schema == nullptr || schema->spec == nullptr) return;   // An ID we do not convert
+
+    RenderedEvent rendered;
+    RenderedValues& values = rendered.values;
+    values.eventId = schema->eventId;
+    values.timeCreated = (uint64_t)record->EventHeader.TimeStamp.QuadPart;
+    values.spec = schema->spec;
+    values.count = (uint8_t)SysmonSchema::fieldCount(*schema->spec);
+
+    bool decoded = schema->fallback ? decodeFallback(record, *schema, values) : decode(record, *schema, values);
+    if (!decoded) {
+        LOG_DEBUG("ETW") << "Event " << record->EventHeader.EventDescriptor.Id << " does not match its schema";
+        return;
+    }
+    if (schema->protocolSlot >= 0) appendSlot(values, (size_t)schema->protocolSlot, schema->protocol);
+    appendSlot(values, RenderedValues::ComputerSlot, m_computer);
+    appendSlot(values, RenderedValues::ChannelSlot, m_providers[index]->channel);
+
+    rendered.format = RenderFormat::Values;
+    rendered.eventId = values.eventId;
+    rendered.source = SOURCE_INDEX;
+    timer.stop();
+
+    m_pipeline.submit(std::move(rendered));
+}
+
+const EtwConsumer::Schema* EtwConsumer::schemaFor(PEVENT_RECORD record, size_t providerIndex) {
+    const EVENT_DESCRIPTOR& descriptor = record->EventHeader.EventDescriptor;
+    uint64_t key = ((uint64_t)providerIndex << 32) | ((uint64_t)descriptor.Id << 8) | descriptor.Version;
+
+    auto it = m_schemas.find(key);
+    if (it != m_schemas.end()) return it->second.get();
+
+    // First sight of this (provider, ID, version); unhandled ones are cached too
+    std::unique_ptr<Schema> schema = buildSchema(record, *m_providers[providerIndex]);
+    const Schema* result = schema.get();
+    m_schemas.emplace(key, std::move(schema));
+    return result;
+}
+
+std::unique_ptr<EtwConsumer::Schema> EtwConsumer::buildSchema(PEVENT_RECORD record, const EtwProviderInfo& provider) {
+    auto schema = std::make_unique<Schema>();
+    USHORT etwId = record->EventHeader.EventDescriptor.Id;
+
+    const EventMap* map = nullptr;
+    int sysmonId = etwId;
+    if (!provider.sysmonLayout) {
+        for (const EventMap& candidate : provider.events) {
+            if (candidate.sysmonId != 0 && candidate.etwId == etwId) map = &candidate;
+        }
+        if (map == nullptr) return schema;
+        sysmonId = map->sysmonId;
+    }
+
+    const SysmonSchema::EventSpec* spec = SysmonSchema::findEvent(sysmonId);
+    if (spec == nullptr) return schema;
+
+    ULONG size = (ULONG)m_infoBuffer.size();
+    ULONG status = TdhGetEventInformation(record, 0, NULL, reinterpret_cast<PTRACE_EVENT_INFO>(m_infoBuffer.data()), &size);
+    if (status == ERROR_INSUFFICIENT_BUFFER) {
+        m_infoBuffer.resize(size);
+        status = TdhGetEventInformation(record, 0, NULL, reinterpret_cast<PTRACE_EVENT_INFO>(m_infoBuffer.data()), &size);
+    }
+    if (status != ERROR_SUCCESS) {
+        LOG_WARN("ETW") << "No schema for " << provider.name << " event " << etwId << " (Error: " << status << ")";
+        return schema;
+    }
+
+    const auto* info = reinterpret_cast<const TRACE_EVENT_INFO*>(m_infoBuffer.data());
+    bool walking = true;
+    for (ULONG i = 0; i < info->TopLevelPropertyCount; i++) {
+        const EVENT_PROPERTY_INFO& epi = info->EventPropertyInfoArray[i];
+        Property property;
+        property.flags = (USHORT)epi.Flags;
+        property.length = epi.length;
+        if (!(epi.Flags & PropertyStruct)) {
+            property.inType = epi.nonStructType.InType;
+            property.outType = epi.nonStructType.OutType;
+        }
+        const wchar_t* wideName = reinterpret_cast<const wchar_t*>(m_infoBuffer.data() + epi.NameOffset);
+        property.name = wideName;
+
+        std::string name;
+        wideToUtf8(property.name.c_str(), property.name.size(), name);
+        if (provider.sysmonLayout) {
+            property.slot = slotOf(*spec, name);
+        } else {
+            for (const FieldMap& field : map->fields) {
+                if (field.etwName != nullptr && name == field.etwName) property.slot = slotOf(*spec, field.field);
+            }
+        }
+
+        // The walk stops at the first property whose size it cannot work out up front
+        bool fixedCount = (epi.Flags & PropertyParamCount) == 0 && epi.count <= 1;
+        bool lengthKnown = (epi.Flags & PropertyParamLength) == 0 || epi.lengthPropertyIndex < i;
+        walking = walking && !(epi.Flags & PropertyStruct) && fixedCount && lengthKnown;
+        if (walking) schema->walkable++;
+
+        if (property.slot >= 0) {
+            schema->kept++;
+            if (!walking) schema->fallback = true;
+        }
+        schema->properties.push_back(std::move(property));
+    }
+
+    if (map != nullptr && map->protocol != nullptr) {
+        schema->protocolSlot = slotOf(*spec, "Protocol");
+        schema->protocol = map->protocol;
+    }
+    schema->spec = spec;
+    schema->eventId = sysmonId;
+
+    LOG_DEBUG("ETW") << "Cached schema for " << provider.name << " event " << etwId
+                     << " v" << (int)record->EventHeader.EventDescriptor.Version << ": "
+                     << schema->kept << " field(s)" << (schema->fallback ? " (TdhGetProperty)" : "");
+    return schema;
+}
+
+// ============================================
+// Decoding
+// ============================================
+namespace {
+    // Bytes the property takes in UserData, NO_SIZE if it cannot be known
+    size_t propertySize(USHORT inType, USHORT flags, USHORT length, const BYTE* data, const BYTE* end,
+                        size_t pointerSize, const std::vector<uint64_t>& integers) {
+        size_t available = (size_t)(end - data);
+        size_t paramLength = (flags & PropertyParamLength) ? (size_t)integers[length] : length;
+
+        switch (inType) {
+            case TDH_INTYPE_INT8:  case TDH_INTYPE_UINT8:  return 1;
+            case TDH_INTYPE_INT16: case TDH_INTYPE_UINT16: return 2;
+            case TDH_INTYPE_INT32: case TDH_INTYPE_UINT32: case TDH_INTYPE_HEXINT32:
+            case TDH_INTYPE_FLOAT: case TDH_INTYPE_BOOLEAN: return 4;
+            case TDH_INTYPE_INT64: case TDH_INTYPE_UINT64: case TDH_INTYPE_HEXINT64:
+            case TDH_INTYPE_DOUBLE: case TDH_INTYPE_FILETIME: return 8;
+            case TDH_INTYPE_POINTER: case TDH_INTYPE_SIZET: return pointerSize;
+            case TDH_INTYPE_GUID: case TDH_INTYPE_SYSTEMTIME: return 16;
+
+            case TDH_INTYPE_UNICODESTRING: {
+                if (paramLength > 0) return paramLength * sizeof(wchar_t);
+                size_t chars = wideLength(data, available);
+                return std::min(available, (chars + 1) * sizeof(wchar_t));   // With the terminator
+            }
+            case TDH_INTYPE_ANSISTRING: {
+                if (paramLength > 0) return paramLength;
+                const void* terminator = std::memchr(data, 0, available);
+                return terminator ? (size_t)((const BYTE*)terminator - data) + 1 : available;
+            }
+            case TDH_INTYPE_BINARY:
+                return paramLength;
+            case TDH_INTYPE_SID:
+                return available >= 8 ? 8 + 4 * (size_t)data[1] : NO_SIZE;
+            case TDH_INTYPE_WBEMSID:
+                // TOKEN_USER (two pointers) in front of the SID
+                return available >= 2 * pointerSize + 8 ? 2 * pointerSize + 8 + 4 * (size_t)data[2 * pointerSize + 1] : NO_SIZE;
+            default:
+                return NO_SIZE;
+        }
+    }
+
+    void storeText(RenderedValues& values, size_t slot, USHORT inType, USHORT outType, const BYTE* data, size_t size) {
+        values.offset[slot] = (uint32_t)values.strings.size();
+
+        if (inType == TDH_INTYPE_UNICODESTRING) {
+            wideToUtf8(reinterpret_cast<const wchar_t*>(data), wideLength(data, size), values.strings);
+        } else if (inType == TDH_INTYPE_ANSISTRING) {
+            const void* terminator = std::memchr(data, 0, size);
+            size_t length = terminator ? (size_t)((const BYTE*)terminator - data) : size;
+            values.strings += sanitizeUtf8(std::string(reinterpret_cast<const char*>(data), length));
+        } else if (size == 4 && outType == TDH_OUTTYPE_IPV4) {
+            // Network order: the bytes are the dotted quad
+            char text[16];
+            snprintf(text, sizeof(text), "%u.%u.%u.%u", data[0], data[1], data[2], data[3]);
+            values.strings += text;
+        } else if (size == 16 && (outType == TDH_OUTTYPE_IPV6 || inType == TDH_INTYPE_BINARY)) {
+            char text[64];
+            if (InetNtopA(AF_INET6, data, text, sizeof(text)) != nullptr) values.strings += text;
+        } else if (isInteger(inType)) {
+            values.strings += isSigned(inType) ? std::to_string(readSigned(data, size))
+                                               : std::to_string(readUnsigned(data, size, outType));
+        }
+
+        values.length[slot] = (uint32_t)(values.strings.size() - values.offset[slot]);
+    }
+
+    int toInt(USHORT inType, USHORT outType, const BYTE* data, size_t size) {
+        if (isInteger(inType)) {
+            return isSigned(inType) ? (int)readSigned(data, size) : (int)readUnsigned(data, size, outType);
+        }
+        if (inType == TDH_INTYPE_UNICODESTRING) {
+            const wchar_t* text = reinterpret_cast<const wchar_t*>(data);
+            int value = 0;
+            for (size_t i = 0, n = wideLength(data, size); i < n && text[i] >= L'0' && text[i] <= L'9'; i++) {
+                value = value * 10 + (text[i] - L'0');
+            }
+            return value;
+        }
+        return 0;
+    }
+
+    void store(RenderedValues& values, const SysmonSchema::EventSpec& spec, size_t slot,
+               USHORT inType, USHORT outType, const BYTE* data, size_t size) {
+        if (spec.fields[slot]->number) {
+            values.ints[slot] = toInt(inType, outType, data, size);
+        } else {
+            storeText(values, slot, inType, outType, data, size);
+        }
+    }
+}
+
+bool EtwConsumer::decode(PEVENT_RECORD record, const Schema& schema, RenderedValues& values) {
+    const BYTE* data = static_cast<const BYTE*>(record->UserData);
+    const BYTE* end = data + record->UserDataLength;
+    size_t pointerSize = (record->EventHeader.Flags & EVENT_HEADER_FLAG_32_BIT_HEADER) ? 4 : 8;
+
+    m_integers.assign(schema.walkable, 0);
+    size_t remaining = schema.kept;
+
+    for (size_t i = 0; i < schema.walkable && remaining > 0; i++) {
+        const Property& property = schema.properties[i];
+        size_t size = propertySize(property.inType, property.flags, property.length, data, end, pointerSize, m_integers);
+        if (size == NO_SIZE || size > (size_t)(end - data)) return false;
+
+        if (isInteger(property.inType)) m_integers[i] = readUnsigned(data, size, TDH_OUTTYPE_NULL);
+        if (property.slot >= 0) {
+            store(values, *schema.spec, (size_t)property.slot, property.inType, property.outType, data, size);
+            remaining--;
+        }
+        data += size;
+    }
+    return true;
+}
+
+bool EtwConsumer::decodeFallback(PEVENT_RECORD record, const Schema& schema, RenderedValues& values) {
+    for (const Property& property : schema.properties) {
+        if (property.slot < 0) continue;
+
+        PROPERTY_DATA_DESCRIPTOR descriptor = {};
+        descriptor.PropertyName = (ULONGLONG)property.name.c_str();
+        descriptor.ArrayIndex = ULONG_MAX;
+
+        ULONG size = 0;
+        if (TdhGetPropertySize(record, 0, NULL, 1, &descriptor, &size) != ERROR_SUCCESS) continue;
+        if (m_propertyBuffer.size() < size) m_propertyBuffer.resize(size);
+        if (TdhGetProperty(record, 0, NULL, 1, &descriptor, size, m_propertyBuffer.data()) != ERROR_SUCCESS) continue;
+
+        store(values, *schema.spec, (size_t)property.slot, property.inType, property.outType,
+              m_propertyBuffer.data(), size);
+    }
+    return true;
+}
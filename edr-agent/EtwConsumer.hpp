@@ -0,0 +1,143 @@
+#ifndef ETWCONSUMER_HPP
+#define ETWCONSUMER_HPP
+
+#include <Windows.h>
+#include <evntrace.h>
+#include <evntcons.h>
+
+#include "EventPipeline.hpp"
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#pragma comment(lib, "advapi32.lib")
+#pragma comment(lib, "tdh.lib")
+
+// ============================================================
+// ETW Consumer
+// ============================================================
+// Real-time ingestion engine that skips the Event Log service: one
+// private ETW session with the configured providers enabled, consumed
+// with ProcessTrace on its own thread.
+//
+//   provider --ETW buffers--> ProcessTrace thread --decode--> pipeline.submit()
+//
+// Events are decoded with TDH into the same RenderedValues the values
+// renderer produces, so workers and the converter cannot tell the two
+// engines apart. TdhGetEventInformation runs once per (provider, ID,
+// version); the schema it returns is cached as a flat layout (in-type and
+// destination slot per property) and later events are decoded by walking
+// UserData against it. Layouts the walk cannot follow (structs, arrays)
+// fall back to TdhGetProperty for just the fields we keep.
+//
+// Known providers, and what their events become:
+//   Microsoft-Windows-Sysmon          same IDs and field names as the channel
+//   Microsoft-Windows-Kernel-Process  1 -> 1 (process create), 2 -> 5 (exit)
+//   Microsoft-Windows-Kernel-Network  12/28 -> 3 (TCP connect, IPv4/IPv6)
+//
+// ETW has no record IDs, so these sources are not bookmarked: events
+// raised while the agent is down are not replayed.
+// ============================================================
+
+struct EtwProviderInfo;   // Row of the known-provider table
+
+struct EtwSource {
+    std::string provider;        // Provider name; a channel name ("Microsoft-Windows-Sysmon/Operational") also works
+    UCHAR level = 5;             // TRACE_LEVEL_VERBOSE
+    ULONGLONG keywords = 0;      // MatchAnyKeyword; 0 = the provider's default from the table
+};
+
+struct EtwConfig {
+    std::string sessionName = "EDR-Agent-ETW";
+    unsigned bufferKb = 256;     // Per buffer
+    unsigned minBuffers = 16;
+    unsigned maxBuffers = 128;   // Headroom for bursts before ETW starts losing events
+    unsigned flushTimerS = 1;    // Upper bound on latency for a quiet provider
+};
+
+class EtwConsumer {
+public:
+    EtwConsumer(EventPipeline& pipeline, const EtwConfig& config);
+    ~EtwConsumer();
+
+    EtwConsumer(const EtwConsumer&) = delete;
+    EtwConsumer& operator=(const EtwConsumer&) = delete;
+
+    // Starts the session with every known provider among sources; returns how many were enabled
+    size_t start(const std::vector<EtwSource>& sources);
+
+    // Stops the session; no more events reach the pipeline afterwards
+    void stop();
+
+    uint64_t receivedCount() const { return m_received.load(std::memory_order_relaxed); }
+    uint64_t lostCount() const { return m_lost.load(std::memory_order_relaxed); }
+
+    // The event_processor.source entries with "engine": "etw"
+    static std::vector<EtwSource> parseSources(const nlohmann::json& sources);
+
+    // Not a BookmarkStore index: ETW events carry no record ID
+    static constexpr uint32_t SOURCE_INDEX = 0xFFFFFFFF;
+
+private:
+    // One property of a cached schema
+    struct Property {
+        USHORT inType = 0;
+        USHORT outType = 0;
+        USHORT flags = 0;
+        USHORT length = 0;           // Fixed length, or the index of the property holding it
+        int slot = -1;               // RenderedValues slot; -1 = not kept
+        std::wstring name;           // For the TdhGetProperty fallback
+    };
+
+    struct Schema {
+        const SysmonSchema::EventSpec* spec = nullptr;   // null = event not handled
+        int eventId = 0;             // Sysmon event ID it becomes
+        int protocolSlot = -1;       // Slot filled from the table, not the event
+        const char* protocol = nullptr;
+        size_t walkable = 0;         // Leading properties the walk can follow
+        size_t kept = 0;             // Properties with a slot
+        bool fallback = false;       // A kept property lies beyond the walkable ones
+        std::vector<Property> properties;
+    };
+
+    static void WINAPI eventCallback(PEVENT_RECORD record);
+    void onEvent(PEVENT_RECORD record);
+    const Schema* schemaFor(PEVENT_RECORD record, size_t providerIndex);
+    std::unique_ptr<Schema> buildSchema(PEVENT_RECORD record, const EtwProviderInfo& provider);
+
+    // Decodes the kept properties into values; false if UserData does not match the schema
+    bool decode(PEVENT_RECORD record, const Schema& schema, RenderedValues& values);
+    bool decodeFallback(PEVENT_RECORD record, const Schema& schema, RenderedValues& values);
+
+    void processLoop();
+    bool stopSession();   // Also used on a session a previous run left behind
+
+    EventPipeline& m_pipeline;
+    EtwConfig m_config;
+    std::wstring m_sessionName;
+    std::string m_computer;
+
+    std::vector<const EtwProviderInfo*> m_providers;   // Enabled, matched on ProviderId
+
+    // ProcessTrace thread only
+    std::unordered_map<uint64_t, std::unique_ptr<Schema>> m_schemas;
+    std::vector<BYTE> m_infoBuffer;
+    std::vector<BYTE> m_propertyBuffer;
+    std::vector<uint64_t> m_integers;   // Earlier integer properties, for lengths taken from them
+
+    TRACEHANDLE m_session = 0;
+    TRACEHANDLE m_trace = INVALID_PROCESSTRACE_HANDLE;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+
+    std::atomic<uint64_t> m_received{0};
+    std::atomic<uint64_t> m_lost{0};
+};
+
+#endif // ETWCONSUMER_HPP
@@ -0,0 +1,201 @@
+#include "EventAggregator.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// FNV-1a, folded one field at a time
+static const uint64_t FNV_OFFSET = 1469598103934665603ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+EventAggregator::EventAggregator(const AggregationConfig& config)
+    : m_config(config)
+{
+    if (m_config.maxEntries == 0) m_config.maxEntries = 1;
+
+    size_t capacity = 16;
+    while (capacity < m_config.maxEntries * 2) capacity <<= 1;
+    m_table.resize(capacity);
+    m_mask = capacity - 1;
+
+    for (const auto& typeKeys : m_config.keys) {
+        EventFamily family = TelemetryEvent::parseFamily(typeKeys.first);
+        if (family == EventFamily::None) {
+            std::cerr << "[Aggregator] Unknown event type '" << typeKeys.first << "', not aggregated" << std::endl;
+            continue;
+        }
+
+        std::vector<KeySpec> specs;
+        for (const std::string& field : typeKeys.second) {
+            KeySpec spec;
+            std::string path = field;
+            size_t colon = path.find(':');
+            if (colon != std::string::npos) {
+                std::string part = path.substr(colon + 1);
+                if (part == "dir") spec.part = KeySpec::Directory;
+                else if (part == "ext") spec.part = KeySpec::Extension;
+                else std::cerr << "[Aggregator] Unknown key modifier '" << part << "' in " << field << std::endl;
+                path = path.substr(0, colon);
+            }
+            spec.field = TelemetryEvent::lookup(family, path);
+            if (spec.field.kind == TelemetryEvent::FieldRef::Missing) {
+                std::cerr << "[Aggregator] Unknown key field '" << path << "' for " << typeKeys.first << std::endl;
+            }
+            specs.push_back(spec);
+        }
+        m_keys.emplace_back(family, std::move(specs));
+    }
+}
+
+// ============================================
+// Keys
+// ============================================
+const std::vector<EventAggregator::KeySpec>* EventAggregator::keysFor(const TelemetryEvent& event) const {
+    for (const auto& typeKeys : m_keys) {
+        if (typeKeys.first == event.family) return &typeKeys.second;
+    }
+    return nullptr;
+}
+
+uint64_t EventAggregator::hashKey(const TelemetryEvent& event, uint32_t source, const std::vector<KeySpec>& keys) {
+    uint64_t hash = fnv1a(FNV_OFFSET, &source, sizeof(source));
+    const char* type = event.typeName();
+    hash = fnv1a(hash, type, std::strlen(type));
+
+    for (const KeySpec& spec : keys) {
+        // Separator keeps ("ab","c") and ("a","bc") apart
+        hash = fnv1a(hash, "\x1f", 1);
+
+        std::string_view view;
+        long long number = 0;
+        TelemetryEvent::FieldRef::Kind kind = event.value(spec.field, view, number);
+        if (kind == TelemetryEvent::FieldRef::Missing) continue;
+
+        if (kind == TelemetryEvent::FieldRef::Integer) {
+            hash = fnv1a(hash, &number, sizeof(number));
+            continue;
+        }
+        if (spec.part != KeySpec::Whole) {
+            size_t slash = view.find_last_of("\\/");
+            if (spec.part == KeySpec::Directory) {
+                view = (slash == std::string_view::npos) ? std::string_view() : view.substr(0, slash);
+            } else {
+                std::string_view name = (slash == std::string_view::npos) ? view : view.substr(slash + 1);
+                size_t dot = name.rfind('.');
+                view = (dot == std::string_view::npos) ? std::string_view() : name.substr(dot);
+            }
+        }
+        hash = fnv1a(hash, view.data(), view.size());
+    }
+
+    return hash == 0 ? 1 : hash;   // 0 marks an empty slot
+}
+
+// ============================================
+// Window
+// ============================================
+bool EventAggregator::offer(TelemetryEvent& event, uint32_t source, uint64_t recordId, Clock::time_point now) {
+    const std::vector<KeySpec>* keys = keysFor(event);
+    if (keys == nullptr) return false;
+
+    uint64_t key = hashKey(event, source, *keys);
+    long long seen = event.timestampUs / 1000000;
+
+    size_t index = key & m_mask;
+    while (m_table[index].key != 0) {
+        Entry& entry = m_table[index];
+        if (entry.key == key) {
+            entry.count++;
+            entry.lastSeen = std::max(entry.lastSeen, seen);
+            entry.lastRecordId = std::max(entry.lastRecordId, recordId);
+            m_absorbed++;
+            return true;
+        }
+        index = (index + 1) & m_mask;
+    }
+
+    // New key. A full table lets it through rather than growing.
+    if (m_size >= m_config.maxEntries) return false;
+
+    Entry& entry = m_table[index];
+    entry.key = key;
+    entry.event = std::move(event);
+    entry.source = source;
+    entry.firstRecordId = recordId;
+    entry.lastRecordId = recordId;
+    entry.count = 1;
+    entry.firstSeen = seen;
+    entry.lastSeen = seen;
+    entry.deadline = now + std::chrono::milliseconds(m_config.windowMs);
+    m_size++;
+    m_nextExpiry = std::min(m_nextExpiry, entry.deadline);
+    return true;
+}
+
+void EventAggregator::collectExpired(Clock::time_point now, const Emit& emit, bool flushAll) {
+    if (m_size == 0 || (!flushAll && now < m_nextExpiry)) return;
+
+    Clock::time_point next = Clock::time_point::max();
+    size_t index = 0;
+    while (index < m_table.size()) {
+        Entry& entry = m_table[index];
+        if (entry.key != 0 && (flushAll || entry.deadline <= now)) {
+            emitEntry(entry, emit);
+            erase(index);
+            continue;   // erase() may have shifted another entry into this slot
+        }
+        if (entry.key != 0) next = std::min(next, entry.deadline);
+        index++;
+    }
+    m_nextExpiry = (m_size == 0) ? Clock::time_point::max() : next;
+}
+
+void EventAggregator::emitEntry(Entry& entry, const Emit& emit) {
+    if (entry.count > 1) {
+        entry.event.aggregateCount = entry.count;
+        entry.event.firstSeen = entry.firstSeen;
+        entry.event.lastSeen = entry.lastSeen;
+    }
+    m_emitted++;
+    emit(std::move(entry.event), entry.source, entry.lastRecordId);
+}
+
+void EventAggregator::erase(size_t index) {
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole so lookups never need tombstones
+    size_t hole = index;
+    size_t next = (hole + 1) & m_mask;
+    while (m_table[next].key != 0) {
+        size_t home = m_table[next].key & m_mask;
+        // Move it if its home slot is not in (hole, next]
+        bool movable = (hole <= next) ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            m_table[hole] = std::move(m_table[next]);
+            hole = next;
+        }
+        next = (next + 1) & m_mask;
+    }
+    m_table[hole].key = 0;
+    m_table[hole].event = TelemetryEvent();
+    m_size--;
+}
+
+uint64_t EventAggregator::heldFloor(uint32_t source) const {
+    if (m_size == 0) return 0;
+
+    uint64_t floor = 0;
+    for (const Entry& entry : m_table) {
+        if (entry.key == 0 || entry.source != source || entry.firstRecordId == 0) continue;
+        if (floor == 0 || entry.firstRecordId < floor) floor = entry.firstRecordId;
+    }
+    return floor;
+}
@@ -0,0 +1,106 @@
+#ifndef EVENTAGGREGATOR_HPP
+#define EVENTAGGREGATOR_HPP
+
+#include "TelemetryEvent.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// Event Aggregator
+// ============================================================
+// Collapses bursts of near-identical converted events (a browser opening
+// 200 connections to one CDN IP:443, a build writing thousands of .obj
+// files) into one record per key and window:
+//
+//   first event of a key --> held, window starts
+//   same key within window --> count++, last_seen updated, event discarded
+//   window expired        --> first event + "aggregation": {count, first_seen, last_seen}
+//
+// The key is a 64-bit hash of source + event_type + the configured fields
+// for that event_type. A field is a dotted path into the converted event
+// ("network.dest_ip"), resolved to a TelemetryEvent field once at startup;
+// ":dir" / ":ext" take the directory or extension of a path ("file.path:ext"). Entries live in a fixed open-addressing table
+// (linear probing, backward-shift deletion), so memory is bounded by
+// maxEntries; when it is full, new keys pass through unaggregated.
+//
+// Not thread-safe: owned and driven by the pipeline's sender thread.
+// ============================================================
+
+struct AggregationConfig {
+    bool enabled = false;
+    unsigned windowMs = 10000;
+    size_t maxEntries = 4096;
+    // event_type -> key fields; event types not listed are never aggregated
+    std::vector<std::pair<std::string, std::vector<std::string>>> keys;
+};
+
+class EventAggregator {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Emit = std::function<void(TelemetryEvent&& event, uint32_t source, uint64_t recordId)>;
+
+    explicit EventAggregator(const AggregationConfig& config);
+
+    // true = absorbed into the window (event is moved from); false = pass it on
+    bool offer(TelemetryEvent& event, uint32_t source, uint64_t recordId, Clock::time_point now);
+
+    // Emits every aggregate whose window has expired (all of them when flushAll);
+    // aggregateCount/firstSeen/lastSeen are set when the window absorbed repeats
+    void collectExpired(Clock::time_point now, const Emit& emit, bool flushAll = false);
+
+    // Windows opened from now on last windowMs; open ones keep their deadline
+    void setWindowMs(unsigned windowMs) { m_config.windowMs = windowMs; }
+    unsigned windowMs() const { return m_config.windowMs; }
+
+    // When the next window closes (time_point::max() when nothing is held)
+    Clock::time_point nextExpiry() const { return m_nextExpiry; }
+
+    // Lowest EventRecordID still held for a source (0 = none); the bookmark must stay below it
+    uint64_t heldFloor(uint32_t source) const;
+
+    size_t size() const { return m_size; }
+    uint64_t absorbedCount() const { return m_absorbed; }
+    uint64_t emittedCount() const { return m_emitted; }
+
+private:
+    struct KeySpec {
+        enum Part { Whole, Directory, Extension };
+        TelemetryEvent::FieldRef field;
+        Part part = Whole;
+    };
+
+    struct Entry {
+        uint64_t key = 0;               // 0 = empty slot
+        TelemetryEvent event;           // First event of the window
+        uint32_t source = 0;
+        uint64_t firstRecordId = 0;
+        uint64_t lastRecordId = 0;
+        uint32_t count = 0;
+        long long firstSeen = 0;        // Event timestamps (Unix seconds)
+        long long lastSeen = 0;
+        Clock::time_point deadline;
+    };
+
+    const std::vector<KeySpec>* keysFor(const TelemetryEvent& event) const;
+    static uint64_t hashKey(const TelemetryEvent& event, uint32_t source, const std::vector<KeySpec>& keys);
+    void erase(size_t index);
+    void emitEntry(Entry& entry, const Emit& emit);
+
+    AggregationConfig m_config;
+    std::vector<std::pair<EventFamily, std::vector<KeySpec>>> m_keys;
+
+    std::vector<Entry> m_table;         // Power-of-two capacity, at most half full
+    size_t m_mask = 0;
+    size_t m_size = 0;
+    Clock::time_point m_nextExpiry = Clock::time_point::max();
+
+    uint64_t m_absorbed = 0;
+    uint64_t m_emitted = 0;
+};
+
+#endif // EVENTAGGREGATOR_HPP
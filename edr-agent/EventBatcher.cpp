@@ -0,0 +1,106 @@
+#include "EventBatcher.hpp"
+
+#include <iostream>
+
+EventBatcher::EventBatcher(const BatchConfig& config)
+    : m_config(config)
+{
+    if (m_config.maxEvents == 0) m_config.maxEvents = 1;
+    m_scratch.reserve(4 * 1024);
+    if (m_config.streamCompression) {
+        m_compressed.reserve(m_config.maxBytes + 64 * 1024);
+    } else {
+        m_body.reserve(64 * 1024);
+    }
+}
+
+void EventBatcher::write(const char* data, size_t size) {
+    m_rawBytes += size;
+    if (!m_config.streamCompression) {
+        m_body.append(data, size);
+    } else if (m_streamOk) {
+        m_streamOk = m_stream.write(data, size);
+    }
+}
+
+void EventBatcher::add(const TelemetryEvent& event) {
+    if (m_count == 0) {
+        m_firstEventTime = Clock::now();
+        if (m_config.streamCompression) {
+            m_streamOk = m_stream.begin(m_compressed);
+        }
+    }
+
+    if (binary()) {
+        m_scratch.clear();
+        if (m_count == 0) m_encoder.begin(event, m_scratch);
+        m_encoder.encode(event, m_scratch);
+    } else {
+        m_scratch.assign(m_count == 0 ? "[" : ",");
+        event.writeJson(m_scratch);
+    }
+    write(m_scratch.data(), m_scratch.size());
+    m_count++;
+}
+
+FlushReason EventBatcher::shouldFlush(Clock::time_point now) const {
+    if (m_count == 0) return FlushReason::None;
+    if (m_count >= m_config.maxEvents) return FlushReason::Events;
+    if (estimatedCompressedBytes() >= m_config.maxBytes) return FlushReason::Bytes;
+    if (now - m_firstEventTime >= std::chrono::milliseconds(m_config.maxDelayMs)) return FlushReason::Timeout;
+    return FlushReason::None;
+}
+
+std::chrono::milliseconds EventBatcher::timeUntilDeadline(Clock::time_point now) const {
+    if (m_count == 0) return std::chrono::milliseconds(m_config.maxDelayMs);
+
+    auto deadline = m_firstEventTime + std::chrono::milliseconds(m_config.maxDelayMs);
+    if (now >= deadline) return std::chrono::milliseconds(0);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+}
+
+bool EventBatcher::finish() {
+    if (!m_finished) {
+        if (!binary()) write("]", 1);
+        if (m_config.streamCompression && m_streamOk) {
+            m_streamOk = m_stream.end();
+            if (m_streamOk) recordCompression(m_rawBytes, m_compressed.size());
+        }
+        m_finished = true;
+    }
+    return !m_config.streamCompression || m_streamOk;
+}
+
+void EventBatcher::recordCompression(size_t rawBytes, size_t compressedBytes) {
+    if (rawBytes == 0 || compressedBytes == 0) return;
+    double observed = (double)compressedBytes / (double)rawBytes;
+    m_compressionRatio = 0.8 * m_compressionRatio + 0.2 * observed;
+}
+
+void EventBatcher::clear() {
+    // clear() keeps the capacity, so steady-state batches don't reallocate
+    m_body.clear();
+    m_compressed.clear();
+    m_count = 0;
+    m_rawBytes = 0;
+    m_finished = false;
+    m_streamOk = true;
+}
+
+size_t EventBatcher::estimatedCompressedBytes() const {
+    if (m_config.streamCompression) {
+        // What zstd already emitted, plus a guess for what it still holds
+        return m_compressed.size() + (size_t)((double)m_stream.bufferedInputBytes() * m_compressionRatio);
+    }
+    return (size_t)((double)m_body.size() * m_compressionRatio);
+}
+
+const char* EventBatcher::reasonName(FlushReason reason) {
+    switch (reason) {
+        case FlushReason::Events:   return "max_events";
+        case FlushReason::Bytes:    return "max_bytes";
+        case FlushReason::Timeout:  return "max_delay";
+        case FlushReason::Shutdown: return "shutdown";
+        default:                    return "none";
+    }
+}
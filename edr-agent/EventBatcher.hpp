@@ -0,0 +1,118 @@
+#ifndef EVENTBATCHER_HPP
+#define EVENTBATCHER_HPP
+
+#include "BinaryBatch.hpp"
+#include "TelemetryEvent.hpp"
+#include "SimpleZstd.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Event Batcher
+// ============================================================
+// Serializes converted events into a JSON array body and decides when
+// to flush. A batch is ready on whichever limit is hit first:
+//   - maxEvents events buffered
+//   - maxBytes estimated compressed bytes buffered
+//   - maxDelayMs since the first event of the batch was buffered
+//
+// With streamCompression (the default) each event is serialized into a
+// small scratch string and fed straight into a zstd stream, so the batch
+// only ever exists compressed, in a buffer reused from batch to batch.
+// Without it, events are appended to a plain body that the HTTP client
+// compresses on send, and the compressed size is estimated from the ratio
+// observed on previous batches.
+//
+// With format = Binary the body is a BinaryBatch (see BinaryBatch.hpp)
+// instead of a JSON array; both modes above work the same way.
+// ============================================================
+
+struct BatchConfig {
+    size_t maxEvents = 500;
+    size_t maxBytes = 256 * 1024;   // Compressed bytes on the wire
+    unsigned maxDelayMs = 2000;
+    bool streamCompression = true;
+    BatchFormat format = BatchFormat::Json;
+};
+
+enum class FlushReason {
+    None,
+    Events,
+    Bytes,
+    Timeout,
+    Shutdown
+};
+
+class EventBatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit EventBatcher(const BatchConfig& config);
+
+    // Serializes the event right away; it is not referenced afterwards
+    void add(const TelemetryEvent& event);
+
+    // Checks the three limits against the current batch
+    FlushReason shouldFlush(Clock::time_point now) const;
+
+    // Time left before the oldest buffered event hits maxDelayMs
+    std::chrono::milliseconds timeUntilDeadline(Clock::time_point now) const;
+
+    // Closes the JSON array (and the zstd frame when streaming). Returns
+    // false if compression failed and the batch cannot be sent.
+    bool finish();
+
+    // Valid after finish() until clear(): compressedBody() when compressed(), body() otherwise
+    bool compressed() const { return m_config.streamCompression; }
+    const std::string& body() const { return m_body; }
+    const std::vector<BYTE>& compressedBody() const { return m_compressed; }
+
+    // Content-Type for the body this batcher produces
+    bool binary() const { return m_config.format == BatchFormat::Binary; }
+    const wchar_t* contentType() const { return binary() ? EDR_BATCH_CONTENT_TYPE : EDR_JSON_CONTENT_TYPE; }
+
+    // Feeds the real compression result back into the size estimate
+    void recordCompression(size_t rawBytes, size_t compressedBytes);
+
+    void clear();
+
+    // Event limit for the next batch (rate control); 0 is taken as 1
+    void setMaxEvents(size_t maxEvents) { m_config.maxEvents = maxEvents == 0 ? 1 : maxEvents; }
+
+    // All three flush limits (config reload); format and compression mode stay
+    void setLimits(const BatchConfig& limits) {
+        setMaxEvents(limits.maxEvents);
+        m_config.maxBytes = limits.maxBytes;
+        m_config.maxDelayMs = limits.maxDelayMs;
+    }
+
+    bool empty() const { return m_count == 0; }
+    size_t count() const { return m_count; }
+    size_t rawBytes() const { return m_rawBytes; }
+    size_t estimatedCompressedBytes() const;
+
+    static const char* reasonName(FlushReason reason);
+
+private:
+    void write(const char* data, size_t size);
+
+    BatchConfig m_config;
+    std::string m_body;               // Uncompressed mode
+    ZstdStream m_stream;              // Streaming mode
+    std::vector<BYTE> m_compressed;
+    std::string m_scratch;            // One serialized event at a time
+    BinaryBatchEncoder m_encoder;     // Binary format
+    bool m_streamOk = true;
+
+    size_t m_count = 0;
+    size_t m_rawBytes = 0;
+    bool m_finished = false;
+    Clock::time_point m_firstEventTime;
+
+    // EWMA of compressed/raw; Django-format JSON compresses very well
+    double m_compressionRatio = 0.15;
+};
+
+#endif // EVENTBATCHER_HPP
@@ -1,176 +1,325 @@
 #include "EventConverter.hpp"
+#include "AgentIdentity.hpp"
+#include "Logger.hpp"
 #include <iostream>      // For std::cout, std::cerr
-#include <Windows.h>     // For GetComputerNameA, DWORD
-#include <random>
-#include <sstream>
-#include <iomanip>
 #include <chrono>
 #include <ctime>
+#include <cstring>
 
 std::string EventConverter::getHostname() {
-    char hostname[256];
-    DWORD size = sizeof(hostname);
-    if (GetComputerNameA(hostname, &size)) {
-        return std::string(hostname);
-    }
-    return "Unknown";
+    return AgentIdentity::agentId();
 }
 
-
-
-
-
 std::string EventConverter::generateEventId() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 15);
-    
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
-    for (int i = 0; i < 8; i++) ss << std::setw(1) << dis(gen);
-    ss << "-";
-    for (int i = 0; i < 4; i++) ss << std::setw(1) << dis(gen);
-    ss << "-";
-    for (int i = 0; i < 4; i++) ss << std::setw(1) << dis(gen);
-    ss << "-";
-    for (int i = 0; i < 4; i++) ss << std::setw(1) << dis(gen);
-    ss << "-";
-    for (int i = 0; i < 12; i++) ss << std::setw(1) << dis(gen);
-    
-    return ss.str();
+    return AgentIdentity::generateEventId();
 }
-// more sysmon process will be add here later
-std::string EventConverter::mapSysmonToEventType(int eventId) {
-    switch (eventId) {
-        case 1:  return "process";
-        case 3:  return "network";
-        case 5:  return "process";
-        case 11: return "file";
-        case 23: return "file";
-        default: return "unknown";
-    }
+
+// Event families come from SysmonSchema::SYSMON_EVENTS; add new IDs there
+const char* EventConverter::mapSysmonToEventType(int eventId) {
+    const SysmonSchema::EventSpec* spec = SysmonSchema::findEvent(eventId);
+    return spec ? TelemetryEvent::familyName(spec->family) : "unknown";
 }
 // here we will add the different severity level and we have to different severity level 
 // we will addd here different condition 
 // to do for the later 
-std::string EventConverter::determineSeverity(int eventId) {
+const char* EventConverter::determineSeverity(int eventId) {
     return "info";
 }
 
-time_t EventConverter::parseSystemTime(const std::string& systemTime) {
-    std::tm tm = {};
-    std::istringstream ss(systemTime);
-    ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
-    
-    if (ss.fail()) {
-        return std::time(nullptr);
+// ============================================
+// Timestamps
+// ============================================
+namespace {
+
+    constexpr uint64_t UNIX_EPOCH_TICKS = 116444736000000000ULL;   // 1970-01-01 in FILETIME ticks
+    constexpr uint64_t TICKS_PER_SECOND = 10000000ULL;
+
+    // Reads exactly count digits at pos
+    bool readDigits(std::string_view text, size_t pos, size_t count, unsigned& value) {
+        if (pos + count > text.size()) return false;
+        value = 0;
+        for (size_t i = pos; i < pos + count; i++) {
+            unsigned digit = (unsigned)(text[i] - '0');
+            if (digit > 9) return false;
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+    // Days since 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant's days_from_civil)
+    long long daysFromCivil(long long year, unsigned month, unsigned day) {
+        year -= month <= 2;
+        long long era = (year >= 0 ? year : year - 399) / 400;
+        unsigned yearOfEra = (unsigned)(year - era * 400);
+        unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + (long long)dayOfEra - 719468;
+    }
+
+    bool leapYear(unsigned year) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
     }
-    
-    return _mkgmtime(&tm);
 }
 
-nlohmann::json EventConverter::sysmonEventToDjangoFormat(const nlohmann::json& sysmonEvent) {
-    nlohmann::json djangoEvent;
-    
-    try {
-        if (!sysmonEvent.contains("info")) {
-            std::cerr << "[EventConverter] Missing 'info' field" << std::endl;
-            return djangoEvent;
+// "YYYY-MM-DDTHH:MM:SS[.fffffff...][Z|+HH:MM|-HH:MM]". Digits past the 7th
+// are below FILETIME resolution and truncated; no zone is taken as UTC,
+// which is what the event log writes.
+bool EventConverter::parseSystemTime(std::string_view systemTime, uint64_t& ticks) {
+    unsigned year, month, day, hour, minute, second;
+    if (!readDigits(systemTime, 0, 4, year) || systemTime.size() < 19 ||
+        systemTime[4] != '-' || !readDigits(systemTime, 5, 2, month) ||
+        systemTime[7] != '-' || !readDigits(systemTime, 8, 2, day) ||
+        (systemTime[10] != 'T' && systemTime[10] != ' ') || !readDigits(systemTime, 11, 2, hour) ||
+        systemTime[13] != ':' || !readDigits(systemTime, 14, 2, minute) ||
+        systemTime[16] != ':' || !readDigits(systemTime, 17, 2, second)) {
+        return false;
+    }
+
+    static const unsigned DAYS_IN_MONTH[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (year < 1601 || month < 1 || month > 12 || day < 1 || hour > 23 || minute > 59 || second > 60) return false;
+    if (day > DAYS_IN_MONTH[month - 1] + (month == 2 && leapYear(year) ? 1u : 0u)) return false;
+    if (second == 60) second = 59;   // Leap second: FILETIME has no slot for it
+
+    size_t pos = 19;
+    uint64_t fraction = 0;
+    if (pos < systemTime.size() && (systemTime[pos] == '.' || systemTime[pos] == ',')) {
+        pos++;
+        size_t digits = 0;
+        while (pos < systemTime.size() && (unsigned)(systemTime[pos] - '0') <= 9) {
+            if (digits < 7) fraction = fraction * 10 + (uint64_t)(systemTime[pos] - '0');
+            digits++;
+            pos++;
         }
-        
-        auto system = sysmonEvent["info"]["System"];
-        auto eventData = sysmonEvent["info"]["EventData"];
-        
-        int eventId = system.value("EventID", 0);
-        
-        std::cout << "[EventConverter] Processing Event ID: " << eventId << std::endl;
-        
-        // Skip Event ID 5 (termination)
-        if (eventId == 5) {
-            std::cout << "[EventConverter] Skipping Event ID 5 (termination)" << std::endl;
-            return djangoEvent;
+        if (digits == 0) return false;
+        for (size_t i = digits; i < 7; i++) fraction *= 10;
+    }
+
+    long long offsetSeconds = 0;
+    if (pos < systemTime.size()) {
+        char zone = systemTime[pos];
+        if (zone == 'Z' || zone == 'z') {
+            pos++;
+        } else if (zone == '+' || zone == '-') {
+            unsigned offsetHours, offsetMinutes;
+            if (!readDigits(systemTime, pos + 1, 2, offsetHours) || pos + 3 >= systemTime.size() ||
+                systemTime[pos + 3] != ':' || !readDigits(systemTime, pos + 4, 2, offsetMinutes) ||
+                offsetHours > 23 || offsetMinutes > 59) {
+                return false;
+            }
+            offsetSeconds = (long long)offsetHours * 3600 + offsetMinutes * 60;
+            if (zone == '+') offsetSeconds = -offsetSeconds;
+            pos += 6;
         }
-        
-        std::string eventType = mapSysmonToEventType(eventId);
-        
-        if (eventType == "unknown") {
-            std::cout << "[EventConverter] Unknown Event ID: " << eventId << std::endl;
-            return djangoEvent;
+        if (pos != systemTime.size()) return false;
+    }
+
+    long long unixSeconds = daysFromCivil(year, month, day) * 86400
+                          + (long long)hour * 3600 + minute * 60 + second + offsetSeconds;
+    ticks = (uint64_t)(unixSeconds * (long long)TICKS_PER_SECOND + (long long)UNIX_EPOCH_TICKS) + fraction;
+    return true;
+}
+
+long long EventConverter::ticksToUnixMicros(uint64_t ticks) {
+    return ((long long)ticks - (long long)UNIX_EPOCH_TICKS) / 10;
+}
+
+// ============================================
+// Field Extraction
+// ============================================
+bool EventConverter::extractFields(const pugi::xml_node& eventNode, EventFields& fields) {
+    if (!eventNode) return false;
+
+    for (pugi::xml_node section : eventNode.children()) {
+        const char* sectionName = section.name();
+
+        if (std::strcmp(sectionName, "System") == 0) {
+            for (pugi::xml_node child : section.children()) {
+                const SysmonSchema::SystemFieldName* entry = SysmonSchema::findSystemField(child.name());
+                if (entry == nullptr) continue;
+
+                switch (entry->field) {
+                    case SysmonSchema::SystemField::EventID:       fields.eventId = child.text().as_int(); break;
+                    case SysmonSchema::SystemField::EventRecordID: fields.recordId = child.text().as_ullong(); break;
+                    case SysmonSchema::SystemField::TimeCreated:   fields.systemTime = child.attribute("SystemTime").value(); break;
+                    case SysmonSchema::SystemField::Computer:      fields.computer = child.text().get(); break;
+                    case SysmonSchema::SystemField::Channel:       fields.channel = child.text().get(); break;
+                    default: break;
+                }
+            }
         }
-        
-        std::cout << "[EventConverter] Event Type: " << eventType << std::endl;
-        // ===== FIX: Use proper timestamp format =====
+        else if (std::strcmp(sectionName, "EventData") == 0) {
+            for (pugi::xml_node data : section.children()) {
+                const SysmonSchema::DataField* field = SysmonSchema::findDataField(data.attribute("Name").value());
+                if (field == nullptr) continue;
 
-         std::string systemTime = system["TimeCreated"]["SystemTime"];
-        time_t timestamp = parseSystemTime(systemTime);
-        
-        
-     
-        djangoEvent["agent_id"] = getHostname();
-        djangoEvent["event_id"] = generateEventId();
-        djangoEvent["event_type"] = eventType;
-        
-        djangoEvent["timestamp"] = timestamp;
+                if (field->number) SysmonSchema::store(*field, fields, data.text().as_int());
+                else SysmonSchema::store(*field, fields, std::string_view(data.text().get()));
+            }
+        }
+    }
 
+    return true;
+}
 
-        djangoEvent["severity"] = determineSeverity(eventId);
-        djangoEvent["version"] = "1.0";
-        
+bool EventConverter::fieldsToTelemetryEvent(const EventFields& fields, TelemetryEvent& event) {
+    event.reset();
 
-        // here we may need to add the different os_version here 
-        djangoEvent["host"] = {
-            {"hostname", system.value("Computer", "")},
-            {"os", "Windows"},
-            {"os_version", "11"}
-        };
+    try {
+        int eventId = fields.eventId;
+        
+        LOG_DEBUG("EventConverter") << "Processing Event ID: " << eventId;
         
-        if (eventType == "process" && eventId == 1) {
-            djangoEvent["process"] = {
-                {"name", eventData.value("Image", "")},
-                {"pid", eventData.value("ProcessId", 0)},
-                {"command_line", eventData.value("CommandLine", "")},
-                {"user", eventData.value("User", "")},
-                {"parent_image", eventData.value("ParentImage", "")},
-                {"action", "created"}
-            };
-            std::cout << "[EventConverter] Process: " << eventData.value("Image", "Unknown") << std::endl;
+        const SysmonSchema::EventSpec* spec = SysmonSchema::findEvent(eventId);
+        if (spec == nullptr) {
+            LOG_DEBUG("EventConverter") << "Unknown Event ID: " << eventId;
+            return false;
         }
-        else if (eventType == "network" && eventId == 3) {
-            djangoEvent["network"] = {
-                {"source_ip", eventData.value("SourceIp", "")},
-                {"source_port", eventData.value("SourcePort", 0)},
-                {"dest_ip", eventData.value("DestinationIp", "")},
-                {"dest_port", eventData.value("DestinationPort", 0)},
-                {"protocol", eventData.value("Protocol", "")},
-                {"image", eventData.value("Image", "")}
-            };
-            std::cout << "[EventConverter] Network: " 
-                      << eventData.value("DestinationIp", "Unknown") << ":" 
-                      << eventData.value("DestinationPort", 0) << std::endl;
+
+        // Rendered for bookkeeping only (e.g. 5, process termination)
+        if (spec->family == EventFamily::None) {
+            LOG_DEBUG("EventConverter") << "Skipping Event ID " << eventId;
+            return false;
         }
-        else if (eventType == "file" && (eventId == 11 || eventId == 23)) {
-            std::string operation = (eventId == 11) ? "created" : "deleted";
-            
-            djangoEvent["file"] = {
-                {"path", eventData.value("TargetFilename", "")},
-                {"operation", operation},
-                {"process_image", eventData.value("Image", "")}
-            };
-            std::cout << "[EventConverter] File: " << operation << " " 
-                      << eventData.value("TargetFilename", "Unknown") << std::endl;
+
+        LOG_DEBUG("EventConverter") << "Event Type: " << TelemetryEvent::familyName(spec->family);
+
+        // Room for every string this event carries, so the buffer grows at most once
+        event.buffer.reserve(128 + fields.image.size() + fields.commandLine.size() + fields.user.size() +
+                             fields.parentImage.size() + fields.targetFilename.size() + fields.computer.size());
+
+        // What each family sends is fixed; which IDs map to it (and the action) is in the table
+        event.family = spec->family;
+        event.action = spec->action;
+        switch (spec->family) {
+            case EventFamily::Process:
+                event.set(TelemetryEvent::Image, fields.image);
+                event.processId = fields.processId;
+                event.parentProcessId = fields.parentProcessId;
+                event.set(TelemetryEvent::CommandLine, fields.commandLine);
+                event.set(TelemetryEvent::User, fields.user);
+                event.set(TelemetryEvent::ParentImage, fields.parentImage);
+                LOG_DEBUG("EventConverter") << "Process: " << fields.image;
+                break;
+
+            case EventFamily::Network:
+                event.set(TelemetryEvent::SourceIp, fields.sourceIp);
+                event.sourcePort = fields.sourcePort;
+                event.set(TelemetryEvent::DestinationIp, fields.destinationIp);
+                event.destinationPort = fields.destinationPort;
+                event.set(TelemetryEvent::Protocol, fields.protocol);
+                event.set(TelemetryEvent::Image, fields.image);
+                LOG_DEBUG("EventConverter") << "Network: "
+                                            << fields.destinationIp << ":" << fields.destinationPort;
+                break;
+
+            case EventFamily::File:
+                event.set(TelemetryEvent::TargetFilename, fields.targetFilename);
+                event.set(TelemetryEvent::Image, fields.image);
+                LOG_DEBUG("EventConverter") << "File: " << event.action << " "
+                                            << fields.targetFilename;
+                break;
+
+            default:
+                LOG_WARN("EventConverter") << "Unhandled event: " << eventId;
+                event.reset();
+                return false;
         }
-        else {
-            std::cerr << "[EventConverter] Unhandled event: " << eventType << "/" << eventId << std::endl;
-            return djangoEvent;
+
+        // The values renderer hands over the FILETIME itself; XML carries SystemTime
+        uint64_t ticks = fields.timeCreated;
+        if (ticks == 0 && !parseSystemTime(fields.systemTime, ticks)) {
+            LOG_WARN("EventConverter") << "Unparseable SystemTime '" << fields.systemTime
+                                       << "' on event " << eventId << ", using receive time";
+            event.timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        } else {
+            event.timestampUs = ticksToUnixMicros(ticks);
         }
+
+        AgentIdentity::generateEventId(event.eventId);
+        event.set(TelemetryEvent::AgentId, AgentIdentity::agentId());
+        event.set(TelemetryEvent::Hostname, fields.computer);
+        event.severity = determineSeverity(eventId);
         
-        std::cout << "[EventConverter] ✓ Conversion successful" << std::endl;
+        LOG_DEBUG("EventConverter") << "✓ Conversion successful";
         
+    } catch (const std::exception& e) {
+        LOG_ERROR("EventConverter") << "ERROR: " << e.what();
+        event.reset();
+        return false;
+    }
+    
+    return true;
+}
+
+nlohmann::json EventConverter::fieldsToDjangoFormat(const EventFields& fields) {
+    TelemetryEvent event;
+    if (!fieldsToTelemetryEvent(fields, event)) {
+        return nlohmann::json();
+    }
+    return event.toJson();
+}
+
+// ============================================
+// Legacy Sysmon JSON adapter
+// ============================================
+// Reads the {"info": {"System", "EventData"}} layout by reference (no
+// subtree copies) and reuses the same builder as the XML path.
+nlohmann::json EventConverter::sysmonEventToDjangoFormat(const nlohmann::json& sysmonEvent) {
+    if (!sysmonEvent.contains("info")) {
+        std::cerr << "[EventConverter] Missing 'info' field" << std::endl;
+        return nlohmann::json();
+    }
+
+    try {
+        static const nlohmann::json EMPTY_OBJECT = nlohmann::json::object();
+        const nlohmann::json& info = sysmonEvent["info"];
+        auto section = [&info](const char* name) -> const nlohmann::json& {
+            auto it = info.find(name);
+            return (it != info.end() && it->is_object()) ? *it : EMPTY_OBJECT;
+        };
+        const nlohmann::json& system = section("System");
+        const nlohmann::json& eventData = section("EventData");
+
+        // One pass over each object; the schema tables say where every key goes
+        auto str = [](const nlohmann::json& value) -> std::string_view {
+            return value.is_string() ? std::string_view(value.get_ref<const std::string&>()) : std::string_view();
+        };
+        auto num = [](const nlohmann::json& value) -> long long {
+            return value.is_number() ? value.get<long long>() : 0;
+        };
+
+        EventFields fields;
+        for (auto it = system.begin(); it != system.end(); ++it) {
+            const SysmonSchema::SystemFieldName* entry = SysmonSchema::findSystemField(it.key());
+            if (entry == nullptr) continue;
+
+            switch (entry->field) {
+                case SysmonSchema::SystemField::EventID:       fields.eventId = (int)num(it.value()); break;
+                case SysmonSchema::SystemField::EventRecordID: fields.recordId = (uint64_t)num(it.value()); break;
+                case SysmonSchema::SystemField::Computer:      fields.computer = str(it.value()); break;
+                case SysmonSchema::SystemField::Channel:       fields.channel = str(it.value()); break;
+                case SysmonSchema::SystemField::TimeCreated: {
+                    auto time = it.value().find("SystemTime");
+                    if (time != it.value().end()) fields.systemTime = str(*time);
+                    break;
+                }
+                default: break;
+            }
+        }
+
+        for (auto it = eventData.begin(); it != eventData.end(); ++it) {
+            const SysmonSchema::DataField* field = SysmonSchema::findDataField(it.key());
+            if (field == nullptr) continue;
+
+            if (field->number) SysmonSchema::store(*field, fields, (int)num(it.value()));
+            else SysmonSchema::store(*field, fields, str(it.value()));
+        }
+
+        return fieldsToDjangoFormat(fields);
+
     } catch (const std::exception& e) {
         std::cerr << "[EventConverter] ERROR: " << e.what() << std::endl;
         return nlohmann::json();
     }
-    
-    return djangoEvent;
 }
@@ -2,18 +2,36 @@
 #define EVENTCONVERTER_HPP
 
 #include "nlohmann/json.hpp"
+#include "pugixml.hpp"
+#include "SysmonSchema.hpp"     // EventFields and the per-ID field tables
+#include "TelemetryEvent.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 class EventConverter {
 public:
+    // Legacy path for the Sysmon JSON format produced by EventXmlToEventJson
     static nlohmann::json sysmonEventToDjangoFormat(const nlohmann::json& sysmonEvent);
+
+    static bool extractFields(const pugi::xml_node& eventNode, EventFields& fields);
+
+    // Fills event (which keeps its buffer) from the extracted fields. Returns
+    // false, leaving event a marker, for IDs that are skipped or not handled.
+    static bool fieldsToTelemetryEvent(const EventFields& fields, TelemetryEvent& event);
+    static nlohmann::json fieldsToDjangoFormat(const EventFields& fields);
+
     static std::string getHostname();
+
+    // SystemTime attribute ("2024-01-01T12:00:00.1234567Z") -> FILETIME ticks
+    // (100 ns since 1601). No allocation or locale; false if it is not ISO-8601.
+    static bool parseSystemTime(std::string_view systemTime, uint64_t& ticks);
+    static long long ticksToUnixMicros(uint64_t ticks);
     
 private:
     static std::string generateEventId();
-    static long long parseSystemTime(const std::string& systemTime);
-    static std::string mapSysmonToEventType(int eventId);
-    static std::string determineSeverity(int eventId);
+    static const char* mapSysmonToEventType(int eventId);
+    static const char* determineSeverity(int eventId);   // Static string: TelemetryEvent keeps the pointer
     
 };
 
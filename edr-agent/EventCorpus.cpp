@@ -0,0 +1,71 @@
+#include "EventCorpus.hpp"
+
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+    void writeU32(std::ofstream& file, uint32_t value) {
+        unsigned char bytes[4] = {(unsigned char)value, (unsigned char)(value >> 8),
+                                  (unsigned char)(value >> 16), (unsigned char)(value >> 24)};
+        file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+
+    bool readU32(std::ifstream& file, uint32_t& value) {
+        unsigned char bytes[4];
+        if (!file.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) return false;
+        value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        return true;
+    }
+}
+
+bool EventCorpus::save(const std::string& path, const std::vector<std::string>& events) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[Corpus] Cannot create " << path << std::endl;
+        return false;
+    }
+
+    writeU32(file, MAGIC);
+    writeU32(file, VERSION);
+    for (const std::string& xml : events) {
+        writeU32(file, (uint32_t)xml.size());
+        file.write(xml.data(), (std::streamsize)xml.size());
+    }
+
+    file.flush();
+    if (!file) {
+        std::cerr << "[Corpus] Failed writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool EventCorpus::load(const std::string& path, std::vector<std::string>& events) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "[Corpus] Cannot open " << path << std::endl;
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0;
+    if (!readU32(file, magic) || !readU32(file, version) || magic != MAGIC || version != VERSION) {
+        std::cerr << "[Corpus] " << path << " is not an event corpus (version " << VERSION << ")" << std::endl;
+        return false;
+    }
+
+    uint32_t length = 0;
+    while (readU32(file, length)) {
+        if (length > MAX_EVENT_BYTES) {
+            std::cerr << "[Corpus] ⚠️ Corrupt record after " << events.size() << " events, stopping" << std::endl;
+            break;
+        }
+        std::string xml(length, '\0');
+        if (!file.read(&xml[0], length)) {
+            std::cerr << "[Corpus] ⚠️ Truncated record after " << events.size() << " events" << std::endl;
+            break;
+        }
+        events.push_back(std::move(xml));
+    }
+    return true;
+}
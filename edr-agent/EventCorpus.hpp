@@ -0,0 +1,34 @@
+#ifndef EVENTCORPUS_HPP
+#define EVENTCORPUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================
+// Event Corpus
+// ============================================================
+// Rendered event XML saved to disk so the hot path can be measured
+// offline (edr-bench) against what a real machine produces. Written by
+// edr-agent --record, read by edr-bench.
+//
+//   "EDRC" | version (u32) | { length (u32) | XML } ...
+//
+// Lengths are little-endian. The XML is kept exactly as EvtRender
+// returned it (after UTF-8 conversion), newlines and all.
+// ============================================================
+
+class EventCorpus {
+public:
+    static constexpr uint32_t MAGIC = 0x43524445;   // "EDRC"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAX_EVENT_BYTES = 16 * 1024 * 1024;
+
+    static bool save(const std::string& path, const std::vector<std::string>& events);
+
+    // Appends to events; stops at the first damaged record (what was read is kept)
+    static bool load(const std::string& path, std::vector<std::string>& events);
+};
+
+#endif // EVENTCORPUS_HPP
@@ -0,0 +1,448 @@
+#include "EventFilter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <queue>
+
+// ASCII-only: Windows paths and switches are what we match on, and
+// leaving bytes >= 0x80 alone keeps UTF-8 intact
+static char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static std::string_view lowerInto(std::string_view text, std::string& buffer) {
+    buffer.resize(text.size());
+    for (size_t i = 0; i < text.size(); i++) buffer[i] = lowerAscii(text[i]);
+    return buffer;
+}
+
+static std::string lowerCopy(std::string_view text) {
+    std::string lowered;
+    lowerInto(text, lowered);
+    return lowered;
+}
+
+// ============================================
+// Path Matcher
+// ============================================
+void PathMatcher::addLength(std::vector<size_t>& lengths, size_t length) {
+    auto it = std::lower_bound(lengths.begin(), lengths.end(), length);
+    if (it == lengths.end() || *it != length) lengths.insert(it, length);
+}
+
+void PathMatcher::addPrefix(std::string_view prefix) {
+    if (prefix.empty()) return;
+    m_storage.push_back(lowerCopy(prefix));
+    m_prefixes.insert(m_storage.back());
+    addLength(m_prefixLengths, prefix.size());
+}
+
+void PathMatcher::addSuffix(std::string_view suffix) {
+    if (suffix.empty()) return;
+    m_storage.push_back(lowerCopy(suffix));
+    m_suffixes.insert(m_storage.back());
+    addLength(m_suffixLengths, suffix.size());
+}
+
+bool PathMatcher::matches(std::string_view path) const {
+    for (size_t length : m_prefixLengths) {
+        if (length > path.size()) break;
+        if (m_prefixes.count(path.substr(0, length))) return true;
+    }
+    for (size_t length : m_suffixLengths) {
+        if (length > path.size()) break;
+        if (m_suffixes.count(path.substr(path.size() - length))) return true;
+    }
+    return false;
+}
+
+// ============================================
+// CIDR Trie
+// ============================================
+CidrTrie::CidrTrie() : m_nodes(2) {}
+
+static bool parseIPv4(std::string_view text, uint8_t out[4]) {
+    size_t pos = 0;
+    for (int part = 0; part < 4; part++) {
+        if (part > 0) {
+            if (pos >= text.size() || text[pos] != '.') return false;
+            pos++;
+        }
+        unsigned value = 0;
+        size_t digits = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9' && digits < 3) {
+            value = value * 10 + (text[pos] - '0');
+            pos++;
+            digits++;
+        }
+        if (digits == 0 || value > 255) return false;
+        out[part] = (uint8_t)value;
+    }
+    return pos == text.size();
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = lowerAscii(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool CidrTrie::parseAddress(std::string_view text, uint8_t bytes[16], bool& isV6) {
+    size_t zone = text.find('%');
+    if (zone != std::string_view::npos) text = text.substr(0, zone);
+
+    if (text.find(':') == std::string_view::npos) {
+        isV6 = false;
+        return parseIPv4(text, bytes);
+    }
+
+    // Groups before and after "::", expanded with zeros in between
+    isV6 = true;
+    uint16_t head[8], tail[8];
+    int headCount = 0, tailCount = 0;
+    bool compressed = false;
+
+    size_t pos = 0;
+    if (text.size() >= 2 && text[0] == ':' && text[1] == ':') {
+        compressed = true;
+        pos = 2;
+    }
+
+    while (pos < text.size()) {
+        size_t end = text.find(':', pos);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view token = text.substr(pos, end - pos);
+
+        uint16_t* groups = compressed ? tail : head;
+        int& count = compressed ? tailCount : headCount;
+
+        if (token.find('.') != std::string_view::npos) {
+            // Embedded IPv4 (e.g. ::ffff:10.0.0.1) fills the last two groups
+            uint8_t v4[4];
+            if (end != text.size() || count > 6 || !parseIPv4(token, v4)) return false;
+            groups[count++] = (uint16_t)((v4[0] << 8) | v4[1]);
+            groups[count++] = (uint16_t)((v4[2] << 8) | v4[3]);
+            pos = end;
+            break;
+        }
+
+        if (token.empty() || token.size() > 4 || count >= 8) return false;
+        unsigned value = 0;
+        for (char c : token) {
+            int digit = hexValue(c);
+            if (digit < 0) return false;
+            value = (value << 4) | (unsigned)digit;
+        }
+        groups[count++] = (uint16_t)value;
+
+        pos = end;
+        if (pos == text.size()) break;
+        if (pos + 1 < text.size() && text[pos + 1] == ':') {
+            if (compressed) return false;   // Only one "::" allowed
+            compressed = true;
+            pos += 2;
+        } else {
+            pos += 1;
+            if (pos == text.size()) return false;   // Trailing single ':'
+        }
+    }
+
+    int total = headCount + tailCount;
+    if (compressed ? total > 7 : total != 8) return false;
+
+    int zeros = 8 - total;
+    int g = 0;
+    for (int i = 0; i < headCount; i++, g++) {
+        bytes[g * 2] = (uint8_t)(head[i] >> 8);
+        bytes[g * 2 + 1] = (uint8_t)head[i];
+    }
+    for (int i = 0; i < zeros; i++, g++) {
+        bytes[g * 2] = 0;
+        bytes[g * 2 + 1] = 0;
+    }
+    for (int i = 0; i < tailCount; i++, g++) {
+        bytes[g * 2] = (uint8_t)(tail[i] >> 8);
+        bytes[g * 2 + 1] = (uint8_t)tail[i];
+    }
+    return true;
+}
+
+bool CidrTrie::insert(std::string_view cidr) {
+    std::string_view address = cidr;
+    int prefixLength = -1;
+
+    size_t slash = cidr.find('/');
+    if (slash != std::string_view::npos) {
+        address = cidr.substr(0, slash);
+        prefixLength = 0;
+        std::string_view digits = cidr.substr(slash + 1);
+        if (digits.empty() || digits.size() > 3) return false;
+        for (char c : digits) {
+            if (c < '0' || c > '9') return false;
+            prefixLength = prefixLength * 10 + (c - '0');
+        }
+    }
+
+    uint8_t bytes[16];
+    bool isV6 = false;
+    if (!parseAddress(address, bytes, isV6)) return false;
+
+    int maxBits = isV6 ? 128 : 32;
+    if (prefixLength < 0) prefixLength = maxBits;
+    if (prefixLength > maxBits) return false;
+
+    int32_t node = isV6 ? 1 : 0;
+    for (int bit = 0; bit < prefixLength; bit++) {
+        if (m_nodes[node].terminal) break;   // A shorter network already covers this one
+        int branch = (bytes[bit / 8] >> (7 - bit % 8)) & 1;
+        if (m_nodes[node].child[branch] < 0) {
+            m_nodes[node].child[branch] = (int32_t)m_nodes.size();
+            m_nodes.emplace_back();
+        }
+        node = m_nodes[node].child[branch];
+    }
+    m_nodes[node].terminal = true;
+    m_count++;
+    return true;
+}
+
+bool CidrTrie::contains(std::string_view address) const {
+    if (m_count == 0 || address.empty()) return false;
+
+    uint8_t bytes[16];
+    bool isV6 = false;
+    if (!parseAddress(address, bytes, isV6)) return false;
+
+    int maxBits = isV6 ? 128 : 32;
+    int32_t node = isV6 ? 1 : 0;
+    for (int bit = 0; ; bit++) {
+        if (m_nodes[node].terminal) return true;
+        if (bit == maxBits) return false;
+        int branch = (bytes[bit / 8] >> (7 - bit % 8)) & 1;
+        node = m_nodes[node].child[branch];
+        if (node < 0) return false;
+    }
+}
+
+// ============================================
+// Aho-Corasick
+// ============================================
+void AhoCorasick::add(std::string_view pattern) {
+    if (pattern.empty()) return;
+    if (m_next.empty()) {
+        m_next.emplace_back();
+        m_next[0].fill(-1);
+        m_output.push_back(false);
+    }
+
+    int32_t state = 0;
+    for (char c : pattern) {
+        uint8_t byte = (uint8_t)lowerAscii(c);
+        if (m_next[state][byte] < 0) {
+            m_next[state][byte] = (int32_t)m_next.size();
+            m_next.emplace_back();
+            m_next.back().fill(-1);
+            m_output.push_back(false);
+        }
+        state = m_next[state][byte];
+    }
+    m_output[state] = true;
+    m_patternCount++;
+}
+
+void AhoCorasick::build() {
+    if (m_next.empty()) return;
+
+    // Breadth-first: fill every missing transition from the failure state,
+    // so matching is one table lookup per byte with no backtracking
+    std::vector<int32_t> fail(m_next.size(), 0);
+    std::queue<int32_t> pending;
+
+    for (int c = 0; c < 256; c++) {
+        int32_t child = m_next[0][c];
+        if (child < 0) {
+            m_next[0][c] = 0;
+        } else {
+            fail[child] = 0;
+            pending.push(child);
+        }
+    }
+
+    while (!pending.empty()) {
+        int32_t state = pending.front();
+        pending.pop();
+        if (m_output[fail[state]]) m_output[state] = true;
+
+        for (int c = 0; c < 256; c++) {
+            int32_t child = m_next[state][c];
+            if (child < 0) {
+                m_next[state][c] = m_next[fail[state]][c];
+            } else {
+                fail[child] = m_next[fail[state]][c];
+                pending.push(child);
+            }
+        }
+    }
+}
+
+bool AhoCorasick::matches(std::string_view text) const {
+    if (m_patternCount == 0) return false;
+    int32_t state = 0;
+    for (char c : text) {
+        state = m_next[state][(uint8_t)c];
+        if (m_output[state]) return true;
+    }
+    return false;
+}
+
+// ============================================
+// Filter
+// ============================================
+FilterAction EventFilter::parseAction(const std::string& name) {
+    if (name == "drop") return FilterAction::Drop;
+    if (name == "tag") return FilterAction::Tag;
+    if (name != "allow" && !name.empty()) {
+        std::cerr << "[Filter] Unknown action '" << name << "', using allow" << std::endl;
+    }
+    return FilterAction::Allow;
+}
+
+bool EventFilter::idInSet(const std::bitset<256>& set, int eventId) {
+    return eventId >= 0 && eventId < 256 && set.test((size_t)eventId);
+}
+
+void EventFilter::readEventIds(const nlohmann::json& list, std::bitset<256>& set) {
+    if (!list.is_array()) return;
+    for (const auto& id : list) {
+        int value = id.get<int>();
+        if (value >= 0 && value < 256) {
+            set.set((size_t)value);
+        } else {
+            std::cerr << "[Filter] Event ID " << value << " out of range, ignored" << std::endl;
+        }
+    }
+}
+
+bool EventFilter::compile(const nlohmann::json& config) {
+    try {
+        m_enabled = config.value("enabled", false);
+        if (!m_enabled) return true;
+
+        if (config.contains("allow_event_ids")) readEventIds(config["allow_event_ids"], m_allowIds);
+        if (config.contains("deny_event_ids")) readEventIds(config["deny_event_ids"], m_denyIds);
+        m_defaultDrop = parseAction(config.value("default_action", std::string("allow"))) == FilterAction::Drop;
+
+        if (config.contains("rules")) {
+            for (const auto& entry : config["rules"]) {
+                auto owned = std::make_unique<Rule>();
+                Rule& rule = *owned;
+                rule.name = entry.value("name", "rule" + std::to_string(m_rules.size() + 1));
+                rule.action = parseAction(entry.value("action", std::string("drop")));
+                rule.tag = entry.value("tag", rule.name);
+
+                if (entry.contains("event_ids")) readEventIds(entry["event_ids"], rule.eventIds);
+                if (entry.contains("image_prefix")) {
+                    for (const auto& prefix : entry["image_prefix"]) rule.image.addPrefix(prefix.get<std::string>());
+                }
+                if (entry.contains("image_suffix")) {
+                    for (const auto& suffix : entry["image_suffix"]) rule.image.addSuffix(suffix.get<std::string>());
+                }
+                if (entry.contains("destination_cidr")) {
+                    for (const auto& cidr : entry["destination_cidr"]) {
+                        std::string text = cidr.get<std::string>();
+                        if (!rule.destination.insert(text)) {
+                            std::cerr << "[Filter] Rule '" << rule.name << "': bad CIDR '" << text << "'" << std::endl;
+                        }
+                    }
+                }
+                if (entry.contains("destination_ports")) {
+                    rule.destinationPorts = entry["destination_ports"].get<std::vector<int>>();
+                    std::sort(rule.destinationPorts.begin(), rule.destinationPorts.end());
+                }
+                if (entry.contains("command_line_contains")) {
+                    for (const auto& pattern : entry["command_line_contains"]) {
+                        rule.commandLine.add(pattern.get<std::string>());
+                    }
+                    rule.commandLine.build();
+                }
+
+                m_rules.push_back(std::move(owned));
+            }
+        }
+
+        std::cout << "[Filter] Compiled " << m_rules.size() << " rule(s)" << std::endl;
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "[Filter] Invalid filter config: " << e.what() << std::endl;
+        m_enabled = false;
+        m_rules.clear();
+        return false;
+    }
+}
+
+bool EventFilter::evaluate(const EventFields& fields, std::vector<std::string_view>& tags) const {
+    if (!m_enabled) return true;
+
+    if ((m_allowIds.any() && !idInSet(m_allowIds, fields.eventId)) || idInSet(m_denyIds, fields.eventId)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Lower-cased once per event, and only if some rule looks at them
+    thread_local std::string imageBuffer;
+    thread_local std::string commandLineBuffer;
+    std::string_view image, commandLine;
+    bool imageReady = false, commandLineReady = false;
+
+    bool tagged = false;
+    for (const auto& owned : m_rules) {
+        const Rule& rule = *owned;
+        if (rule.eventIds.any() && !idInSet(rule.eventIds, fields.eventId)) continue;
+
+        if (!rule.image.empty()) {
+            if (!imageReady) {
+                image = lowerInto(fields.image, imageBuffer);
+                imageReady = true;
+            }
+            if (!rule.image.matches(image)) continue;
+        }
+        if (!rule.destination.empty() && !rule.destination.contains(fields.destinationIp)) continue;
+        if (!rule.destinationPorts.empty() &&
+            !std::binary_search(rule.destinationPorts.begin(), rule.destinationPorts.end(), fields.destinationPort)) {
+            continue;
+        }
+        if (!rule.commandLine.empty()) {
+            if (!commandLineReady) {
+                commandLine = lowerInto(fields.commandLine, commandLineBuffer);
+                commandLineReady = true;
+            }
+            if (!rule.commandLine.matches(commandLine)) continue;
+        }
+
+        switch (rule.action) {
+            case FilterAction::Drop:
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case FilterAction::Allow:
+                if (tagged) m_tagged.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            case FilterAction::Tag:
+                tags.push_back(rule.tag);
+                tagged = true;
+                break;
+        }
+    }
+
+    if (tagged) {
+        m_tagged.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (m_defaultDrop) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,158 @@
+#ifndef EVENTFILTER_HPP
+#define EVENTFILTER_HPP
+
+#include "EventConverter.hpp"
+#include "nlohmann/json.hpp"
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================
+// Event Filter
+// ============================================================
+// Drops or tags events on their raw rendered fields, before any JSON is
+// built. Configured by the "filter" section:
+//
+//   allow_event_ids / deny_event_ids    checked first
+//   rules[]                             first allow/drop match wins; tag rules add a tag and go on
+//   default_action                      "allow" (default) or "drop" when no rule decided
+//
+// A rule matches when every condition it lists matches (any entry of a
+// list will do): event_ids, image_prefix / image_suffix,
+// destination_cidr, destination_ports, command_line_contains. Tagged
+// events are kept even when default_action is "drop".
+//
+// Everything is compiled once at startup: paths into hash sets keyed by
+// length, CIDRs into a binary radix trie, command-line substrings into an
+// Aho-Corasick automaton. Paths and command lines match case-insensitively
+// (ASCII). evaluate() is const and safe to call from every worker.
+// ============================================================
+
+enum class FilterAction {
+    Allow,
+    Drop,
+    Tag
+};
+
+// Prefix/suffix lookups: one hash probe per distinct pattern length.
+// The sets hold views into m_storage, so a copy would point into the
+// original's strings: not copyable or movable (rules are held by pointer).
+class PathMatcher {
+public:
+    PathMatcher() = default;
+    PathMatcher(const PathMatcher&) = delete;
+    PathMatcher& operator=(const PathMatcher&) = delete;
+
+    void addPrefix(std::string_view prefix);
+    void addSuffix(std::string_view suffix);
+    bool empty() const { return m_prefixes.empty() && m_suffixes.empty(); }
+
+    // path must already be lower-cased
+    bool matches(std::string_view path) const;
+
+private:
+    static void addLength(std::vector<size_t>& lengths, size_t length);
+
+    std::deque<std::string> m_storage;     // Owns the strings the sets point into
+    std::unordered_set<std::string_view> m_prefixes;
+    std::unordered_set<std::string_view> m_suffixes;
+    std::vector<size_t> m_prefixLengths;
+    std::vector<size_t> m_suffixLengths;
+};
+
+// IPv4 and IPv6 networks, one bit per trie level
+class CidrTrie {
+public:
+    CidrTrie();
+
+    // "10.0.0.0/8", "fe80::/10" or a bare address (host route)
+    bool insert(std::string_view cidr);
+    bool contains(std::string_view address) const;
+    bool empty() const { return m_count == 0; }
+
+    // Parses dotted IPv4 or IPv6 (with "::" and an optional "%zone") without allocating
+    static bool parseAddress(std::string_view text, uint8_t bytes[16], bool& isV6);
+
+private:
+    struct Node {
+        int32_t child[2] = {-1, -1};
+        bool terminal = false;
+    };
+
+    std::vector<Node> m_nodes;   // [0] = IPv4 root, [1] = IPv6 root
+    size_t m_count = 0;
+};
+
+// Dense DFA over bytes; a match is any pattern occurring anywhere in the text
+class AhoCorasick {
+public:
+    void add(std::string_view pattern);
+    void build();
+    bool empty() const { return m_patternCount == 0; }
+
+    // text must already be lower-cased
+    bool matches(std::string_view text) const;
+
+private:
+    std::vector<std::array<int32_t, 256>> m_next;
+    std::vector<bool> m_output;
+    size_t m_patternCount = 0;
+};
+
+class EventFilter {
+public:
+    EventFilter() = default;
+
+    EventFilter(const EventFilter&) = delete;
+    EventFilter& operator=(const EventFilter&) = delete;
+
+    // Builds the matchers from the "filter" config section. Invalid entries
+    // are skipped with a warning; returns false if the section is malformed.
+    bool compile(const nlohmann::json& config);
+
+    bool enabled() const { return m_enabled; }
+    size_t ruleCount() const { return m_rules.size(); }
+
+    // false = drop the event. Tags of matching tag rules are appended to tags.
+    bool evaluate(const EventFields& fields, std::vector<std::string_view>& tags) const;
+
+    uint64_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    uint64_t taggedCount() const { return m_tagged.load(std::memory_order_relaxed); }
+
+    // "allow" | "drop" | "tag" (defaults to Allow)
+    static FilterAction parseAction(const std::string& name);
+
+private:
+    struct Rule {
+        std::string name;
+        FilterAction action = FilterAction::Allow;
+        std::string tag;
+        std::bitset<256> eventIds;         // Empty = any event
+        PathMatcher image;
+        CidrTrie destination;
+        std::vector<int> destinationPorts; // Sorted
+        AhoCorasick commandLine;
+    };
+
+    static bool idInSet(const std::bitset<256>& set, int eventId);
+    static void readEventIds(const nlohmann::json& list, std::bitset<256>& set);
+
+    bool m_enabled = false;
+    std::bitset<256> m_allowIds;           // Empty = everything allowed
+    std::bitset<256> m_denyIds;
+    std::vector<std::unique_ptr<Rule>> m_rules;   // Rules never move: PathMatcher views its own storage
+    bool m_defaultDrop = false;
+
+    mutable std::atomic<uint64_t> m_dropped{0};
+    mutable std::atomic<uint64_t> m_tagged{0};
+};
+
+#endif // EVENTFILTER_HPP
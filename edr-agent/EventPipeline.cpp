@@ -0,0 +1,765 @@
+#include "EventPipeline.hpp"
+#include "EventRenderer.hpp"
+#include "EventConverter.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "ProcessTable.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+EventPipeline::EventPipeline(HttpClient& httpClient, const PipelineConfig& config,
+                             BookmarkStore* bookmarks, TelemetrySpool* spool,
+                             AsyncHttpSender* asyncSender, std::shared_ptr<const EventFilter> filter,
+                             BatchTransport* transport)
+    : m_httpClient(httpClient)
+    , m_config(config)
+    , m_bookmarks(bookmarks)
+    , m_spool(spool)
+    , m_asyncSender(asyncSender)
+    , m_filter(std::move(filter))
+    , m_transport(transport)
+    , m_arena(config.queueDepth)
+    , m_droppableIds(config.droppableEventIds.begin(), config.droppableEventIds.end())
+{
+    m_config.workerThreads = resolveWorkerCount(m_config.workerThreads);
+
+    // queue_depth is the total; each worker gets its share of it
+    size_t depth = std::max<size_t>(m_config.queueDepth / m_config.workerThreads, 64);
+    for (unsigned i = 0; i < m_config.workerThreads; i++) {
+        m_workers.push_back(std::make_unique<Worker>(depth));
+    }
+
+    if (m_config.aggregation.enabled) {
+        m_aggregator = std::make_unique<EventAggregator>(m_config.aggregation);
+    }
+
+    // The filling batch plus one per request allowed on the wire. With a
+    // transport, running out of slots is the backpressure: the sender stops
+    // filling until the server acknowledges something.
+    size_t inFlight = m_asyncSender != nullptr ? m_asyncSender->maxInFlight() : 1;
+    if (m_transport != nullptr) inFlight = std::max(inFlight, m_transport->maxInFlight());
+    size_t slotCount = 1 + inFlight;
+    for (size_t i = 0; i < slotCount; i++) {
+        m_slots.push_back(std::make_unique<BatchSlot>(m_config.batch));
+        m_freeSlots.push_back(m_slots.back().get());
+    }
+}
+
+EventPipeline::~EventPipeline() {
+    stop();
+}
+
+// ============================================
+// Lifecycle
+// ============================================
+void EventPipeline::start() {
+    if (m_running.exchange(true)) return;
+    m_senderRunning = true;
+
+    for (auto& worker : m_workers) {
+        worker->thread = std::thread(&EventPipeline::workerLoop, this, std::ref(*worker));
+    }
+    m_senderThread = std::thread(&EventPipeline::senderLoop, this);
+
+    std::cout << "[Pipeline] Started (queue depth " << m_workers.front()->input.capacity()
+              << " x " << m_workers.size() << " worker(s))" << std::endl;
+}
+
+void EventPipeline::stop() {
+    if (!m_running.exchange(false)) return;
+
+    // Workers drain their queues before exiting; the sender keeps running
+    // until they are done so nothing converted is left behind
+    for (auto& worker : m_workers) {
+        worker->cv.notify_all();
+    }
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    m_senderRunning = false;
+    m_sendCV.notify_all();
+    if (m_senderThread.joinable()) m_senderThread.join();
+
+    std::cout << "[Pipeline] Stopped. Submitted: " << submittedCount()
+              << ", Dropped: " << droppedCount() << std::endl;
+    if (m_aggregator) {
+        std::cout << "[Aggregator] Absorbed: " << m_aggregator->absorbedCount()
+                  << ", Records: " << m_aggregator->emittedCount() << std::endl;
+    }
+    std::shared_ptr<const EventFilter> filter = std::atomic_load(&m_filter);
+    if (filter != nullptr && filter->enabled()) {
+        std::cout << "[Filter] Dropped: " << filter->droppedCount()
+                  << ", Tagged: " << filter->taggedCount() << std::endl;
+    }
+}
+
+void EventPipeline::setFilter(std::shared_ptr<const EventFilter> filter) {
+    std::atomic_store(&m_filter, std::move(filter));
+    m_filterGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void EventPipeline::setBatchLimits(const BatchConfig& limits) {
+    std::lock_guard<std::mutex> lock(m_limitsMutex);
+    m_pendingLimits = limits;
+    m_limitsChanged.store(true, std::memory_order_release);
+}
+
+// ============================================
+// Producer Side (EventSubscriber)
+// ============================================
+bool EventPipeline::submit(RenderedEvent&& event) {
+    Worker* worker = enqueue(std::move(event), m_config.overflowPolicy);
+    if (worker != nullptr) notifyWorker(*worker);
+    return worker != nullptr;
+}
+
+size_t EventPipeline::submitBatch(std::vector<RenderedEvent>& events, bool block) {
+    OverflowPolicy policy = block ? OverflowPolicy::Block : m_config.overflowPolicy;
+    size_t accepted = 0;
+    for (auto& event : events) {
+        if (enqueue(std::move(event), policy) != nullptr) accepted++;
+    }
+    // One wakeup per worker for the whole pull instead of one per event
+    if (accepted > 0) {
+        for (auto& worker : m_workers) notifyWorker(*worker);
+    }
+    return accepted;
+}
+
+bool EventPipeline::tryDispatch(RenderedEvent& event, Worker*& target) {
+    std::lock_guard<std::mutex> lock(m_dispatchMutex);
+    target = &workerFor(m_nextDispatch);
+    event.sequence = m_nextDispatch;
+    if (!target->input.tryPush(std::move(event))) return false;
+    m_nextDispatch++;
+    return true;
+}
+
+EventPipeline::Worker* EventPipeline::enqueue(RenderedEvent&& event, OverflowPolicy policy) {
+    Worker* target = nullptr;
+    event.enqueuedAt = Metrics::now();
+    if (tryDispatch(event, target)) {
+        countSubmitted();
+        return target;
+    }
+
+    // The next worker's queue is full - apply the overflow policy
+    switch (policy) {
+        case OverflowPolicy::DropOldest: {
+            // Evicts from the same queue, so its sequences stay increasing
+            std::lock_guard<std::mutex> lock(m_dispatchMutex);
+            target = &workerFor(m_nextDispatch);
+            event.sequence = m_nextDispatch;
+            RenderedEvent evicted;
+            while (!target->input.tryPush(std::move(event))) {
+                if (target->input.tryPop(evicted)) {
+                    countDropped();
+                }
+            }
+            m_nextDispatch++;
+            break;
+        }
+
+        case OverflowPolicy::DropByEventType:
+            if (m_droppableIds.count(event.eventId)) {
+                countDropped();
+                return nullptr;
+            }
+            // Not droppable: fall through and wait for space
+            [[fallthrough]];
+
+        case OverflowPolicy::Block:
+            while (!tryDispatch(event, target)) {
+                if (!m_running) {
+                    countDropped();
+                    return nullptr;
+                }
+                notifyWorker(*target);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            break;
+    }
+
+    countSubmitted();
+    return target;
+}
+
+void EventPipeline::countSubmitted() {
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+    Metrics::add(Counter::EventsSubmitted);
+}
+
+void EventPipeline::countDropped() {
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    Metrics::add(Counter::EventsDropped);
+}
+
+unsigned EventPipeline::resolveWorkerCount(unsigned configured) {
+    if (configured != 0) return configured;
+
+    // Leave a core for the subscription callbacks and the sender
+    unsigned cores = std::thread::hardware_concurrency();
+    unsigned workers = cores > 1 ? cores - 1 : 1;
+    return std::min(workers, AUTO_WORKER_LIMIT);
+}
+
+void EventPipeline::notifyWorker(Worker& worker) {
+    worker.cv.notify_one();
+}
+
+void EventPipeline::notifySender() {
+    m_sendCV.notify_one();
+}
+
+// ============================================
+// Workers (sanitize -> parse -> convert)
+// ============================================
+void EventPipeline::workerLoop(Worker& worker) {
+    RenderedEvent event;
+
+    for (;;) {
+        if (!worker.input.tryPop(event)) {
+            if (!m_running) break;  // Stopping and fully drained
+
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.cv.wait_for(lock, std::chrono::milliseconds(100), [this, &worker] {
+                return !m_running || !worker.input.emptyApprox();
+            });
+            continue;
+        }
+
+        Metrics::record(Stage::QueueWait, Metrics::now() - event.enqueuedAt);
+        processEvent(worker, event);
+    }
+}
+
+void EventPipeline::processEvent(Worker& worker, RenderedEvent& event) {
+    // Every sequence reaches the sender, if only as a marker, so it never
+    // waits for one that is not coming
+    ConvertedEvent converted;
+    converted.sequence = event.sequence;
+    converted.source = event.source;
+    converted.recordId = event.recordId;
+
+    // Over budget: the cheapest event is the one never parsed
+    if (m_governor != nullptr && m_governor->shedding(event.eventId)) {
+        Metrics::add(Counter::EventsShed);
+        Metrics::add(Counter::EventsSkipped);
+        pushConverted(worker, std::move(converted));
+        return;
+    }
+
+    try {
+        // Fields are views into event.xml / values, so both stay alive until the event is built.
+        // The document is reused per worker; each load resets it.
+        EventFields fields;
+        thread_local pugi::xml_document doc;
+        bool extracted = false;
+
+        if (event.format == RenderFormat::Values) {
+            Metrics::Timer parse(Stage::Parse);
+            ValuesToEventFields(event.values, fields);
+            extracted = true;
+        } else {
+            // Valid (the usual case) costs one vectorized scan and no copy. Parsing
+            // then happens in place, so node text points into event.xml.
+            Metrics::Timer sanitize(Stage::Sanitize);
+            sanitizeUtf8InPlace(event.xml);
+            sanitize.stop();
+
+            Metrics::Timer parse(Stage::Parse);
+            pugi::xml_parse_result result = doc.load_buffer_inplace(&event.xml[0], event.xml.size());
+            if (result) {
+                extracted = EventConverter::extractFields(doc.child("Event"), fields);
+            } else {
+                LOG_ERROR("EventConverter") << "XML parsing failed: " << result.description();
+            }
+        }
+
+        if (extracted) {
+            // Before the filter: a dropped create or exit still changes the process tree
+            ProcessTable::observe(fields);
+
+            // One atomic load per event; the shared_ptr is only copied after a reload
+            uint64_t generation = m_filterGeneration.load(std::memory_order_acquire);
+            if (worker.filterGeneration != generation) {
+                worker.filter = std::atomic_load(&m_filter);
+                worker.filterGeneration = generation;
+            }
+
+            Metrics::Timer convert(Stage::Convert);
+            thread_local std::vector<std::string_view> tags;
+            tags.clear();
+            if (worker.filter == nullptr || worker.filter->evaluate(fields, tags)) {
+                m_arena.acquire(converted.event);
+                if (EventConverter::fieldsToTelemetryEvent(fields, converted.event)) {
+                    for (std::string_view tag : tags) converted.event.addTag(tag);
+                    if (converted.event.family == EventFamily::Process) {
+                        ProcessTable::appendLineage(converted.event, ProcessTable::eventTime(fields));
+                    }
+                }
+            }
+        }
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Pipeline") << "❌ Exception in pipeline worker: " << e.what();
+        converted.event.reset();
+    }
+
+    Metrics::add(converted.event.empty() ? Counter::EventsSkipped : Counter::EventsConverted);
+    pushConverted(worker, std::move(converted));
+}
+
+bool EventPipeline::pushConverted(Worker& worker, ConvertedEvent&& converted) {
+    // Backpressure: if the sender is behind, the worker waits here. Its
+    // input then fills up and the overflow policy kicks in at the callback.
+    while (!worker.output.tryPush(std::move(converted))) {
+        if (!m_senderRunning) return false;
+        notifySender();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    notifySender();
+    return true;
+}
+
+// ============================================
+// Sender (drains converted events into batches)
+// ============================================
+void EventPipeline::senderLoop() {
+    m_filling = acquireSlot();
+    ConvertedEvent converted;
+
+    while (m_senderRunning) {
+        settleCompleted();
+
+        bool flushed = false;
+        while (!flushed && popNext(converted)) {
+            flushed = accept(converted);
+        }
+        flushed = releaseAggregates(false) || flushed;
+        flushed = flushed || flushIfDue();
+        if (flushed) continue;
+
+        // Sleep until new events arrive, a batch completes, the oldest buffered
+        // event is due or an aggregation window closes
+        auto now = EventBatcher::Clock::now();
+        auto timeout = std::min(m_filling->batcher.timeUntilDeadline(now), std::chrono::milliseconds(100));
+        if (m_aggregator && m_aggregator->nextExpiry() != EventAggregator::Clock::time_point::max()) {
+            auto untilExpiry = std::chrono::duration_cast<std::chrono::milliseconds>(m_aggregator->nextExpiry() - now);
+            timeout = std::max(std::chrono::milliseconds(0), std::min(timeout, untilExpiry));
+        }
+        std::unique_lock<std::mutex> lock(m_sendMutex);
+        m_sendCV.wait_for(lock, timeout, [this] {
+            return !m_senderRunning || nextReady() ||
+                   (!m_inFlight.empty() && m_inFlight.front()->state.load() != BatchSlot::InFlight);
+        });
+    }
+
+    // Shutdown: everything the workers produced is in their outputs by now
+    while (popNext(converted)) {
+        accept(converted);
+    }
+    // Only a producer racing stop() can leave anything out of turn; send it anyway
+    for (auto& worker : m_workers) {
+        if (worker->hasPending) {
+            worker->hasPending = false;
+            accept(worker->pending);
+        }
+        while (worker->output.tryPop(converted)) {
+            accept(converted);
+        }
+    }
+    releaseAggregates(true);
+    if (!m_filling->batcher.empty()) {
+        flushBatch(*m_filling, FlushReason::Shutdown);
+    } else {
+        // Markers only: nothing to send, positions still count
+        m_filling->state = BatchSlot::Sent;
+        m_inFlight.push_back(m_filling);
+    }
+    m_filling = nullptr;
+    waitInFlight();
+}
+
+bool EventPipeline::popNext(ConvertedEvent& converted) {
+    for (;;) {
+        Worker& worker = workerFor(m_nextMerge);
+        if (!worker.hasPending) {
+            if (!worker.output.tryPop(worker.pending)) return false;   // Still converting
+            worker.hasPending = true;
+        }
+
+        // Worker queues hold increasing sequences, so a later one in this
+        // worker's output means m_nextMerge was evicted before conversion
+        if (worker.pending.sequence != m_nextMerge) {
+            m_nextMerge++;
+            continue;
+        }
+
+        converted = std::move(worker.pending);
+        worker.hasPending = false;
+        m_nextMerge++;
+        return true;
+    }
+}
+
+bool EventPipeline::nextReady() {
+    Worker& worker = workerFor(m_nextMerge);
+    return worker.hasPending || !worker.output.emptyApprox();
+}
+
+bool EventPipeline::accept(ConvertedEvent& converted) {
+    if (m_aggregator && !converted.event.empty() &&
+        m_aggregator->offer(converted.event, converted.source, converted.recordId, EventAggregator::Clock::now())) {
+        // Held until its window closes (or counted and done with)
+        if (converted.event.buffer.capacity() > 0) {
+            m_filling->retired.push_back(std::move(converted.event.buffer));
+        }
+        return false;
+    }
+    addToBatch(*m_filling, converted);
+    return flushIfDue();
+}
+
+bool EventPipeline::flushIfDue() {
+    FlushReason reason = m_filling->batcher.shouldFlush(EventBatcher::Clock::now());
+    if (reason == FlushReason::None) return false;
+
+    flushBatch(*m_filling, reason);
+    m_filling = acquireSlot();   // Waits here when maxInFlight batches are on the wire
+    return true;
+}
+
+bool EventPipeline::releaseAggregates(bool flushAll) {
+    if (!m_aggregator) return false;
+
+    bool flushed = false;
+    m_aggregator->collectExpired(EventAggregator::Clock::now(),
+        [this, &flushed](TelemetryEvent&& event, uint32_t source, uint64_t recordId) {
+            ConvertedEvent converted;
+            converted.event = std::move(event);
+            converted.source = source;
+            converted.recordId = recordId;
+            addToBatch(*m_filling, converted);
+            flushed = flushIfDue() || flushed;
+        }, flushAll);
+    return flushed;
+}
+
+void EventPipeline::acknowledge(uint32_t source, uint64_t recordId) {
+    if (source < m_heldSources.size() && m_heldSources[source]) return;
+
+    // Never move past a record the aggregator is still holding back
+    if (m_aggregator) {
+        uint64_t floor = m_aggregator->heldFloor(source);
+        if (floor != 0 && recordId >= floor) recordId = floor - 1;
+    }
+    if (recordId != 0) m_bookmarks->acknowledge(source, recordId);
+}
+
+void EventPipeline::holdSources(const BatchSlot& slot) {
+    Metrics::add(Counter::BatchesLost);
+    if (m_bookmarks == nullptr) return;
+
+    for (size_t source = 0; source < slot.positions.size(); source++) {
+        if (slot.positions[source] == 0) continue;
+        if (source >= m_heldSources.size()) m_heldSources.resize(source + 1, false);
+        if (m_heldSources[source]) continue;
+        m_heldSources[source] = true;
+        LOG_WARN("Batch") << "Bookmark for source " << source << " held at "
+                          << m_bookmarks->recordId(source) << ", the lost events are re-read on restart";
+    }
+}
+
+void EventPipeline::addToBatch(BatchSlot& slot, ConvertedEvent& converted) {
+    if (m_bookmarks != nullptr && converted.recordId != 0) {
+        if (converted.event.empty() && slot.batcher.empty() && m_inFlight.empty()) {
+            // Nothing before it is still waiting for the server
+            acknowledge(converted.source, converted.recordId);
+        } else {
+            if (converted.source >= slot.positions.size()) {
+                slot.positions.resize(converted.source + 1, 0);
+            }
+            uint64_t& position = slot.positions[converted.source];
+            position = std::max(position, converted.recordId);
+        }
+    }
+
+    if (!converted.event.empty()) {
+        slot.batcher.add(converted.event);
+        slot.retired.push_back(std::move(converted.event.buffer));
+    }
+}
+
+void EventPipeline::flushBatch(BatchSlot& slot, FlushReason reason) {
+    EventBatcher& batcher = slot.batcher;
+    size_t count = batcher.count();
+    Metrics::Timer compress(Stage::Compress);
+    if (!batcher.finish()) {
+        LOG_ERROR("Batch") << "❌ Failed to compress batch, dropping " << count << " events";
+        holdSources(slot);
+        recycle(slot);
+        return;
+    }
+    compress.stop();
+
+    size_t wireBytes = batcher.compressed() ? batcher.compressedBody().size() : batcher.body().size();
+    LOG_INFO("Batch") << "Sending " << count << " events ("
+                      << EventBatcher::reasonName(reason) << ", " << batcher.rawBytes() << " bytes"
+                      << (batcher.compressed() ? " -> " + std::to_string(wireBytes) + " zstd" : "") << ")...";
+
+    slot.state = BatchSlot::InFlight;
+    m_inFlight.push_back(&slot);
+    if (!startSend(slot)) {
+        slot.state = BatchSlot::Failed;
+    }
+    settleCompleted();
+}
+
+bool EventPipeline::startSend(BatchSlot& slot) {
+    EventBatcher& batcher = slot.batcher;
+
+    // Far over budget: disk is cheaper than TLS, and the batch is out of memory sooner
+    if (m_spool != nullptr && m_governor != nullptr && m_governor->spilling()) {
+        slot.throttled = true;
+        Metrics::add(Counter::BatchesSpilled);
+        return false;
+    }
+
+    if (m_rateController != nullptr) {
+        // Nothing goes out until the server's backoff window ends; the spool holds it meanwhile
+        if (m_spool != nullptr && m_rateController->throttled()) {
+            slot.throttled = true;
+            Metrics::add(Counter::BatchesThrottled);
+            return false;
+        }
+
+        auto wait = m_rateController->acquire();
+        if (wait.count() > 0) {
+            std::unique_lock<std::mutex> lock(m_sendMutex);
+            m_sendCV.wait_for(lock, wait, [this] { return !m_senderRunning.load(); });
+        }
+    }
+
+    if (m_asyncSender == nullptr && m_transport == nullptr) {
+        // Streaming mode: the body is already compressed, send the pooled buffer as-is.
+        // Otherwise HttpClient compresses, and that time counts as sending.
+        Metrics::Timer send(Stage::HttpSend);
+        bool sent = batcher.compressed()
+            ? m_httpClient.sendCompressedPayload(batcher.compressedBody(), batcher.contentType())
+            : m_httpClient.sendTelemetryPayload(batcher.body(), batcher.contentType());
+        if (sent) slot.state = BatchSlot::Sent;
+        return sent;
+    }
+
+    const std::vector<BYTE>* body = &batcher.compressedBody();
+    if (!batcher.compressed()) {
+        Metrics::Timer compress(Stage::Compress);
+        bool compressed = SimpleZstd::compress(batcher.body(), slot.wire);
+        compress.stop();
+        if (!compressed) {
+            LOG_WARN("Pipeline") << "Compression failed, sending batch synchronously";
+            Metrics::Timer send(Stage::HttpSend);
+            bool sent = m_httpClient.sendTelemetryPayload(batcher.body(), batcher.contentType());
+            if (sent) slot.state = BatchSlot::Sent;
+            return sent;
+        }
+        body = &slot.wire;
+    }
+
+    // Runs on a WinHTTP (or WebSocket) thread; the sender picks the result up in order
+    BatchSlot* target = &slot;
+    uint64_t startedAt = Metrics::now();
+    auto done = [this, target, startedAt](bool ok) {
+        Metrics::record(Stage::HttpSend, Metrics::now() - startedAt);
+        target->state.store(ok ? BatchSlot::Sent : BatchSlot::Failed);
+        std::lock_guard<std::mutex> lock(m_sendMutex);
+        m_sendCV.notify_one();
+    };
+
+    if (m_transport != nullptr) {
+        if (m_transport->sendBatch(*body, done)) return true;
+        LOG_DEBUG("Pipeline") << "Transport refused the batch, sending over HTTP";
+    }
+
+    if (m_asyncSender == nullptr) {
+        Metrics::Timer send(Stage::HttpSend);
+        bool sent = m_httpClient.sendCompressedPayload(*body, batcher.contentType());
+        if (sent) slot.state = BatchSlot::Sent;
+        return sent;
+    }
+    return m_asyncSender->postCompressed(*body, batcher.contentType(), std::move(done));
+}
+
+void EventPipeline::settleCompleted() {
+    while (!m_inFlight.empty() && m_inFlight.front()->state.load() != BatchSlot::InFlight) {
+        BatchSlot* slot = m_inFlight.front();
+        m_inFlight.pop_front();
+        settleBatch(*slot);
+        recycle(*slot);
+    }
+}
+
+void EventPipeline::settleBatch(BatchSlot& slot) {
+    EventBatcher& batcher = slot.batcher;
+    bool delivered = false;
+
+    if (batcher.empty()) {
+        delivered = slot.state.load() == BatchSlot::Sent;
+    } else if (slot.state.load() == BatchSlot::Sent) {
+        LOG_DEBUG("Batch") << "✅ Batch sent successfully";
+        Metrics::add(Counter::BatchesSent);
+        Metrics::add(Counter::BytesSent, wireSize(slot));
+        delivered = true;
+        if (m_spool != nullptr) m_spool->notifyOnline();
+    } else {
+        if (!slot.throttled) {
+            LOG_WARN("Batch") << "❌ Failed to send batch";
+            Metrics::add(Counter::BatchesFailed);
+        }
+        if (m_spool != nullptr && spoolBatch(slot)) {
+            LOG_INFO("Batch") << "Spooled to disk for replay";
+            Metrics::add(Counter::BatchesSpooled);
+            delivered = true;
+        } else {
+            holdSources(slot);
+        }
+    }
+
+    // Acknowledged (or safely on disk): the bookmark may now move past these records
+    if (delivered && m_bookmarks != nullptr) {
+        for (size_t source = 0; source < slot.positions.size(); source++) {
+            acknowledge((uint32_t)source, slot.positions[source]);
+        }
+    }
+
+    if (!batcher.compressed() && !batcher.empty()) {
+        size_t compressedBytes = !slot.wire.empty() ? slot.wire.size() : m_httpClient.getLastCompressedSize();
+        // The estimate lives in the batcher, so every slot learns from this batch
+        for (auto& other : m_slots) {
+            other->batcher.recordCompression(batcher.rawBytes(), compressedBytes);
+        }
+    }
+}
+
+size_t EventPipeline::wireSize(const BatchSlot& slot) const {
+    const EventBatcher& batcher = slot.batcher;
+    if (batcher.compressed()) return batcher.compressedBody().size();
+    if (!slot.wire.empty()) return slot.wire.size();
+    if (m_asyncSender == nullptr && m_transport == nullptr && m_httpClient.getLastCompressedSize() > 0) return m_httpClient.getLastCompressedSize();
+    return batcher.body().size();
+}
+
+void EventPipeline::recycle(BatchSlot& slot) {
+    std::fill(slot.positions.begin(), slot.positions.end(), 0);
+    slot.batcher.clear();
+    slot.wire.clear();
+    m_arena.release(slot.retired);
+    slot.throttled = false;
+    slot.state = BatchSlot::Filling;
+    m_freeSlots.push_back(&slot);
+}
+
+EventPipeline::BatchSlot* EventPipeline::acquireSlot() {
+    settleCompleted();
+    while (m_freeSlots.empty()) {
+        // Every slot is on the wire: wait for the oldest one. Meanwhile the
+        // converted queue fills up and backpressure reaches the workers.
+        std::unique_lock<std::mutex> lock(m_sendMutex);
+        m_sendCV.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return m_inFlight.front()->state.load() != BatchSlot::InFlight;
+        });
+        lock.unlock();
+        settleCompleted();
+    }
+
+    if (m_limitsChanged.exchange(false, std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_limitsMutex);
+        m_config.batch.maxEvents = m_pendingLimits.maxEvents;
+        m_config.batch.maxBytes = m_pendingLimits.maxBytes;
+        m_config.batch.maxDelayMs = m_pendingLimits.maxDelayMs;
+    }
+
+    BatchSlot* slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    slot->batcher.setLimits(m_config.batch);
+    if (m_rateController != nullptr) {
+        slot->batcher.setMaxEvents(m_rateController->batchEvents());
+    }
+    if (m_aggregator && m_governor != nullptr) {
+        m_aggregator->setWindowMs(m_config.aggregation.windowMs * m_governor->aggregationScale());
+    }
+    return slot;
+}
+
+void EventPipeline::waitInFlight() {
+    settleCompleted();
+    while (!m_inFlight.empty()) {
+        std::unique_lock<std::mutex> lock(m_sendMutex);
+        m_sendCV.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return m_inFlight.front()->state.load() != BatchSlot::InFlight;
+        });
+        lock.unlock();
+        settleCompleted();
+    }
+}
+
+bool EventPipeline::spoolBatch(const BatchSlot& slot) {
+    const EventBatcher& batcher = slot.batcher;
+    if (batcher.compressed()) {
+        return m_spool->append(batcher.compressedBody(), batcher.rawBytes(), batcher.binary());
+    }
+
+    // Normally the HTTP path already compressed it; spool exactly those bytes
+    const std::string& body = batcher.body();
+    if (!slot.wire.empty()) {
+        return m_spool->append(slot.wire, body.size(), batcher.binary());
+    }
+    if (m_asyncSender == nullptr && m_transport == nullptr && m_httpClient.getLastCompressedSize() > 0) {
+        return m_spool->append(m_httpClient.getLastCompressedPayload(), body.size(), batcher.binary());
+    }
+    if (!SimpleZstd::compress(body, m_spoolBuffer)) {
+        return false;
+    }
+    return m_spool->append(m_spoolBuffer, body.size(), batcher.binary());
+}
+
+// ============================================
+// Helpers
+// ============================================
+OverflowPolicy EventPipeline::parseOverflowPolicy(const std::string& name) {
+    if (name == "block") return OverflowPolicy::Block;
+    if (name == "drop_by_event_type") return OverflowPolicy::DropByEventType;
+    if (name != "drop_oldest" && !name.empty()) {
+        std::cerr << "[Pipeline] Unknown overflow_policy '" << name << "', using drop_oldest" << std::endl;
+    }
+    return OverflowPolicy::DropOldest;
+}
+
+// Reads the number inside the first <tag ...>123</tag> of the System block
+static uint64_t peekXmlNumber(const std::string& xml, const char* tag) {
+    size_t pos = xml.find(tag);
+    if (pos == std::string::npos) return 0;
+
+    // Skip any attributes (e.g. Qualifiers='') up to the closing '>'
+    pos = xml.find('>', pos);
+    if (pos == std::string::npos) return 0;
+
+    uint64_t value = 0;
+    for (size_t i = pos + 1; i < xml.size() && xml[i] >= '0' && xml[i] <= '9'; i++) {
+        value = value * 10 + (xml[i] - '0');
+    }
+    return value;
+}
+
+int EventPipeline::peekEventId(const std::string& xml) {
+    return (int)peekXmlNumber(xml, "<EventID");
+}
+
+uint64_t EventPipeline::peekRecordId(const std::string& xml) {
+    return peekXmlNumber(xml, "<EventRecordID");
+}
@@ -0,0 +1,291 @@
+#ifndef EVENTPIPELINE_HPP
+#define EVENTPIPELINE_HPP
+
+#include "AsyncHttpSender.hpp"
+#include "BatchTransport.hpp"
+#include "BookmarkStore.hpp"
+#include "BoundedQueue.hpp"
+#include "EventAggregator.hpp"
+#include "EventBatcher.hpp"
+#include "EventFilter.hpp"
+#include "EventRenderer.hpp"
+#include "HttpClient.hpp"
+#include "RateController.hpp"
+#include "ResourceGovernor.hpp"
+#include "TelemetryEvent.hpp"
+#include "TelemetrySpool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================
+// Event Pipeline
+// ============================================================
+// Decouples the EvtSubscribe callback from parsing and HTTP:
+//
+//   callback --render--> [worker queue] x N --> workers (sanitize/parse/convert)
+//                                                  |
+//                                      [worker output] x N --> sender --> HttpClient
+//
+// The callback only renders the event and pushes it. Every event gets the
+// next sequence number and goes to worker (sequence % N), so the sender
+// restores submission order (and with it EventRecordID order per
+// channel) by reading the outputs round-robin; no queue is shared between
+// workers. When a worker queue is full the configured overflow policy
+// decides what gives; an evicted sequence shows up as a gap the sender
+// steps over.
+//
+// With a BookmarkStore attached, every event carries its source and
+// EventRecordID to the sender, which acknowledges the highest record of
+// each source once the server has accepted the batch containing it.
+// With a TelemetrySpool attached, a batch the server did not take goes to
+// disk instead, and counts as acknowledged once it is there.
+//
+// With an AsyncHttpSender attached, the sender keeps filling the next
+// batch while up to maxInFlight earlier ones are on the wire. Results are
+// settled strictly in batch order (spool, then bookmarks), so a bookmark
+// never moves past a batch that is still in flight, whatever order the
+// server answers in. A batch neither sent nor spooled is lost: each
+// source in it stops acknowledging until the next start, which re-reads
+// from the held bookmark (so later batches come again as duplicates).
+//
+// With a BatchTransport attached (the agent's WebSocket), batches go over
+// that one connection first; a batch it refuses (disconnected, or too many
+// unanswered) goes over HTTP as above, and one it loses is spooled.
+//
+// With a RateController attached, each batch is sized and paced by it,
+// and while the server is throttling us batches go straight to the spool
+// without a request.
+//
+// With a ResourceGovernor attached, the pipeline degrades as the agent
+// goes over its own CPU/memory budget: workers shed the configured event
+// IDs before parsing them, aggregation windows widen, and at the critical
+// level batches go to the spool instead of the network.
+//
+// Workers convert into flat TelemetryEvents whose text buffers come from a
+// TelemetryArena; each batch slot hands its buffers back once it settles.
+//
+// With an EventFilter attached, workers run it on the extracted fields and
+// only convert the events it keeps. With aggregation enabled, the
+// sender folds repeats of the same key into one record per window before
+// batching; bookmarks stay below the oldest record still held.
+// ============================================================
+
+enum class OverflowPolicy {
+    DropOldest,       // Evict the oldest queued event to make room
+    DropByEventType,  // Drop incoming events whose ID is in the droppable list, block for the rest
+    Block             // Hold the callback until a worker frees a slot
+};
+
+struct PipelineConfig {
+    size_t queueDepth = 8192;
+    OverflowPolicy overflowPolicy = OverflowPolicy::DropOldest;
+    std::vector<int> droppableEventIds;   // Only used by DropByEventType
+    unsigned workerThreads = 0;           // 0 = one per core (capped at AUTO_WORKER_LIMIT)
+    BatchConfig batch;
+    AggregationConfig aggregation;
+};
+
+// What the callback hands over to the workers
+struct RenderedEvent {
+    RenderFormat format = RenderFormat::Xml;
+    int eventId = 0;
+    uint64_t sequence = 0;    // Submission order, assigned by the pipeline
+    uint64_t enqueuedAt = 0;  // Metrics::now() at submission (queue wait)
+    uint32_t source = 0;      // BookmarkStore source index
+    uint64_t recordId = 0;    // EventRecordID (0 = unknown)
+    std::string xml;          // RenderFormat::Xml
+    RenderedValues values;    // RenderFormat::Values
+};
+
+// What the workers hand over to the sender. An empty event is a position
+// marker for something that was filtered out, so bookmarks still advance.
+struct ConvertedEvent {
+    TelemetryEvent event;
+    uint64_t sequence = 0;
+    uint32_t source = 0;
+    uint64_t recordId = 0;
+};
+
+class EventPipeline {
+public:
+    // bookmarks / spool may be null (no resume tracking / failed batches are dropped).
+    // asyncSender null = one synchronous POST at a time through httpClient.
+    // filter null = every converted event is sent.
+    // transport null = HTTP only.
+    EventPipeline(HttpClient& httpClient, const PipelineConfig& config,
+                  BookmarkStore* bookmarks = nullptr, TelemetrySpool* spool = nullptr,
+                  AsyncHttpSender* asyncSender = nullptr, std::shared_ptr<const EventFilter> filter = nullptr,
+                  BatchTransport* transport = nullptr);
+    ~EventPipeline();
+
+    EventPipeline(const EventPipeline&) = delete;
+    EventPipeline& operator=(const EventPipeline&) = delete;
+
+    // Before start()
+    void setRateController(RateController* controller) { m_rateController = controller; }
+    void setGovernor(const ResourceGovernor* governor) { m_governor = governor; }
+
+    void start();
+
+    // Drains whatever is still queued and flushes the last partial batch
+    void stop();
+
+    // Any time (config reload). Workers pick up the new filter before their
+    // next event; null sends everything.
+    void setFilter(std::shared_ptr<const EventFilter> filter);
+
+    // Any time (config reload): max_events / max_bytes / max_delay_ms apply
+    // from the next batch. Format and compression mode need a restart.
+    void setBatchLimits(const BatchConfig& limits);
+
+    // Called from the subscription callback. Returns false if the event was dropped.
+    bool submit(RenderedEvent&& event);
+
+    // Pull mode: enqueues a whole EvtNext batch and wakes the workers once.
+    // block = wait for space whatever the overflow policy (bookmark back-fill).
+    // Returns the number of events accepted (the vector is left moved-from).
+    size_t submitBatch(std::vector<RenderedEvent>& events, bool block = false);
+
+    uint64_t submittedCount() const { return m_submitted.load(std::memory_order_relaxed); }
+    uint64_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // "drop_oldest" | "drop_by_event_type" | "block" (defaults to DropOldest)
+    static OverflowPolicy parseOverflowPolicy(const std::string& name);
+
+    // 0 -> hardware_concurrency() - 1, within [1, AUTO_WORKER_LIMIT]
+    static unsigned resolveWorkerCount(unsigned configured);
+    static constexpr unsigned AUTO_WORKER_LIMIT = 16;
+
+    // Cheap scan of <EventID>...</EventID> so the callback can apply
+    // DropByEventType without a full XML parse
+    static int peekEventId(const std::string& xml);
+    static uint64_t peekRecordId(const std::string& xml);
+
+private:
+    // A batch from the moment it starts filling until its result is settled
+    struct BatchSlot {
+        enum State { Filling, InFlight, Sent, Failed };
+
+        explicit BatchSlot(const BatchConfig& config) : batcher(config) {}
+
+        EventBatcher batcher;
+        std::vector<uint64_t> positions;   // Highest record per source in this batch
+        std::vector<BYTE> wire;            // Compressed body when the batcher is in plain mode
+        std::vector<std::string> retired;  // Event buffers, back to the arena on recycle
+        std::atomic<int> state{Filling};
+        bool throttled = false;            // Spooled without trying: the server asked us to back off, or we are over budget
+    };
+
+    // One conversion thread with its own input and output. Workers never
+    // share a queue, so neither side contends with the other workers.
+    struct Worker {
+        explicit Worker(size_t depth) : input(depth), output(depth) {}
+
+        BoundedQueue<RenderedEvent> input;
+        BoundedQueue<ConvertedEvent> output;
+        std::mutex mutex;                    // Sleeping worker is woken through cv
+        std::condition_variable cv;
+        std::thread thread;
+
+        // Sender thread only: output already popped, waiting for its turn
+        ConvertedEvent pending;
+        bool hasPending = false;
+
+        // Worker thread only: its copy of m_filter, refreshed when the generation moves
+        std::shared_ptr<const EventFilter> filter;
+        uint64_t filterGeneration = 0;
+    };
+
+    Worker& workerFor(uint64_t sequence) { return *m_workers[sequence % m_workers.size()]; }
+
+    // Returns the target worker (null if the event was dropped). No wakeup.
+    Worker* enqueue(RenderedEvent&& event, OverflowPolicy policy);
+    bool tryDispatch(RenderedEvent& event, Worker*& target);   // target is set either way
+    void countSubmitted();
+    void countDropped();
+    void workerLoop(Worker& worker);
+    void senderLoop();
+    void processEvent(Worker& worker, RenderedEvent& event);
+    bool pushConverted(Worker& worker, ConvertedEvent&& converted);
+    // Sender thread only: next event in submission order, then aggregation and the filling batch
+    bool popNext(ConvertedEvent& converted);
+    bool nextReady();
+    bool accept(ConvertedEvent& converted);              // true if it flushed a batch
+    bool releaseAggregates(bool flushAll);
+    bool flushIfDue();
+    void acknowledge(uint32_t source, uint64_t recordId);
+    void holdSources(const BatchSlot& slot);             // The batch was lost
+    void addToBatch(BatchSlot& slot, ConvertedEvent& converted);
+    void flushBatch(BatchSlot& slot, FlushReason reason);
+    bool startSend(BatchSlot& slot);
+
+    // Sender thread only: settle finished batches in order / get a free slot
+    void settleCompleted();
+    void settleBatch(BatchSlot& slot);
+    size_t wireSize(const BatchSlot& slot) const;   // Bytes that went out for this batch
+    void recycle(BatchSlot& slot);
+    BatchSlot* acquireSlot();
+    void waitInFlight();
+    bool spoolBatch(const BatchSlot& slot);
+
+    void notifyWorker(Worker& worker);
+    void notifySender();
+
+    HttpClient& m_httpClient;
+    PipelineConfig m_config;
+    BookmarkStore* m_bookmarks;
+    TelemetrySpool* m_spool;
+    AsyncHttpSender* m_asyncSender;
+    std::shared_ptr<const EventFilter> m_filter;   // std::atomic_load / atomic_store only
+    std::atomic<uint64_t> m_filterGeneration{1};
+    BatchTransport* m_transport;
+    RateController* m_rateController = nullptr;
+    const ResourceGovernor* m_governor = nullptr;
+    TelemetryArena m_arena;
+    std::vector<BYTE> m_spoolBuffer;          // Only used when the HTTP path did not compress
+
+    // Sender thread only. One slot fills while the others are in flight.
+    std::vector<std::unique_ptr<BatchSlot>> m_slots;
+    std::vector<BatchSlot*> m_freeSlots;
+    std::deque<BatchSlot*> m_inFlight;        // Oldest first
+    BatchSlot* m_filling = nullptr;
+    std::unique_ptr<EventAggregator> m_aggregator;
+    std::vector<bool> m_heldSources;          // Bookmark stays before a lost batch until restart
+    std::unordered_set<int> m_droppableIds;
+
+    // setBatchLimits() -> sender thread, picked up in acquireSlot()
+    std::mutex m_limitsMutex;
+    BatchConfig m_pendingLimits;
+    std::atomic<bool> m_limitsChanged{false};
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // Producers only: sequence numbers are handed out in push order, so
+    // every worker queue holds increasing sequences. Uncontended in
+    // practice (one producer per subscription) and held for a push only.
+    std::mutex m_dispatchMutex;
+    uint64_t m_nextDispatch = 0;
+    uint64_t m_nextMerge = 0;                  // Sender thread only
+
+    std::atomic<bool> m_running{false};        // Workers accept/process events
+    std::atomic<bool> m_senderRunning{false};  // Outlives the workers so their output gets flushed
+    std::thread m_senderThread;
+
+    // A sleeping sender is woken through these; the queues themselves stay lock-free
+    std::mutex m_sendMutex;
+    std::condition_variable m_sendCV;
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_dropped{0};
+};
+
+#endif // EVENTPIPELINE_HPP
@@ -0,0 +1,352 @@
+// EventRenderer.cpp - Windows Event Log rendering and XML -> JSON helpers
+#include "EventRenderer.hpp"
+#include "pugixml.hpp"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cwchar>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// ============================================
+// Convert Event to XML
+// ============================================
+// Renders into a per-thread buffer kept at the largest event seen so far.
+// The common case is one EvtRender call; only a bigger event than any
+// before it pays for the size probe and a second call.
+DWORD EventToEventXml(EVT_HANDLE hEvent, std::string& eventXml) {
+    thread_local std::vector<WCHAR> content(4096);
+    DWORD dwBufferUsed = 0;
+    DWORD dwPropertyCount = 0;
+
+    if (!EvtRender(NULL, hEvent, EvtRenderEventXml, (DWORD)(content.size() * sizeof(WCHAR)),
+                   content.data(), &dwBufferUsed, &dwPropertyCount)) {
+        DWORD status = GetLastError();
+        if (status != ERROR_INSUFFICIENT_BUFFER) {
+            std::wcout << L"EvtRender failed with error: " << status << std::endl;
+            return status;
+        }
+
+        // Buffer sizes are in bytes
+        content.resize(dwBufferUsed / sizeof(WCHAR) + 1);
+        if (!EvtRender(NULL, hEvent, EvtRenderEventXml, (DWORD)(content.size() * sizeof(WCHAR)),
+                       content.data(), &dwBufferUsed, &dwPropertyCount)) {
+            status = GetLastError();
+            std::wcout << L"EvtRender failed with error: " << status << std::endl;
+            return status;
+        }
+    }
+
+    // Convert wide string to UTF-8 in one pass, straight into eventXml (keeps its capacity)
+    eventXml.clear();
+    size_t length = wcsnlen(content.data(), dwBufferUsed / sizeof(WCHAR));   // Drop the null terminator
+    wideToUtf8(content.data(), length, eventXml);
+    return ERROR_SUCCESS;
+}
+
+// ============================================
+// Convert XML to JSON (Sysmon Format)
+// ============================================
+std::string EventXmlToEventJson(const std::string& xml) {
+    try {
+        pugi::xml_document doc;
+        pugi::xml_parse_result result = doc.load_string(xml.c_str());
+
+        if (!result) {
+            std::cerr << "XML parsing failed: " << result.description() << std::endl;
+            return "";
+        }
+
+        nlohmann::json systemJson;
+        nlohmann::json eventDataJson;
+        nlohmann::json eventJson;
+
+        for (pugi::xml_node node : doc.child("Event").children()) {
+            std::string_view sectionName = node.name();
+
+            // Parse System section
+            if (sectionName == "System") {
+                for (pugi::xml_node child : node.children()) {
+                    const SysmonSchema::SystemFieldName* entry = SysmonSchema::findSystemField(child.name());
+                    if (entry == nullptr) continue;
+
+                    switch (entry->field) {
+                        case SysmonSchema::SystemField::Channel:
+                            systemJson["Channel"] = child.text().as_string();
+                            break;
+                        case SysmonSchema::SystemField::Computer:
+                            systemJson["Computer"] = child.text().as_string();
+                            break;
+                        case SysmonSchema::SystemField::Correlation:
+                            systemJson["Correlation"] = nlohmann::json::object();
+                            if (child.attribute("ActivityID")) {
+                                systemJson["Correlation"]["ActivityID"] = child.attribute("ActivityID").value();
+                            }
+                            break;
+                        case SysmonSchema::SystemField::EventID:
+                            systemJson["EventID"] = child.text().as_int();
+                            break;
+                        case SysmonSchema::SystemField::EventRecordID:
+                            systemJson["EventRecordID"] = child.text().as_int();
+                            break;
+                        case SysmonSchema::SystemField::Execution:
+                            systemJson["Execution"]["ProcessID"] = child.attribute("ProcessID").as_int();
+                            systemJson["Execution"]["ThreadID"] = child.attribute("ThreadID").as_int();
+                            break;
+                        case SysmonSchema::SystemField::Keywords:
+                            systemJson["Keywords"] = child.text().as_string();
+                            break;
+                        case SysmonSchema::SystemField::Level:
+                            systemJson["Level"] = child.text().as_int();
+                            break;
+                        case SysmonSchema::SystemField::Provider:
+                            systemJson["Provider"]["Name"] = child.attribute("Name").value();
+                            if (child.attribute("Guid")) {
+                                systemJson["Provider"]["Guid"] = child.attribute("Guid").value();
+                            }
+                            break;
+                        case SysmonSchema::SystemField::Security:
+                            if (child.attribute("UserID")) {
+                                systemJson["Security"]["UserID"] = child.attribute("UserID").value();
+                            }
+                            break;
+                        case SysmonSchema::SystemField::TimeCreated:
+                            systemJson["TimeCreated"]["SystemTime"] = child.attribute("SystemTime").value();
+                            break;
+                        case SysmonSchema::SystemField::Version:
+                            systemJson["Version"] = child.text().as_int();
+                            break;
+                    }
+                }
+            }
+            // Parse EventData section
+            else if (sectionName == "EventData") {
+                for (pugi::xml_node child : node.children()) {
+                    const char* name = child.attribute("Name").value();
+                    const SysmonSchema::DataField* field = SysmonSchema::findDataField(name);
+
+                    // Integer fields per the schema table, everything else as text
+                    if (field != nullptr && field->integer) {
+                        eventDataJson[name] = child.text().as_int();
+                    } else {
+                        eventDataJson[name] = child.text().as_string();
+                    }
+                }
+            }
+        }
+
+        // Build final JSON
+        eventJson["type"] = "event";
+        eventJson["info"]["System"] = systemJson;
+        eventJson["info"]["EventData"] = eventDataJson;
+
+        return eventJson.dump(4);
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error in EventXmlToEventJson: " << e.what() << std::endl;
+        return "";
+    }
+}
+
+// ============================================
+// Values Rendering
+// ============================================
+namespace {
+
+    const wchar_t* const SYSMON_CHANNEL = L"Microsoft-Windows-Sysmon/Operational";
+
+    // One render context per SysmonSchema::SYSMON_EVENTS row; it selects
+    // the row's fields, in the row's order
+    struct ValueContext {
+        EVT_HANDLE hContext = NULL;
+        const SysmonSchema::EventSpec* spec = nullptr;
+        size_t fieldCount = 0;
+    };
+
+    // Built once by InitValueRenderContexts and read-only afterwards, so
+    // the callback threads can use them without locking
+    EVT_HANDLE g_systemContext = NULL;
+    std::unordered_map<int, ValueContext> g_valueContexts;
+
+    // Renders into a per-thread buffer that only grows
+    DWORD renderValues(EVT_HANDLE hContext, EVT_HANDLE hEvent, std::vector<BYTE>& buffer,
+                       DWORD& propertyCount) {
+        DWORD used = 0;
+        if (EvtRender(hContext, hEvent, EvtRenderEventValues, (DWORD)buffer.size(),
+                      buffer.data(), &used, &propertyCount)) {
+            return ERROR_SUCCESS;
+        }
+
+        DWORD status = GetLastError();
+        if (status != ERROR_INSUFFICIENT_BUFFER) return status;
+
+        buffer.resize(used);
+        if (!EvtRender(hContext, hEvent, EvtRenderEventValues, (DWORD)buffer.size(),
+                       buffer.data(), &used, &propertyCount)) {
+            return GetLastError();
+        }
+        return ERROR_SUCCESS;
+    }
+
+    void appendString(RenderedValues& values, size_t slot, LPCWSTR wide) {
+        values.offset[slot] = (uint32_t)values.strings.size();
+        values.length[slot] = 0;
+        if (wide == nullptr || *wide == L'\0') return;
+
+        size_t start = values.strings.size();
+        wideToUtf8(wide, wcslen(wide), values.strings);
+        values.length[slot] = (uint32_t)(values.strings.size() - start);
+    }
+
+    int variantToInt(const EVT_VARIANT& v) {
+        switch (v.Type & EVT_VARIANT_TYPE_MASK) {
+            case EvtVarTypeByte:     return v.ByteVal;
+            case EvtVarTypeUInt16:   return v.UInt16Val;
+            case EvtVarTypeInt32:    return v.Int32Val;
+            case EvtVarTypeUInt32:
+            case EvtVarTypeHexInt32: return (int)v.UInt32Val;
+            case EvtVarTypeInt64:    return (int)v.Int64Val;
+            case EvtVarTypeUInt64:
+            case EvtVarTypeHexInt64: return (int)v.UInt64Val;
+            case EvtVarTypeString:   return v.StringVal ? _wtoi(v.StringVal) : 0;
+            default:                 return 0;
+        }
+    }
+
+    void storeString(RenderedValues& values, size_t slot, const EVT_VARIANT& v) {
+        bool isString = (v.Type & EVT_VARIANT_TYPE_MASK) == EvtVarTypeString;
+        appendString(values, slot, isString ? v.StringVal : nullptr);
+    }
+}
+
+void RenderedValues::clear() {
+    eventId = 0;
+    recordId = 0;
+    timeCreated = 0;
+    spec = nullptr;
+    count = 0;
+    for (size_t i = 0; i < SlotCount; i++) {
+        offset[i] = 0;
+        length[i] = 0;
+    }
+    for (int& v : ints) v = 0;
+    strings.clear();
+}
+
+bool InitValueRenderContexts() {
+    g_systemContext = EvtCreateRenderContext(0, NULL, EvtRenderContextSystem);
+    if (g_systemContext == NULL) {
+        std::cerr << "[Render] EvtCreateRenderContext(System) failed: " << GetLastError() << std::endl;
+        return false;
+    }
+
+    for (const SysmonSchema::EventSpec& spec : SysmonSchema::SYSMON_EVENTS) {
+        std::vector<std::wstring> xpaths;
+        std::vector<LPCWSTR> xpathPtrs;
+        ValueContext ctx;
+        ctx.spec = &spec;
+        ctx.fieldCount = SysmonSchema::fieldCount(spec);
+
+        for (size_t i = 0; i < ctx.fieldCount; i++) {
+            std::string_view name = spec.fields[i]->name;   // ASCII
+            xpaths.push_back(std::wstring(L"Event/EventData/Data[@Name='") +
+                             std::wstring(name.begin(), name.end()) + L"']");
+        }
+        for (const auto& xpath : xpaths) {
+            xpathPtrs.push_back(xpath.c_str());
+        }
+
+        ctx.hContext = EvtCreateRenderContext((DWORD)xpathPtrs.size(), xpathPtrs.data(), EvtRenderContextValues);
+        if (ctx.hContext == NULL) {
+            std::cerr << "[Render] EvtCreateRenderContext for Event ID " << spec.eventId
+                      << " failed: " << GetLastError() << std::endl;
+            continue;  // That ID just uses the XML path
+        }
+        g_valueContexts[spec.eventId] = std::move(ctx);
+    }
+
+    std::cout << "[Render] Values rendering enabled for " << g_valueContexts.size()
+              << " Sysmon event ID(s)" << std::endl;
+    return true;
+}
+
+void CloseValueRenderContexts() {
+    for (auto& entry : g_valueContexts) {
+        if (entry.second.hContext) EvtClose(entry.second.hContext);
+    }
+    g_valueContexts.clear();
+
+    if (g_systemContext) {
+        EvtClose(g_systemContext);
+        g_systemContext = NULL;
+    }
+}
+
+DWORD EventToEventValues(EVT_HANDLE hEvent, RenderedValues& values) {
+    if (g_systemContext == NULL) return ERROR_NOT_SUPPORTED;
+
+    thread_local std::vector<BYTE> systemBuffer(2048);
+    thread_local std::vector<BYTE> dataBuffer(4096);
+
+    // Step 1: System properties (ID, record ID, time, computer, channel)
+    DWORD propertyCount = 0;
+    DWORD status = renderValues(g_systemContext, hEvent, systemBuffer, propertyCount);
+    if (status != ERROR_SUCCESS) return status;
+    if (propertyCount < EvtSystemPropertyIdEND) return ERROR_NOT_SUPPORTED;
+
+    const EVT_VARIANT* sys = reinterpret_cast<const EVT_VARIANT*>(systemBuffer.data());
+
+    const EVT_VARIANT& channel = sys[EvtSystemChannel];
+    if ((channel.Type & EVT_VARIANT_TYPE_MASK) != EvtVarTypeString || channel.StringVal == nullptr ||
+        wcscmp(channel.StringVal, SYSMON_CHANNEL) != 0) {
+        return ERROR_NOT_SUPPORTED;
+    }
+
+    int eventId = variantToInt(sys[EvtSystemEventID]);
+    auto it = g_valueContexts.find(eventId);
+    if (it == g_valueContexts.end()) return ERROR_NOT_SUPPORTED;
+
+    values.clear();
+    values.eventId = eventId;
+    values.recordId = sys[EvtSystemEventRecordId].UInt64Val;
+    if ((sys[EvtSystemTimeCreated].Type & EVT_VARIANT_TYPE_MASK) == EvtVarTypeFileTime) {
+        values.timeCreated = sys[EvtSystemTimeCreated].FileTimeVal;
+    }
+    storeString(values, RenderedValues::ComputerSlot, sys[EvtSystemComputer]);
+    storeString(values, RenderedValues::ChannelSlot, channel);
+
+    // Step 2: Only the EventData fields we actually use
+    const ValueContext& ctx = it->second;
+    status = renderValues(ctx.hContext, hEvent, dataBuffer, propertyCount);
+    if (status != ERROR_SUCCESS) return status;
+
+    const EVT_VARIANT* data = reinterpret_cast<const EVT_VARIANT*>(dataBuffer.data());
+    values.spec = ctx.spec;
+    values.count = (uint8_t)std::min<size_t>(propertyCount, ctx.fieldCount);
+    for (size_t i = 0; i < values.count; i++) {
+        if (ctx.spec->fields[i]->number) {
+            values.ints[i] = variantToInt(data[i]);
+        } else {
+            storeString(values, i, data[i]);
+        }
+    }
+
+    return ERROR_SUCCESS;
+}
+
+void ValuesToEventFields(const RenderedValues& values, EventFields& fields) {
+    fields.eventId = values.eventId;
+    fields.recordId = values.recordId;
+    fields.timeCreated = values.timeCreated;
+    fields.computer = values.get(RenderedValues::ComputerSlot);
+    fields.channel = values.get(RenderedValues::ChannelSlot);
+    if (values.spec == nullptr) return;
+
+    for (size_t i = 0; i < values.count; i++) {
+        const SysmonSchema::DataField& field = *values.spec->fields[i];
+        if (field.number) SysmonSchema::store(field, fields, values.ints[i]);
+        else SysmonSchema::store(field, fields, values.get(i));
+    }
+}
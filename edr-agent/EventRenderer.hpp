@@ -0,0 +1,77 @@
+#ifndef EVENTRENDERER_HPP
+#define EVENTRENDERER_HPP
+
+#include <Windows.h>
+#include <winevt.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "EventConverter.hpp"
+#include "Utf8.hpp"             // sanitizeUtf8 / wideToUtf8
+
+#pragma comment(lib, "wevtapi.lib")
+
+// ============================================
+// XML Rendering
+// ============================================
+
+// Renders an event handle to its UTF-8 XML representation. The conversion
+// always yields valid UTF-8, so the result needs no sanitizing.
+DWORD EventToEventXml(EVT_HANDLE hEvent, std::string& eventXml);
+
+// Converts rendered event XML to the Sysmon JSON format ({"type", "info": {System, EventData}})
+std::string EventXmlToEventJson(const std::string& xml);
+
+// ============================================
+// Values Rendering (EvtRenderEventValues)
+// ============================================
+// Sysmon events with a known ID are rendered through cached render
+// contexts that select only the fields EventConverter uses, so there is
+// no XML to build or parse. Anything else falls back to XML.
+
+enum class RenderFormat {
+    Xml,
+    Values
+};
+
+// One event's values, packed in a single string buffer so it moves
+// through the pipeline queue without per-field allocations. Slot i holds
+// spec->fields[i]; computer and channel sit after the EventData slots.
+struct RenderedValues {
+    enum : size_t {
+        ComputerSlot = SysmonSchema::MAX_EVENT_FIELDS,
+        ChannelSlot,
+        SlotCount
+    };
+
+    int eventId = 0;
+    uint64_t recordId = 0;
+    uint64_t timeCreated = 0;   // FILETIME ticks (100 ns since 1601-01-01 UTC)
+    const SysmonSchema::EventSpec* spec = nullptr;   // Static table row
+    uint8_t count = 0;          // EventData slots filled
+
+    uint32_t offset[SlotCount] = {};
+    uint32_t length[SlotCount] = {};
+    int ints[SysmonSchema::MAX_EVENT_FIELDS] = {};
+    std::string strings;
+
+    std::string_view get(size_t slot) const {
+        return std::string_view(strings.data() + offset[slot], length[slot]);
+    }
+
+    void clear();
+};
+
+// Creates the system context and one values context per known Sysmon event ID
+bool InitValueRenderContexts();
+void CloseValueRenderContexts();
+
+// Returns ERROR_NOT_SUPPORTED when the event has no cached context (the
+// caller should fall back to EventToEventXml)
+DWORD EventToEventValues(EVT_HANDLE hEvent, RenderedValues& values);
+
+// Points an EventFields view at the packed values (no copies)
+void ValuesToEventFields(const RenderedValues& values, EventFields& fields);
+
+#endif // EVENTRENDERER_HPP
@@ -0,0 +1,475 @@
+#include "EventSubscriber.hpp"
+#include "EventRenderer.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+EventSubscriber::EventSubscriber(EventPipeline& pipeline, const SubscriberConfig& config,
+                                 BookmarkStore* bookmarks)
+    : m_pipeline(pipeline)
+    , m_config(config)
+    , m_bookmarks(bookmarks)
+{
+    if (m_config.pullBatchSize == 0) {
+        m_config.pullBatchSize = 1;
+    }
+}
+
+EventSubscriber::~EventSubscriber() {
+    stop();
+}
+
+SubscribeMode EventSubscriber::parseMode(const std::string& name) {
+    if (name == "pull") return SubscribeMode::Pull;
+    if (name != "callback" && !name.empty()) {
+        std::cerr << "[Subscriber] Unknown subscribe_mode '" << name << "', using callback" << std::endl;
+    }
+    return SubscribeMode::Callback;
+}
+
+// ============================================
+// Subscribe
+// ============================================
+size_t EventSubscriber::subscribe(const std::vector<std::pair<std::wstring, std::wstring>>& sources) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool pullMode = (m_config.mode == SubscribeMode::Pull);
+
+    // WaitForMultipleObjects caps us at 64 handles, one of which is the stop event
+    if (pullMode && sources.size() > MAXIMUM_WAIT_OBJECTS - 1) {
+        std::cerr << "[Subscriber] Too many sources for pull mode, using callback mode" << std::endl;
+        pullMode = false;
+        m_config.mode = SubscribeMode::Callback;
+    }
+
+    m_running = true;
+
+    for (const auto& pair : sources) {
+        auto sub = openSource(pair.first, pair.second, pullMode);
+        if (sub) m_subscriptions.push_back(std::move(sub));
+    }
+
+    if (pullMode && !m_subscriptions.empty()) {
+        startPullThread();
+    }
+
+    return m_subscriptions.size();
+}
+
+size_t EventSubscriber::update(const std::vector<std::pair<std::wstring, std::wstring>>& sources) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_running) return 0;
+
+    bool pullMode = (m_config.mode == SubscribeMode::Pull);
+    if (pullMode && sources.size() > MAXIMUM_WAIT_OBJECTS - 1) {
+        std::cerr << "[Subscriber] ⚠️ Too many sources for pull mode, keeping the current subscriptions" << std::endl;
+        return m_subscriptions.size();
+    }
+
+    // Unchanged (path, query) pairs keep their subscription untouched
+    std::vector<std::unique_ptr<Subscription>> kept;
+    std::vector<std::unique_ptr<Subscription>> retired;
+    std::vector<bool> covered(sources.size(), false);
+    for (auto& sub : m_subscriptions) {
+        size_t match = sources.size();
+        for (size_t i = 0; i < sources.size(); i++) {
+            if (!covered[i] && sources[i].first == sub->path && sources[i].second == sub->query) {
+                match = i;
+                break;
+            }
+        }
+        if (match < sources.size()) {
+            covered[match] = true;
+            kept.push_back(std::move(sub));
+        } else {
+            retired.push_back(std::move(sub));
+        }
+    }
+
+    size_t added = (size_t)std::count(covered.begin(), covered.end(), false);
+    if (retired.empty() && added == 0) {
+        m_subscriptions = std::move(kept);
+        return m_subscriptions.size();
+    }
+
+    // The pull thread waits on the handle set it started with
+    if (pullMode) stopPullThread();
+
+    // New subscriptions open before the old ones close, so a changed query
+    // overlaps the previous one instead of leaving a gap. With bookmarks it
+    // resumes after the last acknowledged record: repeats, never losses.
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (covered[i]) continue;
+        auto sub = openSource(sources[i].first, sources[i].second, pullMode);
+        if (sub) kept.push_back(std::move(sub));
+    }
+    for (auto& sub : retired) {
+        std::wcout << L"  → Unsubscribed from: " << sub->path << std::endl;
+        closeSubscription(*sub);
+    }
+    m_subscriptions = std::move(kept);
+
+    if (pullMode && !m_subscriptions.empty()) {
+        startPullThread();
+    }
+
+    std::cout << "[Subscriber] ✓ " << added << " source(s) added, " << retired.size()
+              << " removed, " << m_subscriptions.size() << " active" << std::endl;
+    return m_subscriptions.size();
+}
+
+std::unique_ptr<EventSubscriber::Subscription> EventSubscriber::openSource(const std::wstring& pwsPath,
+                                                                           const std::wstring& pwsQuery,
+                                                                           bool pullMode) {
+    std::wcout << L"  → Subscribing to: " << pwsPath
+               << (pullMode ? L" (pull)" : L" (callback)") << std::endl;
+
+    auto sub = std::make_unique<Subscription>();
+    sub->owner = this;
+    sub->path = pwsPath;
+    sub->query = pwsQuery;
+    sub->source = (uint32_t)(m_bookmarks ? m_bookmarks->registerSource(pwsPath) : m_nextSource++);
+
+    // Resume point, if we have one
+    EVT_HANDLE hBookmark = NULL;
+    if (m_bookmarks) {
+        std::wstring bookmarkXml = m_bookmarks->bookmarkXml(sub->source);
+        if (!bookmarkXml.empty()) {
+            hBookmark = EvtCreateBookmark(bookmarkXml.c_str());
+            if (hBookmark == NULL) {
+                std::wcout << L"  ⚠️ Saved bookmark rejected (Error: " << GetLastError()
+                           << L"), starting from live events" << std::endl;
+            } else {
+                std::wcout << L"  → Resuming after record " << m_bookmarks->recordId(sub->source) << std::endl;
+            }
+        }
+    }
+
+    bool subscribed = false;
+    if (pullMode) {
+        sub->hSignal = CreateEventW(NULL, TRUE, FALSE, NULL);  // Manual reset, set by wevtapi
+        if (sub->hSignal == NULL) {
+            std::wcout << L"  ❌ CreateEvent failed with error: " << GetLastError() << std::endl;
+        } else {
+            sub->hSubscription = openSubscription(*sub, pwsQuery, sub->hSignal, hBookmark);
+            sub->backfilling = (hBookmark != NULL);
+            subscribed = (sub->hSubscription != NULL);
+        }
+    } else if (hBookmark != NULL) {
+        subscribed = backfillThenSubscribe(*sub, pwsQuery, hBookmark);
+    } else {
+        sub->hSubscription = openSubscription(*sub, pwsQuery, NULL, NULL);
+        subscribed = (sub->hSubscription != NULL);
+    }
+
+    if (hBookmark) EvtClose(hBookmark);
+
+    if (!subscribed) {
+        closeSubscription(*sub);
+        return nullptr;
+    }
+
+    std::wcout << L"  ✓ Subscribed successfully" << std::endl;
+    return sub;
+}
+
+void EventSubscriber::closeSubscription(Subscription& sub) {
+    // Blocks until a running callback for it has returned
+    if (sub.hSubscription) EvtClose(sub.hSubscription);
+    if (sub.hSignal) CloseHandle(sub.hSignal);
+    if (sub.hBookmark) EvtClose(sub.hBookmark);
+    sub.hSubscription = NULL;
+    sub.hSignal = NULL;
+    sub.hBookmark = NULL;
+}
+
+void EventSubscriber::startPullThread() {
+    if (m_stopEvent == NULL) {
+        m_stopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    } else {
+        ResetEvent(m_stopEvent);
+    }
+    m_pullThread = std::thread(&EventSubscriber::pullLoop, this);
+}
+
+void EventSubscriber::stopPullThread() {
+    if (m_stopEvent) SetEvent(m_stopEvent);
+    if (m_pullThread.joinable()) m_pullThread.join();
+}
+
+EVT_HANDLE EventSubscriber::openSubscription(Subscription& sub, const std::wstring& query,
+                                             HANDLE hSignal, EVT_HANDLE hBookmark) {
+    EVT_HANDLE hSubscription = EvtSubscribe(
+        NULL,
+        hSignal,
+        sub.path.c_str(),
+        query.c_str(),
+        hBookmark,
+        hSignal ? NULL : &sub,
+        hSignal ? NULL : (EVT_SUBSCRIBE_CALLBACK)subscriptionCallback,
+        hBookmark ? EvtSubscribeStartAfterBookmark : EvtSubscribeToFutureEvents
+    );
+
+    if (NULL == hSubscription) {
+        DWORD status = GetLastError();
+
+        if (ERROR_EVT_CHANNEL_NOT_FOUND == status) {
+            std::wcout << L"  ⚠️ Channel not found: " << sub.path << std::endl;
+        } else if (ERROR_EVT_INVALID_QUERY == status) {
+            std::wcout << L"  ⚠️ Invalid query: " << query << std::endl;
+        } else if (hBookmark != NULL) {
+            // The saved position is unusable (e.g. the log was cleared): go live instead
+            std::wcout << L"  ⚠️ Cannot resume from bookmark (Error: " << status
+                       << L"), starting from live events" << std::endl;
+            return openSubscription(sub, query, hSignal, NULL);
+        } else {
+            std::wcout << L"  ❌ Subscribe failed with error: " << status << std::endl;
+        }
+    }
+    return hSubscription;
+}
+
+bool EventSubscriber::backfillThenSubscribe(Subscription& sub, const std::wstring& query, EVT_HANDLE hBookmark) {
+    // Pull the backlog through the batch path first; the callback engine
+    // would deliver it one event (and one wakeup) at a time
+    sub.hSignal = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (sub.hSignal == NULL) {
+        std::wcout << L"  ❌ CreateEvent failed with error: " << GetLastError() << std::endl;
+        return false;
+    }
+
+    sub.hSubscription = openSubscription(sub, query, sub.hSignal, hBookmark);
+    if (sub.hSubscription == NULL) {
+        return false;
+    }
+
+    sub.hBookmark = EvtCreateBookmark(NULL);
+    sub.backfilling = true;
+
+    uint64_t before = m_backfilled.load(std::memory_order_relaxed);
+    std::vector<EVT_HANDLE> handles(m_config.pullBatchSize);
+    std::vector<RenderedEvent> batch;
+    batch.reserve(m_config.pullBatchSize);
+    // The first EvtNext can come back empty with a backlog still being
+    // loaded: pull once the subscription signals, until it runs dry
+    while (sub.backfilling && m_running) {
+        if (WaitForSingleObject(sub.hSignal, BACKFILL_SIGNAL_WAIT_MS) != WAIT_OBJECT_0) {
+            if (!sub.signaled) std::wcout << L"  ✓ Nothing to back-fill: " << sub.path << std::endl;
+            sub.backfilling = false;
+            break;
+        }
+        drainSubscription(sub, handles, batch);
+    }
+    bool pulledAny = m_backfilled.load(std::memory_order_relaxed) != before;
+
+    EvtClose(sub.hSubscription);
+    CloseHandle(sub.hSignal);
+    sub.hSignal = NULL;
+
+    // Hand over to the live callback right after the last back-filled record.
+    // Anything written during the back-fill is still ahead of that bookmark.
+    EVT_HANDLE hHandOver = (pulledAny && sub.hBookmark) ? sub.hBookmark : hBookmark;
+    sub.hSubscription = openSubscription(sub, query, NULL, hHandOver);
+
+    if (sub.hBookmark) {
+        EvtClose(sub.hBookmark);
+        sub.hBookmark = NULL;
+    }
+    return sub.hSubscription != NULL;
+}
+
+void EventSubscriber::stop() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running.exchange(false)) {
+        stopPullThread();
+    }
+
+    for (auto& sub : m_subscriptions) {
+        closeSubscription(*sub);
+    }
+    m_subscriptions.clear();
+
+    if (m_stopEvent) {
+        CloseHandle(m_stopEvent);
+        m_stopEvent = NULL;
+    }
+}
+
+// ============================================
+// Rendering (shared by both engines)
+// ============================================
+DWORD EventSubscriber::renderEvent(EVT_HANDLE hEvent, uint32_t source, RenderedEvent& rendered) {
+    rendered.source = source;
+    Metrics::Timer timer(Stage::Render);
+
+    // Known Sysmon IDs: typed values straight from the cached render contexts
+    if (m_config.useValueRender && EventToEventValues(hEvent, rendered.values) == ERROR_SUCCESS) {
+        rendered.format = RenderFormat::Values;
+        rendered.eventId = rendered.values.eventId;
+        rendered.recordId = rendered.values.recordId;
+        return ERROR_SUCCESS;
+    }
+
+    // Everything else (e.g. PowerShell 4104): full XML
+    DWORD status = EventToEventXml(hEvent, rendered.xml);
+    if (status != ERROR_SUCCESS) {
+        LOG_ERROR("Subscriber") << "❌ Failed to convert event to XML (Error: " << status << ")";
+        return status;
+    }
+    rendered.format = RenderFormat::Xml;
+    rendered.eventId = EventPipeline::peekEventId(rendered.xml);
+    rendered.recordId = EventPipeline::peekRecordId(rendered.xml);
+    return ERROR_SUCCESS;
+}
+
+// ============================================
+// Callback Engine
+// ============================================
+// Runs on the wevtapi callback thread, so it only renders the event and
+// hands it to the pipeline.
+DWORD WINAPI EventSubscriber::subscriptionCallback(EVT_SUBSCRIBE_NOTIFY_ACTION action,
+                                                   PVOID pContext,
+                                                   EVT_HANDLE hEvent) {
+    Subscription* sub = static_cast<Subscription*>(pContext);
+    DWORD status = ERROR_SUCCESS;
+
+    switch (action) {
+        case EvtSubscribeActionError:
+            if (ERROR_EVT_QUERY_RESULT_STALE == (uintptr_t)hEvent) {
+                std::wcout << L"⚠️ Event records are missing" << std::endl;
+            } else {
+                std::wcout << L"❌ Subscription error: " << (uintptr_t)hEvent << std::endl;
+            }
+            break;
+
+        case EvtSubscribeActionDeliver:
+            try {
+                RenderedEvent rendered;
+                status = sub->owner->renderEvent(hEvent, sub->source, rendered);
+                if (status == ERROR_SUCCESS) {
+                    sub->owner->m_pipeline.submit(std::move(rendered));
+                } else {
+                    LOG_ERROR("Subscriber") << "❌ Failed to process event";
+                }
+            } catch (const std::exception& e) {
+                LOG_ERROR("Subscriber") << "❌ Exception in subscription callback: " << e.what();
+                status = ERROR_UNHANDLED_EXCEPTION;
+            }
+            if (hEvent) {
+                EvtClose(hEvent);
+            }
+            break;
+
+        default:
+            std::wcout << L"⚠️ Unknown subscription action" << std::endl;
+            break;
+    }
+
+    return status;
+}
+
+// ============================================
+// Pull Engine
+// ============================================
+bool EventSubscriber::resubscribe(Subscription& sub) {
+    // Back-fill tracks the last pulled record; otherwise the last acknowledged
+    // one is the best we have (repeats, never losses)
+    EVT_HANDLE hResume = sub.hBookmark;
+    bool ownResume = false;
+    if (hResume == NULL && m_bookmarks) {
+        std::wstring bookmarkXml = m_bookmarks->bookmarkXml(sub.source);
+        if (!bookmarkXml.empty()) {
+            hResume = EvtCreateBookmark(bookmarkXml.c_str());
+            ownResume = (hResume != NULL);
+        }
+    }
+
+    if (sub.hSubscription) EvtClose(sub.hSubscription);
+    // Without EvtSubscribeStrict a bookmark that has been overwritten
+    // resumes at the oldest record still in the log
+    sub.hSubscription = openSubscription(sub, sub.query, sub.hSignal, hResume);
+    if (ownResume) EvtClose(hResume);
+    return sub.hSubscription != NULL;
+}
+
+void EventSubscriber::pullLoop() {
+    std::vector<HANDLE> waitHandles;
+    waitHandles.push_back(m_stopEvent);
+    for (const auto& sub : m_subscriptions) {
+        waitHandles.push_back(sub->hSignal);
+    }
+
+    std::vector<EVT_HANDLE> handles(m_config.pullBatchSize);
+    std::vector<RenderedEvent> batch;
+    batch.reserve(m_config.pullBatchSize);
+
+    std::cout << "[Subscriber] Pull thread started (batch size " << m_config.pullBatchSize << ")" << std::endl;
+
+    while (m_running) {
+        DWORD wait = WaitForMultipleObjects((DWORD)waitHandles.size(), waitHandles.data(), FALSE, INFINITE);
+
+        if (wait == WAIT_OBJECT_0 || wait == WAIT_FAILED) {
+            break;  // Stop requested (or the handles are gone)
+        }
+
+        DWORD index = wait - WAIT_OBJECT_0 - 1;
+        if (index < m_subscriptions.size()) {
+            drainSubscription(*m_subscriptions[index], handles, batch);
+        }
+    }
+}
+
+void EventSubscriber::drainSubscription(Subscription& sub, std::vector<EVT_HANDLE>& handles,
+                                        std::vector<RenderedEvent>& batch) {
+    // Reset before pulling: anything that arrives mid-drain re-signals us
+    if (WaitForSingleObject(sub.hSignal, 0) == WAIT_OBJECT_0) sub.signaled = true;
+    ResetEvent(sub.hSignal);
+
+    bool resubscribed = false;
+    while (m_running) {
+        DWORD returned = 0;
+        if (!EvtNext(sub.hSubscription, (DWORD)handles.size(), handles.data(), 0, 0, &returned)) {
+            DWORD status = GetLastError();
+            if (status == ERROR_EVT_QUERY_RESULT_STALE) {
+                // Retrying the same handle fails the same way; reopen it, once per drain
+                std::wcout << L"⚠️ Event records are missing (" << sub.path << L"), resubscribing" << std::endl;
+                if (!resubscribed && resubscribe(sub)) {
+                    resubscribed = true;
+                    continue;
+                }
+                std::wcout << L"❌ Cannot resubscribe to " << sub.path << std::endl;
+                return;
+            }
+            if (status != ERROR_NO_MORE_ITEMS && status != ERROR_TIMEOUT) {
+                std::wcout << L"❌ EvtNext failed with error: " << status << std::endl;
+            } else if (sub.backfilling && sub.signaled) {
+                sub.backfilling = false;
+                std::wcout << L"  ✓ Back-fill complete: " << sub.path << std::endl;
+            }
+            return;
+        }
+
+        batch.clear();
+        for (DWORD i = 0; i < returned; i++) {
+            batch.emplace_back();
+            if (renderEvent(handles[i], sub.source, batch.back()) != ERROR_SUCCESS) {
+                batch.pop_back();
+            }
+        }
+
+        if (sub.hBookmark && returned > 0) {
+            EvtUpdateBookmark(sub.hBookmark, handles[returned - 1]);
+        }
+        for (DWORD i = 0; i < returned; i++) {
+            EvtClose(handles[i]);
+        }
+
+        // The backlog must not be thrown away by a drop policy: block instead
+        if (sub.backfilling) {
+            m_backfilled.fetch_add(batch.size(), std::memory_order_relaxed);
+        }
+        m_pipeline.submitBatch(batch, sub.backfilling);
+    }
+}
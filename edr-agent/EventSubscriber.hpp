@@ -0,0 +1,136 @@
+#ifndef EVENTSUBSCRIBER_HPP
+#define EVENTSUBSCRIBER_HPP
+
+#include <Windows.h>
+#include <winevt.h>
+
+#include "BookmarkStore.hpp"
+#include "EventPipeline.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ============================================================
+// Event Log Subscriber
+// ============================================================
+// Owns the EvtSubscribe handles for every configured source and feeds
+// rendered events into the pipeline. Two ingestion engines:
+//
+//   Callback - wevtapi calls us once per event on its own thread
+//   Pull     - wevtapi signals an event handle; one thread pulls arrays
+//              of up to pullBatchSize handles with EvtNext and submits
+//              them to the pipeline as a batch
+//
+// With a BookmarkStore, sources that have a saved position subscribe with
+// EvtSubscribeStartAfterBookmark. The backlog is always pulled through the
+// batch path (blocking on a full queue rather than dropping); callback
+// sources then hand over to a live callback subscription that starts
+// after the last back-filled record. EvtSubscribe fills its result set
+// asynchronously, so back-fill only counts as caught up once the
+// subscription has signaled (or stayed quiet for BACKFILL_SIGNAL_WAIT_MS).
+//
+// A result set that goes stale (the log wrapped past our position) is
+// reopened from the last known position instead of retried.
+//
+// On a config reload update() only touches the sources that changed.
+// ============================================================
+
+enum class SubscribeMode {
+    Callback,
+    Pull
+};
+
+struct SubscriberConfig {
+    SubscribeMode mode = SubscribeMode::Callback;
+    DWORD pullBatchSize = 256;
+    bool useValueRender = false;
+};
+
+class EventSubscriber {
+public:
+    // bookmarks may be null (always start from future events)
+    EventSubscriber(EventPipeline& pipeline, const SubscriberConfig& config,
+                    BookmarkStore* bookmarks = nullptr);
+    ~EventSubscriber();
+
+    EventSubscriber(const EventSubscriber&) = delete;
+    EventSubscriber& operator=(const EventSubscriber&) = delete;
+
+    // Subscribes to each (path, query) pair; returns the number that succeeded
+    size_t subscribe(const std::vector<std::pair<std::wstring, std::wstring>>& sources);
+
+    // Config reload: opens pairs that are new, closes those no longer listed
+    // and leaves the rest running. Returns the number active afterwards.
+    size_t update(const std::vector<std::pair<std::wstring, std::wstring>>& sources);
+
+    // Closes all subscriptions; no more events reach the pipeline afterwards
+    void stop();
+
+    size_t activeCount() const { return m_subscriptions.size(); }
+    uint64_t backfilledCount() const { return m_backfilled.load(std::memory_order_relaxed); }
+
+    // "callback" | "pull" (defaults to Callback)
+    static SubscribeMode parseMode(const std::string& name);
+
+    // How long a callback source's back-fill waits for a first signal
+    // before taking the backlog as empty
+    static constexpr DWORD BACKFILL_SIGNAL_WAIT_MS = 2000;
+
+private:
+    struct Subscription {
+        EventSubscriber* owner = nullptr;   // Callback context
+        std::wstring path;
+        std::wstring query;
+        uint32_t source = 0;                // BookmarkStore index
+        EVT_HANDLE hSubscription = NULL;
+        HANDLE hSignal = NULL;              // Pull mode / back-fill only
+        EVT_HANDLE hBookmark = NULL;        // Last pulled record (back-fill hand-over)
+        bool backfilling = false;           // Until EvtNext runs dry after a signal
+        bool signaled = false;              // hSignal has been set since the subscription opened
+    };
+
+    // One source, back-filled when it has a bookmark; null if it could not subscribe
+    std::unique_ptr<Subscription> openSource(const std::wstring& path, const std::wstring& query, bool pullMode);
+    void closeSubscription(Subscription& sub);
+    void startPullThread();
+    void stopPullThread();
+
+    // EvtSubscribe wrapper: signal != NULL selects pull mode, hBookmark != NULL resumes after it
+    EVT_HANDLE openSubscription(Subscription& sub, const std::wstring& query,
+                                HANDLE hSignal, EVT_HANDLE hBookmark);
+
+    // Pulls a callback source's backlog synchronously, then opens its live subscription
+    bool backfillThenSubscribe(Subscription& sub, const std::wstring& query, EVT_HANDLE hBookmark);
+
+    static DWORD WINAPI subscriptionCallback(EVT_SUBSCRIBE_NOTIFY_ACTION action,
+                                             PVOID pContext, EVT_HANDLE hEvent);
+
+    // Renders one event handle (values path first, XML fallback)
+    DWORD renderEvent(EVT_HANDLE hEvent, uint32_t source, RenderedEvent& rendered);
+
+    // Stale result set: reopen after the last pulled (or acknowledged) record
+    bool resubscribe(Subscription& sub);
+
+    void pullLoop();
+    void drainSubscription(Subscription& sub, std::vector<EVT_HANDLE>& handles,
+                           std::vector<RenderedEvent>& batch);
+
+    EventPipeline& m_pipeline;
+    SubscriberConfig m_config;
+    BookmarkStore* m_bookmarks;
+    std::vector<std::unique_ptr<Subscription>> m_subscriptions;   // Stable addresses for the callback context
+    std::atomic<uint64_t> m_backfilled{0};
+    uint32_t m_nextSource = 0;                                     // Source index without bookmarks
+    std::mutex m_mutex;                                            // subscribe / update / stop
+
+    HANDLE m_stopEvent = NULL;
+    std::thread m_pullThread;
+    std::atomic<bool> m_running{false};
+};
+
+#endif // EVENTSUBSCRIBER_HPP
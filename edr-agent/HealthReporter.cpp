@@ -0,0 +1,124 @@
+#include "HealthReporter.hpp"
+
+#include "AgentIdentity.hpp"
+#include "HttpClient.hpp"
+#include "Logger.hpp"
+#include "RateController.hpp"
+#include "ResourceGovernor.hpp"
+#include "TelemetrySpool.hpp"
+
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    std::string utcNow() {
+        std::time_t now = std::time(nullptr);
+        std::tm tm{};
+        gmtime_s(&tm, &now);
+        std::ostringstream out;
+        out << std::put_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
+        return out.str();
+    }
+}
+
+HealthReporter::HealthReporter(const HealthConfig& config, const TelemetrySpool* spool)
+    : m_config(config), m_spool(spool) {
+    if (m_config.intervalS == 0) m_config.intervalS = 60;
+}
+
+HealthReporter::~HealthReporter() {
+    stop();
+}
+
+// ============================================
+// Lifecycle
+// ============================================
+void HealthReporter::start() {
+    if (m_running.exchange(true)) return;
+
+    m_startedAt = std::chrono::steady_clock::now();
+    m_lastReport = m_startedAt;
+    m_previous = Metrics::snapshot();
+    m_thread = std::thread(&HealthReporter::reportLoop, this);
+
+    std::cout << "[Health] Reporting every " << m_config.intervalS << "s to "
+              << m_config.serverUrl << m_config.path << std::endl;
+}
+
+void HealthReporter::stop() {
+    if (!m_running.exchange(false)) return;
+
+    m_waitCV.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+bool HealthReporter::waitFor(std::chrono::seconds duration) {
+    std::unique_lock<std::mutex> lock(m_waitMutex);
+    m_waitCV.wait_for(lock, duration, [this] { return !m_running; });
+    return m_running;
+}
+
+// ============================================
+// Reporting
+// ============================================
+void HealthReporter::reportLoop() {
+    while (waitFor(std::chrono::seconds(m_config.intervalS))) {
+        report(m_config.intervalS);
+    }
+
+    // Partial interval at shutdown, so the last minute is not lost
+    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - m_lastReport).count();
+    if (elapsed > 0) report((unsigned)elapsed);
+}
+
+void HealthReporter::report(unsigned intervalS) {
+    try {
+        Metrics::Snapshot current = Metrics::snapshot();
+        nlohmann::json metrics = Metrics::toJson(current, m_previous);
+        m_previous = current;
+
+        auto now = std::chrono::steady_clock::now();
+        m_lastReport = now;
+
+        nlohmann::json body = {
+            {"agent_id", AgentIdentity::agentId()},
+            {"timestamp", utcNow()},
+            {"version", AGENT_VERSION},
+            {"uptime_s", std::chrono::duration_cast<std::chrono::seconds>(now - m_startedAt).count()},
+            {"interval_s", intervalS},
+            {"metrics", metrics},
+            {"log_suppressed", Logger::suppressedCount()}
+        };
+        if (m_spool != nullptr) {
+            body["spool_pending_bytes"] = m_spool->pendingBytes();
+        }
+        if (m_rateController != nullptr) {
+            body["rate_control"] = m_rateController->toJson();
+        }
+        if (m_governor != nullptr) {
+            body["governor"] = m_governor->toJson();
+        }
+
+        const auto& counters = metrics["counters"];
+        const auto& stages = metrics["stages"];
+        LOG_INFO("Health") << counters["events_converted"]["interval"] << " converted, "
+                           << counters["events_dropped"]["interval"] << " dropped, "
+                           << counters["batches_sent"]["interval"] << " batch(es) sent, "
+                           << counters["batches_failed"]["interval"] << " failed"
+                           << " | convert p99 " << stages["convert"]["p99_us"] << "us"
+                           << ", send p99 " << stages["http_send"]["p99_us"] << "us";
+
+        if (m_config.serverUrl.empty()) return;
+
+        // A fresh client per report: one request a minute does not need a kept-alive connection
+        HttpClient client;
+        client.addHeader("Authorization", "Token " + m_config.authToken);
+        client.POST(m_config.serverUrl + m_config.path, body.dump());
+
+    } catch (const std::exception& e) {
+        LOG_ERROR("Health") << "Report failed: " << e.what();
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef HEALTHREPORTER_HPP
+#define HEALTHREPORTER_HPP
+
+#include "Metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class RateController;
+class ResourceGovernor;
+class TelemetrySpool;
+
+// ============================================================
+// Health Reporter
+// ============================================================
+// Every intervalS seconds takes a Metrics snapshot and POSTs an
+// agent_health record to the Django health app:
+//
+//   {"agent_id", "timestamp", "version", "uptime_s", "interval_s",
+//    "metrics": {"counters": {...}, "stages": {...}},
+//    "log_suppressed", "spool_pending_bytes", "rate_control", "governor"}
+//
+// Counters carry the running total and the interval's share; stage
+// latencies are percentiles for the interval only. A one-line summary
+// goes to the log as well, so the numbers are there without a server.
+// ============================================================
+
+struct HealthConfig {
+    unsigned intervalS = 60;
+    std::string serverUrl;                       // http://host:port
+    std::string path = "/api/v1/health/agent/";
+    std::string authToken;
+};
+
+class HealthReporter {
+public:
+    explicit HealthReporter(const HealthConfig& config, const TelemetrySpool* spool = nullptr);
+    ~HealthReporter();
+
+    HealthReporter(const HealthReporter&) = delete;
+    HealthReporter& operator=(const HealthReporter&) = delete;
+
+    // Adds the controller's current batch size, rate and backoff to each report
+    void setRateController(const RateController* controller) { m_rateController = controller; }
+
+    // Adds the agent's own CPU/memory use and throttle level to each report
+    void setGovernor(const ResourceGovernor* governor) { m_governor = governor; }
+
+    void start();
+    void stop();   // Sends a final report for the partial interval
+
+    static constexpr const char* AGENT_VERSION = "1.0";
+
+private:
+    void reportLoop();
+    void report(unsigned intervalS);
+    bool waitFor(std::chrono::seconds duration);
+
+    HealthConfig m_config;
+    const TelemetrySpool* m_spool;
+    const RateController* m_rateController = nullptr;
+    const ResourceGovernor* m_governor = nullptr;
+    Metrics::Snapshot m_previous;
+    std::chrono::steady_clock::time_point m_startedAt;
+    std::chrono::steady_clock::time_point m_lastReport;
+
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCV;
+};
+
+#endif // HEALTHREPORTER_HPP
@@ -0,0 +1,640 @@
+#include "HostIsolation.hpp"
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <netfw.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+#pragma comment(lib, "ole32.lib")
+#pragma comment(lib, "oleaut32.lib")
+#pragma comment(lib, "ws2_32.lib")
+
+namespace {
+
+    const NET_FW_PROFILE_TYPE2 PROFILES[] = {
+        NET_FW_PROFILE2_DOMAIN, NET_FW_PROFILE2_PRIVATE, NET_FW_PROFILE2_PUBLIC
+    };
+
+    const char* profileKey(NET_FW_PROFILE_TYPE2 profile) {
+        switch (profile) {
+            case NET_FW_PROFILE2_DOMAIN:  return "domain";
+            case NET_FW_PROFILE2_PRIVATE: return "private";
+            default:                      return "public";
+        }
+    }
+
+    // Rules added by the netsh-based isolation of earlier versions; removed on de-isolation too
+    const char* const LEGACY_RULES[] = {
+        "EDR_BLOCK_ALL", "EDR_ALLOW_ANTIGRAVITY", "EDR_ALLOW_SERVER", "EDR_ALLOW_DNS"
+    };
+
+    // ============================================
+    // COM Helpers
+    // ============================================
+    struct ComScope {
+        HRESULT hr;
+        ComScope() : hr(CoInitializeEx(NULL, COINIT_MULTITHREADED)) {}
+        ~ComScope() { if (SUCCEEDED(hr)) CoUninitialize(); }
+        // Already initialized differently on this thread still gives us COM
+        bool ok() const { return SUCCEEDED(hr) || hr == RPC_E_CHANGED_MODE; }
+    };
+
+    template <typename T>
+    struct ComPtr {
+        T* p = nullptr;
+        ComPtr() = default;
+        ComPtr(const ComPtr&) = delete;
+        ComPtr& operator=(const ComPtr&) = delete;
+        ComPtr(ComPtr&& other) noexcept : p(other.p) { other.p = nullptr; }
+        ~ComPtr() { if (p) p->Release(); }
+        T* operator->() const { return p; }
+        void** out() { return (void**)&p; }
+    };
+
+    std::wstring toWide(const std::string& text) {
+        if (text.empty()) return std::wstring();
+        int length = MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), NULL, 0);
+        std::wstring wide(length, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), &wide[0], length);
+        return wide;
+    }
+
+    struct Bstr {
+        BSTR value;
+        explicit Bstr(const std::string& text) : value(SysAllocString(toWide(text).c_str())) {}
+        ~Bstr() { SysFreeString(value); }
+        Bstr(const Bstr&) = delete;
+        Bstr& operator=(const Bstr&) = delete;
+        operator BSTR() const { return value; }
+    };
+
+    // Converts and frees a BSTR handed out by a get_ call
+    std::string takeBstr(BSTR value) {
+        std::string text;
+        if (value != nullptr) {
+            int length = WideCharToMultiByte(CP_UTF8, 0, value, -1, NULL, 0, NULL, NULL);
+            if (length > 1) {
+                text.resize(length - 1);
+                WideCharToMultiByte(CP_UTF8, 0, value, -1, &text[0], length, NULL, NULL);
+            }
+            SysFreeString(value);
+        }
+        return text;
+    }
+
+    std::string ruleName(const std::string& name) {
+        return std::string(HostIsolation::RULE_GROUP) + ": " + name;
+    }
+
+    bool fail(const char* what, HRESULT hr) {
+        std::cerr << "[Isolation] ❌ " << what << " failed (HRESULT 0x" << std::hex << (unsigned long)hr
+                  << std::dec << ")" << std::endl;
+        return false;
+    }
+
+    bool openPolicy(ComPtr<INetFwPolicy2>& policy, ComPtr<INetFwRules>& rules) {
+        HRESULT hr = CoCreateInstance(__uuidof(NetFwPolicy2), NULL, CLSCTX_INPROC_SERVER,
+                                      __uuidof(INetFwPolicy2), policy.out());
+        if (FAILED(hr)) return fail("CoCreateInstance(NetFwPolicy2)", hr);
+
+        hr = policy->get_Rules(&rules.p);
+        if (FAILED(hr)) return fail("INetFwPolicy2::get_Rules", hr);
+        return true;
+    }
+
+    // ============================================
+    // Staging
+    // ============================================
+    // Builds a rule object without touching the firewall, so a bad
+    // allow-list entry fails isolation before anything changed
+    bool stageRule(const IsolationRule& rule, ComPtr<INetFwRule>& out) {
+        HRESULT hr = CoCreateInstance(__uuidof(NetFwRule), NULL, CLSCTX_INPROC_SERVER,
+                                      __uuidof(INetFwRule), out.out());
+        if (FAILED(hr)) return fail("CoCreateInstance(NetFwRule)", hr);
+
+        long protocol = NET_FW_IP_PROTOCOL_ANY;
+        if (rule.protocol == "tcp") protocol = NET_FW_IP_PROTOCOL_TCP;
+        else if (rule.protocol == "udp") protocol = NET_FW_IP_PROTOCOL_UDP;
+        else if (rule.protocol != "any") {
+            std::cerr << "[Isolation] ❌ Rule '" << rule.name << "': unknown protocol '" << rule.protocol << "'" << std::endl;
+            return false;
+        }
+
+        Bstr name(ruleName(rule.name));
+        Bstr grouping(HostIsolation::RULE_GROUP);
+        Bstr description("Allowed while the host is isolated by the EDR agent");
+        Bstr addresses(rule.remoteAddresses);
+
+        if (FAILED(hr = out->put_Name(name)) ||
+            FAILED(hr = out->put_Grouping(grouping)) ||
+            FAILED(hr = out->put_Description(description)) ||
+            FAILED(hr = out->put_Direction(NET_FW_RULE_DIR_OUT)) ||
+            FAILED(hr = out->put_Action(NET_FW_ACTION_ALLOW)) ||
+            FAILED(hr = out->put_Protocol(protocol)) ||
+            FAILED(hr = out->put_RemoteAddresses(addresses)) ||
+            FAILED(hr = out->put_Profiles(NET_FW_PROFILE2_ALL))) {
+            std::cerr << "[Isolation] ❌ Rule '" << rule.name << "' rejected" << std::endl;
+            return fail("INetFwRule setup", hr);
+        }
+
+        if (protocol != NET_FW_IP_PROTOCOL_ANY && rule.remotePorts != "*") {
+            Bstr ports(rule.remotePorts);
+            if (FAILED(hr = out->put_RemotePorts(ports))) {
+                std::cerr << "[Isolation] ❌ Rule '" << rule.name << "': bad remote_ports '" << rule.remotePorts << "'" << std::endl;
+                return fail("INetFwRule::put_RemotePorts", hr);
+            }
+        }
+        if (!rule.program.empty()) {
+            Bstr program(rule.program);
+            if (FAILED(hr = out->put_ApplicationName(program))) return fail("INetFwRule::put_ApplicationName", hr);
+        }
+
+        if (FAILED(hr = out->put_Enabled(VARIANT_TRUE))) return fail("INetFwRule::put_Enabled", hr);
+        return true;
+    }
+
+    // Every address the server name resolves to. Loopback is never filtered, so it is left out.
+    std::string resolveServer(const std::string& host, bool& loopbackOnly) {
+        loopbackOnly = false;
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return "";
+
+        std::set<std::string> addresses;
+        bool sawLoopback = false;
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        addrinfo* results = nullptr;
+        if (getaddrinfo(host.c_str(), NULL, &hints, &results) == 0) {
+            for (addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+                char text[INET6_ADDRSTRLEN] = {};
+                if (ai->ai_family == AF_INET) {
+                    const sockaddr_in* v4 = (const sockaddr_in*)ai->ai_addr;
+                    if ((ntohl(v4->sin_addr.s_addr) >> 24) == 127) { sawLoopback = true; continue; }
+                    inet_ntop(AF_INET, &v4->sin_addr, text, sizeof(text));
+                } else if (ai->ai_family == AF_INET6) {
+                    const sockaddr_in6* v6 = (const sockaddr_in6*)ai->ai_addr;
+                    if (IN6_IS_ADDR_LOOPBACK(&v6->sin6_addr)) { sawLoopback = true; continue; }
+                    inet_ntop(AF_INET6, &v6->sin6_addr, text, sizeof(text));
+                } else {
+                    continue;
+                }
+                addresses.insert(text);
+            }
+            freeaddrinfo(results);
+        }
+        WSACleanup();
+
+        std::string joined;
+        for (const auto& address : addresses) {
+            if (!joined.empty()) joined += ",";
+            joined += address;
+        }
+        loopbackOnly = joined.empty() && sawLoopback;
+        return joined;
+    }
+
+    // ============================================
+    // Saved State
+    // ============================================
+    bool loadState(const std::string& path, nlohmann::json& state) {
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+        state = nlohmann::json::parse(file, nullptr, false);
+        return state.is_object() && state.contains("profiles");
+    }
+
+    bool saveState(const std::string& path, const nlohmann::json& state) {
+        std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::trunc);
+            file << state.dump(2);
+            if (!file.good()) {
+                std::cerr << "[Isolation] ❌ Cannot write " << tmpPath << std::endl;
+                return false;
+            }
+        }
+        if (!MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            std::cerr << "[Isolation] ❌ Failed to replace " << path << " (Error: " << GetLastError() << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    nlohmann::json readProfiles(INetFwPolicy2* policy) {
+        nlohmann::json profiles = nlohmann::json::object();
+        for (NET_FW_PROFILE_TYPE2 profile : PROFILES) {
+            VARIANT_BOOL enabled = VARIANT_FALSE;
+            VARIANT_BOOL blockInbound = VARIANT_FALSE;
+            NET_FW_ACTION outbound = NET_FW_ACTION_ALLOW;
+            policy->get_FirewallEnabled(profile, &enabled);
+            policy->get_BlockAllInboundTraffic(profile, &blockInbound);
+            policy->get_DefaultOutboundAction(profile, &outbound);
+            profiles[profileKey(profile)] = {
+                {"enabled", enabled == VARIANT_TRUE},
+                {"block_inbound", blockInbound == VARIANT_TRUE},
+                {"outbound_block", outbound == NET_FW_ACTION_BLOCK}
+            };
+        }
+        return profiles;
+    }
+
+    bool restoreProfiles(INetFwPolicy2* policy, const nlohmann::json& profiles) {
+        bool ok = true;
+        for (NET_FW_PROFILE_TYPE2 profile : PROFILES) {
+            const char* key = profileKey(profile);
+            if (!profiles.contains(key)) continue;
+
+            const auto& saved = profiles[key];
+            ok = SUCCEEDED(policy->put_DefaultOutboundAction(profile,
+                     saved.value("outbound_block", false) ? NET_FW_ACTION_BLOCK : NET_FW_ACTION_ALLOW)) && ok;
+            ok = SUCCEEDED(policy->put_BlockAllInboundTraffic(profile,
+                     saved.value("block_inbound", false) ? VARIANT_TRUE : VARIANT_FALSE)) && ok;
+            ok = SUCCEEDED(policy->put_FirewallEnabled(profile,
+                     saved.value("enabled", true) ? VARIANT_TRUE : VARIANT_FALSE)) && ok;
+        }
+        return ok;
+    }
+
+    void removeRules(INetFwRules* rules, const std::vector<std::string>& names) {
+        for (const auto& name : names) {
+            Bstr bstr(name);
+            rules->Remove(bstr);   // Absent rules are not an error
+        }
+    }
+
+    bool ruleEnabled(INetFwRules* rules, const std::string& name) {
+        ComPtr<INetFwRule> rule;
+        Bstr bstr(name);
+        if (FAILED(rules->Item(bstr, &rule.p))) return false;
+        VARIANT_BOOL enabled = VARIANT_FALSE;
+        return SUCCEEDED(rule->get_Enabled(&enabled)) && enabled == VARIANT_TRUE;
+    }
+
+    // ============================================
+    // Other Outbound Allow Rules
+    // ============================================
+    // An enabled outbound allow rule wins over DefaultOutboundAction=BLOCK,
+    // so isolation disables every one it does not own and re-enables them on
+    // release. Rule names are not unique, so a rule is recorded by the
+    // fields that tell it apart.
+    template <typename Fn>
+    void forEachRule(INetFwRules* rules, Fn&& fn) {
+        ComPtr<IUnknown> unknown;
+        ComPtr<IEnumVARIANT> items;
+        if (FAILED(rules->get__NewEnum(&unknown.p)) ||
+            FAILED(unknown->QueryInterface(__uuidof(IEnumVARIANT), items.out()))) {
+            return;
+        }
+
+        VARIANT item;
+        VariantInit(&item);
+        while (items->Next(1, &item, NULL) == S_OK) {
+            ComPtr<INetFwRule> rule;
+            if (item.vt == VT_DISPATCH && item.pdispVal != nullptr) {
+                item.pdispVal->QueryInterface(__uuidof(INetFwRule), rule.out());
+            }
+            VariantClear(&item);
+            if (rule.p) fn(rule);
+        }
+    }
+
+    nlohmann::json ruleKey(INetFwRule* rule) {
+        BSTR value = nullptr;
+        long number = 0;
+        nlohmann::json key = nlohmann::json::object();
+        key["name"]             = SUCCEEDED(rule->get_Name(&value)) ? takeBstr(value) : "";
+        key["grouping"]         = SUCCEEDED(rule->get_Grouping(&value)) ? takeBstr(value) : "";
+        key["program"]          = SUCCEEDED(rule->get_ApplicationName(&value)) ? takeBstr(value) : "";
+        key["service"]          = SUCCEEDED(rule->get_ServiceName(&value)) ? takeBstr(value) : "";
+        key["remote_addresses"] = SUCCEEDED(rule->get_RemoteAddresses(&value)) ? takeBstr(value) : "";
+        key["remote_ports"]     = SUCCEEDED(rule->get_RemotePorts(&value)) ? takeBstr(value) : "";
+        key["local_ports"]      = SUCCEEDED(rule->get_LocalPorts(&value)) ? takeBstr(value) : "";
+        key["protocol"]         = SUCCEEDED(rule->get_Protocol(&number)) ? number : 0;
+        key["profiles"]         = SUCCEEDED(rule->get_Profiles(&number)) ? number : 0;
+        return key;
+    }
+
+    // Enabled, outbound, allow, and not one of ours
+    bool foreignOutboundAllow(INetFwRule* rule) {
+        VARIANT_BOOL enabled = VARIANT_FALSE;
+        NET_FW_RULE_DIRECTION direction = NET_FW_RULE_DIR_IN;
+        NET_FW_ACTION action = NET_FW_ACTION_BLOCK;
+        BSTR grouping = nullptr;
+        if (FAILED(rule->get_Enabled(&enabled)) || enabled != VARIANT_TRUE ||
+            FAILED(rule->get_Direction(&direction)) || direction != NET_FW_RULE_DIR_OUT ||
+            FAILED(rule->get_Action(&action)) || action != NET_FW_ACTION_ALLOW) {
+            return false;
+        }
+        rule->get_Grouping(&grouping);
+        return takeBstr(grouping) != HostIsolation::RULE_GROUP;
+    }
+
+    // Re-enables the saved rules that are still there and still disabled
+    bool enableRules(INetFwRules* rules, const nlohmann::json& keys) {
+        if (!keys.is_array() || keys.empty()) return true;
+
+        bool ok = true;
+        forEachRule(rules, [&](ComPtr<INetFwRule>& rule) {
+            VARIANT_BOOL enabled = VARIANT_TRUE;
+            if (FAILED(rule->get_Enabled(&enabled)) || enabled == VARIANT_TRUE) return;
+            nlohmann::json key = ruleKey(rule.p);
+            if (std::find(keys.begin(), keys.end(), key) == keys.end()) return;
+            if (FAILED(rule->put_Enabled(VARIANT_TRUE))) {
+                std::cerr << "[Isolation] ❌ Cannot re-enable rule '" << key["name"].get<std::string>() << "'" << std::endl;
+                ok = false;
+            }
+        });
+        return ok;
+    }
+
+    // Stages a copy of one of our rules already in the firewall, so a failed
+    // re-isolation can put the previous allow-list back after removing it
+    bool restageRule(INetFwRules* rules, const std::string& name, ComPtr<INetFwRule>& out) {
+        ComPtr<INetFwRule> existing;
+        Bstr bstr(name);
+        if (FAILED(rules->Item(bstr, &existing.p))) return false;
+
+        const std::string prefix = ruleName("");
+        nlohmann::json key = ruleKey(existing.p);
+        std::string fullName = key["name"].get<std::string>();
+        if (fullName.compare(0, prefix.size(), prefix) != 0) return false;
+
+        IsolationRule rule;
+        rule.name = fullName.substr(prefix.size());
+        long protocol = key["protocol"].get<long>();
+        rule.protocol = protocol == NET_FW_IP_PROTOCOL_TCP ? "tcp" : protocol == NET_FW_IP_PROTOCOL_UDP ? "udp" : "any";
+        std::string addresses = key["remote_addresses"].get<std::string>();
+        std::string ports = key["remote_ports"].get<std::string>();
+        if (!addresses.empty()) rule.remoteAddresses = addresses;
+        if (!ports.empty()) rule.remotePorts = ports;
+        rule.program = key["program"].get<std::string>();
+        return stageRule(rule, out);
+    }
+
+    long long elapsedMs(std::chrono::steady_clock::time_point started) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+    }
+}
+
+// ============================================
+// Isolation
+// ============================================
+bool HostIsolation::isolate(const IsolationConfig& config, const std::string& serverHost, int serverPort) {
+    auto started = std::chrono::steady_clock::now();
+
+    ComScope com;
+    if (!com.ok()) return fail("CoInitializeEx", com.hr);
+
+    ComPtr<INetFwPolicy2> policy;
+    ComPtr<INetFwRules> rules;
+    if (!openPolicy(policy, rules)) return false;
+
+    // Step 1: Stage every rule; nothing on the system has changed yet
+    std::vector<IsolationRule> allow = config.allow;
+    bool loopbackOnly = false;
+    std::string serverAddresses = resolveServer(serverHost, loopbackOnly);
+    if (!serverAddresses.empty()) {
+        IsolationRule server;
+        server.name = "server";
+        server.protocol = "tcp";
+        server.remoteAddresses = serverAddresses;
+        server.remotePorts = std::to_string(serverPort);
+        allow.insert(allow.begin(), server);
+    } else if (!loopbackOnly) {
+        // Isolating now would cut the agent off from the only way back
+        std::cerr << "[Isolation] ❌ Cannot resolve server '" << serverHost << "', not isolating" << std::endl;
+        return false;
+    }
+
+    std::vector<std::pair<std::string, ComPtr<INetFwRule>>> staged;
+    for (const auto& rule : allow) {
+        ComPtr<INetFwRule> object;
+        if (!stageRule(rule, object)) return false;
+        staged.emplace_back(ruleName(rule.name), std::move(object));
+    }
+
+    // The outbound allow rules that would punch through the block
+    std::vector<std::pair<nlohmann::json, ComPtr<INetFwRule>>> foreign;
+    forEachRule(rules.p, [&](ComPtr<INetFwRule>& rule) {
+        if (foreignOutboundAllow(rule.p)) foreign.emplace_back(ruleKey(rule.p), std::move(rule));
+    });
+
+    // Step 2: Save what isolation replaces. Re-isolating keeps the original
+    // settings, not the already-isolated ones.
+    nlohmann::json state;
+    bool reisolating = loadState(config.statePath, state);
+    if (!reisolating) {
+        state = nlohmann::json::object();
+        state["profiles"] = readProfiles(policy.p);
+        state["rules"] = nlohmann::json::array();
+    }
+    std::set<std::string> ruleNames = state.value("rules", std::set<std::string>());
+
+    // Already isolated: a failure from here on must leave that isolation as it is
+    std::vector<ComPtr<INetFwRule>> previous;
+    for (const auto& name : ruleNames) {
+        ComPtr<INetFwRule> object;
+        if (reisolating && restageRule(rules.p, name, object)) previous.push_back(std::move(object));
+    }
+    for (const auto& entry : staged) ruleNames.insert(entry.first);
+    state["rules"] = ruleNames;
+
+    nlohmann::json disabled = state.value("disabled_rules", nlohmann::json::array());
+    for (const auto& entry : foreign) {
+        if (std::find(disabled.begin(), disabled.end(), entry.first) == disabled.end()) disabled.push_back(entry.first);
+    }
+    state["disabled_rules"] = disabled;
+    if (!saveState(config.statePath, state)) return false;
+
+    std::vector<std::string> names(ruleNames.begin(), ruleNames.end());
+    auto rollback = [&](const char* reason) {
+        if (reisolating) {
+            // Undo only this call: the previous allow-list back, the block and
+            // the state file kept. Rules disabled meanwhile stay disabled (and saved).
+            std::cerr << "[Isolation] ❌ " << reason << ", keeping the previous isolation" << std::endl;
+            removeRules(rules.p, names);
+            for (auto& object : previous) rules->Add(object.p);
+            for (NET_FW_PROFILE_TYPE2 profile : PROFILES) {
+                policy->put_FirewallEnabled(profile, VARIANT_TRUE);
+                policy->put_DefaultOutboundAction(profile, NET_FW_ACTION_BLOCK);
+            }
+            return false;
+        }
+
+        std::cerr << "[Isolation] ❌ " << reason << ", rolling back" << std::endl;
+        restoreProfiles(policy.p, state["profiles"]);
+        enableRules(rules.p, state["disabled_rules"]);
+        removeRules(rules.p, names);
+        DeleteFileA(config.statePath.c_str());
+        return false;
+    };
+
+    // Step 3: Allow rules first, so the server stays reachable throughout
+    removeRules(rules.p, names);
+    for (auto& entry : staged) {
+        HRESULT hr = rules->Add(entry.second.p);
+        if (FAILED(hr)) {
+            fail("INetFwRules::Add", hr);
+            return rollback("Adding allow rules failed");
+        }
+    }
+
+    // Step 4: Then the block: other outbound allow rules off, default outbound
+    // action, and inbound allow rules ignored
+    for (auto& entry : foreign) {
+        if (FAILED(entry.second->put_Enabled(VARIANT_FALSE))) {
+            std::cerr << "[Isolation] ❌ Cannot disable rule '" << entry.first["name"].get<std::string>() << "'" << std::endl;
+            return rollback("Blocking traffic failed");
+        }
+    }
+    for (NET_FW_PROFILE_TYPE2 profile : PROFILES) {
+        if (FAILED(policy->put_FirewallEnabled(profile, VARIANT_TRUE)) ||
+            FAILED(policy->put_DefaultOutboundAction(profile, NET_FW_ACTION_BLOCK)) ||
+            (config.blockInbound && FAILED(policy->put_BlockAllInboundTraffic(profile, VARIANT_TRUE)))) {
+            return rollback("Blocking traffic failed");
+        }
+    }
+
+    // Step 5: Verify by reading everything back
+    for (NET_FW_PROFILE_TYPE2 profile : PROFILES) {
+        NET_FW_ACTION outbound = NET_FW_ACTION_ALLOW;
+        VARIANT_BOOL enabled = VARIANT_FALSE;
+        if (FAILED(policy->get_DefaultOutboundAction(profile, &outbound)) || outbound != NET_FW_ACTION_BLOCK ||
+            FAILED(policy->get_FirewallEnabled(profile, &enabled)) || enabled != VARIANT_TRUE) {
+            return rollback("Verification failed (firewall policy managed elsewhere?)");
+        }
+    }
+    for (const auto& entry : staged) {
+        if (!ruleEnabled(rules.p, entry.first)) {
+            return rollback("Verification failed (allow rule missing)");
+        }
+    }
+    // Any other outbound allow rule left (e.g. pushed by group policy) is a hole in the block
+    std::string punchThrough;
+    forEachRule(rules.p, [&](ComPtr<INetFwRule>& rule) {
+        if (punchThrough.empty() && foreignOutboundAllow(rule.p)) punchThrough = ruleKey(rule.p)["name"].get<std::string>();
+    });
+    if (!punchThrough.empty()) {
+        std::cerr << "[Isolation] ❌ Outbound allow rule '" << punchThrough << "' is still enabled" << std::endl;
+        return rollback("Verification failed (outbound allow rule not ours)");
+    }
+
+    std::cout << "[Isolation] ✅ Host isolated in " << elapsedMs(started) << " ms ("
+              << staged.size() << " allow rule(s), " << foreign.size() << " other rule(s) disabled"
+              << (loopbackOnly ? ", server is local" : "") << ")" << std::endl;
+    return true;
+}
+
+bool HostIsolation::deisolate(const IsolationConfig& config) {
+    auto started = std::chrono::steady_clock::now();
+
+    ComScope com;
+    if (!com.ok()) return fail("CoInitializeEx", com.hr);
+
+    ComPtr<INetFwPolicy2> policy;
+    ComPtr<INetFwRules> rules;
+    if (!openPolicy(policy, rules)) return false;
+
+    std::vector<std::string> names(std::begin(LEGACY_RULES), std::end(LEGACY_RULES));
+    for (const auto& rule : config.allow) names.push_back(ruleName(rule.name));
+    names.push_back(ruleName("server"));
+
+    nlohmann::json state;
+    bool haveState = loadState(config.statePath, state);
+    if (haveState) {
+        for (const auto& name : state.value("rules", std::vector<std::string>())) names.push_back(name);
+    }
+
+    // Traffic back first, then the rules; failing halfway leaves the host reachable
+    bool ok = true;
+    if (haveState) {
+        ok = restoreProfiles(policy.p, state["profiles"]);
+        ok = enableRules(rules.p, state.value("disabled_rules", nlohmann::json::array())) && ok;
+
+        nlohmann::json current = readProfiles(policy.p);
+        for (const auto& profile : state["profiles"].items()) {
+            if (current.value(profile.key(), nlohmann::json()) != profile.value()) {
+                std::cerr << "[Isolation] ❌ Profile '" << profile.key() << "' not restored" << std::endl;
+                ok = false;
+            }
+        }
+    } else {
+        std::cout << "[Isolation] No saved state, removing rules only" << std::endl;
+    }
+    removeRules(rules.p, names);
+
+    if (!ok) return false;
+    if (haveState) DeleteFileA(config.statePath.c_str());
+
+    std::cout << "[Isolation] ✅ Host de-isolated in " << elapsedMs(started) << " ms" << std::endl;
+    return true;
+}
+
+bool HostIsolation::isIsolated(const IsolationConfig& config) {
+    nlohmann::json state;
+    return loadState(config.statePath, state);
+}
+
+// ============================================
+// Config
+// ============================================
+std::vector<IsolationRule> HostIsolation::parseRules(const nlohmann::json& rules) {
+    std::vector<IsolationRule> parsed;
+    if (!rules.is_array()) return parsed;
+
+    // A port list entry: "53", 53 (within 0-65535)
+    auto portText = [](const nlohmann::json& port, std::string& text) {
+        if (port.is_string()) { text = port.get<std::string>(); return true; }
+        if (port.is_number_unsigned() && port.get<uint64_t>() <= 65535) { text = std::to_string(port.get<uint64_t>()); return true; }
+        return false;
+    };
+    auto optionalString = [](const nlohmann::json& entry, const char* key, std::string& out) {
+        if (!entry.contains(key)) return true;
+        if (!entry[key].is_string()) return false;
+        out = entry[key].get<std::string>();
+        return true;
+    };
+
+    for (const auto& entry : rules) {
+        if (!entry.is_object() || !entry.contains("name") || !entry["name"].is_string()) {
+            std::cerr << "[Isolation] Skipping allow rule without a name" << std::endl;
+            continue;
+        }
+
+        IsolationRule rule;
+        rule.name = entry["name"].get<std::string>();
+        bool ok = optionalString(entry, "protocol", rule.protocol) &&
+                  optionalString(entry, "remote_addresses", rule.remoteAddresses) &&
+                  optionalString(entry, "program", rule.program);
+
+        // "53", 53 or [80, 443]
+        if (ok && entry.contains("remote_ports")) {
+            const auto& ports = entry["remote_ports"];
+            if (ports.is_array()) {
+                std::string joined;
+                for (const auto& port : ports) {
+                    std::string text;
+                    if (!portText(port, text)) { ok = false; break; }
+                    if (!joined.empty()) joined += ",";
+                    joined += text;
+                }
+                rule.remotePorts = joined;
+            } else {
+                ok = portText(ports, rule.remotePorts);
+            }
+        }
+
+        if (!ok) {
+            std::cerr << "[Isolation] Skipping allow rule '" << rule.name << "': wrongly typed field" << std::endl;
+            continue;
+        }
+        parsed.push_back(rule);
+    }
+    return parsed;
+}
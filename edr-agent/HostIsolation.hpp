@@ -0,0 +1,62 @@
+#ifndef HOSTISOLATION_HPP
+#define HOSTISOLATION_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <string>
+#include <vector>
+
+// ============================================================
+// Host Isolation
+// ============================================================
+// Network isolation through the Windows Firewall COM API (INetFwPolicy2),
+// in-process instead of one netsh.exe per rule.
+//
+//   isolate()    stage every allow rule, add them, disable every other
+//                enabled outbound allow rule (those win over the default
+//                action), then switch the default outbound action of
+//                every profile to block (and optionally block all
+//                inbound). Read back and verified, including that no
+//                other outbound allow rule is left enabled; any failure
+//                rolls back what was applied. A failed re-isolation
+//                only undoes its own changes and stays isolated.
+//   deisolate()  restores the saved defaults, re-enables the rules it
+//                disabled and removes its own.
+//
+// Windows Firewall has no transactions, so the order does the job: allow
+// rules first, the block last, so the server stays reachable throughout
+// and a half-applied state never cuts the agent off.
+//
+// The settings isolation replaces are saved to statePath before anything
+// changes, so de-isolation restores them even after an agent restart.
+// ============================================================
+
+struct IsolationRule {
+    std::string name;
+    std::string protocol = "any";        // "tcp" | "udp" | "any"
+    std::string remoteAddresses = "*";   // Firewall syntax: IPs, ranges, CIDR, keywords (e.g. "LocalSubnet")
+    std::string remotePorts = "*";       // "53", "80,443", "49152-65535" (tcp/udp only)
+    std::string program;                 // Optional full path; empty = any program
+};
+
+struct IsolationConfig {
+    std::vector<IsolationRule> allow;
+    bool blockInbound = true;            // Also ignore inbound allow rules while isolated
+    std::string statePath = "isolation_state.json";
+};
+
+class HostIsolation {
+public:
+    // The server (resolved to its addresses) plus the configured allow-list
+    static bool isolate(const IsolationConfig& config, const std::string& serverHost, int serverPort);
+    static bool deisolate(const IsolationConfig& config);
+
+    static bool isIsolated(const IsolationConfig& config);
+
+    // The isolation.allow array from config.json
+    static std::vector<IsolationRule> parseRules(const nlohmann::json& rules);
+
+    static constexpr const char* RULE_GROUP = "EDR Isolation";
+};
+
+#endif // HOSTISOLATION_HPP
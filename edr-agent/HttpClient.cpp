@@ -1,6 +1,9 @@
 #include "HttpClient.hpp"
 #include "ConfigReader.hpp"
 #include "SimpleZstd.hpp"
+#include "Logger.hpp"
+#include "RateController.hpp"
+#include <cwctype>
 #include <iostream>
 #include <vector>
 
@@ -68,105 +71,27 @@ bool HttpClient::ensureConnection() {
     if (connect()) return true;
     
     // Retry once
-    std::cerr << "[HTTP] Connection lost, retrying..." << std::endl;
+    LOG_WARN("HTTP") << "Connection lost, retrying...";
     disconnect();
     return connect();
 }
 
-std::string HttpClient::GET(const std::string& endpoint) {
-    // GET requests usually go to different endpoints, so we might need a temporary request handle
-    // BUT we can reuse the Session and Connect handles if the host is the same.
-    // However, the current usage of GET in CommandProcessor seems to use full URLs.
-    // For simplicity in this refactor, we will stick to the previous implementation for GET
-    // because it's used for "polling" or "downloading" from potentially different URLs?
-    // Actually, CommandProcessor uses it for polling commands from the SAME server.
-    // So we SHOULD reuse the connection if possible.
-    
-    // BUT, `endpoint` passed here is a full URL string.
-    // Our persistent connection is to `server` and `port`.
-    // If `endpoint` matches our server/port, we can reuse.
-    // For MVP stability, let's just make GET robust but maybe not strictly reuse the *same* handle 
-    // if the logic is complex to parse.
-    // Actually, let's just use the old "one-off" logic for GET for now to minimize risk,
-    // as the critical part is the high-volume POST telemetry.
-    
-    // ... (Keep original GET implementation for now, or minimal fix) ...
-    // To save space and focus on the requested fix (Telemetry POST), I will keep GET as is 
-    // but wrapped in a standalone session to avoid interfering with our persistent one.
-    
-    std::wstring fullUrl = stringToWstring(endpoint);
-    URL_COMPONENTS urlComp;
-    ZeroMemory(&urlComp, sizeof(urlComp));
-    urlComp.dwStructSize = sizeof(urlComp);
-    
-    wchar_t hostName[256];
-    wchar_t urlPath[1024];
-    
-    urlComp.lpszHostName = hostName;
-    urlComp.dwHostNameLength = ARRAYSIZE(hostName);
-    urlComp.lpszUrlPath = urlPath;
-    urlComp.dwUrlPathLength = ARRAYSIZE(urlPath);
-    
-    if (!WinHttpCrackUrl(fullUrl.c_str(), (DWORD)fullUrl.length(), 0, &urlComp)) {
-        return "";
-    }
-    
-    HINTERNET hTempSession = WinHttpOpen(L"EDR-Agent/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-                                          WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
-    if (!hTempSession) return "";
-    
-    HINTERNET hTempConnect = WinHttpConnect(hTempSession, hostName, urlComp.nPort, 0);
-    if (!hTempConnect) {
-        WinHttpCloseHandle(hTempSession);
-        return "";
-    }
-    
-    HINTERNET hRequest = WinHttpOpenRequest(hTempConnect, L"GET", urlPath, NULL,
-                                             WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, 0);
-    if (!hRequest) {
-        WinHttpCloseHandle(hTempConnect);
-        WinHttpCloseHandle(hTempSession);
-        return "";
-    }
-    
-    // Add Custom Headers
-    std::wstring headersStr;
-    for (const auto& header : customHeaders) {
-        headersStr += header.first + L": " + header.second + L"\r\n";
-    }
-    
-    if (!headersStr.empty()) {
-        WinHttpAddRequestHeaders(hRequest, headersStr.c_str(), -1L, WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
-    }
-    
-    std::string response;
-    if (WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0)) {
-        if (WinHttpReceiveResponse(hRequest, NULL)) {
-            DWORD dwSize = 0;
-            DWORD dwDownloaded = 0;
-            do {
-                dwSize = 0;
-                if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) break;
-                if (!dwSize) break;
-                char* pszOutBuffer = new char[dwSize + 1];
-                if (!pszOutBuffer) break;
-                ZeroMemory(pszOutBuffer, dwSize + 1);
-                if (WinHttpReadData(hRequest, (LPVOID)pszOutBuffer, dwSize, &dwDownloaded)) {
-                    response.append(pszOutBuffer, dwDownloaded);
-                }
-                delete[] pszOutBuffer;
-            } while (dwSize > 0);
-        }
-    }
-    
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hTempConnect);
-    WinHttpCloseHandle(hTempSession);
-    return response;
+// ============================================
+// Generic Requests (command channel, health)
+// ============================================
+std::string HttpClient::GET(const std::string& endpoint, unsigned timeoutMs, DWORD* statusCode) {
+    return sendRequest(L"GET", endpoint, nullptr, timeoutMs, statusCode);
 }
 
 std::string HttpClient::POST(const std::string& endpoint, const std::string& data) {
     // Generic POST method used by CommandProcessor to report action results
+    return sendRequest(L"POST", endpoint, &data, 0, nullptr);
+}
+
+std::string HttpClient::sendRequest(const wchar_t* verb, const std::string& endpoint,
+                                    const std::string* body, unsigned timeoutMs, DWORD* statusCode) {
+    if (statusCode != nullptr) *statusCode = 0;
+
     std::wstring fullUrl = stringToWstring(endpoint);
     URL_COMPONENTS urlComp;
     ZeroMemory(&urlComp, sizeof(urlComp));
@@ -184,32 +109,47 @@ std::string HttpClient::POST(const std::string& endpoint, const std::string& dat
         std::cerr << "[HTTP] Failed to parse URL: " << endpoint << std::endl;
         return "";
     }
-    
-    HINTERNET hTempSession = WinHttpOpen(L"EDR-Agent/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-                                          WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
-    if (!hTempSession) {
-        std::cerr << "[HTTP] WinHttpOpen failed" << std::endl;
-        return "";
-    }
-    
-    HINTERNET hTempConnect = WinHttpConnect(hTempSession, hostName, urlComp.nPort, 0);
-    if (!hTempConnect) {
-        WinHttpCloseHandle(hTempSession);
-        std::cerr << "[HTTP] WinHttpConnect failed" << std::endl;
-        return "";
+
+    // The configured server goes over the persistent connection (WinHTTP keeps
+    // the socket alive between requests); anything else gets a one-off session
+    HINTERNET hTempSession = NULL;
+    HINTERNET hTempConnect = NULL;
+    HINTERNET hTarget = NULL;
+    if (!server.empty() && server == hostName && port == (int)urlComp.nPort) {
+        if (!ensureConnection()) return "";
+        hTarget = hConnect;
+    } else {
+        hTempSession = WinHttpOpen(L"EDR-Agent/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+                                   WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+        if (!hTempSession) {
+            std::cerr << "[HTTP] WinHttpOpen failed" << std::endl;
+            return "";
+        }
+        hTempConnect = WinHttpConnect(hTempSession, hostName, urlComp.nPort, 0);
+        if (!hTempConnect) {
+            WinHttpCloseHandle(hTempSession);
+            std::cerr << "[HTTP] WinHttpConnect failed" << std::endl;
+            return "";
+        }
+        hTarget = hTempConnect;
     }
     
-    HINTERNET hRequest = WinHttpOpenRequest(hTempConnect, L"POST", urlPath, NULL,
+    HINTERNET hRequest = WinHttpOpenRequest(hTarget, verb, urlPath, NULL,
                                              WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, 0);
     if (!hRequest) {
-        WinHttpCloseHandle(hTempConnect);
-        WinHttpCloseHandle(hTempSession);
+        if (hTempConnect) WinHttpCloseHandle(hTempConnect);
+        if (hTempSession) WinHttpCloseHandle(hTempSession);
         std::cerr << "[HTTP] WinHttpOpenRequest failed" << std::endl;
         return "";
     }
+
+    // Long-poll: the server holds the request, so the receive timeout has to outlast it
+    if (timeoutMs > 0) {
+        WinHttpSetTimeouts(hRequest, (int)timeoutMs, (int)timeoutMs, (int)timeoutMs, (int)timeoutMs);
+    }
     
     // Add headers (including custom headers like Authorization)
-    std::wstring headersStr = L"Content-Type: application/json\r\n";
+    std::wstring headersStr = body != nullptr ? L"Content-Type: application/json\r\n" : L"";
     for (const auto& header : customHeaders) {
         headersStr += header.first + L": " + header.second + L"\r\n";
     }
@@ -217,18 +157,20 @@ std::string HttpClient::POST(const std::string& endpoint, const std::string& dat
     if (!headersStr.empty()) {
         WinHttpAddRequestHeaders(hRequest, headersStr.c_str(), -1L, WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
     }
+
+    LPVOID data = body != nullptr ? (LPVOID)body->c_str() : WINHTTP_NO_REQUEST_DATA;
+    DWORD length = body != nullptr ? (DWORD)body->length() : 0;
     
     std::string response;
-    if (WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-                          (LPVOID)data.c_str(), (DWORD)data.length(),
-                          (DWORD)data.length(), 0)) {
+    if (WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0, data, length, length, 0)) {
         if (WinHttpReceiveResponse(hRequest, NULL)) {
             DWORD dwStatusCode = 0;
             DWORD dwSize = sizeof(dwStatusCode);
             WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
                               WINHTTP_HEADER_NAME_BY_INDEX, &dwStatusCode, &dwSize, WINHTTP_NO_HEADER_INDEX);
+            if (statusCode != nullptr) *statusCode = dwStatusCode;
             
-            std::cout << "[HTTP] Command result reported: " << dwStatusCode << std::endl;
+            LOG_DEBUG("HTTP") << (body != nullptr ? "POST " : "GET ") << endpoint << ": " << dwStatusCode;
             
             // Read response body
             DWORD dwDownloaded = 0;
@@ -245,13 +187,13 @@ std::string HttpClient::POST(const std::string& endpoint, const std::string& dat
                 delete[] pszOutBuffer;
             } while (dwSize > 0);
         }
-    } else {
+    } else if (body != nullptr) {
         std::cerr << "[HTTP] POST request failed" << std::endl;
     }
     
     WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hTempConnect);
-    WinHttpCloseHandle(hTempSession);
+    if (hTempConnect) WinHttpCloseHandle(hTempConnect);
+    if (hTempSession) WinHttpCloseHandle(hTempSession);
     return response;
 }
 
@@ -265,18 +207,17 @@ bool HttpClient::sendTelemetry(const nlohmann::json& eventData) {
     }
 }
 
-bool HttpClient::sendTelemetryBatch(const std::vector<nlohmann::json>& events) {
+bool HttpClient::sendTelemetryPayload(const std::string& jsonArray, const wchar_t* contentType) {
     try {
-        nlohmann::json batchJson = events;
-        std::string jsonStr = batchJson.dump();
-        
-        std::vector<BYTE> compressedData;
-        if (compressData(jsonStr, compressedData)) {
-             std::cout << "[HTTP] Compressed " << jsonStr.size() << " bytes to " << compressedData.size() << " bytes" << std::endl;
-             return sendCompressedHttpPost(compressedData);
+        if (compressData(jsonArray, lastCompressed)) {
+             lastCompressedSize = lastCompressed.size();
+             LOG_DEBUG("HTTP") << "Compressed " << jsonArray.size() << " bytes to " << lastCompressed.size() << " bytes";
+             return sendCompressedHttpPost(lastCompressed, contentType);
         } else {
+             lastCompressedSize = 0;
+             lastCompressed.clear();
              std::cerr << "[HTTP] Compression failed, sending plain text" << std::endl;
-             return sendHttpPost(jsonStr);
+             return sendHttpPost(jsonArray, contentType);
         }
     } catch (const std::exception& e) {
         std::cerr << "[HTTP] Error in batch send: " << e.what() << std::endl;
@@ -284,14 +225,27 @@ bool HttpClient::sendTelemetryBatch(const std::vector<nlohmann::json>& events) {
     }
 }
 
+bool HttpClient::sendCompressedPayload(const std::vector<BYTE>& compressedData, const wchar_t* contentType,
+                                       DWORD* statusCode) {
+    if (statusCode != nullptr) *statusCode = 0;
+    try {
+        return sendCompressedHttpPost(compressedData, contentType, statusCode);
+    } catch (const std::exception& e) {
+        std::cerr << "[HTTP] Error in compressed send: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 #include "SimpleZstd.hpp"
 
 bool HttpClient::compressData(const std::string& data, std::vector<BYTE>& compressedData) {
     return SimpleZstd::compress(data, compressedData);
 }
 
-bool HttpClient::sendCompressedHttpPost(const std::vector<BYTE>& compressedData) {
+bool HttpClient::sendCompressedHttpPost(const std::vector<BYTE>& compressedData, const wchar_t* contentType,
+                                        DWORD* statusCode) {
     if (!ensureConnection()) return false;
+    auto started = std::chrono::steady_clock::now();
     
     HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"POST", L"/api/v1/telemetry/",
                                             NULL, WINHTTP_NO_REFERER,
@@ -304,8 +258,8 @@ bool HttpClient::sendCompressedHttpPost(const std::vector<BYTE>& compressedData)
         return false;
     }
     
-    // Add Headers: Content-Type: application/json, Content-Encoding: zstd, Authorization
-    std::wstring headers = L"Content-Type: application/json\r\nContent-Encoding: zstd\r\nAuthorization: " + authToken;
+    // Add Headers: Content-Type, Content-Encoding: zstd, Authorization
+    std::wstring headers = std::wstring(L"Content-Type: ") + contentType + L"\r\nContent-Encoding: zstd\r\nAuthorization: " + authToken;
     
     // The WinHttpAddRequestHeaders call is implicitly handled by passing headers to WinHttpSendRequest
     // if WINHTTP_NO_ADDITIONAL_HEADERS is not used.
@@ -321,7 +275,7 @@ bool HttpClient::sendCompressedHttpPost(const std::vector<BYTE>& compressedData)
                                        
     // Auto-Retry Logic on Failure
     if (!bResults) {
-        std::cerr << "[HTTP] Send failed (" << GetLastError() << "). Reconnecting..." << std::endl;
+        LOG_WARN("HTTP") << "Send failed (" << GetLastError() << "). Reconnecting...";
         WinHttpCloseHandle(hRequest);
         disconnect();
         if (ensureConnection()) {
@@ -341,12 +295,13 @@ bool HttpClient::sendCompressedHttpPost(const std::vector<BYTE>& compressedData)
         bResults = WinHttpReceiveResponse(hRequest, NULL);
     }
     
+    DWORD dwStatusCode = 0;
     if (bResults) {
-        DWORD dwStatusCode = 0;
         DWORD dwSize = sizeof(dwStatusCode);
         WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER, 
                             WINHTTP_HEADER_NAME_BY_INDEX, &dwStatusCode, &dwSize, WINHTTP_NO_HEADER_INDEX);
-                            
+        if (statusCode != nullptr) *statusCode = dwStatusCode;
+
         if (dwStatusCode == 200 || dwStatusCode == 201) {
             // Success!
             // Drain response to keep connection alive
@@ -361,17 +316,19 @@ bool HttpClient::sendCompressedHttpPost(const std::vector<BYTE>& compressedData)
                 delete[] buffer;
             } while (dwAvailable > 0);
         } else {
-            std::cerr << "[HTTP] Server returned error: " << dwStatusCode << std::endl;
+            LOG_WARN("HTTP") << "Server returned error: " << dwStatusCode;
             bResults = false;
         }
     }
     
+    reportResponse(hRequest, dwStatusCode, started);
     WinHttpCloseHandle(hRequest);
     return bResults;
 }
 
-bool HttpClient::sendHttpPost(const std::string& jsonData) {
+bool HttpClient::sendHttpPost(const std::string& jsonData, const wchar_t* contentType) {
     if (!ensureConnection()) return false;
+    auto started = std::chrono::steady_clock::now();
     
     HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"POST", path.c_str(), NULL,
                                              WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES, 0);
@@ -380,7 +337,7 @@ bool HttpClient::sendHttpPost(const std::string& jsonData) {
         return false;
     }
     
-    std::wstring headers = L"Content-Type: application/json\r\nAuthorization: " + authToken + L"\r\n";
+    std::wstring headers = std::wstring(L"Content-Type: ") + contentType + L"\r\nAuthorization: " + authToken + L"\r\n";
     WinHttpAddRequestHeaders(hRequest, headers.c_str(), -1L, WINHTTP_ADDREQ_FLAG_ADD | WINHTTP_ADDREQ_FLAG_REPLACE);
     
     bool bResults = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
@@ -405,23 +362,66 @@ bool HttpClient::sendHttpPost(const std::string& jsonData) {
     
     if (bResults) bResults = WinHttpReceiveResponse(hRequest, NULL);
     
+    DWORD dwStatusCode = 0;
     if (bResults) {
-        DWORD dwStatusCode = 0;
         DWORD dwSize = sizeof(dwStatusCode);
         WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER, 
                             WINHTTP_HEADER_NAME_BY_INDEX, &dwStatusCode, &dwSize, WINHTTP_NO_HEADER_INDEX);
         if (dwStatusCode == 201) {
-            std::cout << "[HTTP] ✅ Sent (201)" << std::endl;
+            LOG_DEBUG("HTTP") << "✅ Sent (201)";
         } else {
-            std::cerr << "[HTTP] ❌ Failed (" << dwStatusCode << ")" << std::endl;
+            LOG_WARN("HTTP") << "❌ Failed (" << dwStatusCode << ")";
             bResults = false;
         }
     }
     
+    reportResponse(hRequest, dwStatusCode, started);
     WinHttpCloseHandle(hRequest);
     return bResults;
 }
 
+// ============================================
+// Rate Control Feedback
+// ============================================
+void HttpClient::reportResponse(HINTERNET hRequest, DWORD statusCode, std::chrono::steady_clock::time_point started) {
+    if (rateController == nullptr) return;
+
+    auto latencyMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    unsigned retryAfter = (statusCode == 429 || statusCode == 503) ? queryRetryAfter(hRequest) : 0;
+    rateController->onResponse(statusCode, (uint64_t)latencyMs, retryAfter);
+}
+
+unsigned HttpClient::queryRetryAfter(HINTERNET hRequest) {
+    wchar_t value[64];
+    DWORD size = sizeof(value);
+    if (!WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_RETRY_AFTER, WINHTTP_HEADER_NAME_BY_INDEX,
+                             value, &size, WINHTTP_NO_HEADER_INDEX)) {
+        return 0;
+    }
+    size_t length = size / sizeof(wchar_t);
+
+    // delay-seconds
+    if (length > 0 && iswdigit(value[0])) {
+        unsigned long seconds = wcstoul(value, nullptr, 10);
+        return (unsigned)std::min<unsigned long>(seconds, 86400);
+    }
+
+    // HTTP-date: how far ahead of our clock it is
+    SYSTEMTIME retryAt;
+    FILETIME retryFt, nowFt;
+    if (!WinHttpTimeToSystemTime(value, &retryAt) || !SystemTimeToFileTime(&retryAt, &retryFt)) return 0;
+    GetSystemTimeAsFileTime(&nowFt);
+
+    ULARGE_INTEGER retry, now;
+    retry.LowPart = retryFt.dwLowDateTime;
+    retry.HighPart = retryFt.dwHighDateTime;
+    now.LowPart = nowFt.dwLowDateTime;
+    now.HighPart = nowFt.dwHighDateTime;
+    if (retry.QuadPart <= now.QuadPart) return 0;
+    return (unsigned)std::min<ULONGLONG>((retry.QuadPart - now.QuadPart + 9999999) / 10000000, 86400);
+}
+
 std::wstring HttpClient::stringToWstring(const std::string& str) {
     if (str.empty()) return std::wstring();
     int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), NULL, 0);
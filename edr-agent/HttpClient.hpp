@@ -1,15 +1,19 @@
 #ifndef HTTPCLIENT_HPP
 #define HTTPCLIENT_HPP
 
+#include <chrono>
 #include <string>
 #include <windows.h>
 #include <winhttp.h>
 #include <vector>
 #include "nlohmann/json.hpp"
 #include "SimpleZstd.hpp"
+#include "BinaryBatch.hpp"
 
 #pragma comment(lib, "winhttp.lib")
 
+class RateController;
+
 class HttpClient {
 private:
     std::wstring server;
@@ -24,24 +28,53 @@ public:
     ~HttpClient();
    
     void addHeader(const std::string& key, const std::string& value);
-    std::string GET(const std::string& endpoint);
+    // Full URLs. Requests to this client's server reuse its persistent
+    // connection. timeoutMs 0 = WinHTTP defaults; statusCode 0 = no response.
+    std::string GET(const std::string& endpoint, unsigned timeoutMs = 0, DWORD* statusCode = nullptr);
     std::string POST(const std::string& endpoint, const std::string& data);
 
     bool sendTelemetry(const nlohmann::json& eventData);
-    bool sendTelemetryBatch(const std::vector<nlohmann::json>& events);
+
+    // Sends an already-serialized batch body (used by the pipeline batcher)
+    bool sendTelemetryPayload(const std::string& jsonArray, const wchar_t* contentType = EDR_JSON_CONTENT_TYPE);
+
+    // Sends a batch that is already zstd-compressed (spool replay). statusCode 0 = no response.
+    bool sendCompressedPayload(const std::vector<BYTE>& compressedData, const wchar_t* contentType = EDR_JSON_CONTENT_TYPE,
+                               DWORD* statusCode = nullptr);
+
+    // Size on the wire of the last telemetry payload (0 if it went uncompressed)
+    size_t getLastCompressedSize() const { return lastCompressedSize; }
+
+    // The last compressed payload, so a failed batch can be spooled without recompressing
+    const std::vector<BYTE>& getLastCompressedPayload() const { return lastCompressed; }
+
+    // Telemetry responses (status, latency, Retry-After) are reported to it
+    void setRateController(RateController* controller) { rateController = controller; }
+
+    // Retry-After of a response in seconds, either form (delta or HTTP-date); 0 = none
+    static unsigned queryRetryAfter(HINTERNET hRequest);
     
 private:
     // Persistent Connection Handles
     HINTERNET hSession = NULL;
     HINTERNET hConnect = NULL;
+
+    size_t lastCompressedSize = 0;
+    std::vector<BYTE> lastCompressed;   // Reused across batches
+    RateController* rateController = nullptr;
     
     bool connect();
     void disconnect();
     bool ensureConnection();
 
-    bool sendHttpPost(const std::string& jsonData);
+    std::string sendRequest(const wchar_t* verb, const std::string& endpoint,
+                            const std::string* body, unsigned timeoutMs, DWORD* statusCode);
+
+    bool sendHttpPost(const std::string& jsonData, const wchar_t* contentType = EDR_JSON_CONTENT_TYPE);
     bool compressData(const std::string& data, std::vector<BYTE>& compressedData);
-    bool sendCompressedHttpPost(const std::vector<BYTE>& compressedData);
+    bool sendCompressedHttpPost(const std::vector<BYTE>& compressedData, const wchar_t* contentType = EDR_JSON_CONTENT_TYPE,
+                                DWORD* statusCode = nullptr);
+    void reportResponse(HINTERNET hRequest, DWORD statusCode, std::chrono::steady_clock::time_point started);
     
     std::wstring stringToWstring(const std::string& str);
 };
@@ -0,0 +1,122 @@
+#include "Logger.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+namespace {
+    constexpr int64_t UNLIMITED = std::numeric_limits<int64_t>::max() / 2;
+}
+
+std::atomic<LogLevel> Logger::s_level{LogLevel::Info};
+std::atomic<int64_t> Logger::s_budget{UNLIMITED};
+std::atomic<uint64_t> Logger::s_suppressed{0};
+std::atomic<uint64_t> Logger::s_suppressedTotal{0};
+std::atomic<bool> Logger::s_running{false};
+uint32_t Logger::s_maxLinesPerSecond = 0;
+BoundedQueue<Logger::Record>* Logger::s_queue = nullptr;
+std::thread Logger::s_writer;
+std::mutex Logger::s_wakeMutex;
+std::condition_variable Logger::s_wakeCV;
+
+// ============================================
+// Lifecycle
+// ============================================
+void Logger::start(const Config& config) {
+    if (s_running.load()) return;
+
+    s_level = config.level;
+    s_maxLinesPerSecond = config.maxLinesPerSecond;
+    // Created once and kept: a producer may still hold the pointer after stop()
+    if (s_queue == nullptr) {
+        s_queue = new BoundedQueue<Record>(config.queueDepth);
+    }
+    refill();
+
+    s_running = true;
+    s_writer = std::thread(&Logger::writerLoop);
+}
+
+void Logger::stop() {
+    if (!s_running.exchange(false)) return;
+
+    s_wakeCV.notify_all();
+    if (s_writer.joinable()) s_writer.join();
+
+    // Anything a producer slipped in after the writer's last pass
+    Record record;
+    while (s_queue->tryPop(record)) print(record);
+    s_budget = UNLIMITED;
+}
+
+LogLevel Logger::parseLevel(const std::string& name) {
+    if (name == "debug") return LogLevel::Debug;
+    if (name == "info") return LogLevel::Info;
+    if (name == "warn") return LogLevel::Warn;
+    if (name == "error") return LogLevel::Error;
+    if (name == "off") return LogLevel::Off;
+
+    std::cerr << "[Log] Unknown level '" << name << "', using info" << std::endl;
+    return LogLevel::Info;
+}
+
+// ============================================
+// Producers
+// ============================================
+void Logger::write(LogLevel level, std::string&& line) {
+    if (!s_running.load(std::memory_order_relaxed)) {
+        print(Record{level, std::move(line)});
+        return;
+    }
+
+    Record record{level, std::move(line)};
+    if (!s_queue->tryPush(std::move(record))) {
+        s_suppressed.fetch_add(1, std::memory_order_relaxed);   // Writer is behind; never block for a log line
+    }
+}
+
+// ============================================
+// Writer Thread
+// ============================================
+void Logger::refill() {
+    s_budget.store(s_maxLinesPerSecond == 0 ? UNLIMITED : (int64_t)s_maxLinesPerSecond,
+                   std::memory_order_relaxed);
+}
+
+void Logger::print(const Record& record) {
+    // One write per line; std::endl would flush every time
+    std::ostream& out = record.level >= LogLevel::Warn ? std::cerr : std::cout;
+    out << record.text << '\n';
+}
+
+void Logger::writerLoop() {
+    auto nextRefill = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    Record record;
+
+    while (s_running) {
+        bool wrote = false;
+        while (s_queue->tryPop(record)) {
+            print(record);
+            wrote = true;
+        }
+        if (wrote) std::cout.flush();
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextRefill) {
+            uint64_t suppressed = s_suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed > 0) {
+                s_suppressedTotal.fetch_add(suppressed, std::memory_order_relaxed);
+                std::cerr << "[Log] " << suppressed << " line(s) suppressed in the last second\n";
+            }
+            refill();
+            nextRefill = now + std::chrono::seconds(1);
+        }
+
+        // Producers never signal (that would put a syscall on the hot path); poll instead
+        std::unique_lock<std::mutex> lock(s_wakeMutex);
+        s_wakeCV.wait_for(lock, std::chrono::milliseconds(20), [] { return !s_running.load(); });
+    }
+
+    while (s_queue->tryPop(record)) print(record);
+    std::cout.flush();
+}
@@ -0,0 +1,118 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include "BoundedQueue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// ============================================================
+// Logger
+// ============================================================
+// Leveled, asynchronous, rate-limited console output for the hot path.
+//
+//   LOG_DEBUG("EventConverter") << "Processing Event ID: " << id;
+//
+// prints "[EventConverter] Processing Event ID: 1". When the level is off
+// or the per-second budget is spent, the macro skips the whole statement,
+// formatting included. Lines that do get through are queued and written
+// by a background thread, so a slow console never stalls a worker.
+// Suppressed lines are counted and reported once a second.
+//
+// Before start() (and after stop()) lines are written synchronously, so
+// startup and shutdown output keeps its order.
+// ============================================================
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+class Logger {
+public:
+    struct Config {
+        LogLevel level = LogLevel::Info;
+        uint32_t maxLinesPerSecond = 200;    // 0 = unlimited
+        size_t queueDepth = 4096;
+    };
+
+    static void start(const Config& config);
+    static void stop();   // Flushes whatever is queued
+
+    // Any time (config reload); takes effect on the next statement
+    static void setLevel(LogLevel level) { s_level.store(level, std::memory_order_relaxed); }
+
+    // Level check plus rate-limit token; the LOG_* macros call this first
+    static bool shouldLog(LogLevel level) {
+        if (level < s_level.load(std::memory_order_relaxed)) return false;
+        if (level >= LogLevel::Error) return true;   // Errors are never rate-limited
+        if (s_budget.fetch_sub(1, std::memory_order_relaxed) > 0) return true;
+        s_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    static void write(LogLevel level, std::string&& line);
+
+    static uint64_t suppressedCount() { return s_suppressedTotal.load(std::memory_order_relaxed); }
+
+    // "debug" | "info" | "warn" | "error" | "off" (defaults to Info)
+    static LogLevel parseLevel(const std::string& name);
+
+    // Collects one line and hands it to write() when the statement ends
+    class Line {
+    public:
+        Line(LogLevel level, const char* tag) : m_level(level) {
+            m_stream << '[' << tag << "] ";
+        }
+        ~Line() { write(m_level, m_stream.str()); }
+
+        template <typename T>
+        Line& operator<<(const T& value) {
+            m_stream << value;
+            return *this;
+        }
+
+    private:
+        LogLevel m_level;
+        std::ostringstream m_stream;
+    };
+
+private:
+    struct Record {
+        LogLevel level = LogLevel::Info;
+        std::string text;
+    };
+
+    static void writerLoop();
+    static void print(const Record& record);
+    static void refill();
+
+    static std::atomic<LogLevel> s_level;
+    static std::atomic<int64_t> s_budget;
+    static std::atomic<uint64_t> s_suppressed;
+    static std::atomic<uint64_t> s_suppressedTotal;
+    static std::atomic<bool> s_running;
+    static uint32_t s_maxLinesPerSecond;
+    static BoundedQueue<Record>* s_queue;
+    static std::thread s_writer;
+    static std::mutex s_wakeMutex;
+    static std::condition_variable s_wakeCV;
+};
+
+#define EDR_LOG(level, tag) \
+    if (!Logger::shouldLog(level)) {} else Logger::Line(level, tag)
+
+#define LOG_DEBUG(tag) EDR_LOG(LogLevel::Debug, tag)
+#define LOG_INFO(tag)  EDR_LOG(LogLevel::Info, tag)
+#define LOG_WARN(tag)  EDR_LOG(LogLevel::Warn, tag)
+#define LOG_ERROR(tag) EDR_LOG(LogLevel::Error, tag)
+
+#endif // LOGGER_HPP
@@ -0,0 +1,209 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+    struct Shard {
+        struct Stage {
+            std::atomic<uint64_t> buckets[Metrics::BUCKET_COUNT];
+            std::atomic<uint64_t> count;
+            std::atomic<uint64_t> sum;
+            std::atomic<uint64_t> max;
+        };
+
+        std::atomic<uint64_t> counters[(size_t)Counter::Count];
+        Stage stages[(size_t)::Stage::Count];
+
+        Shard() {
+            for (auto& counter : counters) counter.store(0, std::memory_order_relaxed);
+            for (auto& stage : stages) {
+                for (auto& bucket : stage.buckets) bucket.store(0, std::memory_order_relaxed);
+                stage.count.store(0, std::memory_order_relaxed);
+                stage.sum.store(0, std::memory_order_relaxed);
+                stage.max.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // Shards outlive their threads (their counts still belong in the totals)
+    // and are never freed, so a snapshot racing thread exit stays safe
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Shard>> shards;
+    };
+
+    Registry& registry() {
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    Shard& localShard() {
+        thread_local Shard* shard = [] {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.shards.push_back(std::make_unique<Shard>());
+            return reg.shards.back().get();
+        }();
+        return *shard;
+    }
+
+    // Only the owning thread writes a shard, so no read-modify-write is needed
+    inline void bump(std::atomic<uint64_t>& value, uint64_t delta) {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    int highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return (int)index;
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    const char* const STAGE_NAMES[] = {
+        "render", "sanitize", "parse", "convert", "queue_wait", "compress", "http_send"
+    };
+    const char* const COUNTER_NAMES[] = {
+        "events_submitted", "events_dropped", "events_converted", "events_skipped", "events_shed",
+        "batches_sent", "batches_failed", "batches_spooled", "batches_throttled", "batches_spilled",
+        "batches_lost", "bytes_sent"
+    };
+    static_assert(sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) == (size_t)Stage::Count, "STAGE_NAMES");
+    static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == (size_t)Counter::Count, "COUNTER_NAMES");
+}
+
+// ============================================
+// Buckets
+// ============================================
+size_t Metrics::bucketIndex(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) return (size_t)value;   // Exact below 32
+
+    int magnitude = highestBit(value);
+    if (magnitude > (int)MAX_MAGNITUDE) return BUCKET_COUNT - 1;
+    int shift = magnitude - (int)SUB_BUCKET_BITS;
+    return (size_t)shift * SUB_BUCKETS + (size_t)(value >> shift);
+}
+
+uint64_t Metrics::bucketLowerBound(size_t index) {
+    if (index < 2 * SUB_BUCKETS) return index;
+
+    size_t group = index / SUB_BUCKETS;
+    uint64_t mantissa = (index % SUB_BUCKETS) + SUB_BUCKETS;
+    return mantissa << (group - 1);
+}
+
+// ============================================
+// Recording
+// ============================================
+void Metrics::record(Stage stage, uint64_t nanoseconds) {
+    Shard::Stage& target = localShard().stages[(size_t)stage];
+    bump(target.buckets[bucketIndex(nanoseconds)], 1);
+    bump(target.count, 1);
+    bump(target.sum, nanoseconds);
+    if (nanoseconds > target.max.load(std::memory_order_relaxed)) {
+        target.max.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::add(Counter counter, uint64_t value) {
+    bump(localShard().counters[(size_t)counter], value);
+}
+
+Metrics::Snapshot Metrics::snapshot() {
+    Snapshot result;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    for (const auto& shard : reg.shards) {
+        for (size_t c = 0; c < (size_t)Counter::Count; c++) {
+            result.counters[c] += shard->counters[c].load(std::memory_order_relaxed);
+        }
+        for (size_t s = 0; s < (size_t)Stage::Count; s++) {
+            const Shard::Stage& source = shard->stages[s];
+            Histogram& target = result.stages[s];
+            for (size_t b = 0; b < BUCKET_COUNT; b++) {
+                target.buckets[b] += source.buckets[b].load(std::memory_order_relaxed);
+            }
+            target.count += source.count.load(std::memory_order_relaxed);
+            target.sum += source.sum.load(std::memory_order_relaxed);
+            target.max = std::max(target.max, source.max.load(std::memory_order_relaxed));
+        }
+    }
+    return result;
+}
+
+// ============================================
+// Histogram Queries
+// ============================================
+uint64_t Metrics::Histogram::percentile(double quantile) const {
+    if (count == 0) return 0;
+
+    // Buckets are read one by one while writers run, so their total can
+    // trail count slightly; rank against what the buckets actually hold
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) total += bucket;
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(quantile * (double)(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(bucketLowerBound(i), max);
+    }
+    return max;
+}
+
+Metrics::Histogram Metrics::Histogram::since(const Histogram& earlier) const {
+    Histogram delta;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        delta.buckets[i] = buckets[i] >= earlier.buckets[i] ? buckets[i] - earlier.buckets[i] : 0;
+    }
+    delta.count = count >= earlier.count ? count - earlier.count : 0;
+    delta.sum = sum >= earlier.sum ? sum - earlier.sum : 0;
+    delta.max = max;
+    return delta;
+}
+
+const char* Metrics::stageName(Stage stage) {
+    return stage < Stage::Count ? STAGE_NAMES[(size_t)stage] : "unknown";
+}
+
+const char* Metrics::counterName(Counter counter) {
+    return counter < Counter::Count ? COUNTER_NAMES[(size_t)counter] : "unknown";
+}
+
+nlohmann::json Metrics::toJson(const Snapshot& current, const Snapshot& previous) {
+    nlohmann::json counters = nlohmann::json::object();
+    for (size_t c = 0; c < (size_t)Counter::Count; c++) {
+        counters[COUNTER_NAMES[c]] = {
+            {"total", current.counters[c]},
+            {"interval", current.counters[c] - std::min(current.counters[c], previous.counters[c])}
+        };
+    }
+
+    auto micros = [](uint64_t nanoseconds) { return (double)nanoseconds / 1000.0; };
+    nlohmann::json stages = nlohmann::json::object();
+    for (size_t s = 0; s < (size_t)Stage::Count; s++) {
+        Histogram interval = current.stages[s].since(previous.stages[s]);
+        stages[STAGE_NAMES[s]] = {
+            {"count", interval.count},
+            {"mean_us", micros((uint64_t)interval.mean())},
+            {"p50_us", micros(interval.percentile(0.50))},
+            {"p90_us", micros(interval.percentile(0.90))},
+            {"p99_us", micros(interval.percentile(0.99))},
+            {"max_us", micros(current.stages[s].max)}
+        };
+    }
+
+    return {{"counters", counters}, {"stages", stages}};
+}
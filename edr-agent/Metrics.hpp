@@ -0,0 +1,122 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================
+// Metrics
+// ============================================================
+// Per-stage latency histograms and event counters for the hot path.
+//
+// Every thread that records gets its own shard on first use, so recording
+// is a couple of relaxed loads and stores on memory no other thread
+// writes: no locks and no shared cache lines. A snapshot sums the shards;
+// HealthReporter takes one per interval and reports the difference.
+//
+// Histograms are HDR-style log-linear: 16 sub-buckets per power of two,
+// so any recorded value is off by at most 1/16 (6.25%) and a histogram
+// is a fixed array whatever the range. Latencies are in nanoseconds.
+// ============================================================
+
+enum class Stage : uint8_t {
+    Render,      // EvtRender (XML or values)
+    Sanitize,    // UTF-8 validation of rendered XML
+    Parse,       // pugixml + field extraction
+    Convert,     // Filter + TelemetryEvent build
+    QueueWait,   // Submitted -> picked up by a worker
+    Compress,    // Batch compression (streamed: finish only)
+    HttpSend,    // Batch POST (or WebSocket frame), start to server answer
+    Count
+};
+
+enum class Counter : uint8_t {
+    EventsSubmitted,
+    EventsDropped,      // Overflow policy
+    EventsConverted,
+    EventsSkipped,      // Filtered, unknown or not sent
+    EventsShed,         // Dropped unparsed while over the resource budget
+    BatchesSent,
+    BatchesFailed,
+    BatchesSpooled,
+    BatchesThrottled,   // Spooled unsent while the server had us backing off
+    BatchesSpilled,     // Spooled unsent while far over the resource budget
+    BatchesLost,        // Neither sent nor spooled; bookmarks hold before them
+    BytesSent,          // On the wire (after compression)
+    Count
+};
+
+class Metrics {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 4;
+    static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_MAGNITUDE = 40;   // 2^40 ns ~ 18 minutes; anything above is clamped
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2);
+
+    struct Histogram {
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        // Lower bound of the bucket holding the given quantile (0..1)
+        uint64_t percentile(double quantile) const;
+        double mean() const { return count ? (double)sum / count : 0.0; }
+
+        // this - earlier, for per-interval figures (max stays the running max)
+        Histogram since(const Histogram& earlier) const;
+    };
+
+    struct Snapshot {
+        std::array<uint64_t, (size_t)Counter::Count> counters{};
+        std::array<Histogram, (size_t)Stage::Count> stages{};
+    };
+
+    static void record(Stage stage, uint64_t nanoseconds);
+    static void add(Counter counter, uint64_t value = 1);
+
+    // Sums every thread's shard. Cheap enough to call every few seconds.
+    static Snapshot snapshot();
+
+    static const char* stageName(Stage stage);
+    static const char* counterName(Counter counter);
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketLowerBound(size_t index);
+
+    // {"counters": {...}, "stages": {"render": {"count", "mean_us", "p50_us", ...}}} for the interval
+    static nlohmann::json toJson(const Snapshot& current, const Snapshot& previous);
+
+    // Nanoseconds on the steady clock, for stamping events that cross threads
+    static uint64_t now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Records the time from construction to destruction (or stop())
+    class Timer {
+    public:
+        explicit Timer(Stage stage) : m_stage(stage), m_start(now()) {}
+        ~Timer() { stop(); }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        void stop() {
+            if (m_start == 0) return;
+            record(m_stage, now() - m_start);
+            m_start = 0;
+        }
+
+    private:
+        Stage m_stage;
+        uint64_t m_start;
+    };
+};
+
+#endif // METRICS_HPP
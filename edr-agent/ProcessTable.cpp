@@ -0,0 +1,244 @@
+#include "ProcessTable.hpp"
+
+#include "EventConverter.hpp"
+#include "Logger.hpp"
+#include "SysmonSchema.hpp"
+#include "TelemetryEvent.hpp"
+#include "Utf8.hpp"
+
+#include <windows.h>
+#include <TlHelp32.h>
+
+#include <algorithm>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+    constexpr size_t MAX_TOMBSTONES = 4096;
+
+    struct State {
+        std::unordered_map<uint32_t, ProcessTable::Process> processes;
+        // Keyed by parent PID, so a child seen before its parent still links up.
+        // Entries are filtered by start time on the way out.
+        std::unordered_map<uint32_t, std::vector<uint32_t>> children;
+        std::unordered_map<uint32_t, uint64_t> tombstones;   // pid -> exit time
+    };
+
+    std::shared_mutex g_mutex;
+    State g_state;
+
+    // Unknown (0) start times cannot rule a process out
+    bool startedAfter(uint64_t later, uint64_t earlier) {
+        return later == 0 || earlier == 0 || later >= earlier;
+    }
+
+    bool isChildOf(const ProcessTable::Process& child, const ProcessTable::Process& parent) {
+        return child.pid != parent.pid && child.parentPid == parent.pid &&
+               startedAfter(child.startTime, parent.startTime);
+    }
+
+    void link(State& state, const ProcessTable::Process& process) {
+        if (process.pid != process.parentPid) {
+            state.children[process.parentPid].push_back(process.pid);
+        }
+    }
+
+    void unlink(State& state, const ProcessTable::Process& process) {
+        auto it = state.children.find(process.parentPid);
+        if (it == state.children.end()) return;
+
+        auto& list = it->second;
+        list.erase(std::remove(list.begin(), list.end(), process.pid), list.end());
+        if (list.empty()) state.children.erase(it);
+    }
+
+    uint64_t fileTimeTicks(const FILETIME& time) {
+        return ((uint64_t)time.dwHighDateTime << 32) | time.dwLowDateTime;
+    }
+
+    // Full image path and start time need a handle; protected processes keep the exe name and 0
+    void queryProcess(ProcessTable::Process& process, const wchar_t* exeName) {
+        HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, process.pid);
+        if (hProcess != NULL) {
+            FILETIME creation, exit, kernel, user;
+            if (GetProcessTimes(hProcess, &creation, &exit, &kernel, &user)) {
+                process.startTime = fileTimeTicks(creation);
+            }
+
+            wchar_t path[MAX_PATH];
+            DWORD length = MAX_PATH;
+            if (QueryFullProcessImageNameW(hProcess, 0, path, &length)) {
+                wideToUtf8(path, length, process.image);
+            }
+            CloseHandle(hProcess);
+        }
+        if (process.image.empty()) {
+            wideToUtf8(exeName, wcslen(exeName), process.image);
+        }
+    }
+
+    bool takeSnapshot(State& state) {
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snapshot == INVALID_HANDLE_VALUE) {
+            LOG_ERROR("ProcessTable") << "CreateToolhelp32Snapshot failed: " << GetLastError();
+            return false;
+        }
+
+        PROCESSENTRY32W entry;
+        entry.dwSize = sizeof(entry);
+        if (Process32FirstW(snapshot, &entry)) {
+            do {
+                ProcessTable::Process process;
+                process.pid = entry.th32ProcessID;
+                process.parentPid = entry.th32ParentProcessID;
+                queryProcess(process, entry.szExeFile);
+                link(state, process);
+                state.processes[process.pid] = std::move(process);
+            } while (Process32NextW(snapshot, &entry));
+        }
+        CloseHandle(snapshot);
+        return true;
+    }
+}
+
+// ============================================
+// Building
+// ============================================
+size_t ProcessTable::rebuild() {
+    // Snapshot outside the lock; workers keep applying events meanwhile
+    State fresh;
+    if (!takeSnapshot(fresh)) return size();
+
+    std::unique_lock<std::shared_mutex> lock(g_mutex);
+    g_state = std::move(fresh);
+    return g_state.processes.size();
+}
+
+// ============================================
+// Event Updates
+// ============================================
+void ProcessTable::onCreate(uint32_t pid, uint32_t parentPid, uint64_t startTime, std::string_view image) {
+    bool resync = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(g_mutex);
+
+        // Its exit was applied first: the process is already gone
+        auto tombstone = g_state.tombstones.find(pid);
+        if (tombstone != g_state.tombstones.end()) {
+            bool exited = startedAfter(tombstone->second, startTime);
+            g_state.tombstones.erase(tombstone);
+            if (exited) return;
+        }
+
+        auto existing = g_state.processes.find(pid);
+        if (existing != g_state.processes.end()) {
+            // Newer process already there: this create is out of order
+            if (existing->second.startTime > startTime && startTime != 0) return;
+            unlink(g_state, existing->second);   // PID reused and the old exit was missed
+        }
+
+        Process& process = g_state.processes[pid];
+        process.pid = pid;
+        process.parentPid = parentPid;
+        process.startTime = startTime;
+        process.image.assign(image.data(), image.size());
+        link(g_state, process);
+
+        resync = g_state.processes.size() > MAX_ENTRIES;
+    }
+
+    if (resync) {
+        LOG_WARN("ProcessTable") << "Over " << MAX_ENTRIES << " entries (exit events lost?), resyncing";
+        rebuild();
+    }
+}
+
+void ProcessTable::onExit(uint32_t pid, uint64_t exitTime) {
+    std::unique_lock<std::shared_mutex> lock(g_mutex);
+
+    auto it = g_state.processes.find(pid);
+    if (it == g_state.processes.end()) {
+        if (g_state.tombstones.size() >= MAX_TOMBSTONES) g_state.tombstones.clear();
+        g_state.tombstones[pid] = exitTime;
+        return;
+    }
+
+    // An exit older than the entry belongs to an earlier process with this PID
+    if (!startedAfter(exitTime, it->second.startTime)) return;
+
+    unlink(g_state, it->second);
+    g_state.processes.erase(it);
+}
+
+void ProcessTable::observe(const EventFields& fields) {
+    if (fields.processId <= 0) return;
+
+    if (fields.eventId == 1) {
+        onCreate((uint32_t)fields.processId, (uint32_t)fields.parentProcessId, eventTime(fields), fields.image);
+    } else if (fields.eventId == 5) {
+        onExit((uint32_t)fields.processId, eventTime(fields));
+    }
+}
+
+uint64_t ProcessTable::eventTime(const EventFields& fields) {
+    if (fields.timeCreated != 0) return fields.timeCreated;
+    uint64_t ticks = 0;
+    return EventConverter::parseSystemTime(fields.systemTime, ticks) ? ticks : 0;
+}
+
+// ============================================
+// Queries
+// ============================================
+std::vector<ProcessTable::Process> ProcessTable::subtree(uint32_t pid) {
+    std::vector<Process> result;
+    std::shared_lock<std::shared_mutex> lock(g_mutex);
+
+    auto root = g_state.processes.find(pid);
+    if (root == g_state.processes.end()) return result;
+
+    // Pre-order walk, reversed below: every descendant ends up before its ancestors
+    std::unordered_set<uint32_t> visited;
+    std::vector<const Process*> pending{&root->second};
+    while (!pending.empty()) {
+        const Process* process = pending.back();
+        pending.pop_back();
+        if (!visited.insert(process->pid).second) continue;
+        result.push_back(*process);
+
+        auto children = g_state.children.find(process->pid);
+        if (children == g_state.children.end()) continue;
+        for (uint32_t childPid : children->second) {
+            auto child = g_state.processes.find(childPid);
+            if (child != g_state.processes.end() && isChildOf(child->second, *process)) {
+                pending.push_back(&child->second);
+            }
+        }
+    }
+
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+void ProcessTable::appendLineage(TelemetryEvent& event, uint64_t startTime) {
+    if (event.parentProcessId <= 0) return;
+    std::shared_lock<std::shared_mutex> lock(g_mutex);
+
+    auto parent = g_state.processes.find((uint32_t)event.parentProcessId);
+    if (parent == g_state.processes.end() || !startedAfter(startTime, parent->second.startTime)) return;
+
+    const Process* current = &parent->second;
+    for (size_t depth = 0; depth < MAX_ANCESTORS; depth++) {
+        auto next = g_state.processes.find(current->parentPid);
+        if (next == g_state.processes.end() || !isChildOf(*current, next->second)) break;
+
+        current = &next->second;
+        event.addAncestor(current->image);
+    }
+}
+
+size_t ProcessTable::size() {
+    std::shared_lock<std::shared_mutex> lock(g_mutex);
+    return g_state.processes.size();
+}
@@ -0,0 +1,68 @@
+#ifndef PROCESSTABLE_HPP
+#define PROCESSTABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct EventFields;
+struct TelemetryEvent;
+
+// ============================================================
+// Process Table
+// ============================================================
+// The agent's view of running processes: pid -> parent, image and start
+// time, plus a children index. Built once at startup from one Toolhelp
+// snapshot, then kept current from Sysmon events (ID 1 adds, ID 5
+// removes) as the workers see them.
+//
+// Start times (FILETIME ticks) tell a process apart from a later one
+// with the same PID:
+//   - a child only counts if it started after its parent
+//   - before terminating, CommandProcessor checks that the live process
+//     started no later than the one in the table
+//
+// Because workers run in parallel, an exit can be seen before the create
+// it belongs to; the exit is then held briefly as a tombstone so the late
+// create is discarded instead of leaking an entry.
+// ============================================================
+
+class ProcessTable {
+public:
+    struct Process {
+        uint32_t pid = 0;
+        uint32_t parentPid = 0;
+        uint64_t startTime = 0;   // FILETIME ticks; 0 = unknown (e.g. protected process)
+        std::string image;
+    };
+
+    static constexpr size_t MAX_ANCESTORS = 4;       // Lineage attached to process events
+    static constexpr size_t MAX_ENTRIES = 65536;     // Beyond this, exits were lost: resync
+
+    // Replaces the table with one Toolhelp snapshot. Returns the process count.
+    static size_t rebuild();
+
+    static void onCreate(uint32_t pid, uint32_t parentPid, uint64_t startTime, std::string_view image);
+    static void onExit(uint32_t pid, uint64_t exitTime);
+
+    // Applies Sysmon ID 1 / 5; anything else is ignored
+    static void observe(const EventFields& fields);
+
+    // pid and its descendants, descendants first (the order to terminate
+    // them in). Empty if pid is not in the table.
+    static std::vector<Process> subtree(uint32_t pid);
+
+    // Adds the images above event.parentProcessId (nearest first) to event.ancestors.
+    // startTime is the child's, to reject a parent entry whose PID was reused.
+    static void appendLineage(TelemetryEvent& event, uint64_t startTime);
+
+    static size_t size();
+
+    // FILETIME ticks of an event: the renderer value, else the SystemTime text
+    // parsed to the full 100 ns; 0 if it has neither
+    static uint64_t eventTime(const EventFields& fields);
+};
+
+#endif // PROCESSTABLE_HPP
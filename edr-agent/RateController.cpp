@@ -0,0 +1,224 @@
+#include "RateController.hpp"
+#include "Logger.hpp"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+    constexpr double RATE_STEP = 0.5;          // Batches/sec added per fast success
+    constexpr double DECREASE_FACTOR = 0.5;
+    constexpr unsigned MAX_SHIFT = 20;
+
+    int64_t unixMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+RateController::RateController(const RateControlConfig& config, size_t maxBatchEvents)
+    : m_config(config)
+    , m_maxBatchEvents(std::max<size_t>(maxBatchEvents, 1))
+    , m_batchEvents((double)m_maxBatchEvents)
+    , m_rate(config.maxBatchesPerSec)
+    , m_rng(std::random_device{}())
+{
+    m_config.minBatchEvents = std::min(std::max<size_t>(m_config.minBatchEvents, 1), m_maxBatchEvents);
+    if (m_config.maxBatchesPerSec > 0) {
+        m_config.minBatchesPerSec = std::min(std::max(m_config.minBatchesPerSec, 0.01), m_config.maxBatchesPerSec);
+    }
+    if (m_config.backoffBaseMs == 0) m_config.backoffBaseMs = 1000;
+    m_config.backoffMaxMs = std::max(m_config.backoffMaxMs, m_config.backoffBaseMs);
+}
+
+// ============================================
+// Persisted Backoff
+// ============================================
+void RateController::load() {
+    std::ifstream file(m_config.statePath);
+    if (!file.is_open()) return;
+
+    try {
+        nlohmann::json saved;
+        file >> saved;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failures = saved.value("failures", 0u);
+        if (m_config.maxBatchesPerSec > 0) {
+            m_rate = std::clamp(saved.value("batches_per_sec", m_config.maxBatchesPerSec),
+                                m_config.minBatchesPerSec, m_config.maxBatchesPerSec);
+        }
+        if (m_failures == 0) return;
+
+        auto now = Clock::now();
+        int64_t remaining = saved.value("retry_at_ms", (int64_t)0) - unixMillis();
+        if (remaining > 0) {
+            m_retryAt = now + std::chrono::milliseconds(std::min<int64_t>(remaining, m_config.backoffMaxMs));
+        } else {
+            // The window ended while we were down. Everyone restarting after
+            // the same outage would hit the server together: spread them out.
+            m_retryAt = now + jitter(backoffWindow());
+        }
+
+        LOG_WARN("RateControl") << "Server was failing before restart (" << m_failures
+                                << " in a row), holding off for "
+                                << std::chrono::duration_cast<std::chrono::milliseconds>(m_retryAt - now).count() << "ms";
+    } catch (const std::exception& e) {
+        std::cerr << "[RateControl] ⚠️ Ignoring unreadable " << m_config.statePath << ": " << e.what() << std::endl;
+    }
+}
+
+void RateController::save() {
+    nlohmann::json state;
+    state["failures"] = m_failures;
+    state["batches_per_sec"] = m_rate;
+    int64_t remaining = std::chrono::duration_cast<std::chrono::milliseconds>(m_retryAt - Clock::now()).count();
+    state["retry_at_ms"] = m_failures == 0 ? 0 : unixMillis() + std::max<int64_t>(remaining, 0);
+    std::string contents = state.dump(2);
+
+    // Same swap-in as the bookmarks: never leave a torn file
+    std::string tmpPath = m_config.statePath + ".tmp";
+    HANDLE hFile = CreateFileA(tmpPath.c_str(), GENERIC_WRITE, 0, NULL,
+                               CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        LOG_WARN("RateControl") << "Cannot create " << tmpPath << " (Error: " << GetLastError() << ")";
+        return;
+    }
+
+    DWORD written = 0;
+    BOOL ok = WriteFile(hFile, contents.data(), (DWORD)contents.size(), &written, NULL)
+              && written == contents.size()
+              && FlushFileBuffers(hFile);
+    CloseHandle(hFile);
+
+    if (!ok || !MoveFileExA(tmpPath.c_str(), m_config.statePath.c_str(),
+                            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        LOG_WARN("RateControl") << "Failed to save " << m_config.statePath << " (Error: " << GetLastError() << ")";
+        DeleteFileA(tmpPath.c_str());
+    }
+}
+
+// ============================================
+// Feedback
+// ============================================
+void RateController::onResponse(unsigned status, uint64_t latencyMs, unsigned retryAfterS) {
+    if (!m_config.enabled) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = Clock::now();
+
+    if (status >= 200 && status < 300) {
+        if (latencyMs > m_config.targetLatencyMs) {
+            m_batchEvents = std::max((double)m_config.minBatchEvents, m_batchEvents * DECREASE_FACTOR);
+        } else {
+            m_batchEvents = std::min((double)m_maxBatchEvents,
+                                     m_batchEvents + std::max<double>(1.0, m_maxBatchEvents / 10.0));
+        }
+        if (m_config.maxBatchesPerSec > 0) {
+            m_rate = std::min(m_config.maxBatchesPerSec, m_rate + RATE_STEP);
+        }
+
+        if (m_failures > 0) {
+            LOG_INFO("RateControl") << "Server accepting again after " << m_failures << " failures";
+            m_failures = 0;
+            m_retryAt = Clock::time_point{};
+            save();
+        }
+    } else if (status == 429 || status == 503) {
+        if (m_config.maxBatchesPerSec > 0) {
+            m_rate = std::max(m_config.minBatchesPerSec, m_rate * DECREASE_FACTOR);
+        }
+        backOff(now, retryAfterS);
+    } else if (status == 0 || status >= 500) {
+        backOff(now, 0);
+    }
+}
+
+void RateController::backOff(Clock::time_point now, unsigned retryAfterS) {
+    // Requests already in flight when the server started failing report
+    // too: they extend the current window but do not deepen the backoff
+    bool backingOff = now < m_retryAt;
+    if (!backingOff) m_failures++;
+
+    std::chrono::milliseconds delay = retryAfterS > 0
+        // The server's word, plus a little so its clients do not all return on the same tick
+        ? std::chrono::milliseconds(std::min<uint64_t>((uint64_t)retryAfterS * 1000, m_config.backoffMaxMs))
+          + jitter(std::chrono::milliseconds(std::min<uint64_t>((uint64_t)retryAfterS * 100, 5000)))
+        : (backingOff ? std::chrono::milliseconds(0) : backoffWindow() / 2 + jitter(backoffWindow() / 2));
+
+    if (now + delay <= m_retryAt) return;
+    m_retryAt = now + delay;
+
+    LOG_WARN("RateControl") << "Server throttling/unavailable, holding off " << delay.count() << "ms"
+                            << (retryAfterS > 0 ? " (Retry-After)" : "")
+                            << ", rate " << m_rate << "/s";
+    save();
+}
+
+std::chrono::milliseconds RateController::backoffWindow() const {
+    unsigned shift = std::min(m_failures > 0 ? m_failures - 1 : 0, MAX_SHIFT);
+    uint64_t window = std::min<uint64_t>((uint64_t)m_config.backoffBaseMs << shift, m_config.backoffMaxMs);
+    return std::chrono::milliseconds(window);
+}
+
+std::chrono::milliseconds RateController::jitter(std::chrono::milliseconds upTo) {
+    if (upTo.count() <= 0) return std::chrono::milliseconds(0);
+    std::uniform_int_distribution<int64_t> pick(0, upTo.count());
+    return std::chrono::milliseconds(pick(m_rng));
+}
+
+// ============================================
+// Queries
+// ============================================
+std::chrono::milliseconds RateController::throttledFor() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = Clock::now();
+    if (now >= m_retryAt) return std::chrono::milliseconds(0);
+    // Round up so a caller waiting this long is no longer throttled
+    return std::chrono::ceil<std::chrono::milliseconds>(m_retryAt - now);
+}
+
+std::chrono::milliseconds RateController::acquire() {
+    if (!m_config.enabled || m_config.maxBatchesPerSec <= 0) return std::chrono::milliseconds(0);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = Clock::now();
+    auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_rate));
+
+    // Idle time does not bank credit: at most one send goes out immediately
+    auto start = std::max(now, m_nextSendAt);
+    m_nextSendAt = start + interval;
+    return std::chrono::ceil<std::chrono::milliseconds>(start - now);
+}
+
+size_t RateController::batchEvents() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (size_t)m_batchEvents;
+}
+
+void RateController::setMaxBatchEvents(size_t maxBatchEvents) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxBatchEvents = std::max<size_t>(maxBatchEvents, 1);
+    m_config.minBatchEvents = std::min(m_config.minBatchEvents, m_maxBatchEvents);
+    m_batchEvents = std::min(m_batchEvents, (double)m_maxBatchEvents);
+}
+
+double RateController::batchesPerSec() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rate;
+}
+
+nlohmann::json RateController::toJson() const {
+    auto throttledMs = throttledFor().count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    nlohmann::json result;
+    result["batch_events"] = (size_t)m_batchEvents;
+    result["batches_per_sec"] = m_rate;
+    result["consecutive_failures"] = m_failures;
+    result["throttled_ms"] = throttledMs;
+    return result;
+}
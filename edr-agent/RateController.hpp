@@ -0,0 +1,94 @@
+#ifndef RATECONTROLLER_HPP
+#define RATECONTROLLER_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+
+// ============================================================
+// Rate Controller
+// ============================================================
+// Adapts how much the agent sends to what the server says it can take.
+// Every telemetry response (sync, async and spool replay) is reported
+// through onResponse():
+//
+//   2xx, fast        batch size grows additively, send rate grows additively
+//   2xx, slow        batch size halves (latency above targetLatencyMs)
+//   429 / 503        send rate halves, sending stops until Retry-After
+//   other 5xx, none  sending stops for a jittered exponential backoff
+//   other 4xx        no change (the batch is bad, not the server)
+//
+// While throttled() the pipeline spools batches instead of sending them
+// and replay waits, so an overloaded server sees no traffic at all until
+// the window ends. The backoff window is saved to statePath when it
+// changes, and a restarted agent picks it up (or, if it already ended,
+// waits a random part of it) instead of the whole fleet reconnecting
+// at once.
+// ============================================================
+
+struct RateControlConfig {
+    bool enabled = true;
+    unsigned targetLatencyMs = 1000;     // Responses slower than this shrink batches
+    size_t minBatchEvents = 50;
+    double maxBatchesPerSec = 20.0;      // 0 = unpaced
+    double minBatchesPerSec = 0.2;
+    unsigned backoffBaseMs = 1000;
+    unsigned backoffMaxMs = 300000;
+    std::string statePath = "backoff_state.json";
+};
+
+class RateController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // maxBatchEvents is the batcher's configured ceiling
+    RateController(const RateControlConfig& config, size_t maxBatchEvents);
+
+    // Restores the backoff window left by the previous run
+    void load();
+
+    // status 0 = no response (connect/send/receive failed).
+    // retryAfterS 0 = no Retry-After header.
+    void onResponse(unsigned status, uint64_t latencyMs, unsigned retryAfterS);
+
+    bool throttled() const { return throttledFor().count() > 0; }
+    std::chrono::milliseconds throttledFor() const;
+
+    // Reserves the next send slot at the current rate; returns how long to
+    // wait before sending (0 = now)
+    std::chrono::milliseconds acquire();
+
+    size_t batchEvents() const;
+    double batchesPerSec() const;
+
+    // New batch.max_events (config reload); the current size is capped to it
+    void setMaxBatchEvents(size_t maxBatchEvents);
+
+    // For agent_health
+    nlohmann::json toJson() const;
+
+private:
+    // m_mutex held
+    void backOff(Clock::time_point now, unsigned retryAfterS);
+    std::chrono::milliseconds backoffWindow() const;
+    std::chrono::milliseconds jitter(std::chrono::milliseconds upTo);
+    void save();
+
+    RateControlConfig m_config;
+    size_t m_maxBatchEvents;
+
+    mutable std::mutex m_mutex;
+    double m_batchEvents;                // double so additive steps below 1 event still add up
+    double m_rate;
+    unsigned m_failures = 0;             // Consecutive; 0 = not backing off
+    Clock::time_point m_retryAt{};
+    Clock::time_point m_nextSendAt{};
+    std::mt19937 m_rng;
+};
+
+#endif // RATECONTROLLER_HPP
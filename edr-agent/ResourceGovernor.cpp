@@ -0,0 +1,233 @@
+#include "ResourceGovernor.hpp"
+#include "Logger.hpp"
+#include "SimpleZstd.hpp"
+
+#include <psapi.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+    constexpr double CRITICAL_PRESSURE = 1.5;
+
+    uint64_t fileTimeTicks(const FILETIME& time) {
+        return ((uint64_t)time.dwHighDateTime << 32) | time.dwLowDateTime;
+    }
+
+    // Kernel + user time of this process so far, in 100 ns units
+    uint64_t processCpuTicks() {
+        FILETIME created, exited, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0;
+        return fileTimeTicks(kernel) + fileTimeTicks(user);
+    }
+
+    double enterPressure(GovernorLevel level) {
+        return level == GovernorLevel::Critical ? CRITICAL_PRESSURE
+             : level == GovernorLevel::Elevated ? 1.0 : 0.0;
+    }
+}
+
+ResourceGovernor::ResourceGovernor(const GovernorConfig& config)
+    : m_config(config)
+{
+    for (int id : m_config.shedEventIds) {
+        if (id >= 0 && id < 256) m_shedIds.set((size_t)id);
+    }
+    if (m_config.sampleIntervalMs < 100) m_config.sampleIntervalMs = 100;
+    if (m_config.recoverSamples == 0) m_config.recoverSamples = 1;
+    if (m_config.aggregationWindowScale == 0) m_config.aggregationWindowScale = 1;
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    m_processors = std::max<unsigned>(info.dwNumberOfProcessors, 1);
+}
+
+ResourceGovernor::~ResourceGovernor() {
+    stop();
+    if (m_job != NULL) CloseHandle(m_job);
+}
+
+// ============================================
+// Lifecycle
+// ============================================
+void ResourceGovernor::start() {
+    if (m_running) return;
+
+    if (m_config.useJobObject && !applyJobLimits()) {
+        std::cerr << "[Governor] ⚠️ Job Object limits not applied, budget is advisory only" << std::endl;
+    }
+
+    m_lastCpu = processCpuTicks();
+    m_lastSampleAt = std::chrono::steady_clock::now();
+    m_running = true;
+    m_thread = std::thread(&ResourceGovernor::sampleLoop, this);
+
+    std::cout << "[Governor] ✓ Budget: " << m_config.cpuPercent << "% CPU, "
+              << m_config.workingSetMb << " MB working set" << std::endl;
+}
+
+void ResourceGovernor::stop() {
+    if (!m_running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_waitCV.notify_all();
+    }
+    if (m_thread.joinable()) m_thread.join();
+
+    // Leave compression the way it was configured
+    if (level() != GovernorLevel::Normal && m_config.pressureZstdLevel > 0) {
+        SimpleZstd::setLevelOverride(0);
+    }
+}
+
+bool ResourceGovernor::applyJobLimits() {
+    if (m_config.jobCpuPercent <= 0 && m_config.jobMemoryMb == 0) return true;
+
+    HANDLE job = CreateJobObjectA(NULL, NULL);
+    if (job == NULL) {
+        std::cerr << "[Governor] CreateJobObject failed (Error: " << GetLastError() << ")" << std::endl;
+        return false;
+    }
+
+    if (m_config.jobCpuPercent > 0) {
+        JOBOBJECT_CPU_RATE_CONTROL_INFORMATION cpu = {};
+        cpu.ControlFlags = JOB_OBJECT_CPU_RATE_CONTROL_ENABLE | JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP;
+        // In 1/100ths of a percent of the whole machine, as the budget is
+        cpu.CpuRate = (DWORD)std::clamp(m_config.jobCpuPercent * 100.0, 1.0, 10000.0);
+        if (!SetInformationJobObject(job, JobObjectCpuRateControlInformation, &cpu, sizeof(cpu))) {
+            std::cerr << "[Governor] CPU rate limit failed (Error: " << GetLastError() << ")" << std::endl;
+            CloseHandle(job);
+            return false;
+        }
+    }
+
+    if (m_config.jobMemoryMb > 0) {
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION memory = {};
+        memory.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+        memory.ProcessMemoryLimit = (SIZE_T)m_config.jobMemoryMb * 1024 * 1024;
+        if (!SetInformationJobObject(job, JobObjectExtendedLimitInformation, &memory, sizeof(memory))) {
+            std::cerr << "[Governor] Memory limit failed (Error: " << GetLastError() << ")" << std::endl;
+            CloseHandle(job);
+            return false;
+        }
+    }
+
+    // Nested jobs (Windows 8+) let this work when a service host already put us in one
+    if (!AssignProcessToJobObject(job, GetCurrentProcess())) {
+        std::cerr << "[Governor] AssignProcessToJobObject failed (Error: " << GetLastError() << ")" << std::endl;
+        CloseHandle(job);
+        return false;
+    }
+    m_job = job;
+
+    std::cout << "[Governor] ✓ Job Object: ";
+    if (m_config.jobCpuPercent > 0) std::cout << m_config.jobCpuPercent << "% CPU cap";
+    else std::cout << "no CPU cap";
+    if (m_config.jobMemoryMb > 0) std::cout << ", " << m_config.jobMemoryMb << " MB commit limit";
+    std::cout << std::endl;
+    return true;
+}
+
+// ============================================
+// Sampling
+// ============================================
+void ResourceGovernor::sampleLoop() {
+    while (m_running) {
+        {
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_waitCV.wait_for(lock, std::chrono::milliseconds(m_config.sampleIntervalMs),
+                              [this] { return !m_running.load(); });
+        }
+        if (!m_running) break;
+        sample();
+    }
+}
+
+void ResourceGovernor::sample() {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t cpu = processCpuTicks();
+    double wallTicks = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastSampleAt).count() / 100.0;
+    double cpuPercent = wallTicks > 0 ? (double)(cpu - m_lastCpu) * 100.0 / (wallTicks * m_processors) : 0.0;
+    m_lastCpu = cpu;
+    m_lastSampleAt = now;
+
+    PROCESS_MEMORY_COUNTERS memory = {};
+    memory.cb = sizeof(memory);
+    uint64_t workingSet = 0;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) {
+        workingSet = memory.WorkingSetSize;
+        m_peakWorkingSet.store(memory.PeakWorkingSetSize, std::memory_order_relaxed);
+    }
+
+    m_cpuPercent.store(cpuPercent, std::memory_order_relaxed);
+    m_workingSet.store(workingSet, std::memory_order_relaxed);
+
+    double cpuPressure = m_config.cpuPercent > 0 ? cpuPercent / m_config.cpuPercent : 0.0;
+    double memoryPressure = m_config.workingSetMb > 0
+        ? (double)workingSet / ((double)m_config.workingSetMb * 1024 * 1024) : 0.0;
+    double pressure = std::max(cpuPressure, memoryPressure);
+    if (pressure > 1.0) m_samplesOver.fetch_add(1, std::memory_order_relaxed);
+
+    GovernorLevel current = level();
+    GovernorLevel target = pressure > CRITICAL_PRESSURE ? GovernorLevel::Critical
+                         : pressure > 1.0 ? GovernorLevel::Elevated : GovernorLevel::Normal;
+
+    if (target > current) {
+        m_belowCount = 0;
+        setLevel(target, pressure);
+    } else if (target < current) {
+        // Down one step at a time, once it has stayed below for a while
+        if (++m_belowCount >= m_config.recoverSamples) {
+            m_belowCount = 0;
+            setLevel((GovernorLevel)((uint8_t)current - 1), pressure);
+        }
+    } else {
+        m_belowCount = 0;
+    }
+}
+
+void ResourceGovernor::setLevel(GovernorLevel next, double pressure) {
+    GovernorLevel previous = m_level.exchange(next, std::memory_order_relaxed);
+    if (previous == next) return;
+    m_transitions.fetch_add(1, std::memory_order_relaxed);
+
+    if (m_config.pressureZstdLevel > 0 && (previous == GovernorLevel::Normal) != (next == GovernorLevel::Normal)) {
+        SimpleZstd::setLevelOverride(next == GovernorLevel::Normal ? 0 : m_config.pressureZstdLevel);
+    }
+
+    if (next > previous) {
+        LOG_WARN("Governor") << "Over budget (" << (int)(pressure * 100) << "%: "
+                             << m_cpuPercent.load(std::memory_order_relaxed) << "% CPU, "
+                             << m_workingSet.load(std::memory_order_relaxed) / (1024 * 1024) << " MB), "
+                             << levelName(previous) << " -> " << levelName(next);
+    } else {
+        LOG_INFO("Governor") << "Back under " << enterPressure(previous) * 100 << "% of budget, "
+                             << levelName(previous) << " -> " << levelName(next);
+    }
+}
+
+// ============================================
+// Queries
+// ============================================
+nlohmann::json ResourceGovernor::toJson() const {
+    nlohmann::json result;
+    result["level"] = levelName(level());
+    result["cpu_percent"] = m_cpuPercent.load(std::memory_order_relaxed);
+    result["cpu_budget_percent"] = m_config.cpuPercent;
+    result["working_set_bytes"] = m_workingSet.load(std::memory_order_relaxed);
+    result["peak_working_set_bytes"] = m_peakWorkingSet.load(std::memory_order_relaxed);
+    result["working_set_budget_bytes"] = (uint64_t)m_config.workingSetMb * 1024 * 1024;
+    result["samples_over_budget"] = m_samplesOver.load(std::memory_order_relaxed);
+    result["transitions"] = m_transitions.load(std::memory_order_relaxed);
+    result["job_object"] = m_job != NULL;
+    return result;
+}
+
+const char* ResourceGovernor::levelName(GovernorLevel level) {
+    switch (level) {
+        case GovernorLevel::Elevated: return "elevated";
+        case GovernorLevel::Critical: return "critical";
+        default:                      return "normal";
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef RESOURCEGOVERNOR_HPP
+#define RESOURCEGOVERNOR_HPP
+
+#include <Windows.h>
+
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma comment(lib, "psapi.lib")
+
+// ============================================================
+// Resource Governor
+// ============================================================
+// Keeps the agent inside its own CPU and memory budget. A sampler thread
+// reads the process's CPU time and working set every sampleIntervalMs and
+// turns the worse of the two ratios (used / budget) into a level:
+//
+//   Normal     under budget            nothing changes
+//   Elevated   over budget             workers shed shedEventIds, aggregation
+//                                      windows widen by aggregationWindowScale,
+//                                      zstd drops to pressureZstdLevel
+//   Critical   over 1.5x budget        all of the above, and batches go to the
+//                                      spool instead of the network (replay waits)
+//
+// A level is entered on the first sample over its threshold and left one
+// step at a time, after recoverSamples samples in a row below it, so a
+// spike does not make the agent flap between modes.
+//
+// Any of this is best effort: a burst can still take the agent over
+// budget for a sample or two. With useJobObject the process is also put
+// in a Job Object whose CPU rate and commit limits the kernel enforces
+// whatever the level. A memory limit is a hard wall (allocations fail
+// beyond it), so keep it well above workingSetMb.
+// ============================================================
+
+enum class GovernorLevel : uint8_t {
+    Normal,
+    Elevated,
+    Critical
+};
+
+struct GovernorConfig {
+    bool enabled = false;
+    unsigned sampleIntervalMs = 1000;
+    double cpuPercent = 10.0;            // Of the whole machine (all cores)
+    size_t workingSetMb = 256;
+    unsigned recoverSamples = 5;
+    std::vector<int> shedEventIds;       // Dropped unparsed above Normal (keep 1 and 5: the process table needs them)
+    unsigned aggregationWindowScale = 4;
+    int pressureZstdLevel = 1;           // 0 = keep the configured level
+    bool useJobObject = false;
+    double jobCpuPercent = 0;            // Hard cap; 0 = none
+    size_t jobMemoryMb = 0;              // Process commit limit; 0 = none
+};
+
+class ResourceGovernor {
+public:
+    explicit ResourceGovernor(const GovernorConfig& config);
+    ~ResourceGovernor();
+
+    ResourceGovernor(const ResourceGovernor&) = delete;
+    ResourceGovernor& operator=(const ResourceGovernor&) = delete;
+
+    // Applies the Job Object limits (if configured) and starts sampling
+    void start();
+    void stop();
+
+    GovernorLevel level() const { return m_level.load(std::memory_order_relaxed); }
+
+    // Worker threads: true = drop this event without parsing it
+    bool shedding(int eventId) const {
+        return level() != GovernorLevel::Normal && eventId >= 0 && eventId < 256 && m_shedIds.test((size_t)eventId);
+    }
+
+    // 1 at Normal
+    unsigned aggregationScale() const {
+        return level() == GovernorLevel::Normal ? 1 : m_config.aggregationWindowScale;
+    }
+
+    // Batches should go to disk, not the network
+    bool spilling() const { return level() == GovernorLevel::Critical; }
+
+    // For agent_health
+    nlohmann::json toJson() const;
+
+    // "normal" | "elevated" | "critical"
+    static const char* levelName(GovernorLevel level);
+
+private:
+    void sampleLoop();
+    void sample();
+    void setLevel(GovernorLevel level, double pressure);
+    bool applyJobLimits();
+
+    GovernorConfig m_config;
+    std::bitset<256> m_shedIds;
+    unsigned m_processors = 1;
+    HANDLE m_job = NULL;
+
+    // Sampler thread only
+    uint64_t m_lastCpu = 0;              // Kernel + user, 100 ns units
+    std::chrono::steady_clock::time_point m_lastSampleAt;
+    unsigned m_belowCount = 0;
+
+    std::atomic<GovernorLevel> m_level{GovernorLevel::Normal};
+    std::atomic<double> m_cpuPercent{0};
+    std::atomic<uint64_t> m_workingSet{0};
+    std::atomic<uint64_t> m_peakWorkingSet{0};
+    std::atomic<uint64_t> m_transitions{0};
+    std::atomic<uint64_t> m_samplesOver{0};
+
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCV;
+};
+
+#endif // RESOURCEGOVERNOR_HPP
@@ -1,26 +1,361 @@
 #include "SimpleZstd.hpp"
 #include <zstd.h>
+#include <zdict.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+
+// ============================================
+// Shared Settings
+// ============================================
+namespace {
+    int g_level = 3;
+    int g_workers = 0;
+    size_t g_multithreadThreshold = 1024 * 1024;
+    ZSTD_CDict* g_cdict = nullptr;
+    std::string g_dictionary;                  // Kept for digesting at an override level
+    ZSTD_DDict* g_ddict = nullptr;
+    unsigned g_dictId = 0;
+    std::atomic<bool> g_workersSupported{true};
+
+    // What new frames use: the configured level/dictionary or the override
+    std::atomic<int> g_activeLevel{3};
+    std::atomic<ZSTD_CDict*> g_activeCDict{nullptr};
+
+    // Dictionaries digested at override levels; freed by configure() only,
+    // since a thread may still be referencing one
+    std::mutex g_overrideMutex;
+    std::vector<std::pair<int, ZSTD_CDict*>> g_overrideCDicts;
+
+    // Bumped by configure() / setLevelOverride() so thread contexts re-apply their parameters
+    std::atomic<unsigned> g_generation{1};
+
+    // One compression context per thread, created on first use and kept
+    // alive until the thread exits. Parameters stick between calls.
+    struct ThreadContext {
+        ZSTD_CCtx* cctx = nullptr;
+        ZSTD_DCtx* dctx = nullptr;
+        unsigned generation = 0;
+        int workers = -1;
+
+        ~ThreadContext() {
+            if (cctx) ZSTD_freeCCtx(cctx);
+            if (dctx) ZSTD_freeDCtx(dctx);
+        }
+    };
+
+    thread_local ThreadContext t_context;
+
+    void applyParameters(ZSTD_CCtx* cctx) {
+        ZSTD_CCtx_reset(cctx, ZSTD_reset_parameters);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, g_activeLevel.load(std::memory_order_relaxed));
+        // A referenced dictionary brings its own level
+        if (ZSTD_CDict* cdict = g_activeCDict.load(std::memory_order_relaxed)) {
+            ZSTD_CCtx_refCDict(cctx, cdict);
+        }
+    }
+
+    ZSTD_CCtx* threadCCtx() {
+        if (!t_context.cctx) {
+            t_context.cctx = ZSTD_createCCtx();
+            if (!t_context.cctx) return nullptr;
+        }
+
+        unsigned generation = g_generation.load(std::memory_order_acquire);
+        if (t_context.generation != generation) {
+            applyParameters(t_context.cctx);
+            t_context.generation = generation;
+            t_context.workers = -1;
+        }
+        return t_context.cctx;
+    }
+
+    void setWorkers(ZSTD_CCtx* cctx, size_t inputSize) {
+        int workers = (g_workers > 0 && inputSize >= g_multithreadThreshold &&
+                       g_workersSupported.load(std::memory_order_relaxed)) ? g_workers : 0;
+        if (workers == t_context.workers) return;
+
+        size_t result = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, workers);
+        if (ZSTD_isError(result)) {
+            // libzstd built without ZSTD_MULTITHREAD: stay single-threaded
+            if (g_workersSupported.exchange(false)) {
+                std::cerr << "[Zstd] Multithreaded compression unavailable: " << ZSTD_getErrorName(result) << std::endl;
+            }
+            workers = 0;
+        }
+        t_context.workers = workers;
+    }
+
+    bool readFile(const std::string& path, std::string& contents) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return false;
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+}
+
+bool SimpleZstd::configure(const ZstdConfig& config) {
+    g_level = config.level;
+    g_workers = config.workers;
+    g_multithreadThreshold = config.multithreadThreshold;
+
+    if (g_cdict) { ZSTD_freeCDict(g_cdict); g_cdict = nullptr; }
+    if (g_ddict) { ZSTD_freeDDict(g_ddict); g_ddict = nullptr; }
+    for (auto& entry : g_overrideCDicts) ZSTD_freeCDict(entry.second);
+    g_overrideCDicts.clear();
+    g_dictionary.clear();
+    g_dictId = 0;
+
+    bool ok = true;
+    if (!config.dictionaryPath.empty()) {
+        std::string dictionary;
+        if (!readFile(config.dictionaryPath, dictionary) || dictionary.empty()) {
+            std::cerr << "[Zstd] ⚠️ Cannot read dictionary " << config.dictionaryPath << std::endl;
+            ok = false;
+        } else {
+            // Digested once here; every thread context just references it
+            g_cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), g_level);
+            g_ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+            g_dictId = ZDICT_getDictID(dictionary.data(), dictionary.size());
+            if (!g_cdict || !g_ddict) {
+                std::cerr << "[Zstd] ⚠️ Invalid dictionary " << config.dictionaryPath << std::endl;
+                ok = false;
+            } else {
+                std::cout << "[Zstd] Loaded dictionary " << config.dictionaryPath
+                          << " (id " << g_dictId << ", " << dictionary.size() << " bytes)" << std::endl;
+                g_dictionary = std::move(dictionary);
+            }
+        }
+    }
+
+    g_activeLevel.store(g_level, std::memory_order_relaxed);
+    g_activeCDict.store(g_cdict, std::memory_order_relaxed);
+    g_generation.fetch_add(1, std::memory_order_release);
+    return ok;
+}
+
+void SimpleZstd::setLevelOverride(int level) {
+    std::lock_guard<std::mutex> lock(g_overrideMutex);
+    int target = level > 0 ? level : g_level;
+
+    ZSTD_CDict* cdict = g_cdict;
+    if (cdict && target != g_level) {
+        auto found = std::find_if(g_overrideCDicts.begin(), g_overrideCDicts.end(),
+                                  [target](const auto& entry) { return entry.first == target; });
+        if (found != g_overrideCDicts.end()) {
+            cdict = found->second;
+        } else if (ZSTD_CDict* digested = ZSTD_createCDict(g_dictionary.data(), g_dictionary.size(), target)) {
+            g_overrideCDicts.emplace_back(target, digested);
+            cdict = digested;
+        }
+        // Could not digest it: stay on the configured dictionary (and its level)
+    }
+
+    g_activeLevel.store(target, std::memory_order_relaxed);
+    g_activeCDict.store(cdict, std::memory_order_relaxed);
+    g_generation.fetch_add(1, std::memory_order_release);
+}
 
 bool SimpleZstd::compress(const std::string& input, std::vector<BYTE>& output) {
-    size_t const inputSize = input.size();
-    
-    // 1. Calculate maximum compressed size
-    size_t const maxDestSize = ZSTD_compressBound(inputSize);
-    output.resize(maxDestSize);
+    return compress(input.data(), input.size(), output);
+}
+
+bool SimpleZstd::compress(const char* data, size_t size, std::vector<BYTE>& output) {
+    ZSTD_CCtx* cctx = threadCCtx();
+    if (!cctx) {
+        std::cerr << "[Zstd] Failed to create compression context" << std::endl;
+        return false;
+    }
+    setWorkers(cctx, size);
 
-    // 2. Compress
-    // Level 3 is default, good balance of speed/ratio.
-    size_t const cSize = ZSTD_compress(output.data(), maxDestSize, input.data(), inputSize, 3);
+    // 1. Make room for the worst case. A reused vector keeps its capacity,
+    //    so this only allocates the first time (or for a bigger batch).
+    size_t const maxDestSize = ZSTD_compressBound(size);
+    if (output.size() < maxDestSize) {
+        output.resize(maxDestSize);
+    }
+
+    // 2. Compress with the thread's context (level, dictionary and workers already set)
+    size_t const cSize = ZSTD_compress2(cctx, output.data(), output.size(), data, size);
 
     // 3. Check for errors
     if (ZSTD_isError(cSize)) {
         std::cerr << "[Zstd] Compression failed: " << ZSTD_getErrorName(cSize) << std::endl;
+        ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
         return false;
     }
 
-    // 4. Resize output to actual compressed size
+    // 4. Resize output to actual compressed size (capacity is kept)
     output.resize(cSize);
 
     return true;
 }
+
+bool SimpleZstd::decompress(const BYTE* data, size_t size, std::string& output) {
+    if (!t_context.dctx) {
+        t_context.dctx = ZSTD_createDCtx();
+        if (!t_context.dctx) return false;
+    }
+
+    ZSTD_DCtx* dctx = t_context.dctx;
+    ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+    if (g_ddict && ZSTD_getDictID_fromFrame(data, size) == g_dictId) {
+        ZSTD_DCtx_refDDict(dctx, g_ddict);
+    }
+
+    // Streamed frames (ZstdStream) carry no content size, so decompress
+    // incrementally instead of sizing the output up front
+    unsigned long long contentSize = ZSTD_getFrameContentSize(data, size);
+    size_t chunk = ZSTD_DStreamOutSize();
+    output.clear();
+    if (contentSize != ZSTD_CONTENTSIZE_ERROR && contentSize != ZSTD_CONTENTSIZE_UNKNOWN) {
+        output.reserve((size_t)contentSize);
+    }
+
+    ZSTD_inBuffer input = { data, size, 0 };
+    for (;;) {
+        size_t used = output.size();
+        output.resize(used + chunk);
+        ZSTD_outBuffer out = { &output[used], chunk, 0 };
+        size_t result = ZSTD_decompressStream(dctx, &out, &input);
+        output.resize(used + out.pos);
+
+        if (ZSTD_isError(result)) {
+            std::cerr << "[Zstd] Decompression failed: " << ZSTD_getErrorName(result) << std::endl;
+            return false;
+        }
+        if (result == 0) return true;                   // Frame complete
+        if (input.pos == input.size && out.pos < chunk) {
+            std::cerr << "[Zstd] Decompression failed: truncated frame" << std::endl;
+            return false;
+        }
+    }
+}
+
+unsigned SimpleZstd::dictionaryId() {
+    return g_dictId;
+}
+
+// ============================================
+// Streaming Compression
+// ============================================
+ZstdStream::ZstdStream()
+    : m_cctx(ZSTD_createCCtx())
+{
+}
+
+ZstdStream::~ZstdStream() {
+    if (m_cctx) ZSTD_freeCCtx(m_cctx);
+}
+
+bool ZstdStream::begin(std::vector<BYTE>& output) {
+    if (!m_cctx) {
+        std::cerr << "[Zstd] Failed to create stream context" << std::endl;
+        return false;
+    }
+
+    unsigned generation = g_generation.load(std::memory_order_acquire);
+    if (m_generation != generation) {
+        applyParameters(m_cctx);
+        m_generation = generation;
+    } else {
+        ZSTD_CCtx_reset(m_cctx, ZSTD_reset_session_only);
+    }
+
+    m_output = &output;
+    m_output->clear();
+    m_inputBytes = 0;
+    m_inputAtLastOutput = 0;
+    return true;
+}
+
+bool ZstdStream::write(const char* data, size_t size) {
+    m_inputBytes += size;
+    return drive(data, size, ZSTD_e_continue);
+}
+
+bool ZstdStream::end() {
+    return drive(nullptr, 0, ZSTD_e_end);
+}
+
+bool ZstdStream::drive(const char* data, size_t size, int directive) {
+    if (!m_output) return false;
+
+    ZSTD_inBuffer input = { data, size, 0 };
+    const size_t chunk = ZSTD_CStreamOutSize();
+
+    for (;;) {
+        // Grow by one zstd block at a time; capacity survives between frames
+        size_t used = m_output->size();
+        if (m_output->capacity() - used < chunk) {
+            m_output->reserve(std::max(m_output->capacity() * 2, used + chunk));
+        }
+        m_output->resize(used + chunk);
+
+        ZSTD_outBuffer output = { m_output->data() + used, chunk, 0 };
+        size_t remaining = ZSTD_compressStream2(m_cctx, &output, &input, (ZSTD_EndDirective)directive);
+        m_output->resize(used + output.pos);
+
+        if (ZSTD_isError(remaining)) {
+            std::cerr << "[Zstd] Stream compression failed: " << ZSTD_getErrorName(remaining) << std::endl;
+            ZSTD_CCtx_reset(m_cctx, ZSTD_reset_session_only);
+            m_output = nullptr;
+            return false;
+        }
+        if (output.pos > 0) {
+            m_inputAtLastOutput = m_inputBytes - (input.size - input.pos);
+        }
+
+        bool done = (directive == ZSTD_e_end) ? (remaining == 0) : (input.pos == input.size);
+        if (done) break;
+    }
+
+    if (directive == ZSTD_e_end) {
+        m_inputAtLastOutput = m_inputBytes;
+        m_output = nullptr;
+    }
+    return true;
+}
+
+// ============================================
+// Dictionary Training
+// ============================================
+bool SimpleZstd::trainDictionary(const std::vector<std::string>& samples, size_t dictionarySize,
+                                 const std::string& outputPath) {
+    if (samples.size() < 8) {
+        std::cerr << "[Zstd] Need at least 8 samples to train a dictionary (have " << samples.size() << ")" << std::endl;
+        return false;
+    }
+
+    // ZDICT wants all samples back to back plus their sizes
+    std::string buffer;
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        buffer += sample;
+        sizes.push_back(sample.size());
+    }
+
+    std::vector<char> dictionary(dictionarySize);
+    size_t result = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+                                          buffer.data(), sizes.data(), (unsigned)sizes.size());
+    if (ZDICT_isError(result)) {
+        std::cerr << "[Zstd] Dictionary training failed: " << ZDICT_getErrorName(result) << std::endl;
+        return false;
+    }
+
+    std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[Zstd] Cannot write " << outputPath << std::endl;
+        return false;
+    }
+    file.write(dictionary.data(), (std::streamsize)result);
+
+    std::cout << "[Zstd] Trained dictionary: " << result << " bytes from " << samples.size()
+              << " samples (" << buffer.size() << " bytes), id " << ZDICT_getDictID(dictionary.data(), result)
+              << " -> " << outputPath << std::endl;
+    return true;
+}
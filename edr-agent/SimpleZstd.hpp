@@ -3,9 +3,77 @@
 #include <string>
 #include <windows.h>
 
+// Compression settings shared by every thread. Apply once at startup,
+// before any thread compresses.
+struct ZstdConfig {
+    int level = 3;                          // 1 (fast) .. 19 (small); 3 is zstd's default
+    int workers = 0;                        // zstd worker threads for large inputs (0 = single-threaded)
+    size_t multithreadThreshold = 1024 * 1024;  // Inputs below this never use workers
+    std::string dictionaryPath;             // Trained dictionary (empty = none)
+};
+
 class SimpleZstd {
 public:
+    // Sets level/workers and loads the dictionary. Returns false if the
+    // dictionary could not be loaded (compression still works without it).
+    static bool configure(const ZstdConfig& config);
+
+    // Temporarily compresses at level instead (0 = back to the configured
+    // one), e.g. to save CPU under load. Safe while other threads compress:
+    // each picks it up at its next frame. With a dictionary this digests it
+    // once more at that level, the first time the level is asked for.
+    static void setLevelOverride(int level);
+
     // Compresses data using Zstandard
     // Returns true on success, false on failure.
+    // Each thread keeps its own ZSTD_CCtx, and output keeps its capacity between calls.
     static bool compress(const std::string& input, std::vector<BYTE>& output);
+    static bool compress(const char* data, size_t size, std::vector<BYTE>& output);
+
+    // Decompresses one frame (with the loaded dictionary if it has one)
+    static bool decompress(const BYTE* data, size_t size, std::string& output);
+
+    // 0 when no dictionary is loaded
+    static unsigned dictionaryId();
+
+    // Trains a dictionary from individual events and writes it to outputPath
+    static bool trainDictionary(const std::vector<std::string>& samples, size_t dictionarySize,
+                                const std::string& outputPath);
+};
+
+struct ZSTD_CCtx_s;
+
+// Incremental compression of one frame into a caller-owned buffer.
+// Serialized pieces are fed in as they are produced, so the uncompressed
+// payload never exists in one piece. Uses the same level/dictionary as
+// SimpleZstd but its own context, so it can stay open across calls.
+class ZstdStream {
+public:
+    ZstdStream();
+    ~ZstdStream();
+
+    ZstdStream(const ZstdStream&) = delete;
+    ZstdStream& operator=(const ZstdStream&) = delete;
+
+    // Starts a new frame; output is cleared but keeps its capacity
+    bool begin(std::vector<BYTE>& output);
+    bool write(const char* data, size_t size);
+    bool write(const std::string& data) { return write(data.data(), data.size()); }
+
+    // Flushes everything and closes the frame
+    bool end();
+
+    size_t inputBytes() const { return m_inputBytes; }
+
+    // Input zstd is still holding on to (not yet reflected in output.size())
+    size_t bufferedInputBytes() const { return m_inputBytes - m_inputAtLastOutput; }
+
+private:
+    bool drive(const char* data, size_t size, int directive);
+
+    ZSTD_CCtx_s* m_cctx = nullptr;
+    std::vector<BYTE>* m_output = nullptr;
+    size_t m_inputBytes = 0;
+    size_t m_inputAtLastOutput = 0;
+    unsigned m_generation = 0;
 };
@@ -0,0 +1,268 @@
+#ifndef SYSMONSCHEMA_HPP
+#define SYSMONSCHEMA_HPP
+
+#include "TelemetryEvent.hpp"   // EventFamily
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Fields the converter needs from one rendered event. Strings are views
+// into the source (e.g. the pugixml document) and live only as long as it does.
+struct EventFields {
+    // System
+    int eventId = 0;
+    uint64_t recordId = 0;
+    std::string_view systemTime;
+    uint64_t timeCreated = 0;       // FILETIME ticks; set by the values renderer instead of systemTime
+    std::string_view computer;
+    std::string_view channel;
+
+    // EventData
+    std::string_view image;
+    std::string_view commandLine;
+    std::string_view user;
+    std::string_view parentImage;
+    std::string_view targetFilename;
+    std::string_view sourceIp;
+    std::string_view destinationIp;
+    std::string_view protocol;
+    int processId = 0;
+    int parentProcessId = 0;
+    int sourcePort = 0;
+    int destinationPort = 0;
+};
+
+// ============================================================
+// Sysmon Schema
+// ============================================================
+// Compile-time tables for everything the agent knows about Sysmon events:
+//
+//   DATA_FIELDS    EventData name -> EventFields member (and JSON type)
+//   SYSTEM_FIELDS  System child name -> SystemField
+//   SYSMON_EVENTS  event ID -> family, action and the fields to render
+//
+// Names are looked up through hash tables built by the compiler, on
+// string_views straight from the source, so nothing is copied.
+//
+// Covering another event ID is one SYSMON_EVENTS row (plus DATA_FIELDS
+// rows for names not listed yet); the XML and values renderers and the
+// converter all read from here.
+// ============================================================
+
+namespace SysmonSchema {
+
+// ============================================
+// Name Index
+// ============================================
+constexpr uint32_t hashName(std::string_view name) {
+    uint32_t hash = 2166136261u;   // FNV-1a
+    for (char c : name) {
+        hash = (hash ^ (uint8_t)c) * 16777619u;
+    }
+    return hash;
+}
+
+// Open-addressed table over entries[].name, filled at compile time.
+// Size is a power of two with room to spare, so probes stay short.
+template <typename Entry, size_t N, size_t Size>
+class NameIndex {
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+    static_assert(N < Size / 2 && N < 0xFF, "Table too full");
+
+public:
+    constexpr explicit NameIndex(const Entry (&entries)[N]) : m_entries(entries), m_slots(), m_maxProbe(0) {
+        for (size_t i = 0; i < Size; i++) m_slots[i] = EMPTY;
+        for (size_t i = 0; i < N; i++) {
+            size_t probe = 0;
+            size_t slot = hashName(entries[i].name) & (Size - 1);
+            while (m_slots[slot] != EMPTY) {
+                if (entries[m_slots[slot]].name == entries[i].name) throw "duplicate name";
+                slot = (slot + 1) & (Size - 1);
+                probe++;
+            }
+            m_slots[slot] = (uint8_t)i;
+            if (probe > m_maxProbe) m_maxProbe = probe;
+        }
+    }
+
+    constexpr const Entry* find(std::string_view name) const {
+        size_t slot = hashName(name) & (Size - 1);
+        for (size_t probe = 0; probe <= m_maxProbe; probe++) {
+            uint8_t index = m_slots[slot];
+            if (index == EMPTY) return nullptr;
+            if (m_entries[index].name == name) return &m_entries[index];
+            slot = (slot + 1) & (Size - 1);
+        }
+        return nullptr;
+    }
+
+    constexpr size_t maxProbe() const { return m_maxProbe; }
+
+private:
+    static constexpr uint8_t EMPTY = 0xFF;
+
+    const Entry* m_entries;
+    uint8_t m_slots[Size];
+    size_t m_maxProbe;
+};
+
+// ============================================
+// EventData Fields
+// ============================================
+struct DataField {
+    std::string_view name;
+    bool integer;                           // Typed as a number in the Sysmon JSON
+    std::string_view EventFields::* text;   // Where the converter wants it (null = not used)
+    int EventFields::* number;
+};
+
+inline constexpr DataField DATA_FIELDS[] = {
+    {"Image",             false, &EventFields::image,          nullptr},
+    {"CommandLine",       false, &EventFields::commandLine,    nullptr},
+    {"User",              false, &EventFields::user,           nullptr},
+    {"ParentImage",       false, &EventFields::parentImage,    nullptr},
+    {"TargetFilename",    false, &EventFields::targetFilename, nullptr},
+    {"ImageLoaded",       false, &EventFields::targetFilename, nullptr},   // ID 7: the module is the file
+    {"SourceIp",          false, &EventFields::sourceIp,       nullptr},
+    {"DestinationIp",     false, &EventFields::destinationIp,  nullptr},
+    {"Protocol",          false, &EventFields::protocol,       nullptr},
+    {"ProcessId",         true,  nullptr, &EventFields::processId},
+    {"ParentProcessId",   true,  nullptr, &EventFields::parentProcessId},
+    {"SourcePort",        true,  nullptr, &EventFields::sourcePort},
+    {"DestinationPort",   true,  nullptr, &EventFields::destinationPort},
+    {"TerminalSessionId", true,  nullptr, nullptr},
+};
+
+inline constexpr NameIndex<DataField, sizeof(DATA_FIELDS) / sizeof(DATA_FIELDS[0]), 64> DATA_FIELD_INDEX{DATA_FIELDS};
+
+constexpr const DataField* findDataField(std::string_view name) {
+    return DATA_FIELD_INDEX.find(name);
+}
+
+// For table rows: a typo fails the build instead of dropping the field
+constexpr const DataField* dataField(std::string_view name) {
+    const DataField* field = findDataField(name);
+    if (field == nullptr) throw "unknown EventData field";
+    return field;
+}
+
+// ============================================
+// System Fields
+// ============================================
+enum class SystemField : uint8_t {
+    Provider,
+    EventID,
+    Version,
+    Level,
+    Keywords,
+    TimeCreated,
+    EventRecordID,
+    Correlation,
+    Execution,
+    Channel,
+    Computer,
+    Security
+};
+
+struct SystemFieldName {
+    std::string_view name;
+    SystemField field;
+};
+
+inline constexpr SystemFieldName SYSTEM_FIELDS[] = {
+    {"Provider",      SystemField::Provider},
+    {"EventID",       SystemField::EventID},
+    {"Version",       SystemField::Version},
+    {"Level",         SystemField::Level},
+    {"Keywords",      SystemField::Keywords},
+    {"TimeCreated",   SystemField::TimeCreated},
+    {"EventRecordID", SystemField::EventRecordID},
+    {"Correlation",   SystemField::Correlation},
+    {"Execution",     SystemField::Execution},
+    {"Channel",       SystemField::Channel},
+    {"Computer",      SystemField::Computer},
+    {"Security",      SystemField::Security},
+};
+
+inline constexpr NameIndex<SystemFieldName, sizeof(SYSTEM_FIELDS) / sizeof(SYSTEM_FIELDS[0]), 32> SYSTEM_FIELD_INDEX{SYSTEM_FIELDS};
+
+constexpr const SystemFieldName* findSystemField(std::string_view name) {
+    return SYSTEM_FIELD_INDEX.find(name);
+}
+
+// ============================================
+// Event IDs
+// ============================================
+constexpr size_t MAX_EVENT_FIELDS = 8;
+
+struct EventSpec {
+    int eventId;
+    EventFamily family;       // None = rendered (cheaply) but not sent, e.g. termination
+    const char* action;       // process.action / file.operation
+    const DataField* fields[MAX_EVENT_FIELDS];   // What the values renderer selects; null ends the list
+};
+
+inline constexpr EventSpec SYSMON_EVENTS[] = {
+    {1,  EventFamily::Process, "created",
+         {dataField("Image"), dataField("CommandLine"), dataField("User"), dataField("ParentImage"),
+          dataField("ProcessId"), dataField("ParentProcessId")}},
+    {3,  EventFamily::Network, "",
+         {dataField("Image"), dataField("User"), dataField("Protocol"), dataField("SourceIp"),
+          dataField("SourcePort"), dataField("DestinationIp"), dataField("DestinationPort"),
+          dataField("ProcessId")}},
+    {5,  EventFamily::None, "",
+         {dataField("Image"), dataField("ProcessId")}},
+    {7,  EventFamily::File, "loaded",
+         {dataField("Image"), dataField("ImageLoaded"), dataField("User"), dataField("ProcessId")}},
+    {11, EventFamily::File, "created",
+         {dataField("Image"), dataField("TargetFilename"), dataField("ProcessId")}},
+    {23, EventFamily::File, "deleted",
+         {dataField("Image"), dataField("TargetFilename"), dataField("User"), dataField("ProcessId")}},
+};
+
+constexpr size_t MAX_EVENT_ID = 64;   // Sysmon IDs are small; index them directly
+
+struct EventIndex {
+    uint8_t slot[MAX_EVENT_ID];
+
+    constexpr EventIndex() : slot() {
+        for (size_t i = 0; i < MAX_EVENT_ID; i++) slot[i] = 0xFF;
+        for (size_t i = 0; i < sizeof(SYSMON_EVENTS) / sizeof(SYSMON_EVENTS[0]); i++) {
+            int id = SYSMON_EVENTS[i].eventId;
+            if (id <= 0 || (size_t)id >= MAX_EVENT_ID || slot[id] != 0xFF) throw "bad event ID";
+            slot[id] = (uint8_t)i;
+        }
+    }
+};
+
+inline constexpr EventIndex EVENT_INDEX{};
+
+// The row for a Sysmon event ID, null if the agent does not handle it
+constexpr const EventSpec* findEvent(int eventId) {
+    if (eventId <= 0 || (size_t)eventId >= MAX_EVENT_ID) return nullptr;
+    uint8_t slot = EVENT_INDEX.slot[eventId];
+    return slot == 0xFF ? nullptr : &SYSMON_EVENTS[slot];
+}
+
+constexpr size_t fieldCount(const EventSpec& spec) {
+    size_t count = 0;
+    while (count < MAX_EVENT_FIELDS && spec.fields[count] != nullptr) count++;
+    return count;
+}
+
+// Assigns a value to the member field points at (no-op for fields the converter ignores)
+inline void store(const DataField& field, EventFields& fields, std::string_view text) {
+    if (field.text) fields.*field.text = text;
+}
+inline void store(const DataField& field, EventFields& fields, int number) {
+    if (field.number) fields.*field.number = number;
+}
+
+static_assert(DATA_FIELD_INDEX.maxProbe() <= 2, "EventData names collide; grow the index");
+static_assert(SYSTEM_FIELD_INDEX.maxProbe() <= 2, "System names collide; grow the index");
+static_assert(findEvent(1)->family == EventFamily::Process, "SYSMON_EVENTS index");
+
+} // namespace SysmonSchema
+
+#endif // SYSMONSCHEMA_HPP
@@ -0,0 +1,330 @@
+#include "TelemetryEvent.hpp"
+#include "AgentIdentity.hpp"
+
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+struct PathSpec {
+    EventFamily family;          // None = any family
+    const char* path;
+    TelemetryEvent::FieldRef ref;
+};
+
+using Ref = TelemetryEvent::FieldRef;
+
+const PathSpec PATHS[] = {
+    {EventFamily::None,    "agent_id",              {Ref::String, TelemetryEvent::AgentId}},
+    {EventFamily::None,    "host.hostname",         {Ref::String, TelemetryEvent::Hostname}},
+
+    {EventFamily::Process, "process.name",          {Ref::String, TelemetryEvent::Image}},
+    {EventFamily::Process, "process.pid",           {Ref::Integer, 0}},
+    {EventFamily::Process, "process.command_line",  {Ref::String, TelemetryEvent::CommandLine}},
+    {EventFamily::Process, "process.user",          {Ref::String, TelemetryEvent::User}},
+    {EventFamily::Process, "process.parent_image",  {Ref::String, TelemetryEvent::ParentImage}},
+    {EventFamily::Process, "process.action",        {Ref::Action, 0}},
+
+    {EventFamily::Network, "network.source_ip",     {Ref::String, TelemetryEvent::SourceIp}},
+    {EventFamily::Network, "network.source_port",   {Ref::Integer, 1}},
+    {EventFamily::Network, "network.dest_ip",       {Ref::String, TelemetryEvent::DestinationIp}},
+    {EventFamily::Network, "network.dest_port",     {Ref::Integer, 2}},
+    {EventFamily::Network, "network.protocol",      {Ref::String, TelemetryEvent::Protocol}},
+    {EventFamily::Network, "network.image",         {Ref::String, TelemetryEvent::Image}},
+
+    {EventFamily::File,    "file.path",             {Ref::String, TelemetryEvent::TargetFilename}},
+    {EventFamily::File,    "file.operation",        {Ref::Action, 0}},
+    {EventFamily::File,    "file.process_image",    {Ref::String, TelemetryEvent::Image}},
+};
+
+// Same escaping as nlohmann::json::dump(), so both paths produce identical bodies
+void writeString(std::string_view value, std::string& out) {
+    out.push_back('"');
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); i++) {
+        unsigned char c = (unsigned char)value[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(value.data() + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+        }
+    }
+    out.append(value.data() + start, value.size() - start);
+    out.push_back('"');
+}
+
+void writeKey(const char* key, std::string& out) {
+    out.push_back('"');
+    out += key;
+    out += "\":";
+}
+
+void writeStringField(const char* key, std::string_view value, std::string& out) {
+    writeKey(key, out);
+    writeString(value, out);
+    out.push_back(',');
+}
+
+void writeIntegerField(const char* key, long long value, std::string& out) {
+    writeKey(key, out);
+    out += std::to_string(value);
+    out.push_back(',');
+}
+
+// Replaces the trailing ',' of the last field
+void closeObject(std::string& out) {
+    if (!out.empty() && out.back() == ',') out.back() = '}';
+    else out.push_back('}');
+}
+
+} // namespace
+
+// ============================================
+// Fields
+// ============================================
+int TelemetryEvent::integer(uint8_t index) const {
+    switch (index) {
+        case 0:  return processId;
+        case 1:  return sourcePort;
+        default: return destinationPort;
+    }
+}
+
+TelemetryEvent::FieldRef::Kind TelemetryEvent::value(const FieldRef& ref, std::string_view& string, long long& number) const {
+    switch (ref.kind) {
+        case FieldRef::String:  string = get((Field)ref.index); break;
+        case FieldRef::Action:  string = action; break;
+        case FieldRef::Integer: number = integer(ref.index); break;
+        default: break;
+    }
+    return ref.kind;
+}
+
+void TelemetryEvent::reset() {
+    family = EventFamily::None;
+    timestampUs = 0;
+    severity = "info";
+    action = "";
+    processId = parentProcessId = sourcePort = destinationPort = 0;
+    aggregateCount = 0;
+    firstSeen = lastSeen = 0;
+    for (Text& field : text) field = Text();
+    tags.clear();
+    ancestors.clear();
+    buffer.clear();
+}
+
+const char* TelemetryEvent::familyName(EventFamily family) {
+    switch (family) {
+        case EventFamily::Process: return "process";
+        case EventFamily::Network: return "network";
+        case EventFamily::File:    return "file";
+        default:                   return "unknown";
+    }
+}
+
+EventFamily TelemetryEvent::parseFamily(std::string_view name) {
+    if (name == "process") return EventFamily::Process;
+    if (name == "network") return EventFamily::Network;
+    if (name == "file") return EventFamily::File;
+    return EventFamily::None;
+}
+
+TelemetryEvent::FieldRef TelemetryEvent::lookup(EventFamily family, std::string_view path) {
+    for (const PathSpec& spec : PATHS) {
+        if ((spec.family == EventFamily::None || spec.family == family) && path == spec.path) {
+            return spec.ref;
+        }
+    }
+    return FieldRef();
+}
+
+// ============================================
+// Serialization
+// ============================================
+void TelemetryEvent::writeJson(std::string& out) const {
+    // Keys in sorted order, as nlohmann::json (a std::map) dumps them; the
+    // zstd dictionaries were trained on that layout
+    out.push_back('{');
+    writeStringField("agent_id", get(AgentId), out);
+    if (aggregateCount > 1) {
+        writeKey("aggregation", out);
+        out.push_back('{');
+        writeIntegerField("count", aggregateCount, out);
+        writeIntegerField("first_seen", firstSeen, out);
+        writeIntegerField("last_seen", lastSeen, out);
+        closeObject(out);
+        out.push_back(',');
+    }
+    writeStringField("event_id", std::string_view(eventId, sizeof(eventId)), out);
+    writeStringField("event_type", typeName(), out);
+
+    if (family == EventFamily::File) {
+        writeKey("file", out);
+        out.push_back('{');
+        writeStringField("operation", action, out);
+        writeStringField("path", get(TargetFilename), out);
+        writeStringField("process_image", get(Image), out);
+        closeObject(out);
+        out.push_back(',');
+    }
+
+    writeKey("host", out);
+    out.push_back('{');
+    writeStringField("hostname", get(Hostname), out);
+    writeStringField("os", AgentIdentity::OS_NAME, out);
+    writeStringField("os_version", AgentIdentity::OS_VERSION, out);
+    closeObject(out);
+    out.push_back(',');
+
+    if (family == EventFamily::Network) {
+        writeKey("network", out);
+        out.push_back('{');
+        writeStringField("dest_ip", get(DestinationIp), out);
+        writeIntegerField("dest_port", destinationPort, out);
+        writeStringField("image", get(Image), out);
+        writeStringField("protocol", get(Protocol), out);
+        writeStringField("source_ip", get(SourceIp), out);
+        writeIntegerField("source_port", sourcePort, out);
+        closeObject(out);
+        out.push_back(',');
+    } else if (family == EventFamily::Process) {
+        writeKey("process", out);
+        out.push_back('{');
+        writeStringField("action", action, out);
+        if (!ancestors.empty()) {
+            writeKey("ancestors", out);
+            out.push_back('[');
+            for (size_t i = 0; i < ancestors.size(); i++) {
+                if (i > 0) out.push_back(',');
+                writeString(ancestor(i), out);
+            }
+            out += "],";
+        }
+        writeStringField("command_line", get(CommandLine), out);
+        writeStringField("name", get(Image), out);
+        writeStringField("parent_image", get(ParentImage), out);
+        if (parentProcessId != 0) writeIntegerField("parent_pid", parentProcessId, out);
+        writeIntegerField("pid", processId, out);
+        writeStringField("user", get(User), out);
+        closeObject(out);
+        out.push_back(',');
+    }
+
+    writeStringField("severity", severity, out);
+    if (!tags.empty()) {
+        writeKey("tags", out);
+        out.push_back('[');
+        for (size_t i = 0; i < tags.size(); i++) {
+            if (i > 0) out.push_back(',');
+            writeString(tag(i), out);
+        }
+        out += "],";
+    }
+    // Whole seconds for older consumers, plus the full precision
+    writeIntegerField("timestamp", timestampUs / 1000000, out);
+    writeIntegerField("timestamp_us", timestampUs, out);
+    writeStringField("version", VERSION, out);
+    closeObject(out);
+}
+
+nlohmann::json TelemetryEvent::toJson() const {
+    if (empty()) return nlohmann::json();
+
+    nlohmann::json event;
+    event["agent_id"] = get(AgentId);
+    event["event_id"] = std::string_view(eventId, sizeof(eventId));
+    event["event_type"] = typeName();
+    event["timestamp"] = timestampUs / 1000000;
+    event["timestamp_us"] = timestampUs;
+    event["severity"] = severity;
+    event["version"] = VERSION;
+    event["host"] = AgentIdentity::hostBlock(get(Hostname));
+
+    if (family == EventFamily::Process) {
+        event["process"] = {
+            {"name", get(Image)},
+            {"pid", processId},
+            {"command_line", get(CommandLine)},
+            {"user", get(User)},
+            {"parent_image", get(ParentImage)},
+            {"action", action}
+        };
+        if (parentProcessId != 0) event["process"]["parent_pid"] = parentProcessId;
+        if (!ancestors.empty()) {
+            nlohmann::json list = nlohmann::json::array();
+            for (size_t i = 0; i < ancestors.size(); i++) list.push_back(ancestor(i));
+            event["process"]["ancestors"] = std::move(list);
+        }
+    } else if (family == EventFamily::Network) {
+        event["network"] = {
+            {"source_ip", get(SourceIp)},
+            {"source_port", sourcePort},
+            {"dest_ip", get(DestinationIp)},
+            {"dest_port", destinationPort},
+            {"protocol", get(Protocol)},
+            {"image", get(Image)}
+        };
+    } else {
+        event["file"] = {
+            {"path", get(TargetFilename)},
+            {"operation", action},
+            {"process_image", get(Image)}
+        };
+    }
+
+    if (!tags.empty()) {
+        nlohmann::json list = nlohmann::json::array();
+        for (size_t i = 0; i < tags.size(); i++) list.push_back(tag(i));
+        event["tags"] = std::move(list);
+    }
+    if (aggregateCount > 1) {
+        event["aggregation"] = {
+            {"count", aggregateCount},
+            {"first_seen", firstSeen},
+            {"last_seen", lastSeen}
+        };
+    }
+    return event;
+}
+
+// ============================================
+// Arena
+// ============================================
+void TelemetryArena::acquire(TelemetryEvent& event) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_free.empty()) {
+        event.buffer = std::move(m_free.back());
+        m_free.pop_back();
+    }
+}
+
+void TelemetryArena::release(std::vector<std::string>& buffers) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::string& buffer : buffers) {
+            if (m_free.size() >= m_maxFree) break;   // The rest is freed below
+            buffer.clear();
+            m_free.push_back(std::move(buffer));
+        }
+    }
+    buffers.clear();
+}
+
+size_t TelemetryArena::freeCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_free.size();
+}
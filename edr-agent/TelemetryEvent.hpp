@@ -0,0 +1,148 @@
+#ifndef TELEMETRYEVENT_HPP
+#define TELEMETRYEVENT_HPP
+
+#include "nlohmann/json.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================
+// Telemetry Event
+// ============================================================
+// One converted event as a flat, typed record instead of a nlohmann::json
+// tree. Every string field is an offset/length into a single text buffer
+// owned by the event, so converting an event costs one allocation, and
+// none once the buffer comes back recycled through TelemetryArena.
+//
+// Serialization runs straight from the struct: writeJson() for the JSON
+// array body (same keys and order as the old json dump), BinaryBatchEncoder
+// for the binary one. toJson() builds the tree for the legacy converter
+// entry points.
+// ============================================================
+
+enum class EventFamily : uint8_t {
+    None,       // Position marker only (filtered or skipped event)
+    Process,
+    Network,
+    File
+};
+
+struct TelemetryEvent {
+    struct Text {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    enum Field : uint8_t {
+        AgentId,
+        Hostname,
+        Image,
+        CommandLine,
+        User,
+        ParentImage,
+        TargetFilename,
+        SourceIp,
+        DestinationIp,
+        Protocol,
+        FieldCount
+    };
+
+    // Where a dotted key path ("network.dest_ip") lands in the struct
+    struct FieldRef {
+        enum Kind : uint8_t { Missing, String, Integer, Action };
+        Kind kind = Missing;
+        uint8_t index = 0;      // Field for String, 0..2 (pid, source port, dest port) for Integer
+    };
+
+    EventFamily family = EventFamily::None;
+    char eventId[36];
+    long long timestampUs = 0;          // Unix microseconds
+    const char* severity = "info";      // Static strings only
+    const char* action = "";            // process.action / file.operation
+    int processId = 0;
+    int parentProcessId = 0;            // Process events; 0 = unknown
+    int sourcePort = 0;
+    int destinationPort = 0;
+
+    // Set by the aggregator on the record it emits for a window
+    uint32_t aggregateCount = 0;
+    long long firstSeen = 0;
+    long long lastSeen = 0;
+
+    Text text[FieldCount];
+    std::vector<Text> tags;
+    std::vector<Text> ancestors;        // Images above the parent, nearest first (ProcessTable)
+    std::string buffer;
+
+    bool empty() const { return family == EventFamily::None; }
+
+    std::string_view get(Field field) const {
+        return std::string_view(buffer.data() + text[field].offset, text[field].length);
+    }
+    std::string_view tag(size_t index) const {
+        return std::string_view(buffer.data() + tags[index].offset, tags[index].length);
+    }
+    void set(Field field, std::string_view value) { text[field] = append(value); }
+    void addTag(std::string_view value) { tags.push_back(append(value)); }
+    std::string_view ancestor(size_t index) const {
+        return std::string_view(buffer.data() + ancestors[index].offset, ancestors[index].length);
+    }
+    void addAncestor(std::string_view image) { ancestors.push_back(append(image)); }
+
+    int integer(uint8_t index) const;
+    FieldRef::Kind value(const FieldRef& ref, std::string_view& string, long long& number) const;
+
+    // Back to a marker; buffers keep their capacity
+    void reset();
+
+    // "process" / "network" / "file" ("unknown" for None)
+    const char* typeName() const { return familyName(family); }
+    static const char* familyName(EventFamily family);
+    static EventFamily parseFamily(std::string_view name);
+    static FieldRef lookup(EventFamily family, std::string_view path);
+
+    // Appends the event as one JSON object (no separators)
+    void writeJson(std::string& out) const;
+    nlohmann::json toJson() const;
+
+    static constexpr const char* VERSION = "1.0";
+
+private:
+    Text append(std::string_view value) {
+        Text ref{(uint32_t)buffer.size(), (uint32_t)value.size()};
+        buffer.append(value.data(), value.size());
+        return ref;
+    }
+};
+
+// ============================================================
+// Telemetry Arena
+// ============================================================
+// Recycles event text buffers between the sender and the workers: the
+// sender hands back a whole batch's worth once the batch is settled, the
+// workers take them one per event. After warm-up, events are converted
+// and batched without touching the heap.
+// ============================================================
+class TelemetryArena {
+public:
+    explicit TelemetryArena(size_t maxFree = 8192) : m_maxFree(maxFree) {}
+
+    // Gives the event a recycled (empty, pre-sized) buffer if one is free
+    void acquire(TelemetryEvent& event);
+
+    // Takes back every buffer in buffers and leaves it empty
+    void release(std::vector<std::string>& buffers);
+
+    size_t freeCount() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<std::string> m_free;
+    size_t m_maxFree;
+};
+
+#endif // TELEMETRYEVENT_HPP
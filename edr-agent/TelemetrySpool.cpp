@@ -0,0 +1,451 @@
+#include "TelemetrySpool.hpp"
+#include "HttpClient.hpp"
+#include "RateController.hpp"
+#include "ResourceGovernor.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const uint32_t SPOOL_MAGIC = 0x53524445;                 // "EDRS", JSON batch
+    const uint32_t SPOOL_MAGIC_BINARY = 0x42524445;          // "EDRB", BinaryBatch
+    const uint32_t MAX_RECORD_BYTES = 64 * 1024 * 1024;      // Anything larger is corruption
+    const char SEGMENT_PREFIX[] = "segment-";
+    const char SEGMENT_SUFFIX[] = ".spool";
+}
+
+TelemetrySpool::TelemetrySpool(const SpoolConfig& config)
+    : m_config(config)
+{
+    if (m_config.segmentBytes == 0) m_config.segmentBytes = 16ULL * 1024 * 1024;
+    if (m_config.replayBatchesPerSec == 0) m_config.replayBatchesPerSec = 1;
+}
+
+TelemetrySpool::~TelemetrySpool() {
+    stop();
+}
+
+// ============================================
+// Open (recover segments from a previous run)
+// ============================================
+bool TelemetrySpool::open() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::error_code ec;
+    fs::create_directories(m_config.directory, ec);
+    if (ec) {
+        std::cerr << "[Spool] ❌ Cannot create " << m_config.directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    auto maxAge = std::chrono::hours(m_config.maxAgeHours);
+    auto now = fs::file_time_type::clock::now();
+
+    for (const auto& entry : fs::directory_iterator(m_config.directory, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(SEGMENT_PREFIX, 0) != 0) continue;
+
+        Segment segment;
+        segment.seq = std::strtoull(name.c_str() + sizeof(SEGMENT_PREFIX) - 1, nullptr, 10);
+        segment.path = entry.path().string();
+        segment.bytes = entry.file_size(ec);
+        if (segment.seq == 0) continue;
+
+        // Whole segment past the age cap: nothing in it is worth sending
+        if (m_config.maxAgeHours > 0 && now - entry.last_write_time(ec) > maxAge) {
+            removeSegment(segment);
+            continue;
+        }
+
+        m_sealed.push_back(segment);
+        m_totalBytes += segment.bytes;
+        m_nextSeq = std::max(m_nextSeq, segment.seq + 1);
+    }
+
+    std::sort(m_sealed.begin(), m_sealed.end(),
+              [](const Segment& a, const Segment& b) { return a.seq < b.seq; });
+
+    std::cout << "[Spool] " << m_sealed.size() << " segment(s), "
+              << (m_totalBytes / 1024) << " KB pending in " << m_config.directory << std::endl;
+    return true;
+}
+
+// ============================================
+// Append (sender thread)
+// ============================================
+bool TelemetrySpool::append(const std::vector<BYTE>& compressed, size_t rawSize, bool binary) {
+    if (compressed.empty() || compressed.size() > MAX_RECORD_BYTES) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_activeFile != INVALID_HANDLE_VALUE && m_active.bytes >= m_config.segmentBytes) {
+        sealActiveSegment();
+    }
+    if (m_activeFile == INVALID_HANDLE_VALUE && !openActiveSegment()) {
+        return false;
+    }
+
+    RecordHeader header;
+    header.magic = binary ? SPOOL_MAGIC_BINARY : SPOOL_MAGIC;
+    header.compressedSize = (uint32_t)compressed.size();
+    header.rawSize = (uint32_t)rawSize;
+    header.checksum = checksum(compressed.data(), compressed.size());
+    header.createdMs = nowMs();
+
+    DWORD written = 0;
+    BOOL ok = WriteFile(m_activeFile, &header, sizeof(header), &written, NULL) && written == sizeof(header);
+    ok = ok && WriteFile(m_activeFile, compressed.data(), (DWORD)compressed.size(), &written, NULL)
+            && written == compressed.size();
+    // The bookmark moves past these events once we return true, so they must be on disk
+    ok = ok && FlushFileBuffers(m_activeFile);
+
+    if (!ok) {
+        std::cerr << "[Spool] ❌ Write failed (Error: " << GetLastError() << ")" << std::endl;
+        sealActiveSegment();   // Whatever made it to disk stays replayable; next append starts fresh
+        return false;
+    }
+
+    uint64_t recordBytes = sizeof(header) + compressed.size();
+    m_active.bytes += recordBytes;
+    m_totalBytes += recordBytes;
+    m_spooled.fetch_add(1, std::memory_order_relaxed);
+
+    enforceSizeCap();
+    return true;
+}
+
+bool TelemetrySpool::openActiveSegment() {
+    m_active = Segment();
+    m_active.seq = m_nextSeq++;
+    m_active.path = segmentPath(m_active.seq);
+
+    m_activeFile = CreateFileA(m_active.path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, NULL,
+                               OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_activeFile == INVALID_HANDLE_VALUE) {
+        std::cerr << "[Spool] ❌ Cannot create " << m_active.path << " (Error: " << GetLastError() << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void TelemetrySpool::sealActiveSegment() {
+    if (m_activeFile == INVALID_HANDLE_VALUE) return;
+    CloseHandle(m_activeFile);
+    m_activeFile = INVALID_HANDLE_VALUE;
+
+    if (m_active.bytes > 0) {
+        m_sealed.push_back(m_active);
+    } else {
+        DeleteFileA(m_active.path.c_str());
+    }
+    m_active = Segment();
+}
+
+void TelemetrySpool::enforceSizeCap() {
+    while (m_totalBytes > m_config.maxBytes) {
+        if (m_sealed.empty()) {
+            if (m_active.bytes == 0) break;
+            sealActiveSegment();
+            continue;
+        }
+
+        Segment oldest = m_sealed.front();
+        m_sealed.pop_front();
+        std::cerr << "[Spool] ⚠️ Size cap reached, evicting " << oldest.path
+                  << " (" << (oldest.bytes / 1024) << " KB)" << std::endl;
+        removeSegment(oldest);
+        m_totalBytes -= std::min(m_totalBytes, oldest.bytes);
+        m_evicted.fetch_add(1, std::memory_order_relaxed);
+
+        if (oldest.seq == m_replaySeq) {
+            m_replaySeq = 0;
+            m_replayOffset = 0;
+        }
+    }
+}
+
+void TelemetrySpool::removeSegment(const Segment& segment) {
+    // The replay thread opens segments with FILE_SHARE_DELETE, so this also
+    // works while it is in the middle of one
+    if (!DeleteFileA(segment.path.c_str())) {
+        std::cerr << "[Spool] ⚠️ Cannot delete " << segment.path << " (Error: " << GetLastError() << ")" << std::endl;
+    }
+}
+
+uint64_t TelemetrySpool::pendingBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_totalBytes;
+}
+
+// ============================================
+// Replay
+// ============================================
+void TelemetrySpool::startReplay(HttpClient& replayClient) {
+    if (m_running.exchange(true)) return;
+    m_replayClient = &replayClient;
+    m_replayThread = std::thread(&TelemetrySpool::replayLoop, this);
+}
+
+void TelemetrySpool::stop() {
+    if (m_running.exchange(false)) {
+        m_waitCV.notify_all();
+        if (m_replayThread.joinable()) m_replayThread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    sealActiveSegment();
+}
+
+void TelemetrySpool::notifyOnline() {
+    if (!m_online.exchange(true)) {
+        m_waitCV.notify_all();
+    }
+}
+
+bool TelemetrySpool::waitFor(std::chrono::milliseconds duration) {
+    std::unique_lock<std::mutex> lock(m_waitMutex);
+    m_waitCV.wait_for(lock, duration, [this] { return !m_running; });
+    return m_running;
+}
+
+void TelemetrySpool::replayLoop() {
+    // Spread the first attempt so endpoints that lost the server together
+    // don't all come back in the same second
+    std::mt19937 rng(std::random_device{}());
+    if (m_config.replayJitterMs > 0) {
+        std::uniform_int_distribution<unsigned> jitter(0, m_config.replayJitterMs);
+        if (!waitFor(std::chrono::milliseconds(jitter(rng)))) return;
+    }
+
+    auto backoff = std::chrono::milliseconds(1000);
+    const auto maxBackoff = std::chrono::milliseconds(60000);
+
+    while (m_running) {
+        Segment segment;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // Only take the active segment once the server looks reachable,
+            // otherwise every failed batch would end up in its own segment
+            if (m_sealed.empty() && m_active.bytes > 0 && m_online) {
+                sealActiveSegment();
+            }
+            if (!m_sealed.empty()) {
+                segment = m_sealed.front();
+            }
+        }
+
+        if (segment.seq == 0) {
+            // Nothing pending: sleep until the sender reports the server is up, or a while
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_waitCV.wait_for(lock, std::chrono::seconds(5), [this] {
+                return !m_running || m_online;
+            });
+            if (m_online) {
+                std::lock_guard<std::mutex> spoolLock(m_mutex);
+                if (m_sealed.empty() && m_active.bytes == 0) m_online = false;  // Nothing to do: re-arm
+            }
+            continue;
+        }
+
+        ReplayResult result = replaySegment(segment);
+
+        if (result == ReplayResult::Stopped) break;
+
+        if (result == ReplayResult::SendFailed) {
+            m_online = false;
+            if (!waitFor(backoff)) break;
+            backoff = std::min(backoff * 2, maxBackoff);
+            continue;
+        }
+
+        // Done: the whole segment reached the server
+        backoff = std::chrono::milliseconds(1000);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_sealed.empty() && m_sealed.front().seq == segment.seq) {
+            m_sealed.pop_front();
+            removeSegment(segment);
+            m_totalBytes -= std::min(m_totalBytes, segment.bytes);
+            std::cout << "[Spool] ✓ Replayed " << segment.path << std::endl;
+        }
+        m_replaySeq = 0;
+        m_replayOffset = 0;
+    }
+}
+
+TelemetrySpool::ReplayResult TelemetrySpool::replaySegment(const Segment& segment) {
+    uint64_t offset = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_replaySeq != segment.seq) {
+            m_replaySeq = segment.seq;
+            m_replayOffset = 0;
+        }
+        offset = m_replayOffset;
+    }
+
+    HANDLE hFile = CreateFileA(segment.path.c_str(), GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        // Evicted or deleted underneath us: nothing left to send from it
+        return ReplayResult::Done;
+    }
+
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)offset;
+    SetFilePointerEx(hFile, position, NULL, FILE_BEGIN);
+
+    const uint64_t maxAgeMs = (uint64_t)m_config.maxAgeHours * 3600 * 1000;
+    const auto interval = std::chrono::milliseconds(1000 / m_config.replayBatchesPerSec);
+    ReplayResult result = ReplayResult::Done;
+
+    while (m_running) {
+        // The server asked for a break (Retry-After or backoff): wait it out before the next record
+        if (m_rateController != nullptr) {
+            auto hold = m_rateController->throttledFor();
+            if (hold.count() > 0 && !waitFor(hold)) {
+                result = ReplayResult::Stopped;
+                break;
+            }
+        }
+        // The live sender is spilling to us to save resources; replaying now would undo that
+        if (m_governor != nullptr && m_governor->spilling()) {
+            if (!waitFor(std::chrono::milliseconds(1000))) {
+                result = ReplayResult::Stopped;
+                break;
+            }
+            continue;
+        }
+
+        RecordHeader header;
+        DWORD read = 0;
+        if (!ReadFile(hFile, &header, sizeof(header), &read, NULL) || read != sizeof(header)) {
+            break;  // End of segment (or a torn tail from a crash)
+        }
+        bool knownMagic = header.magic == SPOOL_MAGIC || header.magic == SPOOL_MAGIC_BINARY;
+        if (!knownMagic || header.compressedSize == 0 || header.compressedSize > MAX_RECORD_BYTES) {
+            std::cerr << "[Spool] ⚠️ Corrupt record in " << segment.path << " at " << offset
+                      << ", skipping rest of segment" << std::endl;
+            break;
+        }
+
+        m_replayBuffer.resize(header.compressedSize);
+        if (!ReadFile(hFile, m_replayBuffer.data(), header.compressedSize, &read, NULL) || read != header.compressedSize) {
+            break;
+        }
+        uint64_t next = offset + sizeof(header) + header.compressedSize;
+
+        bool expired = maxAgeMs > 0 && nowMs() - header.createdMs > maxAgeMs;
+        DWORD status = 0;
+        if (expired || checksum(m_replayBuffer.data(), m_replayBuffer.size()) != header.checksum) {
+            m_evicted.fetch_add(1, std::memory_order_relaxed);
+        } else if (m_replayClient->sendCompressedPayload(m_replayBuffer,
+                       header.magic == SPOOL_MAGIC_BINARY ? EDR_BATCH_CONTENT_TYPE : EDR_JSON_CONTENT_TYPE, &status)) {
+            m_replayed.fetch_add(1, std::memory_order_relaxed);
+            m_online = true;
+            if (!waitFor(interval)) {
+                offset = next;
+                result = ReplayResult::Stopped;
+                break;
+            }
+        } else if (rejected(status)) {
+            // The server is up and will never take this one: move on to the next
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "[Spool] ⚠️ Server rejected record in " << segment.path << " at " << offset
+                      << " (HTTP " << status << "), dropping it" << std::endl;
+            m_online = true;
+            if (!waitFor(interval)) {
+                offset = next;
+                result = ReplayResult::Stopped;
+                break;
+            }
+        } else {
+            // No response, 5xx or 429: try the same record again after a backoff
+            result = ReplayResult::SendFailed;
+            break;
+        }
+
+        offset = next;
+    }
+
+    if (!m_running && result == ReplayResult::Done) {
+        result = ReplayResult::Stopped;
+    }
+
+    CloseHandle(hFile);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_replaySeq == segment.seq) {
+        m_replayOffset = offset;
+    }
+    return result;
+}
+
+// ============================================
+// Offline Reader
+// ============================================
+size_t TelemetrySpool::forEachRecord(const std::string& directory,
+                                     const std::function<bool(const std::vector<BYTE>&)>& visit) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        if (entry.path().filename().string().rfind(SEGMENT_PREFIX, 0) == 0) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());   // Zero-padded sequence numbers sort by name
+
+    size_t visited = 0;
+    std::vector<BYTE> payload;
+    for (const auto& path : paths) {
+        std::ifstream file(path, std::ios::binary);
+        RecordHeader header;
+        while (file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            bool binary = header.magic == SPOOL_MAGIC_BINARY;
+            if ((!binary && header.magic != SPOOL_MAGIC) || header.compressedSize > MAX_RECORD_BYTES) break;
+            payload.resize(header.compressedSize);
+            if (!file.read(reinterpret_cast<char*>(payload.data()), header.compressedSize)) break;
+            if (binary || checksum(payload.data(), payload.size()) != header.checksum) continue;
+
+            visited++;
+            if (!visit(payload)) return visited;
+        }
+    }
+    return visited;
+}
+
+// ============================================
+// Helpers
+// ============================================
+bool TelemetrySpool::rejected(DWORD statusCode) {
+    // 429 is throttling, 408 a timeout, 401/403 a token problem: none says the record is bad
+    if (statusCode < 400 || statusCode >= 500) return false;
+    return statusCode != 429 && statusCode != 408 && statusCode != 401 && statusCode != 403;
+}
+
+std::string TelemetrySpool::segmentPath(uint64_t seq) const {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%012llu%s", SEGMENT_PREFIX, (unsigned long long)seq, SEGMENT_SUFFIX);
+    return (fs::path(m_config.directory) / name).string();
+}
+
+uint32_t TelemetrySpool::checksum(const BYTE* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint64_t TelemetrySpool::nowMs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
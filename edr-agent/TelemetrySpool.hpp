@@ -0,0 +1,157 @@
+#ifndef TELEMETRYSPOOL_HPP
+#define TELEMETRYSPOOL_HPP
+
+#include <Windows.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class HttpClient;
+class RateController;
+class ResourceGovernor;
+
+// ============================================================
+// Telemetry Spool
+// ============================================================
+// Keeps batches the server could not take on disk until it is back.
+//
+//   sender --append()--> [active segment] --rotate--> [sealed segments]
+//                                                           |
+//                       replay thread (oldest first, rate-limited) --> HttpClient
+//
+// Batches are stored exactly as they go on the wire (zstd-compressed),
+// appended sequentially to segment files that rotate at segmentBytes.
+// Replay streams one record at a time, so replaying gigabytes costs one
+// batch worth of memory. When the spool exceeds maxBytes the oldest
+// segment is evicted; records older than maxAgeHours are skipped.
+//
+// A segment is deleted once it has been fully replayed, so a crash in the
+// middle of one re-sends that segment (at-least-once, never lost). A
+// record the server rejects outright (a 4xx other than 429, 401/403 or
+// 408) would fail forever, so it is dropped and counted instead of
+// holding the rest of the spool back.
+// ============================================================
+
+struct SpoolConfig {
+    std::string directory = "spool";
+    uint64_t maxBytes = 512ULL * 1024 * 1024;
+    uint64_t segmentBytes = 16ULL * 1024 * 1024;
+    unsigned maxAgeHours = 72;
+    unsigned replayBatchesPerSec = 5;    // Keeps a fleet coming back online from stampeding ingestion
+    unsigned replayJitterMs = 30000;     // Random delay before the first replay attempt
+};
+
+class TelemetrySpool {
+public:
+    explicit TelemetrySpool(const SpoolConfig& config);
+    ~TelemetrySpool();
+
+    TelemetrySpool(const TelemetrySpool&) = delete;
+    TelemetrySpool& operator=(const TelemetrySpool&) = delete;
+
+    // Creates the directory and picks up segments left by a previous run
+    bool open();
+
+    // Called by the sender when a batch failed. Returns true once the batch is on disk.
+    // binary marks a BinaryBatch body, so replay sends it with the right Content-Type.
+    bool append(const std::vector<BYTE>& compressed, size_t rawSize, bool binary = false);
+
+    // The replay thread uses its own client so it never races the live sender
+    void startReplay(HttpClient& replayClient);
+    void stop();
+
+    // A live send succeeded: the server is reachable, replay can start now
+    void notifyOnline();
+
+    // Replay holds off while it says the server is throttling us. Before startReplay().
+    void setRateController(const RateController* controller) { m_rateController = controller; }
+
+    // Replay also holds off while the agent is far over its resource budget. Before startReplay().
+    void setGovernor(const ResourceGovernor* governor) { m_governor = governor; }
+
+    uint64_t pendingBytes() const;
+    uint64_t spooledCount() const { return m_spooled.load(std::memory_order_relaxed); }
+    uint64_t replayedCount() const { return m_replayed.load(std::memory_order_relaxed); }
+    uint64_t evictedCount() const { return m_evicted.load(std::memory_order_relaxed); }
+    uint64_t rejectedCount() const { return m_rejected.load(std::memory_order_relaxed); }
+
+    // Offline read of every JSON record in a spool directory, oldest first (tool
+    // mode, e.g. dictionary training). Stops early when visit returns false.
+    static size_t forEachRecord(const std::string& directory,
+                                const std::function<bool(const std::vector<BYTE>&)>& visit);
+
+private:
+    #pragma pack(push, 1)
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t compressedSize;
+        uint32_t rawSize;
+        uint32_t checksum;        // FNV-1a of the payload, catches torn writes
+        uint64_t createdMs;       // Unix epoch milliseconds
+    };
+    #pragma pack(pop)
+
+    struct Segment {
+        uint64_t seq = 0;
+        std::string path;
+        uint64_t bytes = 0;
+    };
+
+    enum class ReplayResult {
+        Done,         // Reached the end of the segment
+        SendFailed,   // Server still unreachable, retry later from the same record
+        Stopped
+    };
+
+    // All of these expect m_mutex to be held
+    bool openActiveSegment();
+    void sealActiveSegment();
+    void enforceSizeCap();
+    void removeSegment(const Segment& segment);
+
+    void replayLoop();
+    ReplayResult replaySegment(const Segment& segment);
+    bool waitFor(std::chrono::milliseconds duration);   // false when stopping
+
+    std::string segmentPath(uint64_t seq) const;
+    static uint32_t checksum(const BYTE* data, size_t size);
+    static uint64_t nowMs();
+    static bool rejected(DWORD statusCode);   // Permanent: retrying the record cannot help
+
+    SpoolConfig m_config;
+    HttpClient* m_replayClient = nullptr;
+    const RateController* m_rateController = nullptr;
+    const ResourceGovernor* m_governor = nullptr;
+
+    mutable std::mutex m_mutex;
+    std::deque<Segment> m_sealed;          // Oldest first
+    Segment m_active;
+    HANDLE m_activeFile = INVALID_HANDLE_VALUE;
+    uint64_t m_totalBytes = 0;
+    uint64_t m_nextSeq = 1;
+
+    uint64_t m_replaySeq = 0;              // Segment the replay thread is in, and where
+    uint64_t m_replayOffset = 0;
+    std::vector<BYTE> m_replayBuffer;      // Reused for every record
+
+    std::thread m_replayThread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_online{false};
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCV;
+
+    std::atomic<uint64_t> m_spooled{0};
+    std::atomic<uint64_t> m_replayed{0};
+    std::atomic<uint64_t> m_evicted{0};
+    std::atomic<uint64_t> m_rejected{0};
+};
+
+#endif // TELEMETRYSPOOL_HPP
@@ -0,0 +1,289 @@
+#include "Utf8.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define EDR_UTF8_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define EDR_TARGET_AVX2
+#else
+#define EDR_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// ============================================
+// Scalar
+// ============================================
+
+// Length (1-4) of the valid sequence starting at p, 0 if none does
+size_t sequenceLength(const unsigned char* p, size_t remaining) {
+    unsigned char c = p[0];
+    if (c < 0x80) return 1;
+    if (c < 0xC2 || c > 0xF4) return 0;        // Continuation byte, overlong lead or beyond U+10FFFF
+    if (c < 0xE0) {
+        return (remaining >= 2 && (p[1] & 0xC0) == 0x80) ? 2 : 0;
+    }
+
+    // The second byte carries the overlong / surrogate / range limits
+    unsigned char low = 0x80, high = 0xBF;
+    if (c < 0xF0) {
+        if (remaining < 3) return 0;
+        if (c == 0xE0) low = 0xA0;
+        else if (c == 0xED) high = 0x9F;
+        return (p[1] >= low && p[1] <= high && (p[2] & 0xC0) == 0x80) ? 3 : 0;
+    }
+    if (remaining < 4) return 0;
+    if (c == 0xF0) low = 0x90;
+    else if (c == 0xF4) high = 0x8F;
+    return (p[1] >= low && p[1] <= high && (p[2] & 0xC0) == 0x80 && (p[3] & 0xC0) == 0x80) ? 4 : 0;
+}
+
+// Walks the non-ASCII run at i. Returns where ASCII resumes, or the invalid offset with bad set.
+size_t scanRun(const unsigned char* p, size_t size, size_t i, bool& bad) {
+    while (i < size && p[i] >= 0x80) {
+        size_t length = sequenceLength(p + i, size - i);
+        if (length == 0) {
+            bad = true;
+            return i;
+        }
+        i += length;
+    }
+    return i;
+}
+
+size_t findInvalidScalar(const unsigned char* p, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        if (i + 8 <= size) {
+            uint64_t word;
+            std::memcpy(&word, p + i, sizeof(word));
+            if ((word & 0x8080808080808080ULL) == 0) {
+                i += 8;
+                continue;
+            }
+        }
+        if (p[i] < 0x80) {
+            i++;
+            continue;
+        }
+        bool bad = false;
+        i = scanRun(p, size, i, bad);
+        if (bad) return i;
+    }
+    return size;
+}
+
+#ifndef EDR_UTF8_SIMD
+size_t packAsciiScalar(const uint16_t* units, size_t count, char* out) {
+    size_t i = 0;
+    while (i < count && units[i] < 0x80) {
+        out[i] = (char)units[i];
+        i++;
+    }
+    return i;
+}
+#endif
+
+// ============================================
+// SSE2 / AVX2
+// ============================================
+#ifdef EDR_UTF8_SIMD
+unsigned lowestSetBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+size_t findInvalidSse2(const unsigned char* p, size_t size) {
+    size_t i = 0;
+    while (i + 16 <= size) {
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(p + i)));
+        if (mask == 0) {
+            i += 16;
+            continue;
+        }
+        bool bad = false;
+        i = scanRun(p, size, i + lowestSetBit(mask), bad);
+        if (bad) return i;
+    }
+    return i + findInvalidScalar(p + i, size - i);
+}
+
+EDR_TARGET_AVX2 size_t findInvalidAvx2(const unsigned char* p, size_t size) {
+    size_t i = 0;
+    while (i + 32 <= size) {
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(p + i)));
+        if (mask == 0) {
+            i += 32;
+            continue;
+        }
+        bool bad = false;
+        i = scanRun(p, size, i + lowestSetBit(mask), bad);
+        if (bad) return i;
+    }
+    return i + findInvalidSse2(p + i, size - i);
+}
+
+// Converts leading all-ASCII blocks of units; the caller finishes the rest
+size_t packAsciiSse2(const uint16_t* units, size_t count, char* out) {
+    const __m128i highBits = _mm_set1_epi16((short)0xFF80);
+    size_t i = 0;
+    while (i + 16 <= count) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(units + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(units + i + 8));
+        __m128i high = _mm_and_si128(_mm_or_si128(a, b), highBits);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF) break;
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+        i += 16;
+    }
+    return i;
+}
+
+EDR_TARGET_AVX2 size_t packAsciiAvx2(const uint16_t* units, size_t count, char* out) {
+    const __m256i highBits = _mm256_set1_epi16((short)0xFF80);
+    size_t i = 0;
+    while (i + 32 <= count) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(units + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(units + i + 16));
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), highBits)) break;
+        // packus works per 128-bit lane; the permute puts the quarters back in order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)(out + i), packed);
+        i += 32;
+    }
+    return i + packAsciiSse2(units + i, count - i, out + i);
+}
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;   // OS saves YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+struct Backend {
+    const char* name;
+    size_t (*findInvalid)(const unsigned char* p, size_t size);
+    size_t (*packAscii)(const uint16_t* units, size_t count, char* out);
+};
+
+const Backend& backend() {
+    static const Backend chosen = [] {
+#ifdef EDR_UTF8_SIMD
+        if (cpuHasAvx2()) return Backend{"avx2", findInvalidAvx2, packAsciiAvx2};
+        return Backend{"sse2", findInvalidSse2, packAsciiSse2};   // Baseline on x64
+#else
+        return Backend{"scalar", findInvalidScalar, packAsciiScalar};
+#endif
+    }();
+    return chosen;
+}
+
+} // namespace
+
+// ============================================
+// Validation
+// ============================================
+size_t findInvalidUtf8(const char* data, size_t size) {
+    return backend().findInvalid((const unsigned char*)data, size);
+}
+
+bool sanitizeUtf8InPlace(std::string& text) {
+    size_t size = text.size();
+    size_t read = findInvalidUtf8(text.data(), size);
+    if (read == size) return true;
+
+    // Output never outgrows input, so valid stretches just move down
+    char* p = &text[0];
+    size_t write = read;
+    while (read < size) {
+        read++;   // Drop the invalid byte
+        size_t valid = findInvalidUtf8(p + read, size - read);
+        std::memmove(p + write, p + read, valid);
+        write += valid;
+        read += valid;
+    }
+    text.resize(write);
+    return false;
+}
+
+std::string sanitizeUtf8(const std::string& input) {
+    std::string output = input;
+    sanitizeUtf8InPlace(output);
+    return output;
+}
+
+// ============================================
+// UTF-16 -> UTF-8
+// ============================================
+void utf16ToUtf8(const uint16_t* units, size_t count, std::string& out) {
+    const Backend& simd = backend();
+
+    // Sized for all-ASCII and grown only when wider characters show up
+    size_t pos = out.size();
+    out.resize(pos + count);
+    size_t i = 0;
+    auto reserve = [&out, &pos](size_t bytes) {
+        if (pos + bytes > out.size()) out.resize(std::max(out.size() * 2, pos + bytes));
+    };
+
+    while (i < count) {
+        reserve(count - i);
+        size_t packed = simd.packAscii(units + i, count - i, &out[pos]);
+        i += packed;
+        pos += packed;
+
+        // A non-ASCII unit within the next block: finish that block unit by unit
+        size_t blockEnd = std::min(count, i + 16);
+        while (i < blockEnd) {
+            uint32_t unit = units[i++];
+            reserve(4);
+            char* dst = &out[pos];
+            if (unit < 0x80) {
+                dst[0] = (char)unit;
+                pos += 1;
+            } else if (unit < 0x800) {
+                dst[0] = (char)(0xC0 | (unit >> 6));
+                dst[1] = (char)(0x80 | (unit & 0x3F));
+                pos += 2;
+            } else if (unit >= 0xD800 && unit <= 0xDBFF && i < count && units[i] >= 0xDC00 && units[i] <= 0xDFFF) {
+                uint32_t codePoint = 0x10000 + ((unit - 0xD800) << 10) + (units[i++] - 0xDC00);
+                dst[0] = (char)(0xF0 | (codePoint >> 18));
+                dst[1] = (char)(0x80 | ((codePoint >> 12) & 0x3F));
+                dst[2] = (char)(0x80 | ((codePoint >> 6) & 0x3F));
+                dst[3] = (char)(0x80 | (codePoint & 0x3F));
+                pos += 4;
+            } else {
+                if (unit >= 0xD800 && unit <= 0xDFFF) unit = 0xFFFD;   // Unpaired surrogate
+                dst[0] = (char)(0xE0 | (unit >> 12));
+                dst[1] = (char)(0x80 | ((unit >> 6) & 0x3F));
+                dst[2] = (char)(0x80 | (unit & 0x3F));
+                pos += 3;
+            }
+        }
+    }
+    out.resize(pos);
+}
+
+const char* utf8Backend() {
+    return backend().name;
+}
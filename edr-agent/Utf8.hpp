@@ -0,0 +1,50 @@
+#ifndef UTF8_HPP
+#define UTF8_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ============================================================
+// UTF-8 Validation and Conversion
+// ============================================================
+// Rendered events are almost entirely ASCII, so both directions check
+// 32 (AVX2) or 16 (SSE2) bytes at a time for high bits and only drop to
+// the scalar decoder for the bytes around a non-ASCII character. The
+// vector width is picked once at startup from CPUID; non-x64 builds use
+// the scalar code throughout.
+//
+// Validation is strict (RFC 3629: no overlongs, no surrogates, nothing
+// above U+10FFFF), i.e. what nlohmann::json and pugixml accept.
+// ============================================================
+
+// Offset of the first byte that does not start a valid sequence, or size if the text is valid
+size_t findInvalidUtf8(const char* data, size_t size);
+
+inline bool isValidUtf8(const char* data, size_t size) {
+    return findInvalidUtf8(data, size) == size;
+}
+
+// Leaves valid text untouched (no copy, no allocation) and otherwise drops
+// invalid bytes in place. Returns false if anything was dropped.
+bool sanitizeUtf8InPlace(std::string& text);
+
+// Copying form, for callers that need to keep the input
+std::string sanitizeUtf8(const std::string& input);
+
+// Appends the UTF-8 form of units to out (reusing its capacity). Unpaired surrogates
+// become U+FFFD, as WideCharToMultiByte does, so the result is always
+// valid UTF-8 and needs no separate validation pass.
+void utf16ToUtf8(const uint16_t* units, size_t count, std::string& out);
+
+#ifdef _WIN32
+inline void wideToUtf8(const wchar_t* wide, size_t count, std::string& out) {
+    static_assert(sizeof(wchar_t) == sizeof(uint16_t), "wchar_t is UTF-16 on Windows");
+    utf16ToUtf8(reinterpret_cast<const uint16_t*>(wide), count, out);
+}
+#endif
+
+// "avx2" | "sse2" | "scalar"
+const char* utf8Backend();
+
+#endif // UTF8_HPP
@@ -1,5 +1,6 @@
 
 #include "WebSocketClient.hpp"
+#include "Logger.hpp"
 #include <iostream>
 #include <sstream>
 #include <regex>
@@ -10,12 +11,16 @@
 // ============================================================
 // The initialization list initializes Beast components in order:
 // 1. m_ioc      - The I/O context (event loop)
-// 2. m_resolver - Needs a reference to the I/O context
-// 3. m_ws       - Uses beast::tcp_stream for timeout support
-// ============================================================
-WebSocketClient::WebSocketClient()
-    : m_resolver(net::make_strand(m_ioc))
-    , m_ws(std::make_unique<websocket::stream<beast::tcp_stream>>(net::make_strand(m_ioc)))
+// 2. m_strand   - Serializes every handler and the write queue
+// 3. m_resolver - Needs a reference to the I/O context
+// 4. m_ws       - Uses beast::tcp_stream for timeout support
+// ============================================================
+WebSocketClient::WebSocketClient(const WebSocketConfig& config)
+    : m_strand(net::make_strand(m_ioc))
+    , m_config(config)
+    , m_resolver(m_strand)
+    , m_ws(std::make_unique<websocket::stream<beast::tcp_stream>>(m_strand))
+    , m_ack_timer(m_strand)
     , m_open(false)
     , m_should_reconnect(true)
     , m_retry_count(0)
@@ -139,10 +144,25 @@ void WebSocketClient::on_connect(beast::error_code ec, tcp::resolver::results_ty
     // Set suggested timeout settings for the websocket
     m_ws->set_option(websocket::stream_base::timeout::suggested(beast::role_type::client));
     
-    // Set a decorator to change the User-Agent
+    // Negotiated in the handshake; the server may still decline it
+    if (m_config.permessageDeflate) {
+        websocket::permessage_deflate pmd;
+        pmd.client_enable = true;
+        m_ws->set_option(pmd);
+    }
+
+    // Set a decorator to change the User-Agent (and authenticate, for telemetry)
+    std::string authorization = m_config.authToken.empty() ? "" : "Token " + m_config.authToken;
+    std::string agentId = m_config.agentId;
     m_ws->set_option(websocket::stream_base::decorator(
-        [](websocket::request_type& req) {
+        [authorization, agentId](websocket::request_type& req) {
             req.set(beast::http::field::user_agent, "EDR-Agent/1.0");
+            if (!authorization.empty()) {
+                req.set(beast::http::field::authorization, authorization);
+            }
+            if (!agentId.empty()) {
+                req.set("X-Agent-ID", agentId);
+            }
         }
     ));
     
@@ -214,6 +234,7 @@ void WebSocketClient::on_read(beast::error_code ec, std::size_t bytes_transferre
             std::lock_guard<std::mutex> lock(m_mutex);
             m_open = false;
         }
+        abort_pending();
         schedule_reconnect();
         return;
     }
@@ -225,28 +246,36 @@ void WebSocketClient::on_read(beast::error_code ec, std::size_t bytes_transferre
             std::lock_guard<std::mutex> lock(m_mutex);
             m_open = false;
         }
+        abort_pending();
         schedule_reconnect();
         return;
     }
     
     // Extract the message as a string
     std::string message = beast::buffers_to_string(m_buffer.data());
-    std::cout << "[WebSocket] Received: " << message << std::endl;
-    
+    LOG_DEBUG("WebSocket") << "Received: " << message.substr(0, 200);
 
-
-
-try {
+    try {
         nlohmann::json data = nlohmann::json::parse(message);
         std::string msgType = data.value("type", "");
         
-        if (msgType == "command") {
-            // It's a command - process it
-            std::cout << "[WebSocket] Processing command..." << std::endl;
-            std::string response = CommandProcessor::executeCommand(message);
-            if (!response.empty()) {
-                send(response);
+        if (msgType == "telemetry_ack") {
+            // One per batch; anything but "accepted" sends the batch to the spool
+            uint64_t batchId = data.value("batch_id", (uint64_t)0);
+            std::string status = data.value("status", "");
+            if (status != "accepted") {
+                LOG_WARN("WebSocket") << "Batch " << batchId << " " << status << ": " << data.value("message", "");
             }
+            complete_batch(batchId, status == "accepted");
+        } else if (msgType == "command") {
+            // It's a command - process it off the strand; send() posts the response back
+            std::cout << "[WebSocket] Processing command..." << std::endl;
+            net::post(m_command_pool, [this, message = std::move(message)]() {
+                std::string response = CommandProcessor::executeCommand(message);
+                if (!response.empty()) {
+                    send(response);
+                }
+            });
         } else if (msgType == "connection_established") {
             // Welcome message - just log it
             std::cout << "[WebSocket] Server says: " << data.value("message", "") << std::endl;
@@ -268,6 +297,8 @@ try {
 // ============================================================
 // Send
 // ============================================================
+// Both only post to the strand; the write itself happens in do_write.
+// ============================================================
 void WebSocketClient::send(const std::string& data) {
     // Check if connected
     {
@@ -277,34 +308,167 @@ void WebSocketClient::send(const std::string& data) {
             return;
         }
     }
-    
-    // Use post to ensure thread safety
-    net::post(m_ws->get_executor(), [this, data]() {
-        beast::error_code ec;
-        
-        // Set text mode for JSON
-        m_ws->text(true);
-        
-        // Synchronous write (simpler for our use case)
-        m_ws->write(net::buffer(data), ec);
-        
-        if (ec) {
-            std::cerr << "[WebSocket] Write error: " << ec.message() << std::endl;
-        } else {
-            std::cout << "[WebSocket] Sent: " << data.substr(0, 100) << "..." << std::endl;
+
+    Frame frame;
+    frame.data = std::make_shared<const std::string>(data);
+    net::post(m_strand, [this, frame = std::move(frame)]() mutable {
+        enqueue(std::move(frame));
+    });
+}
+
+bool WebSocketClient::sendBatch(const std::vector<uint8_t>& compressed, Completion done) {
+    uint64_t batchId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open || m_pending.size() >= m_config.maxPendingBatches) {
+            return false;   // Backpressure: the pipeline sends this one over HTTP
         }
+        batchId = m_next_batch_id++;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_config.ackTimeoutMs);
+        m_pending.emplace(batchId, PendingBatch{std::move(done), deadline});
+    }
+
+    // u64 batch_id, little-endian, then the zstd frame as-is
+    auto data = std::make_shared<std::string>();
+    data->reserve(sizeof(batchId) + compressed.size());
+    for (size_t i = 0; i < sizeof(batchId); i++) {
+        data->push_back((char)(uint8_t)(batchId >> (8 * i)));
+    }
+    data->append((const char*)compressed.data(), compressed.size());
+
+    Frame frame;
+    frame.data = std::move(data);
+    frame.binary = true;
+    frame.batchId = batchId;
+    net::post(m_strand, [this, frame = std::move(frame)]() mutable {
+        enqueue(std::move(frame));
     });
+    return true;
+}
+
+// ============================================================
+// Write Queue
+// ============================================================
+void WebSocketClient::enqueue(Frame frame) {
+    if (!is_open()) {
+        // Lost the connection after the frame was accepted
+        if (frame.batchId != 0) complete_batch(frame.batchId, false);
+        return;
+    }
+
+    bool isBatch = frame.batchId != 0;
+    m_write_queue.push_back(std::move(frame));
+    do_write();
+    if (isBatch) arm_ack_timer();
+}
+
+void WebSocketClient::do_write() {
+    if (m_writing || m_write_queue.empty()) return;
+
+    // One async_write at a time; the frame stays at the front until on_write
+    const Frame& frame = m_write_queue.front();
+    m_writing = true;
+    m_ws->binary(frame.binary);
+    m_ws->async_write(
+        net::buffer(*frame.data),
+        beast::bind_front_handler(&WebSocketClient::on_write, this)
+    );
 }
 
 // ============================================================
 // Async Handler: on_write
 // ============================================================
 void WebSocketClient::on_write(beast::error_code ec, std::size_t bytes_transferred) {
-    boost::ignore_unused(bytes_transferred);
-    
+    m_writing = false;
+    if (m_write_queue.empty()) return;   // Queue was reset by a reconnect
+
+    Frame frame = std::move(m_write_queue.front());
+    m_write_queue.pop_front();
+
     if (ec) {
         std::cerr << "[WebSocket] Write error: " << ec.message() << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = false;
+        }
+        // The read loop sees the same failure and reconnects
+        if (frame.batchId != 0) complete_batch(frame.batchId, false);
+        abort_pending();
+        return;
+    }
+
+    LOG_DEBUG("WebSocket") << "Sent " << (frame.binary ? "binary" : "text") << " frame, "
+                           << bytes_transferred << " bytes";
+    do_write();
+}
+
+// ============================================================
+// Telemetry Acknowledgements
+// ============================================================
+void WebSocketClient::complete_batch(uint64_t batchId, bool ok) {
+    Completion done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pending.find(batchId);
+        if (it == m_pending.end()) return;   // Timed out or aborted already
+        done = std::move(it->second.done);
+        m_pending.erase(it);
+    }
+    done(ok);
+}
+
+void WebSocketClient::abort_pending() {
+    // Frames not written yet go; the one being written finishes in on_write
+    m_write_queue.erase(m_writing ? std::next(m_write_queue.begin()) : m_write_queue.begin(),
+                        m_write_queue.end());
+
+    std::unordered_map<uint64_t, PendingBatch> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.swap(m_pending);
+    }
+    if (pending.empty()) return;
+
+    LOG_WARN("WebSocket") << pending.size() << " unacknowledged batch(es) handed back";
+    for (auto& entry : pending) {
+        entry.second.done(false);
+    }
+}
+
+void WebSocketClient::arm_ack_timer() {
+    if (m_ack_timer_armed) return;
+    m_ack_timer_armed = true;
+
+    m_ack_timer.expires_after(std::chrono::seconds(1));
+    m_ack_timer.async_wait(beast::bind_front_handler(&WebSocketClient::on_ack_timer, this));
+}
+
+void WebSocketClient::on_ack_timer(beast::error_code ec) {
+    m_ack_timer_armed = false;
+    if (ec) return;
+
+    std::vector<Completion> expired;
+    bool remaining;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = m_pending.begin(); it != m_pending.end();) {
+            if (it->second.deadline <= now) {
+                expired.push_back(std::move(it->second.done));
+                it = m_pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        remaining = !m_pending.empty();
+    }
+
+    if (!expired.empty()) {
+        LOG_WARN("WebSocket") << expired.size() << " batch(es) not acknowledged within "
+                              << m_config.ackTimeoutMs << " ms";
+        for (auto& done : expired) done(false);
     }
+    if (remaining) arm_ack_timer();
 }
 
 // ============================================================
@@ -323,18 +487,22 @@ void WebSocketClient::close() {
     }
     
     // Check if already closed
+    bool wasOpen;
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        if (!m_open) {
-            // Just make sure thread is cleaned up
-            if (m_io_thread.joinable()) {
-                m_ioc.stop();
-                m_io_thread.join();
-            }
-            return;
-        }
+        wasOpen = m_open;
         m_open = false;
     }
+    if (!wasOpen) {
+        // Just make sure thread is cleaned up (outside the lock: handlers take it)
+        if (m_io_thread.joinable()) {
+            m_ioc.stop();
+            m_io_thread.join();
+        }
+        m_command_pool.join();
+        abort_pending();
+        return;
+    }
     
     std::cout << "[WebSocket] Closing connection..." << std::endl;
     
@@ -352,6 +520,12 @@ void WebSocketClient::close() {
     if (m_io_thread.joinable()) {
         m_io_thread.join();
     }
+
+    // A running command finishes first; its response is dropped (not connected)
+    m_command_pool.join();
+
+    // The I/O thread is gone, so this is the only thread left touching the queue
+    abort_pending();
     
     std::cout << "[WebSocket] Connection closed." << std::endl;
 }
@@ -404,7 +578,7 @@ void WebSocketClient::schedule_reconnect() {
     
     // Create or reset the timer
     if (!m_reconnect_timer) {
-        m_reconnect_timer = std::make_unique<net::steady_timer>(m_ioc);
+        m_reconnect_timer = std::make_unique<net::steady_timer>(m_strand);
     }
     
     m_reconnect_timer->expires_after(std::chrono::milliseconds(m_retry_delay_ms));
@@ -422,9 +596,13 @@ void WebSocketClient::schedule_reconnect() {
 void WebSocketClient::do_reconnect() {
     std::cout << "[WebSocket] Attempting reconnection to " << m_host << ":" << m_port << m_path << std::endl;
     
+    // Nothing written on the old stream can complete anymore
+    m_write_queue.clear();
+    m_writing = false;
+
     // Reset the WebSocket stream for a fresh connection
     // Using reset() because unique_ptr allows this (unlike direct assignment)
-    m_ws.reset(new websocket::stream<beast::tcp_stream>(net::make_strand(m_ioc)));
+    m_ws.reset(new websocket::stream<beast::tcp_stream>(m_strand));
     
     // Start the resolution chain again
     m_resolver.async_resolve(
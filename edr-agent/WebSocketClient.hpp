@@ -2,13 +2,17 @@
 #ifndef WEBSOCKETCLIENT_HPP
 #define WEBSOCKETCLIENT_HPP
 
+#include "BatchTransport.hpp"
 #include "CommandProcessor.hpp"
+#include <chrono>
+#include <deque>
 #include <string>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
 #include <memory>
+#include <unordered_map>
 
 // ============================================================
 // Boost.Beast WebSocket Client
@@ -16,11 +20,35 @@
 // This implementation uses Boost.Beast (part of Boost) instead of
 // the separate WebSocket++ library. Beast is actively maintained
 // and compatible with modern Boost versions (1.87+).
+//
+// Everything goes out through one write queue on the strand: frames are
+// held as shared_ptr buffers and exactly one async_write is outstanding
+// at a time, so callers on any thread only post and never wait.
+//
+// Telemetry (sender.transport = "websocket") rides the same connection
+// as commands. Each batch is one binary frame:
+//
+//   u64 batch_id (little-endian)   zstd frame of the batch body
+//
+// and the server answers {"type": "telemetry_ack", "batch_id": N,
+// "status": "accepted" | ...}. Up to maxPendingBatches batches may be
+// unanswered; beyond that sendBatch() refuses and the pipeline falls back
+// to HTTP. A batch whose ack does not come within ackTimeoutMs, or whose
+// connection drops first, is reported as failed (and so spooled).
+//
+// Commands run one at a time on their own thread, never on the strand: a
+// slow one (a process tree kill, isolation) would otherwise hold up
+// telemetry writes, acks and the ack timer. The response is posted back
+// to the write queue like any other frame.
+//
+// The batches are zstd already, so permessage-deflate is off by default;
+// it only pays off for the JSON command traffic.
 // ============================================================
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 // Namespace Aliases (Makes code cleaner)
@@ -29,9 +57,17 @@ namespace websocket = beast::websocket;   // From <boost/beast/websocket.hpp>
 namespace net = boost::asio;              // From <boost/asio.hpp>
 using tcp = boost::asio::ip::tcp;         // From <boost/asio/ip/tcp.hpp>
 
-class WebSocketClient {
+struct WebSocketConfig {
+    size_t maxPendingBatches = 8;        // Sent but not acknowledged yet
+    unsigned ackTimeoutMs = 30000;
+    bool permessageDeflate = false;
+    std::string authToken;               // Sent as "Authorization: Token ..." in the handshake
+    std::string agentId;                 // X-Agent-ID: the server delivers queued commands on connect
+};
+
+class WebSocketClient : public BatchTransport {
 public:
-    WebSocketClient();
+    explicit WebSocketClient(const WebSocketConfig& config = WebSocketConfig());
     ~WebSocketClient();
     
     // ============================================================
@@ -41,8 +77,12 @@ public:
     // Connects to the Server (e.g., "ws://192.168.x.x:8000/ws/agent/")
     void connect(const std::string& uri);
     
-    // Sends a JSON response back to the server
+    // Queues a JSON response for the server (dropped while disconnected)
     void send(const std::string& data);
+
+    // Queues a telemetry batch as a binary frame; see the header comment
+    bool sendBatch(const std::vector<uint8_t>& compressed, Completion done) override;
+    size_t maxInFlight() const override { return m_config.maxPendingBatches; }
     
     // Closes the connection cleanly
     void close();
@@ -63,6 +103,25 @@ private:
     
     // Start the async read loop
     void do_read();
+
+    // Write queue (strand only)
+    struct Frame {
+        std::shared_ptr<const std::string> data;
+        bool binary = false;
+        uint64_t batchId = 0;            // 0 = not a telemetry batch
+    };
+    void enqueue(Frame frame);
+    void do_write();
+
+    // Telemetry acknowledgements
+    struct PendingBatch {
+        Completion done;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    void complete_batch(uint64_t batchId, bool ok);
+    void abort_pending();                // Connection lost: fail every unanswered batch
+    void arm_ack_timer();
+    void on_ack_timer(beast::error_code ec);
     
     // Schedule a reconnection attempt after delay
     void schedule_reconnect();
@@ -79,6 +138,11 @@ private:
     
     // The io_context is the core I/O event loop (like the "Chef" analogy)
     net::io_context m_ioc;
+
+    // Every handler and the write queue run on this strand
+    net::strand<net::io_context::executor_type> m_strand;
+
+    WebSocketConfig m_config;
     
     // Resolver: Translates hostname to IP address
     tcp::resolver m_resolver;
@@ -102,11 +166,22 @@ private:
     int m_retry_delay_ms;                     // Current delay in ms
     int m_max_retry_delay_ms;                 // Max delay cap
     std::unique_ptr<net::steady_timer> m_reconnect_timer;
+
+    // Strand only: frames waiting to be written, front = the one being written
+    std::deque<Frame> m_write_queue;
+    bool m_writing = false;
+    net::steady_timer m_ack_timer;
+    bool m_ack_timer_armed = false;
+
+    // Batches sent and not acknowledged yet (guarded by m_mutex)
+    std::unordered_map<uint64_t, PendingBatch> m_pending;
+    uint64_t m_next_batch_id = 1;
     
     // Thread Safety
     bool m_open;
     bool m_should_reconnect;                  // Whether to attempt reconnection
     std::thread m_io_thread;                  // Background worker thread
+    net::thread_pool m_command_pool{1};       // CommandProcessor, off the strand, in arrival order
     mutable std::mutex m_mutex;               // Lock for thread safety
     std::condition_variable m_cv;            // Signal for waiting threads
 };